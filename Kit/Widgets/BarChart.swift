@@ -27,6 +27,12 @@ public class BarChart: WidgetWrapper {
     
     public var NSLabelCharts: [NSAttributedString] = []
     
+    private struct BarLevel: Hashable {
+        let level: Int
+        let zone: Int
+        let color: NSColor?
+    }
+    
     public init(title: String, config: NSDictionary?, preview: Bool = false) {
         var widgetTitle: String = title
         
@@ -223,18 +229,23 @@ public class BarChart: WidgetWrapper {
     }
     
     public func setValue(_ newValue: [[ColorValue]]) {
-        let updated = self.queue.sync { () -> Bool in
-            let tolerance: CGFloat = 0.01
-            let isDifferent = self._value.count != newValue.count || zip(self._value, newValue).contains { row1, row2 in
-                row1.count != row2.count || zip(row1, row2).contains { val1, val2 in
-                    abs(val1.value - val2.value) > tolerance || val1.color != val2.color
-                }
-            }
-            guard isDifferent else { return false }
+        let zones = self.queue.sync { () -> colorZones in
             self._value = newValue
-            return true
+            return self._colorZones
         }
-        if updated {
+        
+        // bars are compared by their height in pixels and the color zone, smaller changes are not visible
+        let step = 1 / max(self.shadowSize.height * (NSScreen.main?.backingScaleFactor ?? 1), 1)
+        let signature = newValue.map { row in
+            row.map { v in
+                BarLevel(
+                    level: WidgetRenderCache.quantize(v.value, step: step),
+                    zone: v.value < zones.orange ? 0 : v.value < zones.red ? 1 : 2,
+                    color: v.color
+                )
+            }
+        }
+        if self.renderCache.update(0, signature, rect: CGRect(origin: .zero, size: self.shadowSize)) != nil {
             self.redraw()
         }
     }
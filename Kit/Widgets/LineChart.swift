@@ -58,6 +58,7 @@ public class LineChart: WidgetWrapper {
     private var frameSettingsView: NSSwitch? = nil
     
     public var NSLabelCharts: [NSAttributedString] = []
+    private var labelImage: (key: String, image: NSImage)? = nil
     
     public init(title: String, config: NSDictionary?, preview: Bool = false) {
         var widgetTitle: String = title
@@ -171,38 +172,23 @@ public class LineChart: WidgetWrapper {
         }
         
         if self.labelState {
-            let letterHeight = self.frame.height / 3
             let letterWidth: CGFloat = 6.0
-            
-            var yMargin: CGFloat = 0
-            for char in self.NSLabelCharts {
-                let rect = CGRect(x: x, y: yMargin, width: letterWidth, height: letterHeight)
-                char.draw(with: rect)
-                yMargin += letterHeight
-            }
+            let size = NSSize(width: letterWidth, height: self.frame.height)
+            self.label(size).draw(in: NSRect(origin: CGPoint(x: x, y: 0), size: size))
             
             width += letterWidth + Constants.Widget.spacing
             x = letterWidth + Constants.Widget.spacing
         }
         
         if self.valueState {
-            let style = NSMutableParagraphStyle()
-            style.alignment = .right
-            
             var valueColor = isDarkMode ? NSColor.white : NSColor.black
             if self.valueColorState {
                 valueColor = color
             }
             
-            let stringAttributes = [
-                NSAttributedString.Key.font: NSFont.systemFont(ofSize: 8, weight: .regular),
-                NSAttributedString.Key.foregroundColor: valueColor,
-                NSAttributedString.Key.paragraphStyle: style
-            ]
-            
             let rect = CGRect(x: x+2, y: boxSize.height-7, width: boxSize.width - 2, height: 7)
-            let str = NSAttributedString.init(string: "\(Int((value.rounded(toPlaces: 2)) * 100))%", attributes: stringAttributes)
-            str.draw(with: rect)
+            let str = "\(Int((value.rounded(toPlaces: 2)) * 100))%"
+            self.text(str, font: NSFont.systemFont(ofSize: 8, weight: .regular), color: valueColor, alignment: .right).draw(with: rect)
             
             boxSize.height = offset == 0.5 ? 10 : 9
         }
@@ -247,6 +233,27 @@ public class LineChart: WidgetWrapper {
         self.setWidth(width)
     }
     
+    // the label letters are static, they are rendered once per size and appearance
+    private func label(_ size: NSSize) -> NSImage {
+        let key = "\(size.width)x\(size.height)_\(isDarkMode)"
+        if let cached = self.labelImage, cached.key == key {
+            return cached.image
+        }
+        
+        let letters = self.NSLabelCharts
+        let image = NSImage(size: size, flipped: false) { rect in
+            let letterHeight = rect.height / 3
+            var yMargin: CGFloat = 0
+            for char in letters {
+                char.draw(with: CGRect(x: 0, y: yMargin, width: rect.width, height: letterHeight))
+                yMargin += letterHeight
+            }
+            return true
+        }
+        self.labelImage = (key, image)
+        return image
+    }
+    
     public func setValue(_ newValue: Double) {
         self.queue.sync {
             self._value = newValue
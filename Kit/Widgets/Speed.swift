@@ -34,6 +34,11 @@ public class SpeedWidget: WidgetWrapper {
     
     private var width: CGFloat = 58
     
+    private struct SpeedRow: Hashable {
+        let value: String
+        let active: Bool
+    }
+    
     private var valueColorView: NSPopUpButton? = nil
     private var valueAlignmentView: NSPopUpButton? = nil
     private var iconAlignmentView: NSPopUpButton? = nil
@@ -235,22 +240,12 @@ public class SpeedWidget: WidgetWrapper {
     private func drawValue(_ value: Int64, offset: CGPoint, color: NSColor) -> CGFloat {
         let rowWidth: CGFloat = self.unitsState ? 58 : 32
         let height: CGFloat = self.frame.height
-        let style = NSMutableParagraphStyle()
-        style.alignment = self.valueAlignment
         let size: CGFloat = 10
         
-        let inputStringAttributes = [
-            NSAttributedString.Key.font: NSFont.systemFont(ofSize: 11, weight: .regular),
-            NSAttributedString.Key.foregroundColor: color,
-            NSAttributedString.Key.paragraphStyle: style
-        ]
-        
         let rect = CGRect(x: offset.x, y: (height-size)/2 + offset.y + 1, width: rowWidth - (Constants.Widget.margin.x*2), height: size)
-        let value = NSAttributedString.init(
-            string: Units(bytes: value).getReadableSpeed(base: base, unit: self.speedUnit, omitUnits: !self.unitsState),
-            attributes: inputStringAttributes
-        )
-        value.draw(with: rect)
+        if self.needsToDraw(rect) {
+            self.text(self.formatted(value), font: NSFont.systemFont(ofSize: 11, weight: .regular), color: color, alignment: self.valueAlignment).draw(with: rect)
+        }
         
         return rowWidth
     }
@@ -339,36 +334,21 @@ public class SpeedWidget: WidgetWrapper {
         if self.valueState {
             let rowWidth: CGFloat = self.unitsState ? 48 : 30
             let rowHeight: CGFloat = self.frame.height / 2
-            let style = NSMutableParagraphStyle()
-            style.alignment = self.valueAlignment
-            
-            let inputStringAttributes = [
-                NSAttributedString.Key.font: NSFont.systemFont(ofSize: 9, weight: .light),
-                NSAttributedString.Key.foregroundColor: self.inputColor(self.valueColorState),
-                NSAttributedString.Key.paragraphStyle: style
-            ]
-            let outputStringAttributes = [
-                NSAttributedString.Key.font: NSFont.systemFont(ofSize: 9, weight: .light),
-                NSAttributedString.Key.foregroundColor: self.outputColor(self.valueColorState),
-                NSAttributedString.Key.paragraphStyle: style
-            ]
+            let font = NSFont.systemFont(ofSize: 9, weight: .light)
             
             let inputY: CGFloat = self.displayValueState == "io" ? rowHeight + 1 : 1
             let outputY: CGFloat = self.displayValueState == "io" ? 1 : rowHeight + 1
             
+            // only the rows inside the dirty region are drawn
             var rect = CGRect(x: Constants.Widget.margin.x + x, y: inputY, width: rowWidth - (Constants.Widget.margin.x*2), height: rowHeight)
-            let input = NSAttributedString.init(
-                string: Units(bytes: self.inputValue).getReadableSpeed(base: base, unit: self.speedUnit, omitUnits: !self.unitsState),
-                attributes: inputStringAttributes
-            )
-            input.draw(with: rect)
+            if self.needsToDraw(rect) {
+                self.text(self.formatted(self.inputValue), font: font, color: self.inputColor(self.valueColorState), alignment: self.valueAlignment).draw(with: rect)
+            }
             
             rect = CGRect(x: Constants.Widget.margin.x + x, y: outputY, width: rowWidth - (Constants.Widget.margin.x*2), height: rowHeight)
-            let output = NSAttributedString.init(
-                string: Units(bytes: self.outputValue).getReadableSpeed(base: base, unit: self.speedUnit, omitUnits: !self.unitsState),
-                attributes: outputStringAttributes
-            )
-            output.draw(with: rect)
+            if self.needsToDraw(rect) {
+                self.text(self.formatted(self.outputValue), font: font, color: self.outputColor(self.valueColorState), alignment: self.valueAlignment).draw(with: rect)
+            }
             
             width += rowWidth
         }
@@ -654,24 +634,35 @@ public class SpeedWidget: WidgetWrapper {
     }
     
     public func setValue(input: Int64, output: Int64) {
-        var updated: Bool = false
+        guard self.inputValue != input || self.outputValue != output else { return }
+        self.inputValue = abs(input)
+        self.outputValue = abs(output)
         
-        if self.inputValue != input {
-            self.inputValue = abs(input)
-            updated = true
-        }
-        if self.outputValue != output {
-            self.outputValue = abs(output)
-            updated = true
+        // the widget changes only when the formatted value or the active state changes
+        let input = SpeedRow(value: self.valueState ? self.formatted(self.inputValue) : "", active: self.inputValue >= 1024)
+        let output = SpeedRow(value: self.valueState ? self.formatted(self.outputValue) : "", active: self.outputValue >= 1024)
+        let bounds = CGRect(origin: .zero, size: self.shadowSize)
+        
+        var regions: [(id: Int, signature: AnyHashable, rect: CGRect)] = [(0, AnyHashable(input), bounds), (1, AnyHashable(output), bounds)]
+        if self.modeState == "twoRows" {
+            let half = bounds.height / 2
+            let top = CGRect(x: 0, y: half, width: bounds.width, height: half)
+            let bottom = CGRect(x: 0, y: 0, width: bounds.width, height: half)
+            regions = [
+                (0, AnyHashable(input), self.displayValueState == "io" ? top : bottom),
+                (1, AnyHashable(output), self.displayValueState == "io" ? bottom : top)
+            ]
         }
         
-        if updated {
-            DispatchQueue.main.async(execute: {
-                self.display()
-            })
+        if let rect = self.renderCache.update(regions) {
+            self.redraw(rect)
         }
     }
     
+    private func formatted(_ value: Int64) -> String {
+        Units(bytes: value).getReadableSpeed(base: self.base, unit: self.speedUnit, omitUnits: !self.unitsState)
+    }
+    
     @objc private func toggleValueAlignment(_ sender: NSMenuItem) {
         guard let key = sender.representedObject as? String else { return }
         if let newAlignment = Alignments.first(where: { $0.key == key }) {
@@ -169,21 +169,13 @@ public class StackWidget: WidgetWrapper {
             font = NSFont.monospacedDigitSystemFont(ofSize: 13, weight: .regular)
         }
         
-        let style = NSMutableParagraphStyle()
-        style.alignment = alignment
-        
         var width: CGFloat = self.oneRowWidth
         if !fixedSizeState {
             width = element.value.widthOfString(usingFont: font).rounded(.up) + 2
         }
         
         let rect = CGRect(x: x, y: (Constants.Widget.height-13)/2, width: width, height: 13)
-        let str = NSAttributedString.init(string: element.value, attributes: [
-            NSAttributedString.Key.font: font,
-            NSAttributedString.Key.foregroundColor: NSColor.textColor,
-            NSAttributedString.Key.paragraphStyle: style
-        ])
-        str.draw(with: rect)
+        self.text(element.value, font: font, color: .textColor, alignment: alignment).draw(with: rect)
         
         return width
     }
@@ -205,14 +197,6 @@ public class StackWidget: WidgetWrapper {
         } else {
             font = NSFont.systemFont(ofSize: 10, weight: .light)
         }
-        let style = NSMutableParagraphStyle()
-        style.alignment = alignment
-        
-        let attributes = [
-            NSAttributedString.Key.font: font,
-            NSAttributedString.Key.foregroundColor: NSColor.textColor,
-            NSAttributedString.Key.paragraphStyle: style
-        ]
         
         var width: CGFloat = self.twoRowWidth
         if !fixedSizeState {
@@ -222,13 +206,11 @@ public class StackWidget: WidgetWrapper {
         }
         
         var rect = CGRect(x: x, y: rowHeight+1, width: width, height: rowHeight)
-        var str = NSAttributedString.init(string: topElement.value, attributes: attributes)
-        str.draw(with: rect)
+        self.text(topElement.value, font: font, color: .textColor, alignment: alignment).draw(with: rect)
         
-        if bottomElement != nil {
+        if let bottomElement {
             rect = CGRect(x: x, y: 1, width: width, height: rowHeight)
-            str = NSAttributedString.init(string: bottomElement!.value, attributes: attributes)
-            str.draw(with: rect)
+            self.text(bottomElement.value, font: font, color: .textColor, alignment: alignment).draw(with: rect)
         }
         
         return width
@@ -258,7 +240,11 @@ public class StackWidget: WidgetWrapper {
             if tableNeedsToBeUpdated {
                 self.orderTableView.update()
             }
-            self.display()
+            
+            let signature = self.queue.sync { self.values.map{ "\($0.key)=\($0.value)" } }
+            if self.renderCache.update(0, signature, rect: self.bounds) != nil || tableNeedsToBeUpdated {
+                self.display()
+            }
         })
     }
     
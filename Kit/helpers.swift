@@ -160,15 +160,15 @@ public struct Units {
         case ..<1_000:
             return ("0", "K\(stringBase)/s")
         case 1_000..<1_000_000:
-            return (String(format: "%.0f", value/1_000), "K\(stringBase)/s")
+            return (ValueFormatter.decimal(value/1_000, digits: 0), "K\(stringBase)/s")
         case 1_000_000..<100_000_000:
-            return (String(format: "%.1f", value/1_000_000), "M\(stringBase)/s")
+            return (ValueFormatter.decimal(value/1_000_000, digits: 1), "M\(stringBase)/s")
         case 100_000_000..<1_000_000_000:
-            return (String(format: "%.0f", value/1_000_000), "M\(stringBase)/s")
+            return (ValueFormatter.decimal(value/1_000_000, digits: 0), "M\(stringBase)/s")
         case 1_000_000_000..<1_000_000_000_000:
-            return (String(format: "%.1f", value/1_000_000_000), "G\(stringBase)/s")
+            return (ValueFormatter.decimal(value/1_000_000_000, digits: 1), "G\(stringBase)/s")
         default:
-            return (String(format: "%.1f", value/1_000_000_000_000), "T\(stringBase)/s")
+            return (ValueFormatter.decimal(value/1_000_000_000_000, digits: 1), "T\(stringBase)/s")
         }
     }
     
@@ -178,17 +178,7 @@ public struct Units {
     }
     
     public func getReadableMemory(style: ByteCountFormatter.CountStyle = .file) -> String {
-        let formatter: ByteCountFormatter = ByteCountFormatter()
-        formatter.countStyle = style
-        formatter.includesUnit = true
-        formatter.isAdaptive = true
-        
-        var value = formatter.string(fromByteCount: Int64(self.bytes))
-        if let idx = value.lastIndex(of: ",") {
-            value.replaceSubrange(idx...idx, with: ".")
-        }
-        
-        return value
+        return ValueFormatter.shared.memory(self.bytes, style: style)
     }
     
     public func toUnit(_ unit: SizeUnit) -> Double {
@@ -202,24 +192,16 @@ public struct Units {
     }
     
     private func formatSpeedValue(_ value: Double) -> String {
-        let formatter = NumberFormatter()
-        formatter.numberStyle = .decimal
-        formatter.decimalSeparator = "."
-        formatter.usesGroupingSeparator = false
-        formatter.minimumFractionDigits = 0
-        
         switch value {
         case 0:
-            formatter.maximumFractionDigits = 0
+            return ValueFormatter.decimal(value, digits: 0)
         case ..<10:
-            formatter.maximumFractionDigits = 2
+            return ValueFormatter.decimal(value, digits: 2, trim: true)
         case ..<100:
-            formatter.maximumFractionDigits = 1
+            return ValueFormatter.decimal(value, digits: 1, trim: true)
         default:
-            formatter.maximumFractionDigits = 0
+            return ValueFormatter.decimal(value, digits: 0)
         }
-        
-        return formatter.string(from: NSNumber(value: value)) ?? String(format: "%.2f", value)
     }
 }
 
@@ -909,9 +891,7 @@ public func localizedString(_ key: String, _ params: String..., comment: String
 
 public extension UnitTemperature {
     static var system: UnitTemperature {
-        let measureFormatter = MeasurementFormatter()
-        let measurement = Measurement(value: 0, unit: UnitTemperature.celsius)
-        return measureFormatter.string(from: measurement).hasSuffix("C") ? .celsius : .fahrenheit
+        return ValueFormatter.shared.systemTemperatureUnit
     }
     
     static var current: UnitTemperature {
@@ -927,18 +907,7 @@ public extension UnitTemperature {
 }
 
 public func temperature(_ value: Double, defaultUnit: UnitTemperature = UnitTemperature.celsius, fractionDigits: Int = 0) -> String {
-    let formatter = MeasurementFormatter()
-    formatter.locale = Locale.init(identifier: "en_US")
-    formatter.numberFormatter.maximumFractionDigits = fractionDigits
-    if fractionDigits != 0 {
-        formatter.numberFormatter.minimumFractionDigits = fractionDigits
-    }
-    formatter.unitOptions = .providedUnit
-    
-    var measurement = Measurement(value: value, unit: defaultUnit)
-    measurement.convert(to: UnitTemperature.current)
-    
-    return formatter.string(from: measurement)
+    return ValueFormatter.shared.temperature(value, from: defaultUnit, to: UnitTemperature.current, fractionDigits: fractionDigits)
 }
 
 public func sysctlByName(_ name: String) -> Int64 {
@@ -16,7 +16,7 @@ open class NotificationsWrapper: NSStackView {
     public let module: String
     
     private var ids: [String: Bool?] = [:]
-    private var streak: [String: Int] = [:]
+    private let rules = RuleEngine()
     
     public init(_ module: ModuleType, _ ids: [String] = []) {
         self.module = module.stringValue
@@ -43,32 +43,31 @@ open class NotificationsWrapper: NSStackView {
         for id in ids {
             let notificationID = "Stats_\(self.module)_\(id)"
             self.ids[notificationID] = nil
-            self.streak[notificationID] = 0
+            self.rules.remove(notificationID)
             removeNotification(notificationID)
         }
     }
     
     public func checkDouble(id rid: String, value: Double, threshold: Double, title: String, subtitle: String, less: Bool = false, consecutive: Int = 2) {
+        // a NaN reading is skipped, it leaves the state as it is
+        guard !value.isNaN else { return }
         let id = "Stats_\(self.module)_\(rid)"
-        let first = less ? value > threshold : value < threshold
-        let second = less ? value <= threshold : value >= threshold
-
-        if self.ids[id] != nil, first {
-            removeNotification(id)
-            self.ids[id] = nil
-        }
-
-        if first {
-            self.streak[id] = 0
-        }
-
-        if self.ids[id] == nil && second {
-            let count = (self.streak[id] ?? 0) + 1
-            self.streak[id] = count
-            if count >= max(1, consecutive) {
+        let slot = self.rules.slot(id)
+        self.rules.set(NotificationRule(id: id, conditions: [RuleCondition(slot: slot, less ? .below(threshold) : .above(threshold))], consecutive: consecutive))
+        self.rules.update(slot, value)
+        
+        // only the rule of the updated value is evaluated, a fired rule is not shown again until it is cleared
+        let time = TimeInterval(DispatchTime.now().uptimeNanoseconds) / 1_000_000_000
+        for event in self.rules.evaluate(time) {
+            switch event {
+            case .fired(let id):
                 self.showNotification(id: id, title: title, subtitle: subtitle)
                 self.ids[id] = true
-                self.streak[id] = 0
+            case .cleared(let id):
+                if self.ids[id] != nil {
+                    removeNotification(id)
+                    self.ids[id] = nil
+                }
             }
         }
     }
@@ -116,6 +116,7 @@ open class Reader<T: Codable>: NSObject, ReaderInternal_p {
         if let value {
             self.callbackHandler(value)
             SystemStats.shared.send(key: moduleKey, value: value)
+            OpenMetricsExporter.shared.send(key: moduleKey, value: value)
             if let ts = self.lastDBWrite, let interval = self.interval, Date().timeIntervalSince(ts) > interval * 10 {
                 DB.shared.insert(key: moduleKey, value: value, ts: self.history)
                 self.lastDBWrite = Date()
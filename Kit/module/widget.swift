@@ -148,6 +148,13 @@ public enum widget_t: String {
 }
 extension widget_t: CaseIterable {}
 
+internal struct WidgetText: Hashable {
+    let string: String
+    let font: NSFont
+    let color: NSColor
+    let alignment: NSTextAlignment
+}
+
 public protocol widget_p: NSView {
     var widthHandler: (() -> Void)? { get set }
     var onClick: (() -> Void)? { get set }
@@ -163,6 +170,12 @@ open class WidgetWrapper: NSView, widget_p {
     public var shadowSize: CGSize
     internal var queue: DispatchQueue
     
+    public let renderCache: WidgetRenderCache = WidgetRenderCache()
+    public var redrawsPerMinute: Int {
+        self.renderCache.redrawsPerMinute
+    }
+    private let texts: LRUCache<WidgetText, NSAttributedString> = LRUCache(capacity: 32)
+    
     public init(_ type: widget_t, title: String, frame: NSRect) {
         self.type = type
         self.title = title
@@ -219,6 +232,31 @@ open class WidgetWrapper: NSView, widget_p {
         }
     }
     
+    // redraws only the changed part of the widget
+    public func redraw(_ rect: CGRect) {
+        DispatchQueue.main.async { [weak self] in
+            self?.setNeedsDisplay(rect)
+        }
+    }
+    
+    open override func draw(_ dirtyRect: NSRect) {
+        super.draw(dirtyRect)
+        self.renderCache.drawn()
+    }
+    
+    // attributed strings are reused while the text and the style are the same
+    internal func text(_ string: String, font: NSFont, color: NSColor, alignment: NSTextAlignment = .left) -> NSAttributedString {
+        self.texts.value(WidgetText(string: string, font: font, color: color, alignment: alignment)) {
+            let style = NSMutableParagraphStyle()
+            style.alignment = alignment
+            return NSAttributedString(string: string, attributes: [
+                NSAttributedString.Key.font: font,
+                NSAttributedString.Key.foregroundColor: color,
+                NSAttributedString.Key.paragraphStyle: style
+            ])
+        }
+    }
+    
     open func settings() -> NSView { return NSView() }
     
     open override func mouseDown(with event: NSEvent) {
@@ -0,0 +1,96 @@
+//
+//  Accelerator.swift
+//  Kit
+//
+//  Created by Serhiy Mytrovtsiy on 19/10/2026.
+//  Using Swift 6.0.
+//  Running on macOS 26.5.
+//
+//  Copyright © 2026 Serhiy Mytrovtsiy. All rights reserved.
+//
+
+import Foundation
+
+// Values of the PerformanceStatistics property of an IOAccelerator. They are read with CF keys
+// created once, the dictionary is never bridged to Swift.
+public struct GPUPerformance: Equatable {
+    public static let property: CFString = "PerformanceStatistics" as CFString
+    
+    private static let utilizationKeys: [CFString] = ["Device Utilization %" as CFString, "GPU Activity(%)" as CFString]
+    private static let rendererKey: CFString = "Renderer Utilization %" as CFString
+    private static let tilerKey: CFString = "Tiler Utilization %" as CFString
+    private static let temperatureKey: CFString = "Temperature(C)" as CFString
+    private static let fanSpeedKey: CFString = "Fan Speed(%)" as CFString
+    private static let coreClockKey: CFString = "Core Clock(MHz)" as CFString
+    private static let memoryClockKey: CFString = "Memory Clock(MHz)" as CFString
+    
+    public var utilization: Int? = nil
+    public var renderer: Int? = nil
+    public var tiler: Int? = nil
+    public var temperature: Int? = nil
+    public var fanSpeed: Int? = nil
+    public var coreClock: Int? = nil
+    public var memoryClock: Int? = nil
+    
+    public init() {}
+    
+    public init(_ stats: CFDictionary) {
+        for key in GPUPerformance.utilizationKeys {
+            if let value = GPUPerformance.int(stats, key) {
+                self.utilization = value
+                break
+            }
+        }
+        self.renderer = GPUPerformance.int(stats, GPUPerformance.rendererKey)
+        self.tiler = GPUPerformance.int(stats, GPUPerformance.tilerKey)
+        self.temperature = GPUPerformance.int(stats, GPUPerformance.temperatureKey)
+        self.fanSpeed = GPUPerformance.int(stats, GPUPerformance.fanSpeedKey)
+        self.coreClock = GPUPerformance.int(stats, GPUPerformance.coreClockKey)
+        self.memoryClock = GPUPerformance.int(stats, GPUPerformance.memoryClockKey)
+    }
+    
+    // integer value of a CFNumber entry, nil for a missing key or another type
+    public static func int(_ dict: CFDictionary, _ key: CFString) -> Int? {
+        guard let raw = CFDictionaryGetValue(dict, Unmanaged.passUnretained(key).toOpaque()) else { return nil }
+        let object = Unmanaged<CFTypeRef>.fromOpaque(raw).takeUnretainedValue()
+        guard CFGetTypeID(object) == CFNumberGetTypeID() else { return nil }
+        var value: Int = 0
+        guard CFNumberGetValue((object as! CFNumber), .nsIntegerType, &value) else { return nil }
+        return value
+    }
+}
+
+// IOPCIMatch / IOPCIPrimaryMatch of an accelerator: "0xDDDDVVVV" identifiers (device and vendor) with
+// an optional "&0xMASK", separated by spaces. It is parsed once and compared as integers.
+public struct GPUPCIMatch: Equatable {
+    public let list: [(value: UInt32, mask: UInt32)]
+    
+    public init(_ string: String) {
+        self.list = string.split(whereSeparator: { $0 == " " || $0 == "\t" || $0 == "\n" }).compactMap { token in
+            let parts = token.split(separator: "&", maxSplits: 1)
+            guard let value = GPUPCIMatch.hex(parts[0]) else { return nil }
+            let mask = parts.count > 1 ? GPUPCIMatch.hex(parts[1]) ?? 0xFFFF_FFFF : 0xFFFF_FFFF
+            return (value, mask)
+        }
+    }
+    
+    // the identifier of a PCI device from its little endian device-id and vendor-id properties
+    public static func id(device: Data, vendor: Data) -> UInt32? {
+        guard device.count >= 2, vendor.count >= 2 else { return nil }
+        let d = device.startIndex, v = vendor.startIndex
+        return UInt32(device[d + 1]) << 24 | UInt32(device[d]) << 16 | UInt32(vendor[v + 1]) << 8 | UInt32(vendor[v])
+    }
+    
+    public func matches(_ id: UInt32) -> Bool {
+        self.list.contains(where: { id & $0.mask == $0.value & $0.mask })
+    }
+    
+    public static func == (lhs: GPUPCIMatch, rhs: GPUPCIMatch) -> Bool {
+        lhs.list.elementsEqual(rhs.list, by: { $0.value == $1.value && $0.mask == $1.mask })
+    }
+    
+    private static func hex(_ value: Substring) -> UInt32? {
+        let value = value.lowercased()
+        return UInt32(value.hasPrefix("0x") ? String(value.dropFirst(2)) : value, radix: 16)
+    }
+}
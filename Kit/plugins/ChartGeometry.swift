@@ -0,0 +1,408 @@
+//
+//  ChartGeometry.swift
+//  Kit
+//
+//  Created by Serhiy Mytrovtsiy on 18/10/2026.
+//  Using Swift 6.0.
+//  Running on macOS 26.5.
+//
+//  Copyright © 2026 Serhiy Mytrovtsiy. All rights reserved.
+//
+
+import Foundation
+
+public enum ChartDecimation: String {
+    case m4
+    case lttb
+}
+
+public struct ChartSample: Equatable {
+    public let index: Int
+    public let value: Double
+    
+    public init(index: Int, value: Double) {
+        self.index = index
+        self.value = value
+    }
+}
+
+public struct ChartFrame {
+    public var x: CGFloat
+    public var y: CGFloat
+    public var width: CGFloat
+    public var height: CGFloat
+    public var flip: Bool
+    public var scale: Scale
+    public var fixedScale: Double
+    public var zeroValue: Double
+    
+    public init(x: CGFloat = 0, y: CGFloat = 0, width: CGFloat, height: CGFloat, flip: Bool = false, scale: Scale = .none, fixedScale: Double = 1, zeroValue: Double = 0.01) {
+        self.x = x
+        self.y = y
+        self.width = width
+        self.height = height
+        self.flip = flip
+        self.scale = scale
+        self.fixedScale = fixedScale
+        self.zeroValue = zeroValue
+    }
+}
+
+// Same math as scaleValue(), but the scale is resolved once per frame instead of for every point.
+internal struct ChartScaler {
+    private enum Mode {
+        case none, linear, square, cube, logarithmic, fixed
+    }
+    
+    private let mode: Mode
+    private let maxValue: Double
+    private let localMax: Double
+    private let height: Double
+    private let zeroValue: Double
+    private let limit: Double
+    
+    init(_ frame: ChartFrame, maxValue: Double) {
+        switch frame.scale.key {
+        case Scale.linear.key: self.mode = .linear
+        case Scale.square.key: self.mode = .square
+        case Scale.cube.key: self.mode = .cube
+        case Scale.logarithmic.key: self.mode = .logarithmic
+        case Scale.fixed.key: self.mode = .fixed
+        default: self.mode = .none
+        }
+        
+        var localMax = maxValue
+        switch self.mode {
+        case .square where maxValue > 0: localMax = sqrt(maxValue)
+        case .cube where maxValue > 0: localMax = cbrt(maxValue)
+        case .logarithmic where maxValue > 0: localMax = log(maxValue/frame.zeroValue)
+        case .fixed: localMax = frame.fixedScale
+        default: break
+        }
+        
+        self.maxValue = maxValue
+        self.localMax = localMax <= 0 ? 1 : localMax
+        self.height = Double(frame.height)
+        self.zeroValue = frame.zeroValue
+        self.limit = frame.fixedScale
+    }
+    
+    func y(_ value: Double) -> Double {
+        var value = value
+        switch self.mode {
+        case .none:
+            if value > 1 && self.maxValue != 0 {
+                value /= self.maxValue
+            }
+            return value * self.height
+        case .square where value > 0: value = sqrt(value)
+        case .cube where value > 0: value = cbrt(value)
+        case .logarithmic where value > 0: value = log(value/self.zeroValue)
+        case .fixed where value > self.limit: value = self.limit
+        default: break
+        }
+        return self.height * Swift.max(value, 0) / self.localMax
+    }
+}
+
+// Incremental M4 reduction of a sliding series: samples are grouped into buckets of about one pixel
+// column and every bucket keeps only its first, min, max and last sample. Buckets are aligned to the
+// absolute sample index, so appending touches only the last bucket and expiring touches only the first.
+public final class ChartDecimator {
+    private struct Bucket {
+        let id: Int
+        var first: ChartSample
+        var last: ChartSample
+        var min: ChartSample
+        var max: ChartSample
+        var broken: Bool = false // the line is interrupted after the bucket
+        
+        init(id: Int, _ sample: ChartSample) {
+            self.id = id
+            self.first = sample
+            self.last = sample
+            self.min = sample
+            self.max = sample
+        }
+        
+        mutating func add(_ sample: ChartSample) {
+            self.last = sample
+            if sample.value < self.min.value {
+                self.min = sample
+            }
+            if sample.value > self.max.value {
+                self.max = sample
+            }
+        }
+    }
+    
+    public let capacity: Int
+    public let columns: Int
+    public let width: Int
+    public var method: ChartDecimation
+    
+    private var buckets: [Bucket] = []
+    private var head: Int = 0
+    
+    public init(capacity: Int, columns: Int, method: ChartDecimation = .m4) {
+        self.capacity = max(capacity, 1)
+        self.columns = max(columns, 1)
+        self.width = max(1, Int((Double(self.capacity) / Double(self.columns)).rounded(.up)))
+        self.method = method
+        self.buckets.reserveCapacity(self.capacity / self.width + 2)
+    }
+    
+    public var count: Int {
+        self.buckets.count - self.head
+    }
+    
+    public var maxValue: Double {
+        var value: Double = 0
+        for i in self.head..<self.buckets.count where self.buckets[i].max.value > value {
+            value = self.buckets[i].max.value
+        }
+        return value
+    }
+    
+    // nil value interrupts the line
+    public func append(_ index: Int, _ value: Double?) {
+        let last = self.buckets.count - 1
+        guard let value else {
+            if last >= self.head {
+                self.buckets[last].broken = true
+            }
+            return
+        }
+        
+        let sample = ChartSample(index: index, value: value)
+        let id = index / self.width
+        if last >= self.head && self.buckets[last].id == id && !self.buckets[last].broken {
+            self.buckets[last].add(sample)
+        } else {
+            self.buckets.append(Bucket(id: id, sample))
+        }
+    }
+    
+    // drops samples older than `oldest`, a partially expired bucket is rebuilt from the source
+    public func trim(oldest: Int, _ value: (Int) -> Double?) {
+        while self.head < self.buckets.count && self.buckets[self.head].last.index < oldest {
+            self.head += 1
+        }
+        
+        if self.head < self.buckets.count && self.buckets[self.head].first.index < oldest {
+            let old = self.buckets[self.head]
+            var bucket: Bucket? = nil
+            for i in oldest...old.last.index {
+                guard let v = value(i) else { continue }
+                let sample = ChartSample(index: i, value: v)
+                if bucket == nil {
+                    bucket = Bucket(id: old.id, sample)
+                } else {
+                    bucket?.add(sample)
+                }
+            }
+            if var bucket {
+                bucket.broken = old.broken
+                self.buckets[self.head] = bucket
+            } else {
+                self.head += 1
+            }
+        }
+        
+        if self.head > 64 && self.head * 2 > self.buckets.count {
+            self.buckets.removeFirst(self.head)
+            self.head = 0
+        }
+    }
+    
+    public func reset() {
+        self.buckets.removeAll(keepingCapacity: true)
+        self.head = 0
+    }
+    
+    // reduced samples split into continuous lines
+    public func samples() -> [[ChartSample]] {
+        var lines: [[ChartSample]] = []
+        var line: [ChartSample] = []
+        line.reserveCapacity(self.count * 4)
+        
+        func add(_ s: ChartSample) {
+            if line.last.map({ $0.index < s.index }) ?? true {
+                line.append(s)
+            }
+        }
+        
+        for i in self.head..<self.buckets.count {
+            let b = self.buckets[i]
+            add(b.first)
+            add(b.min.index <= b.max.index ? b.min : b.max)
+            add(b.min.index <= b.max.index ? b.max : b.min)
+            add(b.last)
+            if b.broken {
+                lines.append(line)
+                line = []
+            }
+        }
+        if !line.isEmpty {
+            lines.append(line)
+        }
+        
+        if self.method == .lttb {
+            lines = lines.map{ ChartDecimator.lttb($0, threshold: max(2, $0.count / 2)) }
+        }
+        
+        return lines
+    }
+    
+    // maps the reduced samples to the frame, `first` is the index drawn at the left edge and `count` the number of slots
+    public func lines(first: Int, count: Int, frame: ChartFrame) -> [[(index: Int, point: CGPoint)]] {
+        let scaler = ChartScaler(frame, maxValue: self.maxValue)
+        let xRatio = count > 1 ? frame.width / CGFloat(count - 1) : 0
+        
+        return self.samples().map { line in
+            line.map { s in
+                var y = CGFloat(scaler.y(s.value))
+                if frame.flip {
+                    y = frame.height - y
+                }
+                return (s.index, CGPoint(x: frame.x + CGFloat(s.index - first) * xRatio, y: y + frame.y))
+            }
+        }
+    }
+    
+    // Largest-Triangle-Three-Buckets, keeps the first and the last sample
+    public static func lttb(_ data: [ChartSample], threshold: Int) -> [ChartSample] {
+        guard threshold >= 3, data.count > threshold else { return data }
+        
+        var result: [ChartSample] = [data[0]]
+        result.reserveCapacity(threshold)
+        let every = Double(data.count - 2) / Double(threshold - 2)
+        var a = 0
+        
+        for i in 0..<threshold-2 {
+            let start = Int(Double(i) * every) + 1
+            let end = min(Int(Double(i + 1) * every) + 1, data.count - 1)
+            let nextStart = end
+            let nextEnd = min(Int(Double(i + 2) * every) + 1, data.count)
+            
+            var avgX: Double = 0, avgY: Double = 0
+            for j in nextStart..<nextEnd {
+                avgX += Double(data[j].index)
+                avgY += data[j].value
+            }
+            let n = Double(max(nextEnd - nextStart, 1))
+            avgX /= n
+            avgY /= n
+            
+            let ax = Double(data[a].index), ay = data[a].value
+            var best = start, area: Double = -1
+            for j in start..<max(end, start + 1) {
+                let s = abs((ax - avgX) * (data[j].value - ay) - (ax - Double(data[j].index)) * (avgY - ay))
+                if s > area {
+                    area = s
+                    best = j
+                }
+            }
+            result.append(data[best])
+            a = best
+        }
+        
+        result.append(data[data.count - 1])
+        return result
+    }
+}
+
+// Streaming estimate of the typical sampling interval: the median of the last `window` positive
+// deltas, kept sorted so an update costs O(window) with a small constant window. Used to detect
+// gaps in the series without rescanning the whole history on every sample.
+public struct IntervalEstimator {
+    public let window: Int
+    public private(set) var last: Date? = nil
+    // the last detected gap, end is the timestamp of the sample which closed it
+    public private(set) var gap: (start: Date, end: Date)? = nil
+    
+    private var deltas: [TimeInterval]
+    private var sorted: [TimeInterval] = []
+    private var head: Int = 0
+    private var interrupted: Bool = true
+    
+    public init(window: Int = 31) {
+        self.window = max(window, 1)
+        self.deltas = []
+        self.deltas.reserveCapacity(self.window)
+        self.sorted.reserveCapacity(self.window)
+    }
+    
+    public var typical: TimeInterval? {
+        self.sorted.count >= 2 ? self.sorted[self.sorted.count / 2] : nil
+    }
+    
+    // number of samples missing between the last timestamp and ts, 0 when the interval looks regular
+    public func missing(_ ts: Date, minGap: TimeInterval = 2, tolerance: Double = 1.5) -> Int {
+        guard let last = self.last, let typical = self.typical else { return 0 }
+        let gap = ts.timeIntervalSince(last)
+        guard gap >= minGap, gap > typical * tolerance else { return 0 }
+        return max(0, Int((gap / typical).rounded()) - 1)
+    }
+    
+    // adds the timestamp, returns the number of missing samples before it
+    @discardableResult
+    public mutating func add(_ ts: Date, minGap: TimeInterval = 2, tolerance: Double = 1.5) -> Int {
+        let missing = self.missing(ts, minGap: minGap, tolerance: tolerance)
+        defer {
+            self.last = ts
+            self.interrupted = false
+        }
+        
+        if missing > 0, let last = self.last {
+            self.gap = (last, ts)
+            return missing
+        }
+        guard !self.interrupted, let last = self.last else { return 0 }
+        
+        let delta = ts.timeIntervalSince(last)
+        guard delta > 0 else { return 0 }
+        
+        if self.deltas.count < self.window {
+            self.deltas.append(delta)
+        } else {
+            let old = self.deltas[self.head]
+            self.deltas[self.head] = delta
+            self.head = (self.head + 1) % self.window
+            let i = self.index(old)
+            if i < self.sorted.count && self.sorted[i] == old {
+                self.sorted.remove(at: i)
+            }
+        }
+        self.sorted.insert(delta, at: self.index(delta))
+        
+        return 0
+    }
+    
+    // an empty slot in the series, the next delta is not counted
+    public mutating func interrupt() {
+        self.interrupted = true
+    }
+    
+    public mutating func reset() {
+        self.last = nil
+        self.gap = nil
+        self.deltas.removeAll(keepingCapacity: true)
+        self.sorted.removeAll(keepingCapacity: true)
+        self.head = 0
+        self.interrupted = true
+    }
+    
+    private func index(_ value: TimeInterval) -> Int {
+        var lo = 0, hi = self.sorted.count
+        while lo < hi {
+            let mid = (lo + hi) / 2
+            if self.sorted[mid] < value {
+                lo = mid + 1
+            } else {
+                hi = mid
+            }
+        }
+        return lo
+    }
+}
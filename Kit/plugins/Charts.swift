@@ -197,6 +197,12 @@ public class LineChartView: ChartView {
     
     private var points: [DoubleValue?]
     private var head: Int = 0
+    // total number of slots written, the oldest slot in the ring has index sequence - points.count
+    private var sequence: Int
+    private var decimator: ChartDecimator
+    private var decimation: ChartDecimation = .m4
+    private var intervals: IntervalEstimator = IntervalEstimator()
+    private var columns: Int
     private var shadowPoints: [DoubleValue?] = []
     private var transparent: Bool = true
     private var flipY: Bool = false
@@ -232,6 +238,9 @@ public class LineChartView: ChartView {
         animation: Bool = true
     ) {
         self.points = Array(repeating: nil, count: max(num, 1))
+        self.sequence = max(num, 1)
+        self.columns = max(Int(frame.width), 1)
+        self.decimator = ChartDecimator(capacity: max(num, 1), columns: self.columns)
         self.suffix = suffix
         self.color = color
         self.scale = scale
@@ -263,8 +272,6 @@ public class LineChartView: ChartView {
     public override func draw(_ dirtyRect: NSRect) {
         super.draw(dirtyRect)
         
-        var originalPoints: [DoubleValue?] = []
-        var shadowPoints: [DoubleValue?] = []
         var transparent: Bool = true
         var flipY: Bool = false
         var minMax: Bool = false
@@ -278,8 +285,6 @@ public class LineChartView: ChartView {
         var fixedScale: Double = 1
         var zeroValue: Double = 0.01
         self.read {
-            originalPoints = self.orderedPointsLocked()
-            shadowPoints = self.shadowPoints
             transparent = self.transparent
             flipY = self.flipY
             minMax = self.minMax
@@ -294,13 +299,8 @@ public class LineChartView: ChartView {
             zeroValue = self.zeroValue
         }
         
-        let points = stop ? shadowPoints : originalPoints
-        guard let context = NSGraphicsContext.current?.cgContext, !points.isEmpty else { return }
+        guard let context = NSGraphicsContext.current?.cgContext else { return }
         context.setShouldAntialias(true)
-        var maxValue: Double = 0
-        for opt in points {
-            if let p = opt, p.value > maxValue { maxValue = p.value }
-        }
         
         let lineColor: NSColor = color
         var gradientColor: NSColor = color.withAlphaComponent(0.5)
@@ -317,39 +317,14 @@ public class LineChartView: ChartView {
         let yLegendWidth: CGFloat = yLegend ? 30 : 0
         let height: CGFloat = self.frame.height - offset - xLegendHeight
         let chartWidth: CGFloat = self.frame.width - yLegendWidth
-        let xRatio: CGFloat = chartWidth / CGFloat(points.count-1)
         let zero: CGFloat = flipY ? self.frame.height : xLegendHeight
+        let frame = ChartFrame(x: yLegendWidth, y: xLegendHeight, width: chartWidth, height: height, flip: flipY, scale: scale, fixedScale: fixedScale, zeroValue: zeroValue)
         
-        var lines: [[CGPoint]] = []
-        var line: [CGPoint] = []
+        let geometry = self.read { self.geometryLocked(frame, frozen: self.stop) }
+        let lines: [[CGPoint]] = geometry.lines.map{ $0.map{ $0.point } }
         var list: [(value: DoubleValue, point: CGPoint)] = []
-        let needList = xLegend || (isTooltipEnabled && self.cursor != nil)
-        
-        for (i, v) in points.enumerated() {
-            guard let v else {
-                if !line.isEmpty {
-                    lines.append(line)
-                    line = []
-                }
-                continue
-            }
-            
-            var y = scaleValue(scale: scale, value: v.value, maxValue: maxValue, zeroValue: zeroValue, maxHeight: height, limit: fixedScale)
-            if flipY {
-                y = height - y
-            }
-            
-            let point = CGPoint(
-                x: yLegendWidth + CGFloat(i) * xRatio,
-                y: y + xLegendHeight
-            )
-            line.append(point)
-            if needList {
-                list.append((value: v, point: point))
-            }
-        }
-        if !line.isEmpty {
-            lines.append(line)
+        if xLegend || (isTooltipEnabled && self.cursor != nil) {
+            list = geometry.lines.flatMap{ $0 }
         }
         
         var path = NSBezierPath()
@@ -391,11 +366,8 @@ public class LineChartView: ChartView {
                 NSAttributedString.Key.paragraphStyle: NSMutableParagraphStyle()
             ]
             
-            var str: String = ""
-            let flatList = originalPoints.map{ $0?.value ?? 0 }
-            if let value = flatList.max() {
-                str = toolTipFunc != nil ? toolTipFunc!(DoubleValue(value)) : "\(Int(value.rounded(toPlaces: 2) * 100))\(suffix)"
-            }
+            let value = geometry.maxValue
+            let str = toolTipFunc != nil ? toolTipFunc!(DoubleValue(value)) : "\(Int(value.rounded(toPlaces: 2) * 100))\(suffix)"
             let textWidth = str.widthOfString(usingFont: stringAttributes[NSAttributedString.Key.font] as! NSFont)
             let y = flipY ? xLegendHeight + 1 : height + xLegendHeight - 9
             let rect = CGRect(x: 1, y: y, width: textWidth, height: 8)
@@ -553,19 +525,11 @@ public class LineChartView: ChartView {
             let n = self.points.count
             guard n > 0 else { return }
             
-            if let stats = self.intervalStatsLocked() {
-                let gap = value.ts.timeIntervalSince(stats.lastTs)
-                if gap >= 2.0, gap > stats.typical * 1.5 {
-                    let missing = min(Int((gap / stats.typical).rounded()) - 1, n - 1)
-                    for _ in 0..<max(0, missing) {
-                        self.points[self.head] = nil
-                        self.head = (self.head + 1) % n
-                    }
-                }
+            for _ in 0..<min(self.intervals.add(value.ts), n - 1) {
+                self.appendLocked(nil)
             }
             
-            self.points[self.head] = value
-            self.head = (self.head + 1) % n
+            self.appendLocked(value)
         }
         self.onMain { [weak self] in
             guard let self, self.window?.isVisible ?? false else { return }
@@ -586,6 +550,58 @@ public class LineChartView: ChartView {
         }
     }
     
+    private func appendLocked(_ value: DoubleValue?) {
+        let n = self.points.count
+        self.points[self.head] = value
+        self.head = (self.head + 1) % n
+        self.decimator.append(self.sequence, value?.value)
+        self.sequence += 1
+        self.decimator.trim(oldest: self.sequence - n) { self.pointLocked($0)?.value }
+    }
+    
+    private func pointLocked(_ index: Int) -> DoubleValue? {
+        let n = self.points.count
+        let i = index - (self.sequence - n)
+        guard i >= 0 && i < n else { return nil }
+        return self.points[(self.head + i) % n]
+    }
+    
+    private func rebuildLocked() {
+        let n = self.points.count
+        self.decimator = ChartDecimator(capacity: n, columns: self.columns, method: self.decimation)
+        self.sequence = n
+        self.intervals.reset()
+        for i in 0..<n {
+            let point = self.points[(self.head + i) % n]
+            self.decimator.append(i, point?.value)
+            if let point {
+                self.intervals.add(point.ts)
+            } else {
+                self.intervals.interrupt()
+            }
+        }
+    }
+    
+    // reduced line geometry of the live ring or of the frozen copy while the mouse is pressed
+    private func geometryLocked(_ frame: ChartFrame, frozen: Bool) -> (lines: [[(value: DoubleValue, point: CGPoint)]], maxValue: Double) {
+        if frozen {
+            let points = self.shadowPoints
+            let decimator = ChartDecimator(capacity: points.count, columns: self.columns, method: self.decimation)
+            for (i, p) in points.enumerated() {
+                decimator.append(i, p?.value)
+            }
+            let lines = decimator.lines(first: 0, count: points.count, frame: frame).map { line in
+                line.compactMap{ item in points[item.index].map{ (value: $0, point: item.point) } }
+            }
+            return (lines, decimator.maxValue)
+        }
+        
+        let lines = self.decimator.lines(first: self.sequence - self.points.count, count: self.points.count, frame: frame).map { line in
+            line.compactMap{ item in self.pointLocked(item.index).map{ (value: $0, point: item.point) } }
+        }
+        return (lines, self.decimator.maxValue)
+    }
+    
     private func orderedPointsLocked() -> [DoubleValue?] {
         let n = self.points.count
         guard n > 0 else { return [] }
@@ -597,29 +613,6 @@ public class LineChartView: ChartView {
         return result
     }
     
-    private func intervalStatsLocked() -> (lastTs: Date, typical: TimeInterval)? {
-        var deltas: [TimeInterval] = []
-        var prev: Date?
-        var lastTs: Date?
-        let n = self.points.count
-        for i in 0..<n {
-            let p = self.points[(self.head + i) % n]
-            if let p {
-                if let prev {
-                    let d = p.ts.timeIntervalSince(prev)
-                    if d > 0 { deltas.append(d) }
-                }
-                prev = p.ts
-                lastTs = p.ts
-            } else {
-                prev = nil
-            }
-        }
-        guard let lastTs, deltas.count >= 2 else { return nil }
-        deltas.sort()
-        return (lastTs, deltas[deltas.count / 2])
-    }
-    
     public func addValue(_ value: Double) {
         self.addValue(DoubleValue(value))
     }
@@ -636,6 +629,7 @@ public class LineChartView: ChartView {
                 self.points = arr
             }
             self.head = 0
+            self.rebuildLocked()
         }
         self.onMain { [weak self] in
             self?.layer?.removeAnimation(forKey: "slide")
@@ -656,6 +650,7 @@ public class LineChartView: ChartView {
         self.write {
             self.points = newPoints.map { Optional($0) }
             self.head = 0
+            self.rebuildLocked()
         }
         self.onMain { [weak self] in
             self?.layer?.removeAnimation(forKey: "slide")
@@ -703,13 +698,37 @@ public class LineChartView: ChartView {
     }
     
     public func setLegend(x: Bool, y: Bool) {
+        let columns = max(Int(self.frame.width - (y ? 30 : 0)), 1)
         self.write {
             self.xLegend = x
             self.yLegend = y
+            if self.columns != columns {
+                self.columns = columns
+                self.rebuildLocked()
+            }
+        }
+        self.displayIfVisible()
+    }
+    
+    public func setDecimation(_ newValue: ChartDecimation) {
+        self.write {
+            guard self.decimation != newValue else { return }
+            self.decimation = newValue
+            self.decimator.method = newValue
         }
         self.displayIfVisible()
     }
     
+    public override func setFrameSize(_ newSize: NSSize) {
+        super.setFrameSize(newSize)
+        self.write {
+            let columns = max(Int(newSize.width - (self.yLegend ? 30 : 0)), 1)
+            guard self.columns != columns else { return }
+            self.columns = columns
+            self.rebuildLocked()
+        }
+    }
+    
     public override func mouseEntered(with event: NSEvent) {
         guard self.tooltipEnabledSnapshot else { return }
         self.cursor = convert(event.locationInWindow, from: nil)
@@ -0,0 +1,98 @@
+//
+//  CoreLoad.swift
+//  Kit
+//
+//  Created by Serhiy Mytrovtsiy on 19/10/2026.
+//  Using Swift 6.0.
+//  Running on macOS 26.5.
+//
+//  Copyright © 2026 Serhiy Mytrovtsiy. All rights reserved.
+//
+
+import Foundation
+
+// Load of every logical core from the tick counters (user, system, idle, nice per core, the layout of
+// PROCESSOR_CPU_LOAD_INFO). The counters and the results live in buffers allocated once, the core
+// groups are resolved when the table is created, so an update is one pass over the cores which
+// gives the load per core, per sibling pair, per core type and of the whole system.
+public final class CoreLoadTable {
+    public let count: Int
+    
+    public private(set) var usage: [Double]
+    // average of the hyperthreading siblings (cores 2n and 2n+1)
+    public private(set) var siblings: [Double]
+    public private(set) var user: Double = 0
+    public private(set) var system: Double = 0
+    public private(set) var idle: Double = 0
+    
+    private var ticks: [SIMD4<UInt32>]
+    // coreType raw value of every core, 0 for a core without a type
+    private var kinds: [Int]
+    private var sizes: SIMD4<Double> = SIMD4<Double>()
+    private var averages: SIMD4<Double> = SIMD4<Double>()
+    
+    public init(count: Int, cores: [core_s]? = nil) {
+        self.count = max(count, 0)
+        self.usage = [Double](repeating: 0, count: self.count)
+        self.siblings = [Double](repeating: 0, count: self.count / 2)
+        self.ticks = [SIMD4<UInt32>](repeating: SIMD4<UInt32>(), count: self.count)
+        self.kinds = [Int](repeating: 0, count: self.count)
+        
+        // a core is found by its id, a list with ids out of the range falls back to the position
+        for type in [coreType.efficiency, .performance, .super] {
+            for (i, core) in (cores ?? []).filter({ $0.type == type }).enumerated() {
+                let index = (0..<self.count).contains(Int(core.id)) ? Int(core.id) : i
+                if index < self.count {
+                    self.kinds[index] = type.rawValue
+                }
+            }
+        }
+        for kind in self.kinds where kind != 0 {
+            self.sizes[kind] += 1
+        }
+    }
+    
+    // average load of the cores of the type, nil when there are none
+    public func average(_ type: coreType) -> Double? {
+        guard type.rawValue > 0, self.sizes[type.rawValue] > 0 else { return nil }
+        return self.averages[type.rawValue]
+    }
+    
+    // takes the counters of all cores (4 per core), returns false when the buffer is too short. The
+    // first update gives the load since boot. A core without ticks in the interval keeps its last load.
+    @discardableResult
+    public func update(_ counters: UnsafeBufferPointer<Int32>) -> Bool {
+        guard counters.count >= self.count * 4, let base = counters.baseAddress else { return false }
+        let raw = UnsafeRawPointer(base)
+        
+        var total = SIMD4<UInt64>()
+        var sums = SIMD4<Double>()
+        
+        for i in 0..<self.count {
+            let now = raw.loadUnaligned(fromByteOffset: i * 16, as: SIMD4<UInt32>.self)
+            // the counters are 32 bit and wrap, the difference is taken modulo 2^32
+            let delta = SIMD4<UInt64>(truncatingIfNeeded: now &- self.ticks[i])
+            self.ticks[i] = now
+            total &+= delta
+            
+            let busy = delta[0] &+ delta[1] &+ delta[3]
+            let all = busy &+ delta[2]
+            if all != 0 {
+                self.usage[i] = min(1, Double(busy) / Double(all))
+            }
+            sums[self.kinds[i]] += self.usage[i]
+            if i & 1 == 1 && i / 2 < self.siblings.count {
+                self.siblings[i / 2] = (self.usage[i - 1] + self.usage[i]) / 2
+            }
+        }
+        
+        self.averages = sums / self.sizes
+        let all = Double(total[0] &+ total[1] &+ total[2] &+ total[3])
+        if all > 0 {
+            self.user = Double(total[0]) / all
+            self.system = Double(total[1]) / all
+            self.idle = Double(total[2]) / all
+        }
+        return true
+    }
+}
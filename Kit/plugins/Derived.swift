@@ -0,0 +1,214 @@
+//
+//  Derived.swift
+//  Kit
+//
+//  Created by Serhiy Mytrovtsiy on 18/10/2026.
+//  Using Swift 6.0.
+//  Running on macOS 26.5.
+//
+//  Copyright © 2026 Serhiy Mytrovtsiy. All rights reserved.
+//
+
+import Foundation
+
+public enum DerivedOperation: String, Codable {
+    case avg
+    case max
+    case min
+    case sum
+    case ema
+    case rate
+    case clamp
+}
+
+// Definition of a computed value. Inputs are keys of other values (sources or other definitions),
+// a trailing or leading "*" matches all keys with the given prefix or suffix.
+public struct Derived_t: Codable, Equatable {
+    public var key: String
+    public var name: String
+    public var operation: DerivedOperation
+    public var inputs: [String]
+    
+    public var alpha: Double? = nil
+    public var lower: Double? = nil
+    public var upper: Double? = nil
+    
+    public init(key: String, name: String, operation: DerivedOperation, inputs: [String], alpha: Double? = nil, lower: Double? = nil, upper: Double? = nil) {
+        self.key = key
+        self.name = name
+        self.operation = operation
+        self.inputs = inputs
+        self.alpha = alpha
+        self.lower = lower
+        self.upper = upper
+    }
+    
+    public func matches(_ key: String) -> Bool {
+        self.inputs.contains { (pattern: String) -> Bool in
+            if pattern.hasSuffix("*") {
+                return key.hasPrefix(pattern.dropLast())
+            } else if pattern.hasPrefix("*") {
+                return key.hasSuffix(pattern.dropFirst())
+            }
+            return pattern == key
+        }
+    }
+    
+    public static func load(_ key: String) -> [Derived_t] {
+        guard let data = Store.shared.data(key: key), let list = try? JSONDecoder().decode([Derived_t].self, from: data) else {
+            return []
+        }
+        return list
+    }
+    
+    public static func save(_ key: String, _ list: [Derived_t]) {
+        guard let data = try? JSONEncoder().encode(list) else { return }
+        Store.shared.set(key: key, value: data)
+    }
+}
+
+// Evaluates the derived values as a DAG over flat slots: sources first, then every definition in
+// topological order. Only nodes with a changed input are recomputed on evaluate().
+public final class DerivedGraph {
+    private struct Node {
+        let definition: Derived_t
+        let inputs: [Int]
+        var ema: Double? = nil
+        var last: (value: Double, time: TimeInterval)? = nil
+    }
+    
+    public let sources: [String]
+    public private(set) var keys: [String] = []
+    public private(set) var values: [Double]
+    
+    private var nodes: [Node] = []
+    private var dirty: [Bool]
+    private var present: [Bool]
+    private var index: [String: Int] = [:]
+    
+    public init(sources: [String], definitions: [Derived_t]) {
+        self.sources = sources
+        self.keys = sources
+        for (i, key) in sources.enumerated() where self.index[key] == nil {
+            self.index[key] = i
+        }
+        
+        var pending = definitions.filter{ self.index[$0.key] == nil }
+        var resolved: [Derived_t] = []
+        while !pending.isEmpty {
+            // a definition is ready when no other pending definition matches its inputs
+            guard let next = pending.firstIndex(where: { d in
+                !pending.contains(where: { $0.key != d.key && d.matches($0.key) })
+            }) else { break } // cycle, the rest is dropped
+            resolved.append(pending.remove(at: next))
+        }
+        
+        for definition in resolved {
+            let inputs = self.keys.indices.filter{ self.keys[$0] != definition.key && definition.matches(self.keys[$0]) }
+            guard !inputs.isEmpty else { continue }
+            self.index[definition.key] = self.keys.count
+            self.keys.append(definition.key)
+            self.nodes.append(Node(definition: definition, inputs: inputs))
+        }
+        
+        self.values = Array(repeating: 0, count: self.keys.count)
+        self.dirty = Array(repeating: true, count: self.keys.count)
+        self.present = Array(repeating: false, count: self.keys.count)
+    }
+    
+    public var definitions: [Derived_t] {
+        self.nodes.map{ $0.definition }
+    }
+    
+    public func slot(_ key: String) -> Int? {
+        self.index[key]
+    }
+    
+    public func set(_ slot: Int, _ value: Double) {
+        guard slot < self.sources.count else { return }
+        if !self.present[slot] || self.values[slot] != value {
+            self.values[slot] = value
+            self.present[slot] = true
+            self.dirty[slot] = true
+        }
+    }
+    
+    public func value(_ key: String) -> Double? {
+        guard let slot = self.index[key] else { return nil }
+        return self.value(at: slot)
+    }
+    
+    public func value(at slot: Int) -> Double? {
+        guard slot < self.values.count, self.present[slot] else { return nil }
+        return self.values[slot]
+    }
+    
+    // recomputes the nodes with changed inputs and returns the number of evaluated nodes
+    @discardableResult
+    public func evaluate(time: TimeInterval = ProcessInfo.processInfo.systemUptime) -> Int {
+        let offset = self.sources.count
+        var evaluated = 0
+        
+        for i in self.nodes.indices {
+            let slot = offset + i
+            let node = self.nodes[i]
+            guard node.definition.operation == .rate || node.inputs.contains(where: { self.dirty[$0] }) else { continue }
+            evaluated += 1
+            
+            guard let value = self.compute(i, time: time) else { continue }
+            if !self.present[slot] || self.values[slot] != value {
+                self.values[slot] = value
+                self.present[slot] = true
+                self.dirty[slot] = true
+            }
+        }
+        
+        for i in self.dirty.indices {
+            self.dirty[i] = false
+        }
+        
+        return evaluated
+    }
+    
+    private func compute(_ i: Int, time: TimeInterval) -> Double? {
+        let definition = self.nodes[i].definition
+        var count: Double = 0
+        var sum: Double = 0
+        var lowest: Double = .greatestFiniteMagnitude
+        var highest: Double = -.greatestFiniteMagnitude
+        
+        for slot in self.nodes[i].inputs where self.present[slot] {
+            let value = self.values[slot]
+            count += 1
+            sum += value
+            lowest = Swift.min(lowest, value)
+            highest = Swift.max(highest, value)
+        }
+        guard count > 0 else { return nil }
+        
+        switch definition.operation {
+        case .avg:
+            return sum / count
+        case .max:
+            return highest
+        case .min:
+            return lowest
+        case .sum:
+            return sum
+        case .ema:
+            let alpha = Swift.min(Swift.max(definition.alpha ?? 0.3, 0), 1)
+            let value = sum / count
+            let ema = self.nodes[i].ema.map{ alpha * value + (1 - alpha) * $0 } ?? value
+            self.nodes[i].ema = ema
+            return ema
+        case .rate:
+            let value = sum / count
+            defer { self.nodes[i].last = (value, time) }
+            guard let last = self.nodes[i].last, time > last.time else { return 0 }
+            return (value - last.value) / (time - last.time)
+        case .clamp:
+            let value = sum / count
+            return Swift.min(Swift.max(value, definition.lower ?? -.greatestFiniteMagnitude), definition.upper ?? .greatestFiniteMagnitude)
+        }
+    }
+}
@@ -0,0 +1,110 @@
+//
+//  DiskTopology.swift
+//  Kit
+//
+//  Created by Serhiy Mytrovtsiy on 19/10/2026.
+//  Using Swift 6.0.
+//  Running on macOS 26.5.
+//
+//  Copyright © 2026 Serhiy Mytrovtsiy. All rights reserved.
+//
+
+import Foundation
+
+public struct DiskCounters: Equatable {
+    public var read: Int64
+    public var write: Int64
+    
+    public init(read: Int64 = 0, write: Int64 = 0) {
+        self.read = read
+        self.write = write
+    }
+}
+
+// Drives known to a reader, kept up to date by appear and disappear events instead of a rescan on
+// every tick. Every drive holds its handle (the cached registry entry on macOS) and the last
+// counters, so a tick is one counter read and one subtraction per drive.
+public final class DiskTopology<Handle> {
+    public struct Drive {
+        public let name: String
+        public var handle: Handle
+        public var counters: DiskCounters? = nil
+        public var delta: DiskCounters = DiskCounters()
+    }
+    
+    public private(set) var drives: [Drive] = []
+    // increases on every appear or disappear
+    public private(set) var generation: Int = 0
+    
+    private var index: [String: Int] = [:]
+    
+    public init() {}
+    
+    public var count: Int {
+        self.drives.count
+    }
+    
+    public func contains(_ name: String) -> Bool {
+        self.index[name] != nil
+    }
+    
+    public func handle(_ name: String) -> Handle? {
+        self.index[name].map{ self.drives[$0].handle }
+    }
+    
+    // returns the handle replaced by the new one, the caller releases it
+    @discardableResult
+    public func appeared(_ name: String, handle: Handle) -> Handle? {
+        self.generation += 1
+        if let i = self.index[name] {
+            let old = self.drives[i].handle
+            self.drives[i] = Drive(name: name, handle: handle)
+            return old
+        }
+        self.index[name] = self.drives.count
+        self.drives.append(Drive(name: name, handle: handle))
+        return nil
+    }
+    
+    // returns the handle of the removed drive, the caller releases it
+    @discardableResult
+    public func disappeared(_ name: String) -> Handle? {
+        guard let i = self.index.removeValue(forKey: name) else { return nil }
+        self.generation += 1
+        let drive = self.drives.remove(at: i)
+        for j in i..<self.drives.count {
+            self.index[self.drives[j].name] = j
+        }
+        return drive.handle
+    }
+    
+    public func removeAll() -> [Handle] {
+        let handles = self.drives.map{ $0.handle }
+        self.drives.removeAll()
+        self.index.removeAll()
+        self.generation += 1
+        return handles
+    }
+    
+    public func update(_ name: String, _ transform: (inout Handle) -> Void) {
+        guard let i = self.index[name] else { return }
+        transform(&self.drives[i].handle)
+    }
+    
+    // reads the counters of every drive and keeps the difference to the previous tick. The first
+    // sample and counters which went back (a reset or a replaced device) give a zero delta.
+    public func tick(_ read: (Handle) -> DiskCounters?) {
+        for i in 0..<self.drives.count {
+            guard let counters = read(self.drives[i].handle) else {
+                self.drives[i].delta = DiskCounters()
+                continue
+            }
+            if let last = self.drives[i].counters, counters.read >= last.read, counters.write >= last.write {
+                self.drives[i].delta = DiskCounters(read: counters.read - last.read, write: counters.write - last.write)
+            } else {
+                self.drives[i].delta = DiskCounters()
+            }
+            self.drives[i].counters = counters
+        }
+    }
+}
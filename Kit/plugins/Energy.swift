@@ -0,0 +1,124 @@
+//
+//  Energy.swift
+//  Kit
+//
+//  Created by Serhiy Mytrovtsiy on 19/10/2026.
+//  Using Swift 6.0.
+//  Running on macOS 26.5.
+//
+//  Copyright © 2026 Serhiy Mytrovtsiy. All rights reserved.
+//
+
+import Foundation
+
+// cumulative counters of a process
+public struct EnergyCounters: Equatable {
+    // start of the process, a pid with another start is a new process
+    public var start: UInt64
+    // user and system time in nanoseconds
+    public var cpuTime: UInt64
+    public var wakeups: UInt64
+    public var diskRead: UInt64
+    public var diskWritten: UInt64
+    
+    public init(start: UInt64 = 0, cpuTime: UInt64 = 0, wakeups: UInt64 = 0, diskRead: UInt64 = 0, diskWritten: UInt64 = 0) {
+        self.start = start
+        self.cpuTime = cpuTime
+        self.wakeups = wakeups
+        self.diskRead = diskRead
+        self.diskWritten = diskWritten
+    }
+}
+
+// Weights of the energy impact. One second of CPU time per second is 100 like the power column of
+// top, a wakeup and a byte of disk I/O are counted as the CPU time they cost. The wakeup and disk
+// write weights are the kcpu_wakeups and kdiskio_byteswritten coefficients of the energy model
+// macOS ships in /usr/share/pmenergy for Activity Monitor. They were not fitted here, and the
+// shipped values differ a little between Mac models.
+public struct EnergyModel: Equatable {
+    public var cpuTime: Double = 1
+    public var wakeup: Double = 2.0e-4
+    public var diskRead: Double = 0
+    public var diskWritten: Double = 5.3e-10
+    
+    public init() {}
+    
+    // impact of the counters consumed within the interval (seconds)
+    public func impact(cpuTime: UInt64, wakeups: UInt64, diskRead: UInt64, diskWritten: UInt64, interval: TimeInterval) -> Double {
+        guard interval > 0 else { return 0 }
+        let cost = Double(cpuTime) / 1_000_000_000 * self.cpuTime + Double(wakeups) * self.wakeup
+            + Double(diskRead) * self.diskRead + Double(diskWritten) * self.diskWritten
+        return cost / interval * 100
+    }
+}
+
+// Energy impact of the processes from the counters of two snapshots, so a refresh needs one snapshot
+// and no sampling delay. A process is known from its second snapshot, the processes which are gone
+// are forgotten on every update.
+public final class EnergyEstimator {
+    public var model: EnergyModel
+    
+    private var counters: [Int32: EnergyCounters] = [:]
+    private var previous: [Int32: EnergyCounters] = [:]
+    private var time: TimeInterval? = nil
+    
+    public init(model: EnergyModel = EnergyModel()) {
+        self.model = model
+    }
+    
+    public var count: Int {
+        self.counters.count
+    }
+    
+    // starts a snapshot taken at the time (monotonic, seconds)
+    public func begin(_ time: TimeInterval) -> TimeInterval? {
+        swap(&self.previous, &self.counters)
+        self.counters.removeAll(keepingCapacity: true)
+        defer { self.time = time }
+        guard let last = self.time, time > last else { return nil }
+        return time - last
+    }
+    
+    // adds the counters of a process to the snapshot, returns its impact since the previous one
+    @discardableResult
+    public func add(_ pid: Int32, _ value: EnergyCounters, interval: TimeInterval?) -> Double? {
+        self.counters[pid] = value
+        guard let interval, let last = self.previous[pid], last.start == value.start,
+              value.cpuTime >= last.cpuTime, value.wakeups >= last.wakeups else { return nil }
+        return self.model.impact(
+            cpuTime: value.cpuTime - last.cpuTime,
+            wakeups: value.wakeups - last.wakeups,
+            diskRead: value.diskRead >= last.diskRead ? value.diskRead - last.diskRead : 0,
+            diskWritten: value.diskWritten >= last.diskWritten ? value.diskWritten - last.diskWritten : 0,
+            interval: interval
+        )
+    }
+}
+    
+    // the power column of top -o power -l 2 -stats pid,command,power, by pid. Every sample starts
+    // with the header, only the last one has the values over the sampling interval.
+    public static func topPower(_ output: String) -> [Int32: (name: String, power: Double)] {
+        var list: [Int32: (name: String, power: Double)] = [:]
+        output.enumerateLines { line, _ in
+            let fields = line.split(separator: " ")
+            if fields.first == "PID" {
+                list.removeAll()
+                return
+            }
+            guard fields.count >= 3, let pid = Int32(fields[0]), let power = Double(fields[fields.count - 1]) else { return }
+            list[pid] = (fields[1..<fields.count-1].joined(separator: " "), power)
+        }
+        return list
+    }
+    
+    // the processes by impact, the ones without counters take the value reported by top
+    public static func rank(_ list: [(pid: Int32, usage: Double)], denied: [Int32], top: [Int32: (name: String, power: Double)], limit: Int) -> [(pid: Int32, usage: Double)] {
+        var all = list
+        for pid in denied {
+            if let value = top[pid] {
+                all.append((pid, value.power))
+            }
+        }
+        return Array(all.sorted(by: { $0.usage > $1.usage }).prefix(limit))
+    }
+}
@@ -0,0 +1,429 @@
+//
+//  Exporter.swift
+//  Kit
+//
+//  Created by Serhiy Mytrovtsiy on 18/10/2026.
+//  Using Swift 6.0.
+//  Running on macOS 26.5.
+//
+//  Copyright © 2026 Serhiy Mytrovtsiy. All rights reserved.
+//
+
+import Foundation
+import Network
+
+public enum OpenMetricType: String {
+    case gauge
+    case counter
+}
+
+// One sample of a metric family. Counter names are given without the _total suffix.
+public struct OpenMetric {
+    public let name: String
+    public let value: Double
+    public let type: OpenMetricType
+    public let unit: String?
+    public let help: String
+    public let labels: [(String, String)]
+    
+    public init(_ name: String, _ value: Double, type: OpenMetricType = .gauge, unit: String? = nil, help: String = "", labels: [(String, String)] = []) {
+        self.name = name
+        self.value = value
+        self.type = type
+        self.unit = unit
+        self.help = help
+        self.labels = labels
+    }
+}
+
+public protocol OpenMetricsType {
+    func openMetrics() -> [OpenMetric]
+}
+
+// Keeps the OpenMetrics text of every series. An update renders only the lines whose value changed,
+// each family keeps its own block, and the exposition is concatenated from the blocks once after
+// a change, so a scrape returns the same buffer until the next reader callback.
+public final class OpenMetricsRegistry {
+    private final class Family {
+        let header: [UInt8]
+        var series: [String: Int] = [:]
+        var lines: [[UInt8]] = []
+        var values: [Double] = []
+        var block: [UInt8] = []
+        var dirty: Bool = true
+        
+        init(header: [UInt8]) {
+            self.header = header
+        }
+    }
+    
+    private struct SeriesID: Hashable {
+        let family: String
+        let labels: String
+    }
+    
+    private let lock = NSLock()
+    private var families: [String: Family] = [:]
+    private var order: [String] = []
+    private var sources: [String: Set<SeriesID>] = [:]
+    private var exposition: Data = Data()
+    private var dirty: Bool = true
+    
+    public init() {}
+    
+    public var count: Int {
+        self.lock.lock()
+        defer { self.lock.unlock() }
+        return self.families.values.reduce(0) { $0 + $1.lines.count }
+    }
+    
+    // replaces the series of the source, the ones it does not report anymore are removed
+    public func update(source: String, _ metrics: [OpenMetric]) {
+        self.lock.lock()
+        defer { self.lock.unlock() }
+        
+        var seen = Set<SeriesID>(minimumCapacity: metrics.count)
+        for metric in metrics {
+            let family = self.familyLocked(metric)
+            let labels = OpenMetricsRegistry.labels(metric.labels)
+            seen.insert(SeriesID(family: metric.name, labels: labels))
+            
+            if let i = family.series[labels] {
+                if family.values[i].bitPattern == metric.value.bitPattern {
+                    continue
+                }
+                family.values[i] = metric.value
+                family.lines[i] = OpenMetricsRegistry.line(metric, labels: labels)
+            } else {
+                family.series[labels] = family.lines.count
+                family.lines.append(OpenMetricsRegistry.line(metric, labels: labels))
+                family.values.append(metric.value)
+            }
+            family.dirty = true
+            self.dirty = true
+        }
+        
+        if let previous = self.sources[source] {
+            for id in previous where !seen.contains(id) {
+                self.removeLocked(id)
+            }
+        }
+        self.sources[source] = seen.isEmpty ? nil : seen
+    }
+    
+    public func remove(source: String) {
+        self.update(source: source, [])
+    }
+    
+    public func removeAll() {
+        self.lock.lock()
+        defer { self.lock.unlock() }
+        self.families.removeAll()
+        self.order.removeAll()
+        self.sources.removeAll()
+        self.exposition = Data()
+        self.dirty = true
+    }
+    
+    public func exposition() -> Data {
+        self.lock.lock()
+        defer { self.lock.unlock() }
+        guard self.dirty else { return self.exposition }
+        
+        var size = 6
+        for name in self.order {
+            guard let family = self.families[name] else { continue }
+            if family.dirty {
+                family.block.removeAll(keepingCapacity: true)
+                family.block.append(contentsOf: family.header)
+                for line in family.lines {
+                    family.block.append(contentsOf: line)
+                }
+                family.dirty = false
+            }
+            size += family.block.count
+        }
+        
+        var out = Data(capacity: size)
+        for name in self.order {
+            if let family = self.families[name] {
+                out.append(contentsOf: family.block)
+            }
+        }
+        out.append(contentsOf: Array("# EOF\n".utf8))
+        self.exposition = out
+        self.dirty = false
+        return out
+    }
+    
+    // MARK: - helpers
+    
+    private func familyLocked(_ metric: OpenMetric) -> Family {
+        if let family = self.families[metric.name] {
+            return family
+        }
+        var header = "# TYPE \(metric.name) \(metric.type.rawValue)\n"
+        if let unit = metric.unit {
+            header += "# UNIT \(metric.name) \(unit)\n"
+        }
+        if !metric.help.isEmpty {
+            header += "# HELP \(metric.name) \(OpenMetricsRegistry.escape(metric.help, quotes: false))\n"
+        }
+        let family = Family(header: Array(header.utf8))
+        self.families[metric.name] = family
+        let i = self.order.firstIndex(where: { $0 > metric.name }) ?? self.order.count
+        self.order.insert(metric.name, at: i)
+        return family
+    }
+    
+    private func removeLocked(_ id: SeriesID) {
+        guard let family = self.families[id.family], let i = family.series.removeValue(forKey: id.labels) else { return }
+        family.lines.remove(at: i)
+        family.values.remove(at: i)
+        for (key, value) in family.series where value > i {
+            family.series[key] = value - 1
+        }
+        family.dirty = true
+        self.dirty = true
+        
+        if family.lines.isEmpty {
+            self.families[id.family] = nil
+            self.order.removeAll(where: { $0 == id.family })
+        }
+    }
+    
+    private static func line(_ metric: OpenMetric, labels: String) -> [UInt8] {
+        let name = metric.type == .counter ? "\(metric.name)_total" : metric.name
+        return Array("\(name)\(labels) \(OpenMetricsRegistry.value(metric.value))\n".utf8)
+    }
+    
+    internal static func labels(_ list: [(String, String)]) -> String {
+        guard !list.isEmpty else { return "" }
+        return "{" + list.map{ "\($0.0)=\"\(OpenMetricsRegistry.escape($0.1, quotes: true))\"" }.joined(separator: ",") + "}"
+    }
+    
+    internal static func value(_ value: Double) -> String {
+        if value.isNaN {
+            return "NaN"
+        } else if value.isInfinite {
+            return value > 0 ? "+Inf" : "-Inf"
+        } else if value == value.rounded() && abs(value) < 1e15 {
+            return String(Int64(value))
+        }
+        return "\(value)"
+    }
+    
+    private static func escape(_ value: String, quotes: Bool) -> String {
+        guard value.contains(where: { $0 == "\\" || $0 == "\n" || (quotes && $0 == "\"") }) else { return value }
+        var result = ""
+        for c in value {
+            switch c {
+            case "\\": result += "\\\\"
+            case "\n": result += "\\n"
+            case "\"" where quotes: result += "\\\""
+            default: result.append(c)
+            }
+        }
+        return result
+    }
+}
+
+// Minimal HTTP/1.1 endpoint which serves the registry on GET /metrics. Every connection gets one
+// response and is closed, slow or oversized requests are dropped.
+public final class OpenMetricsServer {
+    public static let contentType = "application/openmetrics-text; version=1.0.0; charset=utf-8"
+    
+    public let registry: OpenMetricsRegistry
+    public let maxConnections: Int = 16
+    
+    private let queue = DispatchQueue(label: "eu.exelban.Stats.OpenMetrics")
+    private var listener: NWListener? = nil
+    private var connections: Int = 0
+    private let log: NextLog
+    
+    public init(registry: OpenMetricsRegistry) {
+        self.registry = registry
+        self.log = NextLog.shared.copy(category: "OpenMetrics")
+    }
+    
+    public func start(address: String, port: Int) {
+        self.stop()
+        guard let port = NWEndpoint.Port(rawValue: UInt16(clamping: port)) else { return }
+        
+        let parameters = NWParameters.tcp
+        parameters.allowLocalEndpointReuse = true
+        parameters.requiredLocalEndpoint = NWEndpoint.hostPort(host: NWEndpoint.Host(address), port: port)
+        
+        do {
+            let listener = try NWListener(using: parameters)
+            listener.newConnectionHandler = { [weak self] connection in
+                self?.accept(connection)
+            }
+            listener.stateUpdateHandler = { [weak self] state in
+                guard let self else { return }
+                switch state {
+                case .ready: debug("Listening on \(address):\(port)", log: self.log)
+                case .failed(let err): error("Listener failed: \(err)", log: self.log)
+                default: break
+                }
+            }
+            listener.start(queue: self.queue)
+            self.listener = listener
+        } catch let err {
+            error("Could not listen on \(address):\(port): \(err)", log: self.log)
+        }
+    }
+    
+    public func stop() {
+        self.listener?.cancel()
+        self.listener = nil
+    }
+    
+    // the complete response to a raw request head
+    public func response(_ request: Data) -> Data {
+        let line = request.prefix(while: { $0 != 13 && $0 != 10 })
+        let parts = String(decoding: line, as: UTF8.self).split(separator: " ")
+        guard parts.count == 3, parts[2].hasPrefix("HTTP/1.") else {
+            return OpenMetricsServer.response(400, "Bad Request")
+        }
+        guard parts[0] == "GET" || parts[0] == "HEAD" else {
+            return OpenMetricsServer.response(405, "Method Not Allowed")
+        }
+        guard parts[1].split(separator: "?", maxSplits: 1).first == "/metrics" else {
+            return OpenMetricsServer.response(404, "Not Found")
+        }
+        
+        let body = self.registry.exposition()
+        var response = OpenMetricsServer.head(200, "OK", type: OpenMetricsServer.contentType, length: body.count)
+        if parts[0] == "GET" {
+            response.append(body)
+        }
+        return response
+    }
+    
+    private func accept(_ connection: NWConnection) {
+        guard self.connections < self.maxConnections else {
+            connection.cancel()
+            return
+        }
+        self.connections += 1
+        connection.stateUpdateHandler = { [weak self] state in
+            switch state {
+            case .cancelled, .failed:
+                self?.connections -= 1
+                connection.stateUpdateHandler = nil
+            default: break
+            }
+        }
+        connection.start(queue: self.queue)
+        self.queue.asyncAfter(deadline: .now() + 5) {
+            connection.cancel()
+        }
+        self.receive(connection, Data())
+    }
+    
+    private func receive(_ connection: NWConnection, _ buffer: Data) {
+        connection.receive(minimumIncompleteLength: 1, maximumLength: 4096) { [weak self] data, _, complete, err in
+            guard let self else {
+                connection.cancel()
+                return
+            }
+            var buffer = buffer
+            if let data {
+                buffer.append(data)
+            }
+            
+            if buffer.range(of: Data([13, 10, 13, 10])) != nil || buffer.range(of: Data([10, 10])) != nil {
+                connection.send(content: self.response(buffer), contentContext: .finalMessage, isComplete: true, completion: .contentProcessed { _ in
+                    connection.cancel()
+                })
+            } else if err != nil || complete || buffer.count > 8192 {
+                connection.cancel()
+            } else {
+                self.receive(connection, buffer)
+            }
+        }
+    }
+    
+    private static func head(_ code: Int, _ reason: String, type: String, length: Int) -> Data {
+        Data("HTTP/1.1 \(code) \(reason)\r\nContent-Type: \(type)\r\nContent-Length: \(length)\r\nConnection: close\r\n\r\n".utf8)
+    }
+    
+    private static func response(_ code: Int, _ reason: String) -> Data {
+        let body = Data("\(reason)\n".utf8)
+        var response = OpenMetricsServer.head(code, reason, type: "text/plain; charset=utf-8", length: body.count)
+        response.append(body)
+        return response
+    }
+}
+
+// Local exporter fed by the reader callbacks. Disabled by default, bound to localhost unless
+// another address is set in openmetrics_address.
+public final class OpenMetricsExporter {
+    public static let shared = OpenMetricsExporter()
+    
+    public let registry = OpenMetricsRegistry()
+    
+    private let lock = NSLock()
+    private var active: Bool = false
+    private lazy var server: OpenMetricsServer = OpenMetricsServer(registry: self.registry)
+    
+    public var enabled: Bool {
+        get { Store.shared.bool(key: "openmetrics_state", defaultValue: false) }
+        set {
+            Store.shared.set(key: "openmetrics_state", value: newValue)
+            newValue ? self.start() : self.stop()
+        }
+    }
+    public var address: String {
+        get { Store.shared.string(key: "openmetrics_address", defaultValue: "127.0.0.1") }
+        set {
+            Store.shared.set(key: "openmetrics_address", value: newValue)
+            self.restart()
+        }
+    }
+    public var port: Int {
+        get { Store.shared.int(key: "openmetrics_port", defaultValue: 9253) }
+        set {
+            Store.shared.set(key: "openmetrics_port", value: newValue)
+            self.restart()
+        }
+    }
+    public var url: String {
+        "http://\(self.address):\(self.port)/metrics"
+    }
+    
+    private init() {
+        if self.enabled {
+            self.start()
+        }
+    }
+    
+    public func send(key: String, value: Any) {
+        self.lock.lock()
+        let active = self.active
+        self.lock.unlock()
+        guard active, let v = value as? OpenMetricsType else { return }
+        self.registry.update(source: key, v.openMetrics())
+    }
+    
+    private func start() {
+        self.lock.lock()
+        self.active = true
+        self.lock.unlock()
+        self.server.start(address: self.address, port: self.port)
+    }
+    
+    private func stop() {
+        self.lock.lock()
+        self.active = false
+        self.lock.unlock()
+        self.server.stop()
+        self.registry.removeAll()
+    }
+    
+    private func restart() {
+        guard self.enabled else { return }
+        self.start()
+    }
+}
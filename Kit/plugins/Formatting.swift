@@ -0,0 +1,211 @@
+//
+//  Formatting.swift
+//  Kit
+//
+//  Created by Serhiy Mytrovtsiy on 18/10/2026.
+//  Using Swift 6.0.
+//  Running on macOS 26.5.
+//
+//  Copyright © 2026 Serhiy Mytrovtsiy. All rights reserved.
+//
+
+import Foundation
+
+// Shared formatting for the values shown in widgets, popups and logs. Formatters are built once per
+// locale and setting, and recent results are kept in a small LRU keyed by the rounded value, so the
+// same visible string is never formatted twice in a row.
+public final class ValueFormatter {
+    public static let shared = ValueFormatter()
+    
+    private struct MemoryKey: Hashable {
+        let style: Int
+        let exponent: Int
+        let bucket: Int64
+    }
+    
+    private struct TemperatureKey: Hashable {
+        let unit: String
+        let digits: Int
+        let bucket: Int64
+    }
+    
+    private static let powers: [Double] = [1, 10, 100, 1_000, 10_000, 100_000, 1_000_000]
+    
+    private let lock = NSLock()
+    private var byteFormatters: [Int: ByteCountFormatter] = [:]
+    private var temperatureFormatters: [Int: MeasurementFormatter] = [:]
+    private var systemUnit: UnitTemperature? = nil
+    private var observer: NSObjectProtocol? = nil
+    
+    private let memoryCache = LRUCache<MemoryKey, String>(capacity: 128)
+    private let temperatureCache = LRUCache<TemperatureKey, String>(capacity: 64)
+    
+    private init() {
+        self.observer = NotificationCenter.default.addObserver(forName: NSLocale.currentLocaleDidChangeNotification, object: nil, queue: nil) { [weak self] _ in
+            self?.localeChanged()
+        }
+    }
+    
+    public var systemTemperatureUnit: UnitTemperature {
+        self.lock.lock()
+        defer { self.lock.unlock() }
+        if let unit = self.systemUnit {
+            return unit
+        }
+        let measurement = Measurement(value: 0, unit: UnitTemperature.celsius)
+        let unit: UnitTemperature = MeasurementFormatter().string(from: measurement).hasSuffix("C") ? .celsius : .fahrenheit
+        self.systemUnit = unit
+        return unit
+    }
+    
+    // Adaptive byte count like ByteCountFormatter: bytes and KB without fraction, MB with one digit, GB and above with two.
+    // The value is rounded to the displayed precision first, so every bytes value in the same bucket shares the result.
+    public func memory(_ bytes: Int64, style: ByteCountFormatter.CountStyle = .file) -> String {
+        let base: Double = style == .memory || style == .binary ? 1_024 : 1_000
+        var unit: Double = 1
+        var exponent = 0
+        while exponent < 8 && Double(bytes.magnitude) >= unit * base {
+            unit *= base
+            exponent += 1
+        }
+        var digits = exponent <= 1 ? 0 : exponent == 2 ? 1 : 2
+        var power = ValueFormatter.powers[digits]
+        var bucket = Int64((Double(bytes) / unit * power).rounded())
+        // 1023.9 KB is rounded to 1024 KB, it is shown as 1 MB, so the unit is picked again
+        if exponent < 8 && Double(bucket.magnitude) >= base * power {
+            unit *= base
+            exponent += 1
+            digits = exponent == 2 ? 1 : 2
+            power = ValueFormatter.powers[digits]
+            bucket = Int64((Double(bytes) / unit * power).rounded())
+        }
+        
+        let key = MemoryKey(style: style.rawValue, exponent: exponent, bucket: bucket)
+        return self.memoryCache.value(key) {
+            let value = exponent == 0 ? bytes : Int64((Double(bucket) / power * unit).rounded())
+            var str = self.byteFormatter(style).string(fromByteCount: value)
+            if let idx = str.lastIndex(of: ",") {
+                str.replaceSubrange(idx...idx, with: ".")
+            }
+            return str
+        }
+    }
+    
+    public func temperature(_ value: Double, from: UnitTemperature = .celsius, to: UnitTemperature, fractionDigits: Int = 0) -> String {
+        let digits = min(max(fractionDigits, 0), ValueFormatter.powers.count - 1)
+        var measurement = Measurement(value: value, unit: from)
+        if from != to {
+            measurement.convert(to: to)
+        }
+        let power = ValueFormatter.powers[digits]
+        guard measurement.value.isFinite, abs(measurement.value) < 1e12 else {
+            return self.temperatureFormatter(digits).string(from: measurement)
+        }
+        let bucket = Int64((measurement.value * power).rounded())
+        
+        let key = TemperatureKey(unit: to.symbol, digits: digits, bucket: bucket)
+        return self.temperatureCache.value(key) {
+            self.temperatureFormatter(digits).string(from: Measurement(value: Double(bucket) / power, unit: to))
+        }
+    }
+    
+    // Fixed point decimal written into a stack buffer. Results up to 15 bytes fit the inline String storage,
+    // so formatting a menu bar value does not allocate. The exact binary value is rounded as in printf (0.15
+    // is below 0.15 and gives "0.1"), only exact ties round to even. With trim the trailing fraction zeros are dropped.
+    public static func decimal(_ value: Double, digits: Int, trim: Bool = false) -> String {
+        let digits = min(max(digits, 0), ValueFormatter.powers.count - 1)
+        let power = ValueFormatter.powers[digits]
+        let x = abs(value)
+        guard value.isFinite, x * power < 1e15 else {
+            return String(format: "%.\(digits)f", value)
+        }
+        
+        // the product is rounded, fma gives the exact sign of x * power - n, so n is corrected to floor(x * power)
+        // and compared with the exact midpoint
+        var lower = (x * power).rounded(.down)
+        while lower > 0 && (-lower).addingProduct(x, power) < 0 {
+            lower -= 1
+        }
+        while (-(lower + 1)).addingProduct(x, power) >= 0 {
+            lower += 1
+        }
+        let half = (-(2 * lower + 1)).addingProduct(x, 2 * power)
+        var n = UInt64(lower)
+        if half > 0 || (half == 0 && n % 2 == 1) {
+            n += 1
+        }
+        
+        var fraction = digits
+        if trim {
+            while fraction > 0 && n % 10 == 0 {
+                n /= 10
+                fraction -= 1
+            }
+        }
+        let negative = value < 0 && n != 0
+        
+        return withUnsafeTemporaryAllocation(of: UInt8.self, capacity: 24) { buffer -> String in
+            var i = buffer.count
+            if fraction > 0 {
+                for _ in 0..<fraction {
+                    i -= 1
+                    buffer[i] = 48 + UInt8(n % 10)
+                    n /= 10
+                }
+                i -= 1
+                buffer[i] = 46 // "."
+            }
+            repeat {
+                i -= 1
+                buffer[i] = 48 + UInt8(n % 10)
+                n /= 10
+            } while n > 0
+            if negative {
+                i -= 1
+                buffer[i] = 45 // "-"
+            }
+            return String(decoding: UnsafeBufferPointer(rebasing: buffer[i...]), as: UTF8.self)
+        }
+    }
+    
+    private func byteFormatter(_ style: ByteCountFormatter.CountStyle) -> ByteCountFormatter {
+        self.lock.lock()
+        defer { self.lock.unlock() }
+        if let formatter = self.byteFormatters[style.rawValue] {
+            return formatter
+        }
+        let formatter = ByteCountFormatter()
+        formatter.countStyle = style
+        formatter.includesUnit = true
+        formatter.isAdaptive = true
+        self.byteFormatters[style.rawValue] = formatter
+        return formatter
+    }
+    
+    private func temperatureFormatter(_ digits: Int) -> MeasurementFormatter {
+        self.lock.lock()
+        defer { self.lock.unlock() }
+        if let formatter = self.temperatureFormatters[digits] {
+            return formatter
+        }
+        let formatter = MeasurementFormatter()
+        formatter.locale = Locale.init(identifier: "en_US")
+        formatter.numberFormatter.maximumFractionDigits = digits
+        if digits != 0 {
+            formatter.numberFormatter.minimumFractionDigits = digits
+        }
+        formatter.unitOptions = .providedUnit
+        self.temperatureFormatters[digits] = formatter
+        return formatter
+    }
+    
+    private func localeChanged() {
+        self.lock.lock()
+        self.byteFormatters.removeAll()
+        self.temperatureFormatters.removeAll()
+        self.systemUnit = nil
+        self.lock.unlock()
+        self.memoryCache.removeAll()
+        self.temperatureCache.removeAll()
+    }
+}
@@ -0,0 +1,226 @@
+//
+//  History.swift
+//  Kit
+//
+//  Created by Serhiy Mytrovtsiy on 18/10/2026.
+//  Using Swift 6.0.
+//  Running on macOS 26.5.
+//
+//  Copyright © 2026 Serhiy Mytrovtsiy. All rights reserved.
+//
+
+import Foundation
+
+// Fixed-capacity history of many series in one flat float32 buffer. Each slot keeps a ring of the
+// last `capacity` values plus two monotonic deques, so min and max over the whole window, mean and
+// variance are available in O(1) after every append.
+public final class ValueHistory {
+    public struct Stats: Codable, Equatable {
+        public let count: Int
+        public let last: Double
+        public let min: Double
+        public let max: Double
+        public let mean: Double
+        public let variance: Double
+    }
+    
+    private struct Slot {
+        var next: Int = 0
+        var count: Int = 0
+        var minHead: Int = 0
+        var minCount: Int = 0
+        var maxHead: Int = 0
+        var maxCount: Int = 0
+        var sum: Double = 0
+        var squares: Double = 0
+    }
+    
+    public let capacity: Int
+    private let lock = NSLock()
+    private var list: [String] = []
+    private var index: [String: Int] = [:]
+    private var slots: [Slot] = []
+    private var values: [Float] = []
+    // deque entries are ring positions, 16 bits are enough for the capacity limit
+    private var minDeque: [UInt16] = []
+    private var maxDeque: [UInt16] = []
+    
+    public init(capacity: Int) {
+        self.capacity = min(max(capacity, 1), Int(UInt16.max) + 1)
+    }
+    
+    public var keys: [String] {
+        self.lock.lock()
+        defer { self.lock.unlock() }
+        return self.list
+    }
+    
+    public var memory: Int {
+        self.lock.lock()
+        defer { self.lock.unlock() }
+        return self.values.capacity * MemoryLayout<Float>.stride + (self.minDeque.capacity + self.maxDeque.capacity) * MemoryLayout<UInt16>.stride
+    }
+    
+    // returns the slot for the key, a new one is allocated on the first use
+    public func slot(_ key: String) -> Int {
+        self.lock.lock()
+        defer { self.lock.unlock() }
+        
+        if let slot = self.index[key] {
+            return slot
+        }
+        
+        let slot = self.slots.count
+        self.index[key] = slot
+        self.list.append(key)
+        self.slots.append(Slot())
+        self.values.append(contentsOf: repeatElement(0, count: self.capacity))
+        self.minDeque.append(contentsOf: repeatElement(0, count: self.capacity))
+        self.maxDeque.append(contentsOf: repeatElement(0, count: self.capacity))
+        return slot
+    }
+    
+    // the slot of a known key, unlike slot(_:) it never allocates one
+    public func index(of key: String) -> Int? {
+        self.lock.lock()
+        defer { self.lock.unlock() }
+        return self.index[key]
+    }
+    
+    public func append(_ slot: Int, _ value: Double) {
+        guard value.isFinite else { return }
+        self.lock.lock()
+        defer { self.lock.unlock() }
+        guard slot < self.slots.count else { return }
+        
+        let capacity = self.capacity
+        let base = slot * capacity
+        let v = Float(value)
+        var s = self.slots[slot]
+        let pos = s.next
+        
+        if s.count == capacity {
+            let old = Double(self.values[base + pos])
+            s.sum -= old
+            s.squares -= old * old
+            // the overwritten value can only be the front of a deque, it is the oldest one
+            if s.minCount > 0 && Int(self.minDeque[base + s.minHead]) == pos {
+                s.minHead = (s.minHead + 1) % capacity
+                s.minCount -= 1
+            }
+            if s.maxCount > 0 && Int(self.maxDeque[base + s.maxHead]) == pos {
+                s.maxHead = (s.maxHead + 1) % capacity
+                s.maxCount -= 1
+            }
+        } else {
+            s.count += 1
+        }
+        
+        self.values[base + pos] = v
+        s.sum += Double(v)
+        s.squares += Double(v) * Double(v)
+        
+        while s.minCount > 0 && self.values[base + Int(self.minDeque[base + (s.minHead + s.minCount - 1) % capacity])] >= v {
+            s.minCount -= 1
+        }
+        self.minDeque[base + (s.minHead + s.minCount) % capacity] = UInt16(pos)
+        s.minCount += 1
+        
+        while s.maxCount > 0 && self.values[base + Int(self.maxDeque[base + (s.maxHead + s.maxCount - 1) % capacity])] <= v {
+            s.maxCount -= 1
+        }
+        self.maxDeque[base + (s.maxHead + s.maxCount) % capacity] = UInt16(pos)
+        s.maxCount += 1
+        
+        s.next = (pos + 1) % capacity
+        if s.next == 0 {
+            // recompute the running sums once per lap to drop the accumulated rounding error
+            var sum: Double = 0, squares: Double = 0
+            for i in base..<base+s.count {
+                let x = Double(self.values[i])
+                sum += x
+                squares += x * x
+            }
+            s.sum = sum
+            s.squares = squares
+        }
+        
+        self.slots[slot] = s
+    }
+    
+    public func stats(_ key: String) -> Stats? {
+        self.lock.lock()
+        let slot = self.index[key]
+        self.lock.unlock()
+        guard let slot else { return nil }
+        return self.stats(slot)
+    }
+    
+    public func stats(_ slot: Int) -> Stats? {
+        self.lock.lock()
+        defer { self.lock.unlock() }
+        guard slot < self.slots.count, self.slots[slot].count > 0 else { return nil }
+        
+        let s = self.slots[slot]
+        let base = slot * self.capacity
+        let n = Double(s.count)
+        let mean = s.sum / n
+        
+        return Stats(
+            count: s.count,
+            last: Double(self.values[base + (s.next + self.capacity - 1) % self.capacity]),
+            min: Double(self.values[base + Int(self.minDeque[base + s.minHead])]),
+            max: Double(self.values[base + Int(self.maxDeque[base + s.maxHead])]),
+            mean: mean,
+            variance: max(s.squares / n - mean * mean, 0)
+        )
+    }
+    
+    // gives access to the slot values in chronological order as two segments (older, newer) without copying,
+    // the buffers are valid only inside the closure
+    public func withValues<R>(_ slot: Int, _ body: (UnsafeBufferPointer<Float>, UnsafeBufferPointer<Float>) -> R) -> R {
+        self.lock.lock()
+        defer { self.lock.unlock() }
+        
+        return self.values.withUnsafeBufferPointer { buffer -> R in
+            guard slot < self.slots.count, let ptr = buffer.baseAddress else {
+                return body(UnsafeBufferPointer(start: nil, count: 0), UnsafeBufferPointer(start: nil, count: 0))
+            }
+            let s = self.slots[slot]
+            let base = ptr.advanced(by: slot * self.capacity)
+            if s.count < self.capacity {
+                return body(UnsafeBufferPointer(start: base, count: s.count), UnsafeBufferPointer(start: nil, count: 0))
+            }
+            return body(
+                UnsafeBufferPointer(start: base.advanced(by: s.next), count: self.capacity - s.next),
+                UnsafeBufferPointer(start: base, count: s.next)
+            )
+        }
+    }
+    
+    // minimum and maximum of the last n values, nil when there are fewer than minimum values
+    public func range(_ slot: Int, last n: Int, minimum: Int = 1) -> (min: Double, max: Double)? {
+        self.withValues(slot) { older, newer -> (min: Double, max: Double)? in
+            let total = older.count + newer.count
+            let count = min(n, total)
+            guard count > 0, count >= minimum else { return nil }
+            
+            var lower: Float = .greatestFiniteMagnitude
+            var upper: Float = -.greatestFiniteMagnitude
+            for i in total-count..<total {
+                let v = i < older.count ? older[i] : newer[i - older.count]
+                lower = Swift.min(lower, v)
+                upper = Swift.max(upper, v)
+            }
+            return (Double(lower), Double(upper))
+        }
+    }
+    
+    public func reset() {
+        self.lock.lock()
+        defer { self.lock.unlock() }
+        for i in self.slots.indices {
+            self.slots[i] = Slot()
+        }
+    }
+}
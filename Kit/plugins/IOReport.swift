@@ -0,0 +1,151 @@
+//
+//  IOReport.swift
+//  Kit
+//
+//  Created by Serhiy Mytrovtsiy on 18/10/2026.
+//  Using Swift 6.0.
+//  Running on macOS 26.5.
+//
+//  Copyright © 2026 Serhiy Mytrovtsiy. All rights reserved.
+//
+
+import Foundation
+import Accelerate
+
+// A channel resolved once at subscription time: where its values live in the flat buffer
+// and which group (cluster, energy model component, etc.) it belongs to.
+public struct IOReportSlot: Equatable {
+    public let channel: Int
+    public let group: Int
+    public let offset: Int
+    public let count: Int
+    public let active: Int
+    public let scale: Double
+    
+    public init(channel: Int, group: Int, offset: Int, count: Int = 1, active: Int = 0, scale: Double = 1) {
+        self.channel = channel
+        self.group = group
+        self.offset = offset
+        self.count = count
+        self.active = active
+        self.scale = scale
+    }
+}
+
+// Flat storage for IOReport samples. The reader writes raw residencies/counters into `values`,
+// `commit()` computes the deltas against the previous sample, and the results are aggregated
+// per group without touching the channel dictionaries or names again.
+public final class IOReportSamples {
+    public let slots: [IOReportSlot]
+    public let size: Int
+    
+    public private(set) var values: [Double]
+    public private(set) var deltas: [Double]
+    public private(set) var elapsed: TimeInterval = 0
+    public private(set) var isReady: Bool = false
+    
+    private var previous: [Double]
+    private var previousTime: TimeInterval? = nil
+    private var hasPrevious: Bool = false
+    
+    public init(slots: [IOReportSlot]) {
+        self.slots = slots
+        self.size = slots.reduce(0) { max($0, $1.offset + $1.count) }
+        self.values = [Double](repeating: 0, count: self.size)
+        self.previous = [Double](repeating: 0, count: self.size)
+        self.deltas = [Double](repeating: 0, count: self.size)
+    }
+    
+    // builds the slots for channels with the given state/value counts, channels with group < 0 are skipped
+    public static func layout(groups: [Int], counts: [Int], active: [Int]? = nil, scales: [Double]? = nil) -> [IOReportSlot] {
+        var slots: [IOReportSlot] = []
+        var offset = 0
+        for i in groups.indices where groups[i] >= 0 && counts[i] > 0 {
+            slots.append(IOReportSlot(channel: i, group: groups[i], offset: offset, count: counts[i], active: active?[i] ?? 0, scale: scales?[i] ?? 1))
+            offset += counts[i]
+        }
+        return slots
+    }
+    
+    private static let channelsKey: CFString = "IOReportChannels" as CFString
+    
+    // returns the channels array of the IOReport sample without bridging the whole dictionary
+    public static func channels(_ sample: CFDictionary) -> CFArray? {
+        guard let ptr = CFDictionaryGetValue(sample, Unmanaged.passUnretained(self.channelsKey).toOpaque()) else { return nil }
+        return unsafeBitCast(ptr, to: CFArray.self)
+    }
+    
+    // returns the channel dictionary at index
+    public static func channel(_ channels: CFArray, _ index: Int) -> CFDictionary {
+        unsafeBitCast(CFArrayGetValueAtIndex(channels, index), to: CFDictionary.self)
+    }
+    
+    public func write(_ body: (inout [Double]) -> Void) {
+        body(&self.values)
+    }
+    
+    // computes deltas between the current and the previous values, returns false for the first sample
+    @discardableResult
+    public func commit(time: TimeInterval) -> Bool {
+        defer {
+            swap(&self.values, &self.previous)
+            self.previousTime = time
+            self.hasPrevious = true
+        }
+        
+        guard self.hasPrevious, let previousTime = self.previousTime else {
+            self.isReady = false
+            return false
+        }
+        
+        vDSP_vsubD(self.previous, 1, self.values, 1, &self.deltas, 1, vDSP_Length(self.size))
+        self.elapsed = time - previousTime
+        self.isReady = true
+        
+        return true
+    }
+    
+    public func reset() {
+        self.hasPrevious = false
+        self.previousTime = nil
+        self.isReady = false
+    }
+    
+    // average residency-weighted frequency of all channels in the group, nil when group has no channels
+    public func frequency(group: Int, frequencies: [Int32]) -> Double? {
+        guard self.isReady, !frequencies.isEmpty else { return nil }
+        let freqs = frequencies.map{ Double($0) }
+        
+        var total: Double = 0
+        var count: Double = 0
+        self.deltas.withUnsafeBufferPointer { deltas in
+            for slot in self.slots where slot.group == group {
+                count += 1
+                let states = slot.count - slot.active
+                guard states > 0, let base = deltas.baseAddress?.advanced(by: slot.offset + slot.active) else { continue }
+                
+                var usage: Double = 0
+                vDSP_sveD(base, 1, &usage, vDSP_Length(states))
+                guard usage > 0 else { continue }
+                
+                var weighted: Double = 0
+                vDSP_dotprD(base, 1, freqs, 1, &weighted, vDSP_Length(min(states, freqs.count)))
+                total += weighted / usage
+            }
+        }
+        
+        return count == 0 ? nil : total / count
+    }
+    
+    // scaled delta of the group counters per second (e.g. energy to power)
+    public func rate(group: Int) -> Double {
+        guard self.isReady, self.elapsed > 0 else { return 0 }
+        var total: Double = 0
+        for slot in self.slots where slot.group == group {
+            for i in slot.offset..<slot.offset+slot.count {
+                total += self.deltas[i] * slot.scale
+            }
+        }
+        return total / self.elapsed
+    }
+}
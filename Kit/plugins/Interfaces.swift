@@ -0,0 +1,152 @@
+//
+//  Interfaces.swift
+//  Kit
+//
+//  Created by Serhiy Mytrovtsiy on 19/10/2026.
+//  Using Swift 6.0.
+//  Running on macOS 26.5.
+//
+//  Copyright © 2026 Serhiy Mytrovtsiy. All rights reserved.
+//
+
+import Foundation
+
+public struct InterfaceCounter: Equatable {
+    public let index: Int
+    public var name: String
+    public var baudrate: UInt64 = 0
+    public var ibytes: UInt64 = 0
+    public var obytes: UInt64 = 0
+    
+    public init(index: Int, name: String, baudrate: UInt64 = 0, ibytes: UInt64 = 0, obytes: UInt64 = 0) {
+        self.index = index
+        self.name = name
+        self.baudrate = baudrate
+        self.ibytes = ibytes
+        self.obytes = obytes
+    }
+}
+
+// Byte counters of every network interface, read with one NET_RT_IFLIST2 sysctl into a buffer which
+// is only reallocated when the list grows. Each update keeps the difference to the previous counters
+// per interface, so the rates of all interfaces are known at once.
+public final class InterfaceCounterTable {
+    public struct Entry: Equatable {
+        public var counter: InterfaceCounter
+        // bytes since the previous update, zero on the first sample and after a reset
+        public var download: Int64 = 0
+        public var upload: Int64 = 0
+        public var resets: Int = 0
+    }
+    
+    public private(set) var entries: [Int: Entry] = [:]
+    private var names: [String: Int] = [:]
+    private var buffer: [UInt8] = []
+    private var list: [InterfaceCounter] = []
+    
+    public init() {}
+    
+    public func entry(_ name: String) -> Entry? {
+        self.names[name].flatMap{ self.entries[$0] }
+    }
+    
+    // reads the counters of all interfaces, returns false when the sysctl failed
+    @discardableResult
+    public func read() -> Bool {
+        var mib: [Int32] = [CTL_NET, PF_ROUTE, 0, 0, NET_RT_IFLIST2, 0]
+        var size: size_t = self.buffer.count
+        var result: Int32 = -1
+        
+        for _ in 0..<3 {
+            if !self.buffer.isEmpty {
+                size = self.buffer.count
+                result = self.buffer.withUnsafeMutableBytes { sysctl(&mib, u_int(mib.count), $0.baseAddress, &size, nil, 0) }
+                if result == 0 || errno != ENOMEM {
+                    break
+                }
+            }
+            var needed: size_t = 0
+            guard sysctl(&mib, u_int(mib.count), nil, &needed, nil, 0) == 0, needed > 0 else { return false }
+            // some headroom for the interfaces which appear between the two calls
+            self.buffer = [UInt8](repeating: 0, count: needed + needed / 4)
+        }
+        guard result == 0 else { return false }
+        
+        self.buffer.withUnsafeBytes {
+            InterfaceCounterTable.parse(UnsafeRawBufferPointer(rebasing: $0.prefix(size)), into: &self.list)
+        }
+        self.update(self.list)
+        return true
+    }
+    
+    public func update(_ list: [InterfaceCounter]) {
+        var entries: [Int: Entry] = [:]
+        entries.reserveCapacity(list.count)
+        self.names.removeAll(keepingCapacity: true)
+        
+        for counter in list {
+            var entry = Entry(counter: counter)
+            if let last = self.entries[counter.index], last.counter.name == counter.name {
+                let download = InterfaceCounterTable.delta(last.counter.ibytes, counter.ibytes)
+                let upload = InterfaceCounterTable.delta(last.counter.obytes, counter.obytes)
+                entry.resets = last.resets + (download == nil || upload == nil ? 1 : 0)
+                entry.download = download ?? 0
+                entry.upload = upload ?? 0
+            }
+            entries[counter.index] = entry
+            if !counter.name.isEmpty {
+                self.names[counter.name] = counter.index
+            }
+        }
+        self.entries = entries
+    }
+    
+    // difference of two readings of a counter, nil for a reset. The if_data64 counters are 64-bit and
+    // do not wrap in practice, so any step back is an interface which was re-created (utun and similar).
+    public static func delta(_ old: UInt64, _ new: UInt64) -> Int64? {
+        guard new >= old else { return nil }
+        return Int64(clamping: new - old)
+    }
+    
+    // RTM_IFINFO2 messages of a NET_RT_IFLIST2 buffer, the name comes from the link address which
+    // follows the header. The list is reused, only the counters are replaced.
+    public static func parse(_ buffer: UnsafeRawBufferPointer, into list: inout [InterfaceCounter]) {
+        list.removeAll(keepingCapacity: true)
+        
+        let headerSize = MemoryLayout<if_msghdr2>.size
+        let indexOffset = MemoryLayout<if_msghdr2>.offset(of: \if_msghdr2.ifm_index)!
+        let addrsOffset = MemoryLayout<if_msghdr2>.offset(of: \if_msghdr2.ifm_addrs)!
+        let dataOffset = MemoryLayout<if_msghdr2>.offset(of: \if_msghdr2.ifm_data)!
+        let ibytesOffset = dataOffset + MemoryLayout<if_data64>.offset(of: \if_data64.ifi_ibytes)!
+        let obytesOffset = dataOffset + MemoryLayout<if_data64>.offset(of: \if_data64.ifi_obytes)!
+        let baudrateOffset = dataOffset + MemoryLayout<if_data64>.offset(of: \if_data64.ifi_baudrate)!
+        let nameOffset = MemoryLayout<sockaddr_dl>.offset(of: \sockaddr_dl.sdl_data)!
+        
+        var offset = 0
+        while offset + 4 <= buffer.count {
+            let length = Int(buffer.loadUnaligned(fromByteOffset: offset, as: UInt16.self))
+            guard length > 0, offset + length <= buffer.count else { break }
+            defer { offset += length }
+            
+            guard Int32(buffer[offset + 3]) == RTM_IFINFO2, length >= headerSize else { continue }
+            let index = Int(buffer.loadUnaligned(fromByteOffset: offset + indexOffset, as: UInt16.self))
+            let addrs = buffer.loadUnaligned(fromByteOffset: offset + addrsOffset, as: Int32.self)
+            
+            var name = ""
+            let sdl = offset + headerSize
+            if addrs & RTA_IFP != 0, sdl + nameOffset <= offset + length, Int32(buffer[sdl + 1]) == AF_LINK {
+                let nlen = Int(buffer[sdl + 5])
+                let end = min(sdl + nameOffset + nlen, offset + length)
+                name = String(decoding: UnsafeRawBufferPointer(rebasing: buffer[(sdl + nameOffset)..<end]), as: UTF8.self)
+            }
+            
+            list.append(InterfaceCounter(
+                index: index,
+                name: name,
+                baudrate: buffer.loadUnaligned(fromByteOffset: offset + baudrateOffset, as: UInt64.self),
+                ibytes: buffer.loadUnaligned(fromByteOffset: offset + ibytesOffset, as: UInt64.self),
+                obytes: buffer.loadUnaligned(fromByteOffset: offset + obytesOffset, as: UInt64.self)
+            ))
+        }
+    }
+}
@@ -39,9 +39,126 @@ public protocol Writer: TextOutputStream {
     var type: LogWriter { get }
 }
 
+// Fixed-capacity FIFO. When it is full new values are rejected and counted as dropped.
+public struct LogRing<T> {
+    public let capacity: Int
+    public private(set) var count: Int = 0
+    public private(set) var dropped: Int = 0
+    
+    private var slots: [T?]
+    private var head: Int = 0
+    
+    public init(capacity: Int) {
+        self.capacity = max(capacity, 1)
+        self.slots = Array(repeating: nil, count: self.capacity)
+    }
+    
+    @discardableResult
+    public mutating func push(_ value: T) -> Bool {
+        guard self.count < self.capacity else {
+            self.dropped += 1
+            return false
+        }
+        self.slots[(self.head + self.count) % self.capacity] = value
+        self.count += 1
+        return true
+    }
+    
+    // moves the values into the list in order, returns the number dropped since the last drain
+    public mutating func drain(into list: inout [T]) -> Int {
+        for i in 0..<self.count {
+            let idx = (self.head + i) % self.capacity
+            if let value = self.slots[idx] {
+                list.append(value)
+            }
+            self.slots[idx] = nil
+        }
+        self.head = (self.head + self.count) % self.capacity
+        self.count = 0
+        let dropped = self.dropped
+        self.dropped = 0
+        return dropped
+    }
+}
+
+// Lets a burst of identical messages from the same call site through and suppresses the rest until
+// the window passes or the message changes.
+public struct LogRateLimiter {
+    private struct Site {
+        var message: Int
+        var start: TimeInterval
+        var count: Int
+        var suppressed: Int
+    }
+    
+    public let burst: Int
+    public let window: TimeInterval
+    public let maxSites: Int
+    
+    private var sites: [Int: Site] = [:]
+    
+    public init(burst: Int = 5, window: TimeInterval = 10, maxSites: Int = 256) {
+        self.burst = max(burst, 1)
+        self.window = window
+        self.maxSites = max(maxSites, 1)
+    }
+    
+    // nil when the line must be suppressed, otherwise the number of lines suppressed before it
+    public mutating func check(_ site: Int, message: Int, time: TimeInterval) -> Int? {
+        if var entry = self.sites[site], entry.message == message, time - entry.start < self.window {
+            entry.count += 1
+            defer { self.sites[site] = entry }
+            if entry.count > self.burst {
+                entry.suppressed += 1
+                return nil
+            }
+            return 0
+        }
+        
+        let suppressed = self.sites[site]?.suppressed ?? 0
+        if self.sites[site] == nil && self.sites.count >= self.maxSites {
+            self.sites.removeAll(keepingCapacity: true)
+        }
+        self.sites[site] = Site(message: message, start: time, count: 1, suppressed: 0)
+        return suppressed
+    }
+    
+    // the number of suppressed lines per call site which were not reported yet, the counts start again
+    public mutating func collect() -> [Int: Int] {
+        var list: [Int: Int] = [:]
+        for (site, entry) in self.sites where entry.suppressed > 0 {
+            list[site] = entry.suppressed
+            self.sites[site]?.suppressed = 0
+        }
+        return list
+    }
+}
+
+// The caller only stamps the line and copies it into a shared ring. Timestamps, prefixes and the
+// writes happen on a background queue, in one write per batch. Repeated lines are rate limited
+// per call site and lines which do not fit into the ring are counted.
 public class NextLog {
     public static let shared = NextLog()
     
+    private struct Entry {
+        let time: CFAbsoluteTime
+        let level: LogLevel
+        let options: UInt8
+        let file: String
+        let line: UInt
+        let message: String
+        let log: NextLog
+    }
+    
+    fileprivate static let defaultOptions: UInt8 = NextLog.mask(LogOption.new())
+    private static let lock = NSLock()
+    private static let queue = DispatchQueue(label: "eu.exelban.Stats.Logger", qos: .utility)
+    private static var ring = LogRing<Entry>(capacity: 4096)
+    private static var limiter = LogRateLimiter()
+    // the last suppressed line of every call site, to report the count on flush
+    private static var suppressed: [Int: Entry] = [:]
+    private static var scheduled: Bool = false
+    
     private var writer: Writer = StderrOutputStream()
     private var category: String? = nil
     
@@ -51,7 +168,9 @@ public class NextLog {
     
     public func copy(category: String? = nil) -> NextLog {
         let logger = NextLog()
+        NextLog.lock.lock()
         logger.writer = NextLog.shared.writer
+        NextLog.lock.unlock()
         if let category = category {
             logger.category = category
         }
@@ -59,10 +178,27 @@ public class NextLog {
     }
     
     public func log(level: LogLevel, options: [LogOption] = LogOption.new(), message: String, file: String = #file, line: UInt = #line) {
-        self.writer.write(self.prefix(level, options, file, line) + " " + message + "\n")
+        self.enqueue(level, NextLog.mask(options), message, file, line)
+    }
+    
+    // writes the queued lines and the counts of suppressed ones, called before the app terminates
+    public static func flush() {
+        NextLog.lock.lock()
+        for (site, count) in NextLog.limiter.collect() {
+            guard let e = NextLog.suppressed[site] else { continue }
+            NextLog.ring.push(Entry(time: e.time, level: e.level, options: e.options, file: e.file, line: e.line, message: "last message repeated \(count) times", log: e.log))
+        }
+        NextLog.suppressed.removeAll()
+        NextLog.lock.unlock()
+        
+        NextLog.queue.sync {
+            NextLog.drain()
+        }
     }
     
     public func setWriter(_ writer: LogWriter) {
+        NextLog.lock.lock()
+        defer { NextLog.lock.unlock() }
         switch writer {
         case .stdout:
             self.writer = StdoutOutputStream()
@@ -88,25 +224,99 @@ public class NextLog {
         }
     }
     
-    private func prefix(_ level: LogLevel, _ options: [LogOption], _ file: String = #file, _ line: UInt = #line) -> String {
+    fileprivate func enqueue(_ level: LogLevel, _ options: UInt8, _ message: String, _ file: String, _ line: UInt) {
+        let entry = Entry(time: CFAbsoluteTimeGetCurrent(), level: level, options: options, file: file, line: line, message: message, log: self)
+        let site = file.hashValue &* 31 &+ Int(line)
+        
+        NextLog.lock.lock()
+        if let suppressed = NextLog.limiter.check(site, message: message.hashValue, time: entry.time) {
+            if suppressed > 0 {
+                NextLog.ring.push(Entry(time: entry.time, level: level, options: options, file: file, line: line, message: "last message repeated \(suppressed) times", log: self))
+            }
+            NextLog.ring.push(entry)
+            NextLog.suppressed.removeValue(forKey: site)
+        } else {
+            if NextLog.suppressed[site] == nil && NextLog.suppressed.count >= NextLog.limiter.maxSites {
+                NextLog.suppressed.removeAll(keepingCapacity: true)
+            }
+            NextLog.suppressed[site] = entry
+        }
+        // an error does not wait for the drain which is already scheduled
+        let schedule = !NextLog.scheduled || level == .error
+        NextLog.scheduled = true
+        NextLog.lock.unlock()
+        
+        if schedule {
+            if level == .error {
+                NextLog.queue.async {
+                    NextLog.drain()
+                }
+            } else {
+                NextLog.queue.asyncAfter(deadline: .now() + 0.1) {
+                    NextLog.drain()
+                }
+            }
+        }
+    }
+    
+    private static func drain() {
+        var entries: [Entry] = []
+        NextLog.lock.lock()
+        let dropped = NextLog.ring.drain(into: &entries)
+        NextLog.scheduled = false
+        NextLog.lock.unlock()
+        
+        if dropped > 0 {
+            NextLog.shared.write("\(NextLog.timestamp()) \(LogLevel.error.rawValue) [Logger] \(dropped) lines dropped, the log buffer was full\n")
+        }
+        
+        // one write for every run of lines from the same logger
+        var text = ""
+        var current: NextLog? = nil
+        for entry in entries {
+            if let log = current, log !== entry.log {
+                log.write(text)
+                text = ""
+            }
+            current = entry.log
+            text += entry.log.prefix(entry) + " " + entry.message + "\n"
+        }
+        current?.write(text)
+    }
+    
+    private func write(_ text: String) {
+        guard !text.isEmpty else { return }
+        NextLog.lock.lock()
+        var writer = self.writer
+        NextLog.lock.unlock()
+        writer.write(text)
+    }
+    
+    private static func mask(_ options: [LogOption]) -> UInt8 {
+        options.reduce(0) { $0 | 1 << UInt8($1.rawValue) }
+    }
+    
+    private func prefix(_ entry: Entry) -> String {
+        let has: (LogOption) -> Bool = { entry.options & 1 << UInt8($0.rawValue) != 0 }
+        let level = entry.level, file = entry.file, line = entry.line
         var prefix = ""
         
-        if options.contains(.timestamp) {
-            self.space(&prefix, NextLog.timestampFormatter.string(from: Date()))
+        if has(.timestamp) {
+            self.space(&prefix, NextLog.timestamp(Date(timeIntervalSinceReferenceDate: entry.time)))
         }
         
-        if options.contains(.file) {
+        if has(.file) {
             if let f = file.split(separator: "/").last {
                 self.space(&prefix, String(f))
             }
-            if options.contains(.line) {
+            if has(.line) {
                 prefix += ":\(line)"
             }
-        } else if options.contains(.line) {
+        } else if has(.line) {
             self.space(&prefix, "\(line)")
         }
         
-        if options.contains(.level) {
+        if has(.level) {
             self.space(&prefix, level.rawValue)
         }
         
@@ -126,11 +336,20 @@ public class NextLog {
 }
 
 extension NextLog {
-    private static var timestampFormatter: DateFormatter {
+    private static let timestampFormatter: DateFormatter = {
         let formatter = DateFormatter()
         formatter.locale = Locale(identifier: "en_US_POSIX")
         formatter.dateFormat = "yyyy-MM-dd HH:mm:ss"
         return formatter
+    }()
+    // the timestamp has a second resolution, so a burst of lines reuses the same string
+    private static let timestamps = LRUCache<Int, String>(capacity: 4)
+    
+    private static func timestamp(_ date: Date = Date()) -> String {
+        let second = Int(date.timeIntervalSince1970.rounded(.down))
+        return NextLog.timestamps.value(second) {
+            NextLog.timestampFormatter.string(from: Date(timeIntervalSince1970: TimeInterval(second)))
+        }
     }
     
     private struct StdoutOutputStream: Writer {
@@ -169,17 +388,17 @@ extension NextLog {
 }
 
 public func debug(_ message: String, log: NextLog = NextLog.shared, file: String = #file, line: UInt = #line) {
-    log.log(level: .debug, message: message, file: file, line: line)
+    log.enqueue(.debug, NextLog.defaultOptions, message, file, line)
 }
 
 public func info(_ message: String, log: NextLog = NextLog.shared, file: String = #file, line: UInt = #line) {
-    log.log(level: .info, message: message, file: file, line: line)
+    log.enqueue(.info, NextLog.defaultOptions, message, file, line)
 }
 
 public func error(_ message: String, log: NextLog = NextLog.shared, file: String = #file, line: UInt = #line) {
-    log.log(level: .error, message: message, file: file, line: line)
+    log.enqueue(.error, NextLog.defaultOptions, message, file, line)
 }
 
 public func error_msg(_ message: String, log: NextLog = NextLog.shared, file: String = #file, line: UInt = #line) {
-    log.log(level: .error, message: message, file: file, line: line)
+    log.enqueue(.error, NextLog.defaultOptions, message, file, line)
 }
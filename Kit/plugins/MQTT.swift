@@ -0,0 +1,385 @@
+//
+//  MQTT.swift
+//  Kit
+//
+//  Created by Serhiy Mytrovtsiy on 18/10/2026.
+//  Using Swift 6.0.
+//  Running on macOS 26.5.
+//
+//  Copyright © 2026 Serhiy Mytrovtsiy. All rights reserved.
+//
+
+import Foundation
+
+enum MQTTPacketType: UInt8 {
+    case connect = 1
+    case connack = 2
+    case publish = 3
+    case puback = 4
+    case subscribe = 8
+    case suback = 9
+    case pingreq = 12
+    case pingresp = 13
+    case disconnect = 14
+}
+
+public enum MQTTError: Error, Equatable {
+    case malformedLength
+    case tooLarge(Int)
+    case malformed
+}
+
+// One decoded MQTT 3.1.1 packet. The body is a slice of the decoder buffer, nothing is copied.
+public struct MQTTPacket {
+    public let header: UInt8
+    public let body: Data
+    
+    public var type: UInt8 {
+        self.header >> 4
+    }
+    
+    public var qos: UInt8 {
+        (self.header >> 1) & 0x03
+    }
+    
+    public var retain: Bool {
+        self.header & 0x01 != 0
+    }
+    
+    public var dup: Bool {
+        self.header & 0x08 != 0
+    }
+    
+    // packet identifier of PUBACK, SUBACK and UNSUBACK
+    public var packetId: UInt16? {
+        guard self.body.count >= 2 else { return nil }
+        return UInt16(self.body[self.body.startIndex]) << 8 | UInt16(self.body[self.body.startIndex + 1])
+    }
+    
+    // topic, packet identifier (QoS > 0) and payload of a PUBLISH
+    public func publish() throws -> (topic: String, packetId: UInt16?, payload: Data) {
+        guard self.type == MQTTPacketType.publish.rawValue, self.body.count >= 2 else { throw MQTTError.malformed }
+        let start = self.body.startIndex
+        let length = Int(self.body[start]) << 8 | Int(self.body[start + 1])
+        var offset = start + 2 + length
+        guard offset <= self.body.endIndex, let topic = String(data: self.body[start+2..<offset], encoding: .utf8) else {
+            throw MQTTError.malformed
+        }
+        
+        var packetId: UInt16? = nil
+        if self.qos > 0 {
+            guard offset + 2 <= self.body.endIndex else { throw MQTTError.malformed }
+            packetId = UInt16(self.body[offset]) << 8 | UInt16(self.body[offset + 1])
+            offset += 2
+        }
+        return (topic, packetId, self.body[offset..<self.body.endIndex])
+    }
+}
+
+// Incremental decoder: bytes are appended as they arrive from the transport, next() returns the
+// packets which are complete, no matter how they were split into or combined within frames.
+public final class MQTTDecoder {
+    public let maxPacketSize: Int
+    
+    private var buffer = Data()
+    private var offset: Int = 0
+    
+    public init(maxPacketSize: Int = 1024 * 1024) {
+        self.maxPacketSize = maxPacketSize
+    }
+    
+    public var buffered: Int {
+        self.buffer.count - self.offset
+    }
+    
+    public func append(_ data: Data) {
+        if self.offset > 0 && self.offset * 2 >= self.buffer.count {
+            self.buffer.removeSubrange(self.buffer.startIndex..<self.buffer.startIndex + self.offset)
+            self.offset = 0
+        }
+        self.buffer.append(data)
+    }
+    
+    public func next() throws -> MQTTPacket? {
+        let start = self.buffer.startIndex + self.offset
+        let end = self.buffer.endIndex
+        guard end - start >= 2 else { return nil }
+        
+        var length = 0
+        var multiplier = 1
+        var i = start + 1
+        while true {
+            guard i < end else { return nil }
+            let byte = self.buffer[i]
+            length += Int(byte & 0x7F) * multiplier
+            i += 1
+            if byte & 0x80 == 0 {
+                break
+            }
+            multiplier *= 128
+            guard i - start <= 4 else {
+                self.reset()
+                throw MQTTError.malformedLength
+            }
+        }
+        guard length <= self.maxPacketSize else {
+            self.reset()
+            throw MQTTError.tooLarge(length)
+        }
+        guard end - i >= length else { return nil }
+        
+        let packet = MQTTPacket(header: self.buffer[start], body: self.buffer[i..<i+length])
+        self.offset = i + length - self.buffer.startIndex
+        return packet
+    }
+    
+    public func reset() {
+        self.buffer.removeAll(keepingCapacity: true)
+        self.offset = 0
+    }
+}
+
+// Writes the packets into one reusable buffer, only the returned Data is allocated. A string longer
+// than 65535 bytes or a packet over the 256 MB limit of the remaining length is rejected.
+public final class MQTTEncoder {
+    public static let maxRemainingLength: Int = 268_435_455
+    
+    private var buffer: [UInt8] = []
+    
+    public init(capacity: Int = 4096) {
+        self.buffer.reserveCapacity(capacity)
+    }
+    
+    public func connect(clientID: String, username: String, password: String, keepAlive: UInt16 = 900) throws -> Data {
+        let client = try MQTTEncoder.field(clientID), user = try MQTTEncoder.field(username), pass = try MQTTEncoder.field(password)
+        return self.packet(MQTTPacketType.connect.rawValue << 4, length: 10 + 6 + client.count + user.count + pass.count) {
+            self.string(Array("MQTT".utf8))
+            self.buffer.append(4) // protocol level 3.1.1
+            self.buffer.append(0x80 | 0x40) // username and password
+            self.uint16(keepAlive)
+            self.string(client)
+            self.string(user)
+            self.string(pass)
+        }
+    }
+    
+    public func publish(topic: String, payload: Data, qos: UInt8 = 0, retain: Bool = false, dup: Bool = false, packetId: UInt16 = 0) throws -> Data {
+        let topic = try MQTTEncoder.field(topic)
+        let qos = min(qos, 1)
+        let header = MQTTPacketType.publish.rawValue << 4 | (dup && qos > 0 ? 0x08 : 0) | qos << 1 | (retain ? 0x01 : 0x00)
+        let length = 2 + topic.count + (qos > 0 ? 2 : 0) + payload.count
+        guard length <= MQTTEncoder.maxRemainingLength else { throw MQTTError.tooLarge(length) }
+        return self.packet(header, length: length) {
+            self.string(topic)
+            if qos > 0 {
+                self.uint16(packetId)
+            }
+            self.buffer.append(contentsOf: payload)
+        }
+    }
+    
+    public func subscribe(topic: String, packetId: UInt16, qos: UInt8 = 0) throws -> Data {
+        let topic = try MQTTEncoder.field(topic)
+        return self.packet(MQTTPacketType.subscribe.rawValue << 4 | 0x02, length: 2 + 2 + topic.count + 1) {
+            self.uint16(packetId)
+            self.string(topic)
+            self.buffer.append(min(qos, 1))
+        }
+    }
+    
+    public func puback(_ packetId: UInt16) -> Data {
+        self.packet(MQTTPacketType.puback.rawValue << 4, length: 2) {
+            self.uint16(packetId)
+        }
+    }
+    
+    public func pingreq() -> Data {
+        self.packet(MQTTPacketType.pingreq.rawValue << 4, length: 0) {}
+    }
+    
+    public func disconnect() -> Data {
+        self.packet(MQTTPacketType.disconnect.rawValue << 4, length: 0) {}
+    }
+    
+    private func packet(_ header: UInt8, length: Int, _ body: () -> Void) -> Data {
+        self.buffer.removeAll(keepingCapacity: true)
+        self.buffer.append(header)
+        var remaining = length
+        repeat {
+            var byte = UInt8(remaining % 128)
+            remaining /= 128
+            if remaining > 0 {
+                byte |= 0x80
+            }
+            self.buffer.append(byte)
+        } while remaining > 0
+        body()
+        return Data(self.buffer)
+    }
+    
+    // the UTF-8 bytes of a string field, the length of the field is a 16-bit value
+    private static func field(_ value: String) throws -> [UInt8] {
+        let bytes = Array(value.utf8)
+        guard bytes.count <= Int(UInt16.max) else { throw MQTTError.tooLarge(bytes.count) }
+        return bytes
+    }
+    
+    private func string(_ bytes: [UInt8]) {
+        self.uint16(UInt16(bytes.count))
+        self.buffer.append(contentsOf: bytes)
+    }
+    
+    private func uint16(_ value: UInt16) {
+        self.buffer.append(UInt8(value >> 8))
+        self.buffer.append(UInt8(value & 0xFF))
+    }
+}
+
+// QoS 1 delivery state: queued messages get a packet identifier when they enter the in-flight
+// window and leave it on PUBACK. After a reconnect the unacknowledged ones are sent again as DUP.
+public struct MQTTInflight {
+    public struct Message: Equatable {
+        public let topic: String
+        public let payload: Data
+        public var packetId: UInt16 = 0
+        public var dup: Bool = false
+        public var sentAt: TimeInterval = 0
+        // read from the spool, it stays there until acknowledged
+        public var replayed: Bool = false
+        
+        public init(topic: String, payload: Data, replayed: Bool = false) {
+            self.topic = topic
+            self.payload = payload
+            self.replayed = replayed
+        }
+    }
+    
+    public let window: Int
+    public let queueLimit: Int
+    public private(set) var dropped: Int = 0
+    
+    private var queue: [Message] = []
+    private var head: Int = 0
+    private var inflight: [UInt16: Message] = [:]
+    private var order: [UInt16] = []
+    private var lastId: UInt16 = 0
+    private var reserved: Set<UInt16> = []
+    
+    public init(window: Int = 32, queueLimit: Int = 1024) {
+        self.window = max(window, 1)
+        self.queueLimit = max(queueLimit, 1)
+    }
+    
+    public var inFlight: Int {
+        self.inflight.count
+    }
+    
+    public var queued: Int {
+        self.queue.count - self.head
+    }
+    
+    public mutating func enqueue(_ message: Message) {
+        if self.queued >= self.queueLimit {
+            self.head += 1
+            self.dropped += 1
+        }
+        self.queue.append(message)
+    }
+    
+    // identifier which is not used by any message in flight or reserved
+    public mutating func nextId() -> UInt16 {
+        repeat {
+            self.lastId &+= 1
+            if self.lastId == 0 {
+                self.lastId = 1
+            }
+        } while self.inflight[self.lastId] != nil || self.reserved.contains(self.lastId)
+        return self.lastId
+    }
+    
+    // an identifier for a packet outside of the publish window (SUBSCRIBE), it is not given to a
+    // publish until released by the acknowledgement
+    public mutating func reserve() -> UInt16 {
+        let id = self.nextId()
+        self.reserved.insert(id)
+        return id
+    }
+    
+    @discardableResult
+    public mutating func release(_ packetId: UInt16) -> Bool {
+        self.reserved.remove(packetId) != nil
+    }
+    
+    // a new session, the acknowledgements of the reserved identifiers will not come
+    public mutating func releaseReserved() {
+        self.reserved.removeAll()
+    }
+    
+    // messages which can be sent now, they are in flight until acknowledged
+    public mutating func ready(_ time: TimeInterval) -> [Message] {
+        var list: [Message] = []
+        while self.inflight.count < self.window && self.head < self.queue.count {
+            var message = self.queue[self.head]
+            self.head += 1
+            message.packetId = self.nextId()
+            message.sentAt = time
+            self.inflight[message.packetId] = message
+            self.order.append(message.packetId)
+            list.append(message)
+        }
+        if self.head > 64 && self.head * 2 > self.queue.count {
+            self.queue.removeFirst(self.head)
+            self.head = 0
+        }
+        return list
+    }
+    
+    // the acknowledged message, nil for an unknown identifier
+    @discardableResult
+    public mutating func acknowledged(_ packetId: UInt16) -> Message? {
+        guard let message = self.inflight.removeValue(forKey: packetId) else { return nil }
+        if let i = self.order.firstIndex(of: packetId) {
+            self.order.remove(at: i)
+        }
+        return message
+    }
+    
+    // the unacknowledged messages in the order they were sent, flagged as duplicates
+    public mutating func resend(_ time: TimeInterval) -> [Message] {
+        self.order.compactMap { id -> Message? in
+            guard var message = self.inflight[id] else { return nil }
+            message.dup = true
+            message.sentAt = time
+            self.inflight[id] = message
+            return message
+        }
+    }
+    
+    // drops the replayed messages, they are still in the spool and are replayed again from there
+    public mutating func removeReplayed() {
+        self.queue = self.queue[self.head...].filter{ !$0.replayed }
+        self.head = 0
+        for (id, message) in self.inflight where message.replayed {
+            self.inflight.removeValue(forKey: id)
+        }
+        self.order.removeAll(where: { self.inflight[$0] == nil })
+    }
+    
+    // the spool dropped the records of the replayed messages: the queued ones are dropped, the ones
+    // on the wire stay until their PUBACK, which does not remove anything from the spool anymore
+    public mutating func detachReplayed() {
+        self.queue = self.queue[self.head...].filter{ !$0.replayed }
+        self.head = 0
+        for (id, message) in self.inflight where message.replayed {
+            self.inflight[id]?.replayed = false
+        }
+    }
+    
+    public mutating func removeAll() {
+        self.reserved.removeAll()
+        self.queue.removeAll()
+        self.head = 0
+        self.inflight.removeAll()
+        self.order.removeAll()
+    }
+}
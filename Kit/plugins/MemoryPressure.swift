@@ -0,0 +1,105 @@
+//
+//  MemoryPressure.swift
+//  Kit
+//
+//  Created by Serhiy Mytrovtsiy on 19/10/2026.
+//  Using Swift 6.0.
+//  Running on macOS 26.5.
+//
+//  Copyright © 2026 Serhiy Mytrovtsiy. All rights reserved.
+//
+
+import Foundation
+
+public struct VMCounters: Equatable {
+    public var compressions: UInt64
+    public var decompressions: UInt64
+    public var swapins: UInt64
+    public var swapouts: UInt64
+    
+    public init(compressions: UInt64 = 0, decompressions: UInt64 = 0, swapins: UInt64 = 0, swapouts: UInt64 = 0) {
+        self.compressions = compressions
+        self.decompressions = decompressions
+        self.swapins = swapins
+        self.swapouts = swapouts
+    }
+}
+
+// pages per second
+public struct VMRates: Codable, Equatable {
+    public var compressions: Double = 0
+    public var decompressions: Double = 0
+    public var swapins: Double = 0
+    public var swapouts: Double = 0
+    
+    public init() {}
+}
+
+// State of the memory pressure. The level is set by the kernel events and by the polled level, a
+// change is recorded with the time it was noticed. While the pressure is elevated the reader samples
+// at the fast interval, the rates of the VM counters are computed from the previous sample.
+public final class MemoryPressureMonitor {
+    public struct Transition: Equatable {
+        public let time: Date
+        public let from: RAMPressure
+        public let to: RAMPressure
+    }
+    
+    public let fastInterval: TimeInterval
+    public let limit: Int
+    
+    public private(set) var level: RAMPressure = .normal
+    public private(set) var since: Date? = nil
+    public private(set) var transitions: [Transition] = []
+    
+    private var last: (counters: VMCounters, time: TimeInterval)? = nil
+    
+    public init(fastInterval: TimeInterval = 0.5, limit: Int = 64) {
+        self.fastInterval = fastInterval
+        self.limit = max(limit, 1)
+    }
+    
+    public var elevated: Bool {
+        self.level != .normal
+    }
+    
+    // the level of kern.memorystatus_vm_pressure_level
+    public static func level(_ value: Int) -> RAMPressure {
+        switch value {
+        case 2: return .warning
+        case 4: return .critical
+        default: return .normal
+        }
+    }
+    
+    // returns true when the level changed
+    @discardableResult
+    public func set(_ level: RAMPressure, time: Date = Date()) -> Bool {
+        guard level != self.level else { return false }
+        if self.transitions.count == self.limit {
+            self.transitions.removeFirst()
+        }
+        self.transitions.append(Transition(time: time, from: self.level, to: level))
+        self.level = level
+        self.since = time
+        return true
+    }
+    
+    // rates since the previous sample (monotonic time in seconds), nil for the first one. A counter
+    // which went back was reset and gives a zero rate.
+    public func rates(_ counters: VMCounters, time: TimeInterval) -> VMRates? {
+        defer { self.last = (counters, time) }
+        guard let last = self.last, time > last.time else { return nil }
+        let interval = time - last.time
+        func rate(_ old: UInt64, _ new: UInt64) -> Double {
+            new >= old ? Double(new - old) / interval : 0
+        }
+        
+        var rates = VMRates()
+        rates.compressions = rate(last.counters.compressions, counters.compressions)
+        rates.decompressions = rate(last.counters.decompressions, counters.decompressions)
+        rates.swapins = rate(last.counters.swapins, counters.swapins)
+        rates.swapouts = rate(last.counters.swapouts, counters.swapouts)
+        return rates
+    }
+}
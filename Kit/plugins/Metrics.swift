@@ -0,0 +1,362 @@
+//
+//  Metrics.swift
+//  Kit
+//
+//  Created by Serhiy Mytrovtsiy on 18/10/2026.
+//  Using Swift 6.0.
+//  Running on macOS 26.5.
+//
+//  Copyright © 2026 Serhiy Mytrovtsiy. All rights reserved.
+//
+
+import Foundation
+
+// Binary frame with all metric updates of one tick.
+//
+//  u8      version
+//  u8      flags (0x01 keyframe)
+//  varint  sequence
+//  varint  timestamp, ms since 1970 in a keyframe and ms since the previous frame otherwise
+//  varint  number of entries
+//  entry:
+//      varint  metric id
+//      varint  ms since the frame timestamp
+//      u8      kind (0 full, 1 unchanged, 2 delta), 0x80 when the metric key follows
+//      [varint length, key]
+//      full:   varint length, payload
+//      delta:  varint prefix, varint suffix, varint length, bytes between them
+//
+// Delta payloads are relative to the previous payload of the same metric. A keyframe resets the
+// metric ids and the previous payloads, the decoder can start from any keyframe.
+public enum MetricsFrameError: Error, Equatable {
+    case truncated
+    case version(UInt8)
+    case outOfSync
+    case unknownMetric(Int)
+    case invalid
+}
+
+public struct MetricUpdate: Equatable {
+    public let key: String
+    public let time: Date
+    public let payload: Data
+    
+    public init(key: String, time: Date, payload: Data) {
+        self.key = key
+        self.time = time
+        self.payload = payload
+    }
+}
+
+private enum MetricKind: UInt8 {
+    case full = 0
+    case unchanged = 1
+    case delta = 2
+}
+
+private let MetricsFrameVersion: UInt8 = 1
+private let MetricKeyFlag: UInt8 = 0x80
+
+public final class MetricsFrameEncoder {
+    public var keyframeInterval: Int
+    
+    private var ids: [String: Int] = [:]
+    private var previous: [Int: [UInt8]] = [:]
+    private var sequence: UInt64 = 0
+    private var lastTime: UInt64 = 0
+    private var sinceKeyframe: Int = 0
+    private var forceKeyframe: Bool = true
+    private let lock = NSLock()
+    
+    public init(keyframeInterval: Int = 30) {
+        self.keyframeInterval = max(keyframeInterval, 1)
+    }
+    
+    // the next frame is a keyframe, used after a reconnect
+    public func reset() {
+        self.lock.lock()
+        self.forceKeyframe = true
+        self.lock.unlock()
+    }
+    
+    public func encode(_ updates: [MetricUpdate]) -> Data {
+        self.lock.lock()
+        defer { self.lock.unlock() }
+        
+        let keyframe = self.forceKeyframe || self.sinceKeyframe >= self.keyframeInterval
+        if keyframe {
+            self.ids.removeAll(keepingCapacity: true)
+            self.previous.removeAll(keepingCapacity: true)
+            self.sinceKeyframe = 0
+            self.forceKeyframe = false
+        }
+        self.sinceKeyframe += 1
+        
+        let times = updates.map{ UInt64(max(0, $0.time.timeIntervalSince1970 * 1_000).rounded()) }
+        // the frame timestamp never goes back, otherwise the decoder could not follow the deltas
+        let base = keyframe ? (times.min() ?? self.lastTime) : max(times.min() ?? self.lastTime, self.lastTime)
+        
+        var out: [UInt8] = []
+        out.reserveCapacity(16 + updates.reduce(0) { $0 + $1.payload.count + 8 })
+        out.append(MetricsFrameVersion)
+        out.append(keyframe ? 0x01 : 0x00)
+        MetricsVarint.write(self.sequence, &out)
+        MetricsVarint.write(keyframe ? base : base - self.lastTime, &out)
+        MetricsVarint.write(UInt64(updates.count), &out)
+        
+        for (i, update) in updates.enumerated() {
+            var flag: UInt8 = 0
+            let id: Int
+            if let existing = self.ids[update.key] {
+                id = existing
+            } else {
+                id = self.ids.count
+                self.ids[update.key] = id
+                flag = MetricKeyFlag
+            }
+            MetricsVarint.write(UInt64(id), &out)
+            MetricsVarint.write(max(times[i], base) - base, &out)
+            
+            let payload = [UInt8](update.payload)
+            let kindIndex = out.count
+            out.append(0)
+            if flag != 0 {
+                let key = Array(update.key.utf8)
+                MetricsVarint.write(UInt64(key.count), &out)
+                out.append(contentsOf: key)
+            }
+            
+            var kind: MetricKind = .full
+            if let old = self.previous[id] {
+                if old == payload {
+                    kind = .unchanged
+                } else {
+                    let (prefix, suffix) = MetricsFrameEncoder.overlap(old, payload)
+                    if prefix + suffix > 4 {
+                        kind = .delta
+                        MetricsVarint.write(UInt64(prefix), &out)
+                        MetricsVarint.write(UInt64(suffix), &out)
+                        MetricsVarint.write(UInt64(payload.count - prefix - suffix), &out)
+                        out.append(contentsOf: payload[prefix..<payload.count-suffix])
+                    }
+                }
+            }
+            if kind == .full {
+                MetricsVarint.write(UInt64(payload.count), &out)
+                out.append(contentsOf: payload)
+            }
+            out[kindIndex] = kind.rawValue | flag
+            self.previous[id] = payload
+        }
+        
+        self.sequence &+= 1
+        self.lastTime = base
+        return Data(out)
+    }
+    
+    // common prefix and suffix of two payloads, they never overlap in the new one
+    private static func overlap(_ a: [UInt8], _ b: [UInt8]) -> (Int, Int) {
+        let limit = min(a.count, b.count)
+        var prefix = 0
+        while prefix < limit && a[prefix] == b[prefix] {
+            prefix += 1
+        }
+        var suffix = 0
+        while suffix < limit - prefix && a[a.count - 1 - suffix] == b[b.count - 1 - suffix] {
+            suffix += 1
+        }
+        return (prefix, suffix)
+    }
+}
+
+public final class MetricsFrameDecoder {
+    private var keys: [Int: String] = [:]
+    private var previous: [Int: [UInt8]] = [:]
+    private var expected: UInt64? = nil
+    private var lastTime: UInt64 = 0
+    
+    public init() {}
+    
+    public func decode(_ data: Data) throws -> [MetricUpdate] {
+        var reader = MetricsReader([UInt8](data))
+        
+        let version = try reader.byte()
+        guard version == MetricsFrameVersion else { throw MetricsFrameError.version(version) }
+        let keyframe = try reader.byte() & 0x01 != 0
+        let sequence = try reader.varint()
+        let timestamp = try reader.varint()
+        let count = try reader.varint()
+        
+        if keyframe {
+            self.keys.removeAll(keepingCapacity: true)
+            self.previous.removeAll(keepingCapacity: true)
+        } else if self.expected != sequence {
+            self.expected = nil
+            throw MetricsFrameError.outOfSync
+        }
+        // a broken frame leaves the state out of sync until the next keyframe
+        self.expected = nil
+        let base = keyframe ? timestamp : self.lastTime &+ timestamp
+        
+        var updates: [MetricUpdate] = []
+        updates.reserveCapacity(Int(min(count, 4_096)))
+        for _ in 0..<count {
+            let id = Int(clamping: try reader.varint())
+            let offset = try reader.varint()
+            let raw = try reader.byte()
+            
+            if raw & MetricKeyFlag != 0 {
+                let length = Int(clamping: try reader.varint())
+                guard let key = String(bytes: try reader.bytes(length), encoding: .utf8) else { throw MetricsFrameError.invalid }
+                self.keys[id] = key
+            }
+            guard let key = self.keys[id] else { throw MetricsFrameError.unknownMetric(id) }
+            guard let kind = MetricKind(rawValue: raw & ~MetricKeyFlag) else { throw MetricsFrameError.invalid }
+            
+            var payload: [UInt8]
+            switch kind {
+            case .full:
+                payload = Array(try reader.bytes(Int(clamping: try reader.varint())))
+            case .unchanged:
+                guard let old = self.previous[id] else { throw MetricsFrameError.outOfSync }
+                payload = old
+            case .delta:
+                guard let old = self.previous[id] else { throw MetricsFrameError.outOfSync }
+                let prefix = Int(clamping: try reader.varint())
+                let suffix = Int(clamping: try reader.varint())
+                let middle = try reader.bytes(Int(clamping: try reader.varint()))
+                guard prefix <= old.count, suffix <= old.count - prefix else { throw MetricsFrameError.invalid }
+                payload = Array(old[0..<prefix])
+                payload.append(contentsOf: middle)
+                payload.append(contentsOf: old[(old.count - suffix)...])
+            }
+            
+            self.previous[id] = payload
+            let time = Date(timeIntervalSince1970: TimeInterval(base &+ offset) / 1_000)
+            updates.append(MetricUpdate(key: key, time: time, payload: Data(payload)))
+        }
+        
+        self.expected = sequence &+ 1
+        self.lastTime = base
+        return updates
+    }
+}
+
+private enum MetricsVarint {
+    static func write(_ value: UInt64, _ out: inout [UInt8]) {
+        var v = value
+        while v >= 0x80 {
+            out.append(UInt8(v & 0x7F) | 0x80)
+            v >>= 7
+        }
+        out.append(UInt8(v))
+    }
+}
+
+private struct MetricsReader {
+    private let data: [UInt8]
+    private var offset: Int = 0
+    
+    init(_ data: [UInt8]) {
+        self.data = data
+    }
+    
+    mutating func byte() throws -> UInt8 {
+        guard self.offset < self.data.count else { throw MetricsFrameError.truncated }
+        defer { self.offset += 1 }
+        return self.data[self.offset]
+    }
+    
+    mutating func varint() throws -> UInt64 {
+        var value: UInt64 = 0
+        var shift: UInt64 = 0
+        while true {
+            let b = try self.byte()
+            guard shift < 64 else { throw MetricsFrameError.invalid }
+            value |= UInt64(b & 0x7F) << shift
+            if b & 0x80 == 0 {
+                return value
+            }
+            shift += 7
+        }
+    }
+    
+    mutating func bytes(_ count: Int) throws -> ArraySlice<UInt8> {
+        guard count >= 0, count <= self.data.count - self.offset else { throw MetricsFrameError.truncated }
+        defer { self.offset += count }
+        return self.data[self.offset..<self.offset+count]
+    }
+}
+
+// Collects the metric updates and publishes them together: once per interval after the first pending
+// update, or immediately when the pending payloads exceed the size limit. A metric updated several
+// times in one tick is sent only with its last value.
+public final class MetricsPublisher {
+    public var interval: TimeInterval
+    public var sizeLimit: Int
+    public var flushHandler: (([MetricUpdate]) -> Void)? = nil
+    
+    private let queue = DispatchQueue(label: "eu.exelban.Stats.Remote.Metrics")
+    private var pending: [MetricUpdate] = []
+    private var index: [String: Int] = [:]
+    private var size: Int = 0
+    private var scheduled: Bool = false
+    private var generation: Int = 0
+    
+    public init(interval: TimeInterval = 1, sizeLimit: Int = 16 * 1024) {
+        self.interval = interval
+        self.sizeLimit = sizeLimit
+    }
+    
+    public func add(key: String, payload: Data, time: Date = Date()) {
+        self.queue.async {
+            let update = MetricUpdate(key: key, time: time, payload: payload)
+            if let i = self.index[key] {
+                self.size += payload.count - self.pending[i].payload.count
+                self.pending[i] = update
+            } else {
+                self.index[key] = self.pending.count
+                self.pending.append(update)
+                self.size += payload.count
+            }
+            
+            if self.size >= self.sizeLimit {
+                self.flushLocked()
+            } else if !self.scheduled {
+                self.scheduled = true
+                let generation = self.generation
+                self.queue.asyncAfter(deadline: .now() + self.interval) { [weak self] in
+                    guard let self, self.generation == generation else { return }
+                    self.flushLocked()
+                }
+            }
+        }
+    }
+    
+    public func flush() {
+        self.queue.async {
+            self.flushLocked()
+        }
+    }
+    
+    public func discard() {
+        self.queue.async {
+            self.clearLocked()
+        }
+    }
+    
+    private func flushLocked() {
+        let updates = self.pending
+        self.clearLocked()
+        guard !updates.isEmpty else { return }
+        self.flushHandler?(updates)
+    }
+    
+    private func clearLocked() {
+        self.pending.removeAll(keepingCapacity: true)
+        self.index.removeAll(keepingCapacity: true)
+        self.size = 0
+        self.scheduled = false
+        self.generation &+= 1
+    }
+}
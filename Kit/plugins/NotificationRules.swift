@@ -0,0 +1,249 @@
+//
+//  NotificationRules.swift
+//  Kit
+//
+//  Created by Serhiy Mytrovtsiy on 19/10/2026.
+//  Using Swift 6.0.
+//  Running on macOS 26.5.
+//
+//  Copyright © 2026 Serhiy Mytrovtsiy. All rights reserved.
+//
+
+import Foundation
+
+public enum RulePredicate: Equatable {
+    // the value reached the threshold, it is cleared below threshold - band
+    case above(Double, band: Double = 0)
+    // the value dropped to the threshold, it is cleared above threshold + band
+    case below(Double, band: Double = 0)
+    // change per second, a negative limit is a fall
+    case rate(Double)
+    // the value is further than the deviations from its exponentially weighted mean
+    case anomaly(alpha: Double, deviations: Double)
+}
+
+public struct RuleCondition: Equatable {
+    public let slot: Int
+    public let predicate: RulePredicate
+    
+    public init(slot: Int, _ predicate: RulePredicate) {
+        self.slot = slot
+        self.predicate = predicate
+    }
+}
+
+// A rule fires when all its conditions hold for the consecutive evaluations and the duration (seconds),
+// it fires once and is cleared when a condition does not hold anymore.
+public struct NotificationRule: Equatable {
+    public let id: String
+    public let conditions: [RuleCondition]
+    public let consecutive: Int
+    public let duration: TimeInterval
+    
+    public init(id: String, conditions: [RuleCondition], consecutive: Int = 1, duration: TimeInterval = 0) {
+        self.id = id
+        self.conditions = conditions
+        self.consecutive = max(1, consecutive)
+        self.duration = max(0, duration)
+    }
+}
+
+// Rules over metric slots. The conditions of all rules are compiled into one flat table with their
+// state next to them, an evaluation is one pass over the rules which have a slot updated since the
+// previous one.
+public final class RuleEngine {
+    public enum Event: Equatable {
+        case fired(String)
+        case cleared(String)
+    }
+    
+    private struct Entry {
+        let slot: Int
+        let predicate: RulePredicate
+        var active: Bool = false
+        var previous: (value: Double, time: TimeInterval)? = nil
+        var mean: Double = 0
+        var variance: Double = 0
+        var samples: Int = 0
+    }
+    
+    private struct State {
+        var rule: NotificationRule
+        var range: Range<Int> = 0..<0
+        var streak: Int = 0
+        var since: TimeInterval? = nil
+        var firing: Bool = false
+    }
+    
+    private var slots: [String: Int] = [:]
+    private var values: [Double] = []
+    private var present: [Bool] = []
+    private var dirty: [Bool] = []
+    
+    private var rules: [State] = []
+    private var index: [String: Int] = [:]
+    private var table: [Entry] = []
+    
+    public init() {}
+    
+    // the slot of the metric, it is created on the first use
+    public func slot(_ name: String) -> Int {
+        if let slot = self.slots[name] {
+            return slot
+        }
+        let slot = self.values.count
+        self.slots[name] = slot
+        self.values.append(0)
+        self.present.append(false)
+        self.dirty.append(false)
+        return slot
+    }
+    
+    public func isFiring(_ id: String) -> Bool {
+        self.index[id].map{ self.rules[$0].firing } ?? false
+    }
+    
+    // adds or replaces the rule, a replaced rule keeps its state. A rule with a slot which was not
+    // created by slot(_:) or with an anomaly alpha outside (0, 1] is rejected.
+    @discardableResult
+    public func set(_ rule: NotificationRule) -> Bool {
+        for condition in rule.conditions {
+            guard self.values.indices.contains(condition.slot) else { return false }
+            if case .anomaly(let alpha, _) = condition.predicate, !(alpha > 0 && alpha <= 1) {
+                return false
+            }
+        }
+        
+        if let i = self.index[rule.id] {
+            guard self.rules[i].rule != rule else { return true }
+            self.rules[i].rule = rule
+        } else {
+            self.index[rule.id] = self.rules.count
+            self.rules.append(State(rule: rule))
+        }
+        self.compile()
+        return true
+    }
+    
+    public func remove(_ id: String) {
+        guard let i = self.index.removeValue(forKey: id) else { return }
+        self.rules.remove(at: i)
+        for j in i..<self.rules.count {
+            self.index[self.rules[j].rule.id] = j
+        }
+        self.compile()
+    }
+    
+    // nil marks the metric as missing, its conditions do not hold
+    public func update(_ slot: Int, _ value: Double?) {
+        guard self.values.indices.contains(slot) else { return }
+        self.values[slot] = value ?? 0
+        self.present[slot] = value != nil
+        self.dirty[slot] = true
+    }
+    
+    public func update(_ name: String, _ value: Double?) {
+        self.update(self.slot(name), value)
+    }
+    
+    public func evaluate(_ time: TimeInterval) -> [Event] {
+        var events: [Event] = []
+        for r in 0..<self.rules.count {
+            let range = self.rules[r].range
+            guard self.table[range].contains(where: { self.dirty[$0.slot] }) else { continue }
+            
+            // every condition is evaluated, the rate and the mean only advance with their own slot
+            var holds = !range.isEmpty
+            for e in range {
+                if !self.check(e, time) {
+                    holds = false
+                }
+            }
+            
+            var state = self.rules[r]
+            if holds {
+                state.streak += 1
+                state.since = state.since ?? time
+                if !state.firing && state.streak >= state.rule.consecutive && time - (state.since ?? time) >= state.rule.duration {
+                    state.firing = true
+                    events.append(.fired(state.rule.id))
+                }
+            } else {
+                state.streak = 0
+                state.since = nil
+                if state.firing {
+                    state.firing = false
+                    events.append(.cleared(state.rule.id))
+                }
+            }
+            self.rules[r] = state
+        }
+        for i in self.dirty.indices {
+            self.dirty[i] = false
+        }
+        return events
+    }
+    
+    private func check(_ e: Int, _ time: TimeInterval) -> Bool {
+        var entry = self.table[e]
+        guard self.dirty[entry.slot] else {
+            return entry.active
+        }
+        defer { self.table[e] = entry }
+        guard self.present[entry.slot] else {
+            entry.active = false
+            return false
+        }
+        let value = self.values[entry.slot]
+        
+        switch entry.predicate {
+        case .above(let threshold, let band):
+            entry.active = entry.active ? value >= threshold - band : value >= threshold
+        case .below(let threshold, let band):
+            entry.active = entry.active ? value <= threshold + band : value <= threshold
+        case .rate(let limit):
+            entry.active = false
+            if let previous = entry.previous, time > previous.time {
+                let rate = (value - previous.value) / (time - previous.time)
+                entry.active = limit >= 0 ? rate >= limit : rate <= limit
+            }
+            entry.previous = (value, time)
+        case .anomaly(let alpha, let deviations):
+            // the value is compared with the mean before it is added, after a warm up of 1/alpha samples
+            entry.active = entry.samples >= Int((1 / alpha).rounded()) && abs(value - entry.mean) > deviations * entry.variance.squareRoot()
+            if entry.samples == 0 {
+                entry.mean = value
+            } else {
+                let diff = value - entry.mean
+                entry.mean += alpha * diff
+                entry.variance = (1 - alpha) * (entry.variance + alpha * diff * diff)
+            }
+            entry.samples += 1
+        }
+        return entry.active
+    }
+    
+    // the table of all conditions, the state of a condition which is still at the same place is kept
+    private func compile() {
+        var table: [Entry] = []
+        for r in 0..<self.rules.count {
+            let old = self.rules[r].range
+            let start = table.count
+            for (n, condition) in self.rules[r].rule.conditions.enumerated() {
+                var entry = Entry(slot: condition.slot, predicate: condition.predicate)
+                let i = old.lowerBound + n
+                if old.contains(i), self.table[i].slot == condition.slot {
+                    let last = self.table[i]
+                    entry.active = last.active
+                    entry.previous = last.previous
+                    entry.mean = last.mean
+                    entry.variance = last.variance
+                    entry.samples = last.samples
+                }
+                table.append(entry)
+            }
+            self.rules[r].range = start..<table.count
+        }
+        self.table = table
+    }
+}
@@ -0,0 +1,294 @@
+//
+//  Prober.swift
+//  Kit
+//
+//  Created by Serhiy Mytrovtsiy on 19/10/2026.
+//  Using Swift 6.0.
+//  Running on macOS 26.5.
+//
+//  Copyright © 2026 Serhiy Mytrovtsiy. All rights reserved.
+//
+
+import Foundation
+
+// ICMP echo packets. The identifier is not checked on replies because the datagram sockets may
+// replace it, a reply is recognized by the token in the payload instead.
+public enum ICMPEcho {
+    public static let size: Int = 8 + 16
+    
+    public static func request(identifier: UInt16, sequence: UInt16, token: UInt64) -> [UInt8] {
+        var packet = [UInt8](repeating: 0, count: ICMPEcho.size)
+        packet[0] = 8
+        packet[4] = UInt8(identifier >> 8)
+        packet[5] = UInt8(identifier & 0xFF)
+        packet[6] = UInt8(sequence >> 8)
+        packet[7] = UInt8(sequence & 0xFF)
+        for i in 0..<8 {
+            packet[8 + i] = UInt8((token >> (8 * i)) & 0xFF)
+        }
+        let checksum = packet.withUnsafeBytes{ ICMPEcho.checksum($0) }
+        packet[2] = UInt8(checksum >> 8)
+        packet[3] = UInt8(checksum & 0xFF)
+        return packet
+    }
+    
+    // the sequence of an echo reply with the token, an IPv4 header in front of it is skipped
+    public static func reply(_ packet: UnsafeRawBufferPointer, token: UInt64) -> UInt16? {
+        var offset = 0
+        if packet.count >= 20 && packet[0] & 0xF0 == 0x40 {
+            offset = Int(packet[0] & 0x0F) * 4
+            guard Int32(packet[9]) == IPPROTO_ICMP else { return nil }
+        }
+        guard packet.count - offset >= ICMPEcho.size, packet[offset] == 0, packet[offset + 1] == 0 else { return nil }
+        let icmp = UnsafeRawBufferPointer(rebasing: packet[offset..<packet.count])
+        guard ICMPEcho.checksum(icmp) == 0 else { return nil }
+        
+        var value: UInt64 = 0
+        for i in 0..<8 {
+            value |= UInt64(icmp[8 + i]) << (8 * i)
+        }
+        guard value == token else { return nil }
+        return UInt16(icmp[6]) << 8 | UInt16(icmp[7])
+    }
+    
+    // internet checksum (RFC 1071), zero for a packet with a valid checksum
+    public static func checksum(_ bytes: UnsafeRawBufferPointer) -> UInt16 {
+        var sum: UInt32 = 0
+        var i = 0
+        while i + 1 < bytes.count {
+            sum += UInt32(bytes[i]) << 8 | UInt32(bytes[i + 1])
+            i += 2
+        }
+        if i < bytes.count {
+            sum += UInt32(bytes[i]) << 8
+        }
+        while sum >> 16 != 0 {
+            sum = (sum & 0xFFFF) + (sum >> 16)
+        }
+        return ~UInt16(sum)
+    }
+}
+
+// Round trip times of the last probes. The samples are counted in logarithmic buckets (eight per
+// doubling, about 9% wide), so the percentiles are read from the counts without sorting. A lost
+// probe takes a place in the window without a bucket.
+public final class LatencyHistogram {
+    public static let minimum: Double = 0.05
+    private static let bucketsPerDoubling: Double = 8
+    private static let count: Int = 160
+    
+    public let window: Int
+    
+    private var samples: [Double] = []
+    private var head: Int = 0
+    private var buckets: [Int]
+    private var received: Int = 0
+    
+    public init(window: Int = 120) {
+        self.window = max(window, 1)
+        self.buckets = [Int](repeating: 0, count: LatencyHistogram.count)
+        self.samples.reserveCapacity(self.window)
+    }
+    
+    public var total: Int {
+        self.samples.count
+    }
+    
+    public var loss: Double {
+        self.samples.isEmpty ? 0 : Double(self.samples.count - self.received) / Double(self.samples.count)
+    }
+    
+    // rtt in milliseconds, nil for a lost probe
+    public func add(_ rtt: Double?) {
+        let value = rtt ?? .nan
+        if self.samples.count < self.window {
+            self.samples.append(value)
+        } else {
+            self.remove(self.samples[self.head])
+            self.samples[self.head] = value
+            self.head = (self.head + 1) % self.window
+        }
+        if !value.isNaN {
+            self.buckets[LatencyHistogram.bucket(value)] += 1
+            self.received += 1
+        }
+    }
+    
+    // value of the p quantile (0...1) of the received probes
+    public func percentile(_ p: Double) -> Double? {
+        guard self.received > 0 else { return nil }
+        let rank = max(1, Int((p * Double(self.received)).rounded(.up)))
+        var seen = 0
+        for (i, count) in self.buckets.enumerated() {
+            seen += count
+            if seen >= rank {
+                return LatencyHistogram.value(i)
+            }
+        }
+        return nil
+    }
+    
+    public func removeAll() {
+        self.samples.removeAll(keepingCapacity: true)
+        self.head = 0
+        self.received = 0
+        self.buckets = [Int](repeating: 0, count: LatencyHistogram.count)
+    }
+    
+    private func remove(_ value: Double) {
+        guard !value.isNaN else { return }
+        self.buckets[LatencyHistogram.bucket(value)] -= 1
+        self.received -= 1
+    }
+    
+    private static func bucket(_ value: Double) -> Int {
+        guard value > LatencyHistogram.minimum else { return 0 }
+        let i = Int(log2(value / LatencyHistogram.minimum) * LatencyHistogram.bucketsPerDoubling)
+        return min(i, LatencyHistogram.count - 1)
+    }
+    
+    // geometric middle of the bucket
+    private static func value(_ bucket: Int) -> Double {
+        LatencyHistogram.minimum * pow(2, (Double(bucket) + 0.5) / LatencyHistogram.bucketsPerDoubling)
+    }
+}
+
+public struct ProbeSummary: Equatable {
+    // nil until the first probe of the target finished
+    public var reachable: Bool? = nil
+    public var latency: Double? = nil
+    public var jitter: Double? = nil
+    public var p50: Double? = nil
+    public var p95: Double? = nil
+    public var p99: Double? = nil
+    public var loss: Double = 0
+    
+    public init() {}
+}
+
+// State of the probes of several targets. Every probe gets a sequence number, the pending probes are
+// kept in a ring indexed by it, so a reply is matched in constant time. A probe without a reply
+// within the timeout is lost and makes its target unreachable, a reply makes it reachable again.
+public final class ConnectivityProber {
+    private struct Pending {
+        var sequence: UInt16
+        var target: Int
+        var time: TimeInterval
+        var active: Bool
+    }
+    
+    private struct Target {
+        var summary = ProbeSummary()
+        var previous: Double? = nil
+        let histogram: LatencyHistogram
+    }
+    
+    public let timeout: TimeInterval
+    public private(set) var targets: [String] = []
+    
+    private var states: [Target] = []
+    private var pending: [Pending]
+    private var inFlight: Int = 0
+    private var sequence: UInt16 = 0
+    private let window: Int
+    
+    public init(targets: [String], window: Int = 120, timeout: TimeInterval = 5, capacity: Int = 1024) {
+        self.timeout = timeout
+        self.window = window
+        self.pending = [Pending](repeating: Pending(sequence: 0, target: 0, time: 0, active: false), count: max(capacity, 1))
+        self.set(targets)
+    }
+    
+    public var count: Int {
+        self.targets.count
+    }
+    
+    // reachable when any target answered its last probe
+    public var reachable: Bool? {
+        let list = self.states.compactMap{ $0.summary.reachable }
+        return list.isEmpty ? nil : list.contains(true)
+    }
+    
+    public func set(_ targets: [String]) {
+        guard targets != self.targets else { return }
+        self.targets = targets
+        self.states = targets.map{ _ in Target(histogram: LatencyHistogram(window: self.window)) }
+        for i in self.pending.indices {
+            self.pending[i].active = false
+        }
+        self.inFlight = 0
+    }
+    
+    public func summary(_ target: Int) -> ProbeSummary {
+        self.states.indices.contains(target) ? self.states[target].summary : ProbeSummary()
+    }
+    
+    // registers a probe sent to the target, returns its sequence number
+    public func sent(_ target: Int, time: TimeInterval) -> UInt16 {
+        self.sequence &+= 1
+        let slot = Int(self.sequence) % self.pending.count
+        if self.pending[slot].active {
+            // the ring is full, the oldest probe is counted as lost
+            self.finish(slot, rtt: nil)
+        }
+        self.pending[slot] = Pending(sequence: self.sequence, target: target, time: time, active: true)
+        self.inFlight += 1
+        return self.sequence
+    }
+    
+    // a reply to the probe, returns its target when the probe was pending
+    @discardableResult
+    public func received(_ sequence: UInt16, time: TimeInterval) -> Int? {
+        let slot = Int(sequence) % self.pending.count
+        let probe = self.pending[slot]
+        guard probe.active, probe.sequence == sequence else { return nil }
+        self.finish(slot, rtt: max(0, time - probe.time) * 1_000)
+        return probe.target
+    }
+    
+    // a probe which could not be sent or was answered with an error
+    public func failed(_ sequence: UInt16) {
+        let slot = Int(sequence) % self.pending.count
+        guard self.pending[slot].active, self.pending[slot].sequence == sequence else { return }
+        self.finish(slot, rtt: nil)
+    }
+    
+    // counts the probes older than the timeout as lost
+    public func expire(_ time: TimeInterval) {
+        guard self.inFlight > 0 else { return }
+        for slot in self.pending.indices where self.pending[slot].active && time - self.pending[slot].time >= self.timeout {
+            self.finish(slot, rtt: nil)
+        }
+    }
+    
+    // delay of a probe within the tick (up to jitter of the interval), so the probes of the targets
+    // do not leave at the same moment and do not follow the same phase every tick
+    public static func offset(_ interval: TimeInterval, jitter: Double = 0.2, random: Double = Double.random(in: 0...1)) -> TimeInterval {
+        max(0, interval * jitter * min(max(random, 0), 1))
+    }
+    
+    private func finish(_ slot: Int, rtt: Double?) {
+        let probe = self.pending[slot]
+        self.pending[slot].active = false
+        self.inFlight -= 1
+        guard self.states.indices.contains(probe.target) else { return }
+        
+        var state = self.states[probe.target]
+        state.histogram.add(rtt)
+        state.summary.reachable = rtt != nil
+        if let rtt {
+            state.summary.latency = rtt
+            if let previous = state.previous {
+                let d = abs(rtt - previous)
+                let jitter = state.summary.jitter ?? d
+                state.summary.jitter = jitter + (d - jitter) / 16
+            }
+            state.previous = rtt
+        }
+        state.summary.p50 = state.histogram.percentile(0.5)
+        state.summary.p95 = state.histogram.percentile(0.95)
+        state.summary.p99 = state.histogram.percentile(0.99)
+        state.summary.loss = state.histogram.loss
+        self.states[probe.target] = state
+    }
+}
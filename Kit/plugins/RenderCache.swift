@@ -0,0 +1,199 @@
+//
+//  RenderCache.swift
+//  Kit
+//
+//  Created by Serhiy Mytrovtsiy on 18/10/2026.
+//  Using Swift 6.0.
+//  Running on macOS 26.5.
+//
+//  Copyright © 2026 Serhiy Mytrovtsiy. All rights reserved.
+//
+
+import Foundation
+
+// Fixed-size cache with least recently used eviction. Entries live in a preallocated array linked
+// as a list, so get and set are O(1) and do not allocate once the cache is full.
+public final class LRUCache<Key: Hashable, Value> {
+    private struct Entry {
+        let key: Key
+        var value: Value
+        var prev: Int
+        var next: Int
+    }
+    
+    public let capacity: Int
+    
+    private let lock = NSLock()
+    private var entries: [Entry] = []
+    private var index: [Key: Int] = [:]
+    private var head: Int = -1 // most recently used
+    private var tail: Int = -1 // least recently used
+    
+    public init(capacity: Int) {
+        self.capacity = max(capacity, 1)
+        self.entries.reserveCapacity(self.capacity)
+        self.index.reserveCapacity(self.capacity)
+    }
+    
+    public var count: Int {
+        self.lock.lock()
+        defer { self.lock.unlock() }
+        return self.entries.count
+    }
+    
+    public func get(_ key: Key) -> Value? {
+        self.lock.lock()
+        defer { self.lock.unlock() }
+        guard let i = self.index[key] else { return nil }
+        self.touch(i)
+        return self.entries[i].value
+    }
+    
+    public func set(_ key: Key, _ value: Value) {
+        self.lock.lock()
+        defer { self.lock.unlock() }
+        
+        if let i = self.index[key] {
+            self.entries[i].value = value
+            self.touch(i)
+            return
+        }
+        
+        if self.entries.count < self.capacity {
+            self.entries.append(Entry(key: key, value: value, prev: -1, next: -1))
+            let i = self.entries.count - 1
+            self.index[key] = i
+            self.link(i)
+            return
+        }
+        
+        // reuse the least recently used slot
+        let i = self.tail
+        self.unlink(i)
+        self.index[self.entries[i].key] = nil
+        self.entries[i] = Entry(key: key, value: value, prev: -1, next: -1)
+        self.index[key] = i
+        self.link(i)
+    }
+    
+    public func value(_ key: Key, _ make: () -> Value) -> Value {
+        if let value = self.get(key) {
+            return value
+        }
+        let value = make()
+        self.set(key, value)
+        return value
+    }
+    
+    public func removeAll() {
+        self.lock.lock()
+        defer { self.lock.unlock() }
+        self.entries.removeAll(keepingCapacity: true)
+        self.index.removeAll(keepingCapacity: true)
+        self.head = -1
+        self.tail = -1
+    }
+    
+    private func touch(_ i: Int) {
+        guard self.head != i else { return }
+        self.unlink(i)
+        self.link(i)
+    }
+    
+    private func link(_ i: Int) {
+        self.entries[i].prev = -1
+        self.entries[i].next = self.head
+        if self.head >= 0 {
+            self.entries[self.head].prev = i
+        }
+        self.head = i
+        if self.tail < 0 {
+            self.tail = i
+        }
+    }
+    
+    private func unlink(_ i: Int) {
+        let prev = self.entries[i].prev, next = self.entries[i].next
+        if prev >= 0 {
+            self.entries[prev].next = next
+        } else {
+            self.head = next
+        }
+        if next >= 0 {
+            self.entries[next].prev = prev
+        } else {
+            self.tail = prev
+        }
+    }
+}
+
+// Number of redraws in the last minute, counted in one second buckets.
+public struct RedrawCounter {
+    private var counts: [Int] = Array(repeating: 0, count: 60)
+    private var seconds: [Int] = Array(repeating: -1, count: 60)
+    
+    public init() {}
+    
+    public mutating func record(_ time: TimeInterval = ProcessInfo.processInfo.systemUptime) {
+        let second = Int(max(time, 0))
+        let i = second % 60
+        if self.seconds[i] != second {
+            self.seconds[i] = second
+            self.counts[i] = 0
+        }
+        self.counts[i] += 1
+    }
+    
+    public func perMinute(_ time: TimeInterval = ProcessInfo.processInfo.systemUptime) -> Int {
+        let second = Int(max(time, 0))
+        var total = 0
+        for i in 0..<60 where self.seconds[i] > second - 60 && self.seconds[i] <= second {
+            total += self.counts[i]
+        }
+        return total
+    }
+}
+
+// Keeps what every region of a widget shows (the formatted string, the quantized value, the color state)
+// and reports which regions must be redrawn after an update. Regions with an unchanged signature are skipped.
+public final class WidgetRenderCache {
+    private var signatures: [Int: AnyHashable] = [:]
+    private var counter: RedrawCounter = RedrawCounter()
+    private let lock = NSLock()
+    
+    public init() {}
+    
+    public var redrawsPerMinute: Int {
+        self.lock.lock()
+        defer { self.lock.unlock() }
+        return self.counter.perMinute()
+    }
+    
+    public static func quantize(_ value: Double, step: Double) -> Int {
+        guard value.isFinite, step > 0 else { return 0 }
+        return Int((value / step).rounded())
+    }
+    
+    // returns the union of the regions which changed, nil when nothing to redraw
+    public func update(_ regions: [(id: Int, signature: AnyHashable, rect: CGRect)]) -> CGRect? {
+        self.lock.lock()
+        defer { self.lock.unlock() }
+        
+        var dirty: CGRect? = nil
+        for region in regions where self.signatures[region.id] != region.signature {
+            self.signatures[region.id] = region.signature
+            dirty = dirty.map{ $0.union(region.rect) } ?? region.rect
+        }
+        return dirty
+    }
+    
+    public func update(_ id: Int, _ signature: AnyHashable, rect: CGRect) -> CGRect? {
+        self.update([(id, signature, rect)])
+    }
+    
+    public func drawn(_ time: TimeInterval = ProcessInfo.processInfo.systemUptime) {
+        self.lock.lock()
+        defer { self.lock.unlock() }
+        self.counter.record(time)
+    }
+}
@@ -0,0 +1,182 @@
+//
+//  SMART.swift
+//  Kit
+//
+//  Created by Serhiy Mytrovtsiy on 19/10/2026.
+//  Using Swift 6.0.
+//  Running on macOS 26.5.
+//
+//  Copyright © 2026 Serhiy Mytrovtsiy. All rights reserved.
+//
+
+import Foundation
+
+public struct SMARTValues: Equatable {
+    public var temperature: Int = 0
+    public var life: Int = 0
+    public var totalRead: Int64 = 0
+    public var totalWritten: Int64 = 0
+    public var powerCycles: Int = 0
+    public var powerOnHours: Int = 0
+    public var criticalWarning: Int? = nil
+    public var availableSpare: Int? = nil
+    public var spareThreshold: Int? = nil
+    public var unsafeShutdowns: Int? = nil
+    public var mediaErrors: Int64? = nil
+    
+    public init() {}
+}
+
+// Decoders of the raw SMART pages. They only read bytes, so the IOKit plug-ins stay in the reader
+// and the decoding can be checked against captured pages.
+public enum SMARTLog {
+    // the NVMe SMART / Health Information log page (log identifier 02h)
+    public static func nvme(_ page: UnsafeRawBufferPointer) -> SMARTValues? {
+        guard page.count >= 176 else { return nil }
+        let bytesPerDataUnit: Int64 = 512 * 1000
+        
+        var values = SMARTValues()
+        let kelvin = Int(SMARTLog.integer(page, 1, bytes: 2))
+        values.temperature = kelvin == 0 ? 0 : kelvin - 273
+        values.life = max(0, 100 - Int(page[5]))
+        values.totalRead = SMARTLog.multiply(SMARTLog.uint128(page, 32), bytesPerDataUnit)
+        values.totalWritten = SMARTLog.multiply(SMARTLog.uint128(page, 48), bytesPerDataUnit)
+        values.powerCycles = Int(SMARTLog.uint128(page, 112))
+        values.powerOnHours = Int(SMARTLog.uint128(page, 128))
+        values.criticalWarning = Int(page[0])
+        values.availableSpare = Int(page[3])
+        values.spareThreshold = Int(page[4])
+        values.unsafeShutdowns = Int(SMARTLog.uint128(page, 144))
+        values.mediaErrors = SMARTLog.uint128(page, 160)
+        return values
+    }
+    
+    // the ATA SMART READ DATA page and optionally the Device Statistics log (log address 04h, pages 0-7).
+    // The lifetime totals from the statistics are returned separately, a device does not always report them.
+    public static func ata(_ data: UnsafeRawBufferPointer, statistics: UnsafeRawBufferPointer? = nil) -> (values: SMARTValues, read: Int64?, written: Int64?)? {
+        guard data.count >= 2 + 30 * 12 else { return nil }
+        let bytesPerLBA: Int64 = 512
+        
+        var attributes: [Int: (current: Int, offset: Int)] = [:]
+        for i in 0..<30 {
+            let offset = 2 + i * 12
+            let id = Int(data[offset])
+            if id == 0 { continue }
+            attributes[id] = (Int(data[offset + 3]), offset + 5)
+        }
+        func raw(_ id: Int, bytes: Int = 6) -> UInt64? {
+            guard let attribute = attributes[id] else { return nil }
+            return SMARTLog.integer(data, attribute.offset, bytes: bytes)
+        }
+        
+        var values = SMARTValues()
+        values.temperature = Int(raw(194, bytes: 1) ?? raw(190, bytes: 1) ?? 0)
+        values.life = 100
+        for id in [231, 202, 177, 173, 169, 233] {
+            if let attribute = attributes[id] {
+                values.life = min(max(attribute.current, 0), 100)
+                break
+            }
+        }
+        values.powerCycles = Int(raw(12, bytes: 4) ?? 0)
+        values.powerOnHours = Int(raw(9, bytes: 4) ?? 0)
+        values.unsafeShutdowns = raw(174, bytes: 4).map{ Int($0) }
+        let errors = [raw(5), raw(197), raw(198)].compactMap{ $0 }
+        values.mediaErrors = errors.isEmpty ? nil : Int64(errors.reduce(0, +))
+        values.totalRead = SMARTLog.multiply(Int64(raw(242) ?? 0), bytesPerLBA)
+        values.totalWritten = SMARTLog.multiply(Int64(raw(241) ?? 0), bytesPerLBA)
+        
+        var read: Int64? = nil
+        var written: Int64? = nil
+        if let statistics {
+            // a statistic is valid only with the supported (63) and valid (62) bits set
+            func statistic(page: Int, offset: Int) -> UInt64? {
+                let base = page * 512 + offset
+                guard base + 8 <= statistics.count else { return nil }
+                let value = SMARTLog.integer(statistics, base, bytes: 8)
+                guard value & (1 << 63) != 0, value & (1 << 62) != 0 else { return nil }
+                return value & 0x0000_FFFF_FFFF_FFFF
+            }
+            written = statistic(page: 1, offset: 0x18).flatMap{ Int64($0).multipliedReportingOverflow(by: bytesPerLBA) }.flatMap{ $0.overflow ? nil : $0.partialValue }
+            read = statistic(page: 1, offset: 0x28).flatMap{ Int64($0).multipliedReportingOverflow(by: bytesPerLBA) }.flatMap{ $0.overflow ? nil : $0.partialValue }
+            if let used = statistic(page: 7, offset: 0x08) {
+                values.life = max(0, 100 - Int(used & 0xFF))
+            }
+        }
+        values.totalRead = read ?? values.totalRead
+        values.totalWritten = written ?? values.totalWritten
+        
+        return (values, read, written)
+    }
+    
+    // 128-bit little endian counter, saturated to Int64
+    public static func uint128(_ buffer: UnsafeRawBufferPointer, _ offset: Int) -> Int64 {
+        guard offset + 16 <= buffer.count else { return 0 }
+        let low = SMARTLog.integer(buffer, offset, bytes: 8)
+        let high = SMARTLog.integer(buffer, offset + 8, bytes: 8)
+        if high != 0 || low > UInt64(Int64.max) {
+            return Int64.max
+        }
+        return Int64(low)
+    }
+    
+    private static func integer(_ buffer: UnsafeRawBufferPointer, _ offset: Int, bytes: Int) -> UInt64 {
+        var value: UInt64 = 0
+        for i in 0..<min(bytes, max(0, buffer.count - offset)) {
+            value |= UInt64(buffer[offset + i]) << (8 * i)
+        }
+        return value
+    }
+    
+    private static func multiply(_ value: Int64, _ by: Int64) -> Int64 {
+        let (result, overflow) = value.multipliedReportingOverflow(by: by)
+        return overflow ? Int64.max : result
+    }
+}
+
+// SMART values change within hours, so they are read in the background and the reader takes the
+// cached value. An expired value is still returned while its refresh is running (stale while
+// revalidate), and a failed read is cached too, so a drive without SMART is not asked every tick.
+public final class SMARTCache<Value> {
+    public let ttl: TimeInterval
+    
+    private let lock = NSLock()
+    private var entries: [String: (value: Value?, time: TimeInterval)] = [:]
+    private var refreshing: Set<String> = []
+    
+    public init(ttl: TimeInterval = 600) {
+        self.ttl = ttl
+    }
+    
+    // the cached value and whether the caller must start a refresh, which is then marked as running
+    public func get(_ key: String, now: TimeInterval = CFAbsoluteTimeGetCurrent()) -> (value: Value?, refresh: Bool) {
+        self.lock.lock()
+        defer { self.lock.unlock() }
+        let entry = self.entries[key]
+        guard !self.refreshing.contains(key), entry.map({ now - $0.time >= self.ttl }) ?? true else {
+            return (entry?.value, false)
+        }
+        self.refreshing.insert(key)
+        return (entry?.value, true)
+    }
+    
+    public func set(_ key: String, _ value: Value?, now: TimeInterval = CFAbsoluteTimeGetCurrent()) {
+        self.lock.lock()
+        defer { self.lock.unlock() }
+        self.refreshing.remove(key)
+        // a failed refresh keeps the last known value
+        self.entries[key] = (value ?? self.entries[key]?.value, now)
+    }
+    
+    public func remove(_ key: String) {
+        self.lock.lock()
+        defer { self.lock.unlock() }
+        self.entries.removeValue(forKey: key)
+    }
+    
+    public func removeAll() {
+        self.lock.lock()
+        defer { self.lock.unlock() }
+        self.entries.removeAll()
+    }
+}
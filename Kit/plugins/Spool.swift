@@ -0,0 +1,428 @@
+//
+//  Spool.swift
+//  Kit
+//
+//  Created by Serhiy Mytrovtsiy on 18/10/2026.
+//  Using Swift 6.0.
+//  Running on macOS 26.5.
+//
+//  Copyright © 2026 Serhiy Mytrovtsiy. All rights reserved.
+//
+
+import Foundation
+
+public struct MetricsSpoolStatus: Codable, Equatable {
+    public let records: Int
+    public let bytes: Int
+    public let dropped: Int
+    // age of the oldest record waiting for the replay
+    public let lag: TimeInterval?
+}
+
+// Bounded on-disk queue of the messages which could not be published. Records are appended to
+// segment files, the read position is kept in a cursor file, so a restart continues where the
+// replay stopped. The cursor is written at most once per cursorInterval and on flush, after a
+// crash the records removed since the last write are sent again. When the limit is reached the
+// oldest segment is removed (or new records are rejected with the dropNewest policy).
+//
+// Record: u32 length of the rest, u64 time in ms, u16 topic length, topic, payload (little endian).
+public final class MetricsSpool {
+    public enum Policy: String {
+        case dropOldest
+        case dropNewest
+    }
+    
+    public struct Record: Equatable {
+        public let topic: String
+        public let payload: Data
+        public let time: Date
+        
+        public init(topic: String, payload: Data, time: Date) {
+            self.topic = topic
+            self.payload = payload
+            self.time = time
+        }
+    }
+    
+    private struct Segment {
+        let id: Int
+        var size: Int
+        var records: Int
+    }
+    
+    public let directory: URL
+    public let segmentSize: Int
+    public let maxBytes: Int
+    public let policy: Policy
+    public let cursorInterval: TimeInterval
+    
+    private let lock = NSLock()
+    private var segments: [Segment] = []
+    private var writer: FileHandle? = nil
+    // position in the first segment
+    private var offset: Int = 0
+    private var consumed: Int = 0
+    private var cache: (id: Int, data: Data)? = nil
+    private var dropped: Int = 0
+    private var evicted: Int = 0
+    private var cursorSaved: TimeInterval = 0
+    private var cursorDirty: Bool = false
+    
+    public init?(directory: URL, segmentSize: Int = 256 * 1024, maxBytes: Int = 16 * 1024 * 1024, policy: Policy = .dropOldest, cursorInterval: TimeInterval = 1) {
+        self.directory = directory
+        self.segmentSize = max(segmentSize, 1024)
+        self.maxBytes = max(maxBytes, self.segmentSize * 2)
+        self.policy = policy
+        self.cursorInterval = max(cursorInterval, 0)
+        
+        do {
+            try FileManager.default.createDirectory(at: directory, withIntermediateDirectories: true, attributes: nil)
+        } catch {
+            return nil
+        }
+        self.load()
+    }
+    
+    deinit {
+        if self.cursorDirty {
+            self.saveCursorLocked()
+        }
+        try? self.writer?.close()
+    }
+    
+    public var isEmpty: Bool {
+        self.lock.lock()
+        defer { self.lock.unlock() }
+        return self.pendingLocked() == 0
+    }
+    
+    // number of times the limit removed the oldest segment, the read position moved to the next one
+    public var evictions: Int {
+        self.lock.lock()
+        defer { self.lock.unlock() }
+        return self.evicted
+    }
+    
+    public func status(_ now: Date = Date()) -> MetricsSpoolStatus {
+        self.lock.lock()
+        defer { self.lock.unlock() }
+        let bytes = self.segments.reduce(0) { $0 + $1.size } - self.offset
+        let lag = self.readLocked(1).first.map{ now.timeIntervalSince($0.time) }
+        return MetricsSpoolStatus(records: self.pendingLocked(), bytes: bytes, dropped: self.dropped, lag: lag)
+    }
+    
+    @discardableResult
+    public func append(_ record: Record) -> Bool {
+        let topic = Array(record.topic.utf8.prefix(Int(UInt16.max)))
+        let length = 8 + 2 + topic.count + record.payload.count
+        
+        var data = Data(capacity: 4 + length)
+        MetricsSpool.put(UInt32(length), &data)
+        MetricsSpool.put(UInt64(max(0, record.time.timeIntervalSince1970 * 1_000).rounded()), &data)
+        MetricsSpool.put(UInt16(topic.count), &data)
+        data.append(contentsOf: topic)
+        data.append(record.payload)
+        
+        self.lock.lock()
+        defer { self.lock.unlock() }
+        
+        let total = self.segments.reduce(0) { $0 + $1.size } - self.offset
+        if self.policy == .dropNewest && total + data.count > self.maxBytes {
+            self.dropped += 1
+            return false
+        }
+        
+        if self.writer == nil || (self.segments.last?.size ?? 0) + data.count > self.segmentSize {
+            self.openSegmentLocked()
+        }
+        guard let writer = self.writer, !self.segments.isEmpty else { return false }
+        do {
+            try writer.write(contentsOf: data)
+        } catch {
+            return false
+        }
+        self.segments[self.segments.count - 1].size += data.count
+        self.segments[self.segments.count - 1].records += 1
+        // the replay reads the segment which is written, the cached copy is extended instead of read again
+        if self.cache?.id == self.segments.last?.id {
+            self.cache?.data.append(data)
+        }
+        
+        while self.policy == .dropOldest && self.segments.count > 1 && self.segments.reduce(0, { $0 + $1.size }) > self.maxBytes {
+            self.dropped += self.segments[0].records - self.consumed
+            self.evicted += 1
+            self.removeFirstLocked()
+        }
+        
+        return true
+    }
+    
+    // the oldest records without removing them, skipping the first ones (which are already sent)
+    public func peek(_ count: Int, from skip: Int = 0) -> [Record] {
+        self.lock.lock()
+        defer { self.lock.unlock() }
+        return self.readLocked(count, skip: skip)
+    }
+    
+    // removes the oldest records, called after their delivery was confirmed
+    public func remove(_ count: Int, now: TimeInterval = ProcessInfo.processInfo.systemUptime) {
+        self.lock.lock()
+        defer { self.lock.unlock() }
+        
+        var left = count
+        while left > 0, let first = self.segments.first {
+            guard let data = self.segmentLocked(first.id), self.offset + 4 <= data.count else {
+                self.removeFirstLocked()
+                continue
+            }
+            let length = Int(MetricsSpool.get(UInt32.self, data, self.offset))
+            self.offset += 4 + length
+            self.consumed += 1
+            left -= 1
+            
+            if self.offset >= first.size && self.segments.count > 1 {
+                self.removeFirstLocked()
+            }
+        }
+        
+        if self.pendingLocked() == 0 {
+            self.clearLocked()
+        }
+        self.cursorDirty = true
+        if now - self.cursorSaved >= self.cursorInterval {
+            self.saveCursorLocked()
+            self.cursorSaved = now
+        }
+    }
+    
+    // writes the cursor if it changed since the last write
+    public func flush() {
+        self.lock.lock()
+        defer { self.lock.unlock() }
+        if self.cursorDirty {
+            self.saveCursorLocked()
+        }
+    }
+    
+    public func removeAll() {
+        self.lock.lock()
+        defer { self.lock.unlock() }
+        self.clearLocked()
+        self.dropped = 0
+        self.saveCursorLocked()
+    }
+    
+    // MARK: - helpers
+    
+    private var cursorURL: URL {
+        self.directory.appendingPathComponent("cursor")
+    }
+    
+    private func url(_ id: Int) -> URL {
+        self.directory.appendingPathComponent(String(format: "%010d.spool", id))
+    }
+    
+    private func load() {
+        let files = (try? FileManager.default.contentsOfDirectory(at: self.directory, includingPropertiesForKeys: nil)) ?? []
+        let ids = files.filter{ $0.pathExtension == "spool" }.compactMap{ Int($0.deletingPathExtension().lastPathComponent) }.sorted()
+        
+        for id in ids {
+            guard let data = try? Data(contentsOf: self.url(id)) else { continue }
+            var offset = 0, records = 0
+            while offset + 4 <= data.count {
+                let length = Int(MetricsSpool.get(UInt32.self, data, offset))
+                guard length >= 10, offset + 4 + length <= data.count else { break }
+                offset += 4 + length
+                records += 1
+            }
+            if offset < data.count, let handle = try? FileHandle(forWritingTo: self.url(id)) {
+                // a record cut by a crash
+                try? handle.truncate(atOffset: UInt64(offset))
+                try? handle.close()
+            }
+            if records == 0 {
+                try? FileManager.default.removeItem(at: self.url(id))
+                continue
+            }
+            self.segments.append(Segment(id: id, size: offset, records: records))
+        }
+        
+        if let data = try? Data(contentsOf: self.cursorURL), data.count == 16, let first = self.segments.first {
+            let id = Int(MetricsSpool.get(UInt64.self, data, 0))
+            let offset = Int(MetricsSpool.get(UInt64.self, data, 8))
+            if id == first.id && offset <= first.size, let segment = self.segmentLocked(id) {
+                var position = 0
+                while position < offset && position + 4 <= segment.count {
+                    position += 4 + Int(MetricsSpool.get(UInt32.self, segment, position))
+                    self.consumed += 1
+                }
+                self.offset = position
+            }
+        }
+    }
+    
+    private func pendingLocked() -> Int {
+        self.segments.reduce(0) { $0 + $1.records } - self.consumed
+    }
+    
+    private func readLocked(_ count: Int, skip: Int = 0) -> [Record] {
+        var list: [Record] = []
+        var skip = max(skip, 0)
+        var offset = self.offset
+        for segment in self.segments where list.count < count {
+            guard let data = self.segmentLocked(segment.id) else { break }
+            while list.count < count && offset + 4 <= data.count {
+                let length = Int(MetricsSpool.get(UInt32.self, data, offset))
+                guard length >= 10, offset + 4 + length <= data.count else { break }
+                if skip > 0 {
+                    skip -= 1
+                    offset += 4 + length
+                    continue
+                }
+                let time = MetricsSpool.get(UInt64.self, data, offset + 4)
+                let topicLength = Int(MetricsSpool.get(UInt16.self, data, offset + 12))
+                let start = data.startIndex + offset + 14
+                guard 10 + topicLength <= length else { break }
+                let topic = String(decoding: data[start..<start+topicLength], as: UTF8.self)
+                let payload = data.subdata(in: start+topicLength..<data.startIndex+offset+4+length)
+                list.append(Record(topic: topic, payload: payload, time: Date(timeIntervalSince1970: TimeInterval(time) / 1_000)))
+                offset += 4 + length
+            }
+            offset = 0
+        }
+        return list
+    }
+    
+    private func segmentLocked(_ id: Int) -> Data? {
+        if let cache = self.cache, cache.id == id {
+            return cache.data
+        }
+        guard let data = try? Data(contentsOf: self.url(id)) else { return nil }
+        self.cache = (id, data)
+        return data
+    }
+    
+    private func openSegmentLocked() {
+        try? self.writer?.close()
+        self.writer = nil
+        
+        let id = (self.segments.last?.id ?? 0) + 1
+        let url = self.url(id)
+        guard FileManager.default.createFile(atPath: url.path, contents: nil), let handle = try? FileHandle(forWritingTo: url) else { return }
+        self.writer = handle
+        self.segments.append(Segment(id: id, size: 0, records: 0))
+    }
+    
+    private func removeFirstLocked() {
+        guard let first = self.segments.first else { return }
+        if first.id == self.segments.last?.id {
+            try? self.writer?.close()
+            self.writer = nil
+        }
+        try? FileManager.default.removeItem(at: self.url(first.id))
+        self.segments.removeFirst()
+        if self.cache?.id == first.id {
+            self.cache = nil
+        }
+        self.offset = 0
+        self.consumed = 0
+    }
+    
+    private func clearLocked() {
+        while !self.segments.isEmpty {
+            self.removeFirstLocked()
+        }
+    }
+    
+    private func saveCursorLocked() {
+        var data = Data(capacity: 16)
+        MetricsSpool.put(UInt64(self.segments.first?.id ?? 0), &data)
+        MetricsSpool.put(UInt64(self.offset), &data)
+        try? data.write(to: self.cursorURL, options: .atomic)
+        self.cursorDirty = false
+    }
+    
+    private static func put<T: FixedWidthInteger>(_ value: T, _ data: inout Data) {
+        withUnsafeBytes(of: value.littleEndian) { data.append(contentsOf: $0) }
+    }
+    
+    private static func get<T: FixedWidthInteger>(_ type: T.Type, _ data: Data, _ offset: Int) -> T {
+        var value: T = 0
+        for i in 0..<MemoryLayout<T>.size {
+            value |= T(data[data.startIndex + offset + i]) << (8 * i)
+        }
+        return value
+    }
+}
+
+// Switches the publishing between live, offline and replay. While offline or replaying, new
+// messages are spooled behind the older ones, so the broker receives everything in order.
+// The replay is limited by a token bucket and by the number of sends waiting for completion.
+public struct MetricsReplay {
+    public enum State: String {
+        case live
+        case offline
+        case replaying
+    }
+    
+    public private(set) var state: State = .offline
+    public var rate: Double
+    public var burst: Int
+    public var window: Int
+    public private(set) var inFlight: Int = 0
+    
+    private var tokens: Double = 0
+    private var lastTime: TimeInterval? = nil
+    
+    public init(rate: Double = 50, burst: Int = 20, window: Int = 32) {
+        self.rate = max(rate, 0.1)
+        self.burst = max(burst, 1)
+        self.window = max(window, 1)
+    }
+    
+    public var spooling: Bool {
+        self.state != .live
+    }
+    
+    public mutating func connected(pending: Bool) {
+        self.state = pending ? .replaying : .live
+        self.tokens = Double(self.burst)
+        self.lastTime = nil
+    }
+    
+    public mutating func disconnected() {
+        self.state = .offline
+        self.inFlight = 0
+    }
+    
+    // number of records which can be sent now
+    public mutating func budget(_ time: TimeInterval) -> Int {
+        guard self.state == .replaying else { return 0 }
+        if let last = self.lastTime {
+            self.tokens = min(Double(self.burst), self.tokens + (time - last) * self.rate)
+        }
+        self.lastTime = time
+        return max(0, min(Int(self.tokens), self.window - self.inFlight))
+    }
+    
+    public mutating func sent(_ count: Int) {
+        self.tokens = max(0, self.tokens - Double(count))
+        self.inFlight += count
+    }
+    
+    public mutating func completed() {
+        self.inFlight = max(0, self.inFlight - 1)
+    }
+    
+    // the spool dropped the records which were in flight, the replay continues from its new head
+    public mutating func evicted() {
+        self.inFlight = 0
+    }
+    
+    // the spool is empty and no replayed message is waiting
+    public mutating func drained() {
+        if self.state == .replaying && self.inFlight == 0 {
+            self.state = .live
+        }
+    }
+}
@@ -0,0 +1,516 @@
+//
+//  StreamExtractor.swift
+//  Kit
+//
+//  Created by Serhiy Mytrovtsiy on 19/10/2026.
+//  Using Swift 6.0.
+//  Running on macOS 26.5.
+//
+//  Copyright © 2026 Serhiy Mytrovtsiy. All rights reserved.
+//
+
+import Foundation
+
+public enum StreamValue: Equatable {
+    case string(String)
+    case integer(Int)
+    case real(Double)
+    case bool(Bool)
+    case null
+    // a dictionary or an array at a declared path, its content is not taken
+    case container
+    
+    public var string: String? {
+        if case .string(let value) = self { return value }
+        return nil
+    }
+    public var int: Int? {
+        if case .integer(let value) = self { return value }
+        return nil
+    }
+    public var bool: Bool? {
+        if case .bool(let value) = self { return value }
+        return nil
+    }
+}
+
+public struct StreamMatch: Equatable {
+    // index of the declared path
+    public let path: Int
+    // the keys (or the indexes of the array elements) at the wildcards of the path
+    public let keys: [String]
+    public let value: StreamValue
+    
+    public init(path: Int, keys: [String], value: StreamValue) {
+        self.path = path
+        self.keys = keys
+        self.value = value
+    }
+}
+
+// Takes the values of the declared paths from a JSON or an XML property list document without
+// building the object tree. A path is a list of keys, an array element is its index and "*" matches
+// any key or element. The subtrees which no path goes through are skipped by scanning the bytes.
+// A value is reported for the first path which ends at it. Several concatenated plist documents are
+// read as an array, the document index is the first key.
+public final class StreamExtractor {
+    public static let wildcard: String = "*"
+    private static let maxDepth: Int = 128
+    
+    // at most 64 paths, the candidates at every level are kept in a bit mask
+    public let paths: [[String]]
+    private let all: UInt64
+    
+    public init(_ paths: [[String]]) {
+        let list = Array(paths.prefix(64))
+        self.paths = list
+        self.all = list.count == 64 ? UInt64.max : (1 << UInt64(list.count)) - 1
+    }
+    
+    // the matches in the document order, nil for a malformed document
+    public func json(_ bytes: UnsafeRawBufferPointer) -> [StreamMatch]? {
+        var i = 0
+        var stack: [String] = []
+        var out: [StreamMatch] = []
+        guard self.jsonValue(bytes, &i, &stack, &out, self.all) else { return nil }
+        StreamExtractor.skipSpace(bytes, &i)
+        return i == bytes.count ? out : nil
+    }
+    
+    public func plist(_ bytes: UnsafeRawBufferPointer) -> [StreamMatch]? {
+        var i = 0
+        var stack: [String] = []
+        var out: [StreamMatch] = []
+        var documents = 0
+        while let tag = StreamExtractor.tag(bytes, &i) {
+            guard tag.name == "plist", !tag.closing, !tag.empty else { continue }
+            guard let root = StreamExtractor.tag(bytes, &i), !root.closing else { return nil }
+            stack = [String(documents)]
+            let mask = self.narrow(self.all, 0, stack[0])
+            guard mask != 0 ? self.plistValue(bytes, &i, root, &stack, &out, mask) : StreamExtractor.skipElement(bytes, &i, root) else { return nil }
+            documents += 1
+        }
+        return out
+    }
+    
+    // MARK: - paths
+    
+    // the paths of the parent which go through the key at the depth
+    private func narrow(_ parent: UInt64, _ depth: Int, _ key: String) -> UInt64 {
+        var mask: UInt64 = 0
+        var rest = parent
+        while rest != 0 {
+            let index = rest.trailingZeroBitCount
+            rest &= rest - 1
+            let path = self.paths[index]
+            if path.count > depth && (path[depth] == StreamExtractor.wildcard || path[depth] == key) {
+                mask |= 1 << UInt64(index)
+            }
+        }
+        return mask
+    }
+    
+    // whether a path of the mask continues below the depth and which one ends at it
+    private func match(_ mask: UInt64, _ depth: Int) -> (continues: Bool, exact: Int?) {
+        var continues = false
+        var exact: Int? = nil
+        var rest = mask
+        while rest != 0 {
+            let index = rest.trailingZeroBitCount
+            rest &= rest - 1
+            if self.paths[index].count == depth {
+                exact = exact ?? index
+            } else {
+                continues = true
+            }
+        }
+        return (continues, exact)
+    }
+    
+    private func emit(_ path: Int, _ stack: [String], _ value: StreamValue, _ out: inout [StreamMatch]) {
+        let keys = zip(self.paths[path], stack).compactMap{ $0.0 == StreamExtractor.wildcard ? $0.1 : nil }
+        out.append(StreamMatch(path: path, keys: keys, value: value))
+    }
+    
+    // MARK: - JSON
+    
+    private func jsonValue(_ b: UnsafeRawBufferPointer, _ i: inout Int, _ stack: inout [String], _ out: inout [StreamMatch], _ mask: UInt64) -> Bool {
+        StreamExtractor.skipSpace(b, &i)
+        guard i < b.count, stack.count < StreamExtractor.maxDepth else { return false }
+        let match = self.match(mask, stack.count)
+        guard match.continues || match.exact != nil else {
+            return StreamExtractor.skipJSON(b, &i)
+        }
+        
+        switch b[i] {
+        case UInt8(ascii: "{"):
+            if let exact = match.exact {
+                self.emit(exact, stack, .container, &out)
+            }
+            guard match.continues else { return StreamExtractor.skipJSON(b, &i) }
+            i += 1
+            StreamExtractor.skipSpace(b, &i)
+            if i < b.count && b[i] == UInt8(ascii: "}") {
+                i += 1
+                return true
+            }
+            while true {
+                StreamExtractor.skipSpace(b, &i)
+                guard let key = StreamExtractor.jsonString(b, &i) else { return false }
+                StreamExtractor.skipSpace(b, &i)
+                guard i < b.count, b[i] == UInt8(ascii: ":") else { return false }
+                i += 1
+                guard self.jsonChild(b, &i, &stack, &out, mask, key) else { return false }
+                StreamExtractor.skipSpace(b, &i)
+                guard i < b.count else { return false }
+                i += 1
+                if b[i - 1] == UInt8(ascii: "}") { return true }
+                guard b[i - 1] == UInt8(ascii: ",") else { return false }
+            }
+        case UInt8(ascii: "["):
+            if let exact = match.exact {
+                self.emit(exact, stack, .container, &out)
+            }
+            guard match.continues else { return StreamExtractor.skipJSON(b, &i) }
+            i += 1
+            StreamExtractor.skipSpace(b, &i)
+            if i < b.count && b[i] == UInt8(ascii: "]") {
+                i += 1
+                return true
+            }
+            var index = 0
+            while true {
+                guard self.jsonChild(b, &i, &stack, &out, mask, String(index)) else { return false }
+                index += 1
+                StreamExtractor.skipSpace(b, &i)
+                guard i < b.count else { return false }
+                i += 1
+                if b[i - 1] == UInt8(ascii: "]") { return true }
+                guard b[i - 1] == UInt8(ascii: ",") else { return false }
+            }
+        case UInt8(ascii: "\""):
+            guard let exact = match.exact else { return StreamExtractor.skipJSON(b, &i) }
+            guard let value = StreamExtractor.jsonString(b, &i) else { return false }
+            self.emit(exact, stack, .string(value), &out)
+            return true
+        default:
+            let start = i
+            guard StreamExtractor.skipJSON(b, &i) else { return false }
+            guard let exact = match.exact else { return true }
+            let token = String(decoding: UnsafeRawBufferPointer(rebasing: b[start..<i]), as: UTF8.self)
+            let value: StreamValue
+            switch token {
+            case "true": value = .bool(true)
+            case "false": value = .bool(false)
+            case "null": value = .null
+            default:
+                if let number = Int(token) {
+                    value = .integer(number)
+                } else if let number = Double(token) {
+                    value = .real(number)
+                } else {
+                    return false
+                }
+            }
+            self.emit(exact, stack, value, &out)
+            return true
+        }
+    }
+    
+    private func jsonChild(_ b: UnsafeRawBufferPointer, _ i: inout Int, _ stack: inout [String], _ out: inout [StreamMatch], _ parent: UInt64, _ key: String) -> Bool {
+        let mask = self.narrow(parent, stack.count, key)
+        guard mask != 0 else {
+            StreamExtractor.skipSpace(b, &i)
+            return StreamExtractor.skipJSON(b, &i)
+        }
+        stack.append(key)
+        defer { stack.removeLast() }
+        return self.jsonValue(b, &i, &stack, &out, mask)
+    }
+    
+    private static func skipSpace(_ b: UnsafeRawBufferPointer, _ i: inout Int) {
+        while i < b.count && (b[i] == 0x20 || b[i] == 0x0A || b[i] == 0x0D || b[i] == 0x09) {
+            i += 1
+        }
+    }
+    
+    // skips the value at the index without decoding it
+    private static func skipJSON(_ b: UnsafeRawBufferPointer, _ i: inout Int) -> Bool {
+        guard i < b.count else { return false }
+        switch b[i] {
+        case UInt8(ascii: "\""):
+            return StreamExtractor.skipString(b, &i)
+        case UInt8(ascii: "{"), UInt8(ascii: "["):
+            var depth = 0
+            while i < b.count {
+                switch b[i] {
+                case UInt8(ascii: "\""):
+                    guard StreamExtractor.skipString(b, &i) else { return false }
+                    continue
+                case UInt8(ascii: "{"), UInt8(ascii: "["):
+                    depth += 1
+                case UInt8(ascii: "}"), UInt8(ascii: "]"):
+                    depth -= 1
+                    if depth == 0 {
+                        i += 1
+                        return true
+                    }
+                default: break
+                }
+                i += 1
+            }
+            return false
+        default:
+            let start = i
+            while i < b.count {
+                let c = b[i]
+                if c == UInt8(ascii: ",") || c == UInt8(ascii: "}") || c == UInt8(ascii: "]") || c == 0x20 || c == 0x0A || c == 0x0D || c == 0x09 {
+                    break
+                }
+                i += 1
+            }
+            return i > start
+        }
+    }
+    
+    private static func skipString(_ b: UnsafeRawBufferPointer, _ i: inout Int) -> Bool {
+        i += 1
+        while i < b.count {
+            if b[i] == UInt8(ascii: "\\") {
+                i += 2
+                continue
+            }
+            if b[i] == UInt8(ascii: "\"") {
+                i += 1
+                return true
+            }
+            i += 1
+        }
+        return false
+    }
+    
+    private static func jsonString(_ b: UnsafeRawBufferPointer, _ i: inout Int) -> String? {
+        guard i < b.count, b[i] == UInt8(ascii: "\"") else { return nil }
+        let start = i + 1
+        var j = start
+        while j < b.count && b[j] != UInt8(ascii: "\"") && b[j] != UInt8(ascii: "\\") {
+            j += 1
+        }
+        guard j < b.count else { return nil }
+        if b[j] == UInt8(ascii: "\"") {
+            i = j + 1
+            return String(decoding: UnsafeRawBufferPointer(rebasing: b[start..<j]), as: UTF8.self)
+        }
+        
+        // a string with escapes
+        var bytes: [UInt8] = Array(b[start..<j])
+        var pending: UInt32? = nil
+        while j < b.count {
+            let c = b[j]
+            if c == UInt8(ascii: "\"") {
+                i = j + 1
+                return String(decoding: bytes, as: UTF8.self)
+            }
+            guard c == UInt8(ascii: "\\") else {
+                bytes.append(c)
+                j += 1
+                continue
+            }
+            guard j + 1 < b.count else { return nil }
+            let e = b[j + 1]
+            j += 2
+            switch e {
+            case UInt8(ascii: "b"): bytes.append(0x08)
+            case UInt8(ascii: "f"): bytes.append(0x0C)
+            case UInt8(ascii: "n"): bytes.append(0x0A)
+            case UInt8(ascii: "r"): bytes.append(0x0D)
+            case UInt8(ascii: "t"): bytes.append(0x09)
+            case UInt8(ascii: "u"):
+                guard j + 4 <= b.count, let code = UInt32(String(decoding: UnsafeRawBufferPointer(rebasing: b[j..<(j + 4)]), as: UTF8.self), radix: 16) else { return nil }
+                j += 4
+                var scalar: UInt32 = code
+                if (0xD800..<0xDC00).contains(code) {
+                    pending = code
+                    continue
+                } else if (0xDC00..<0xE000).contains(code), let high = pending {
+                    scalar = 0x10000 + ((high - 0xD800) << 10) + (code - 0xDC00)
+                }
+                pending = nil
+                bytes.append(contentsOf: Array(String(Unicode.Scalar(scalar).map{ Character($0) } ?? "\u{FFFD}").utf8))
+            default: bytes.append(e)
+            }
+        }
+        return nil
+    }
+    
+    // MARK: - XML property list
+    
+    private struct Tag {
+        let name: String
+        let closing: Bool
+        let empty: Bool
+    }
+    
+    private func plistValue(_ b: UnsafeRawBufferPointer, _ i: inout Int, _ tag: Tag, _ stack: inout [String], _ out: inout [StreamMatch], _ mask: UInt64) -> Bool {
+        guard stack.count < StreamExtractor.maxDepth else { return false }
+        let match = self.match(mask, stack.count)
+        guard match.continues || match.exact != nil else {
+            return StreamExtractor.skipElement(b, &i, tag)
+        }
+        
+        switch tag.name {
+        case "dict", "array":
+            if let exact = match.exact {
+                self.emit(exact, stack, .container, &out)
+            }
+            guard match.continues else { return StreamExtractor.skipElement(b, &i, tag) }
+            guard !tag.empty else { return true }
+            var index = 0
+            while let next = StreamExtractor.tag(b, &i) {
+                if next.closing {
+                    return next.name == tag.name
+                }
+                var key = String(index)
+                var value = next
+                if tag.name == "dict" {
+                    guard next.name == "key" else { return false }
+                    key = ""
+                    if !next.empty {
+                        guard let text = StreamExtractor.text(b, &i, "key") else { return false }
+                        key = text
+                    }
+                    guard let v = StreamExtractor.tag(b, &i), !v.closing else { return false }
+                    value = v
+                }
+                let child = self.narrow(mask, stack.count, key)
+                stack.append(key)
+                let ok = child != 0 ? self.plistValue(b, &i, value, &stack, &out, child) : StreamExtractor.skipElement(b, &i, value)
+                stack.removeLast()
+                guard ok else { return false }
+                index += 1
+            }
+            return false
+        case "true", "false":
+            guard tag.empty || StreamExtractor.tag(b, &i).map({ $0.closing && $0.name == tag.name }) == true else { return false }
+            if let exact = match.exact {
+                self.emit(exact, stack, .bool(tag.name == "true"), &out)
+            }
+            return true
+        default:
+            var text = ""
+            if !tag.empty {
+                guard let value = StreamExtractor.text(b, &i, tag.name) else { return false }
+                text = value
+            }
+            guard let exact = match.exact else { return true }
+            switch tag.name {
+            case "integer":
+                guard let value = Int(text.trimmingCharacters(in: .whitespaces)) else { return false }
+                self.emit(exact, stack, .integer(value), &out)
+            case "real":
+                guard let value = Double(text.trimmingCharacters(in: .whitespaces)) else { return false }
+                self.emit(exact, stack, .real(value), &out)
+            default:
+                self.emit(exact, stack, .string(text), &out)
+            }
+            return true
+        }
+    }
+    
+    // the next element tag, the declarations, comments and the text between the tags are skipped
+    private static func tag(_ b: UnsafeRawBufferPointer, _ i: inout Int) -> Tag? {
+        while i < b.count {
+            while i < b.count && b[i] != UInt8(ascii: "<") {
+                i += 1
+            }
+            guard i + 1 < b.count else { return nil }
+            let start = i + 1
+            
+            if b[start] == UInt8(ascii: "!") && start + 2 < b.count && b[start + 1] == UInt8(ascii: "-") && b[start + 2] == UInt8(ascii: "-") {
+                i = start + 3
+                while i + 2 < b.count && !(b[i] == UInt8(ascii: "-") && b[i + 1] == UInt8(ascii: "-") && b[i + 2] == UInt8(ascii: ">")) {
+                    i += 1
+                }
+                i += 3
+                continue
+            }
+            
+            var end = start
+            while end < b.count && b[end] != UInt8(ascii: ">") {
+                end += 1
+            }
+            guard end < b.count else { return nil }
+            i = end + 1
+            if b[start] == UInt8(ascii: "?") || b[start] == UInt8(ascii: "!") {
+                continue
+            }
+            
+            let closing = b[start] == UInt8(ascii: "/")
+            let empty = b[end - 1] == UInt8(ascii: "/")
+            var nameStart = closing ? start + 1 : start
+            var nameEnd = nameStart
+            while nameEnd < end && b[nameEnd] != 0x20 && b[nameEnd] != UInt8(ascii: "/") && b[nameEnd] != 0x0A && b[nameEnd] != 0x09 {
+                nameEnd += 1
+            }
+            nameStart = min(nameStart, nameEnd)
+            return Tag(name: String(decoding: UnsafeRawBufferPointer(rebasing: b[nameStart..<nameEnd]), as: UTF8.self), closing: closing, empty: empty)
+        }
+        return nil
+    }
+    
+    // the text of an element and its closing tag
+    private static func text(_ b: UnsafeRawBufferPointer, _ i: inout Int, _ name: String) -> String? {
+        let start = i
+        while i < b.count && b[i] != UInt8(ascii: "<") {
+            i += 1
+        }
+        let raw = UnsafeRawBufferPointer(rebasing: b[start..<i])
+        guard let closing = StreamExtractor.tag(b, &i), closing.closing, closing.name == name else { return nil }
+        guard raw.contains(UInt8(ascii: "&")) else {
+            return String(decoding: raw, as: UTF8.self)
+        }
+        return StreamExtractor.entities(String(decoding: raw, as: UTF8.self))
+    }
+    
+    private static func entities(_ text: String) -> String {
+        var result = ""
+        var rest = Substring(text)
+        while let amp = rest.firstIndex(of: "&") {
+            result += rest[..<amp]
+            guard let semicolon = rest[amp...].firstIndex(of: ";") else { break }
+            let name = rest[rest.index(after: amp)..<semicolon]
+            switch name {
+            case "lt": result += "<"
+            case "gt": result += ">"
+            case "amp": result += "&"
+            case "quot": result += "\""
+            case "apos": result += "'"
+            default:
+                let code = name.hasPrefix("#x") ? UInt32(name.dropFirst(2), radix: 16) : name.hasPrefix("#") ? UInt32(name.dropFirst()) : nil
+                if let code, let scalar = Unicode.Scalar(code) {
+                    result.unicodeScalars.append(scalar)
+                } else {
+                    result += rest[amp...semicolon]
+                }
+            }
+            rest = rest[rest.index(after: semicolon)...]
+        }
+        return result + rest
+    }
+    
+    private static func skipElement(_ b: UnsafeRawBufferPointer, _ i: inout Int, _ tag: Tag) -> Bool {
+        guard !tag.empty else { return true }
+        var depth = 1
+        while let next = StreamExtractor.tag(b, &i) {
+            if next.closing {
+                depth -= 1
+            } else if !next.empty {
+                depth += 1
+            }
+            if depth == 0 {
+                return next.name == tag.name
+            }
+        }
+        return false
+    }
+}
@@ -0,0 +1,220 @@
+//
+//  Sync.swift
+//  Kit
+//
+//  Created by Serhiy Mytrovtsiy on 19/10/2026.
+//  Using Swift 6.0.
+//  Running on macOS 26.5.
+//
+//  Copyright © 2026 Serhiy Mytrovtsiy. All rights reserved.
+//
+
+import Foundation
+
+public protocol SyncItem: Decodable {
+    var id: String { get }
+}
+
+public enum SyncError: Error, Equatable {
+    case status(Int)
+    case decoding
+}
+
+public struct SyncStats: Equatable {
+    public var requests: Int = 0
+    public var notModified: Int = 0
+    public var deltas: Int = 0
+    public var snapshots: Int = 0
+    public var bytes: Int = 0
+    public var decodeTime: TimeInterval = 0
+}
+
+private struct SyncDelta<T: Decodable>: Decodable {
+    let changed: [T]?
+    let deleted: [String]?
+    let cursor: String?
+}
+
+private func syncRequest(host: String, path: String, token: String, etag: String?) -> URLRequest? {
+    guard let url = URL(string: "\(host)\(path)") else { return nil }
+    var request = URLRequest(url: url)
+    request.httpMethod = "GET"
+    // the conditional request is ours, URLCache must not answer it
+    request.cachePolicy = .reloadIgnoringLocalCacheData
+    request.setValue("Bearer \(token)", forHTTPHeaderField: "Authorization")
+    if let etag {
+        request.setValue(etag, forHTTPHeaderField: "If-None-Match")
+    }
+    return request
+}
+
+// Local copy of a list endpoint. The ETag of the last response is sent back as If-None-Match, so an
+// unchanged list costs a 304 without a body. When the server returns a cursor (X-Sync-Cursor header),
+// the next request asks only for the changes since it and the delta object
+// {"changed": [...], "deleted": [ids], "cursor": ...} is merged in place. A plain array replaces the list.
+public final class SyncCollection<T: SyncItem> {
+    public let path: String
+    
+    private let lock = NSLock()
+    private let decoder = JSONDecoder()
+    private var items: [T] = []
+    private var index: [String: Int] = [:]
+    private var etag: String? = nil
+    private var cursor: String? = nil
+    private var _stats: SyncStats = SyncStats()
+    
+    public init(path: String) {
+        self.path = path
+    }
+    
+    public var list: [T] {
+        self.lock.lock()
+        defer { self.lock.unlock() }
+        return self.items
+    }
+    
+    public var stats: SyncStats {
+        self.lock.lock()
+        defer { self.lock.unlock() }
+        return self._stats
+    }
+    
+    // fills an empty cache with a stored list, it is shown until the first response arrives
+    public func seed(_ list: [T]) {
+        self.lock.lock()
+        defer { self.lock.unlock() }
+        guard self.items.isEmpty && self.etag == nil else { return }
+        self.replaceLocked(list)
+    }
+    
+    public func reset() {
+        self.lock.lock()
+        defer { self.lock.unlock() }
+        self.replaceLocked([])
+        self.etag = nil
+        self.cursor = nil
+    }
+    
+    public func request(host: String, token: String) -> URLRequest? {
+        self.lock.lock()
+        defer { self.lock.unlock() }
+        var path = self.path
+        if let cursor = self.cursor, let value = cursor.addingPercentEncoding(withAllowedCharacters: .urlQueryAllowed) {
+            path += (path.contains("?") ? "&" : "?") + "since=\(value)"
+        }
+        return syncRequest(host: host, path: path, token: token, etag: self.etag)
+    }
+    
+    // merges the response into the cache, returns true when the list changed
+    @discardableResult
+    public func apply(status: Int, data: Data, etag: String? = nil, cursor: String? = nil) throws -> Bool {
+        self.lock.lock()
+        defer { self.lock.unlock() }
+        
+        self._stats.requests += 1
+        self._stats.bytes += data.count
+        if status == 304 {
+            self._stats.notModified += 1
+            return false
+        }
+        guard status == 200 else {
+            if status == 410 || status == 412 {
+                // the cursor expired on the server, start over with a full list
+                self.etag = nil
+                self.cursor = nil
+            }
+            throw SyncError.status(status)
+        }
+        
+        let start = CFAbsoluteTimeGetCurrent()
+        defer { self._stats.decodeTime += CFAbsoluteTimeGetCurrent() - start }
+        
+        var changed = false
+        if data.first(where: { $0 != 0x20 && $0 != 0x0A && $0 != 0x0D && $0 != 0x09 }) == 0x7B { // {
+            guard let delta = try? self.decoder.decode(SyncDelta<T>.self, from: data) else { throw SyncError.decoding }
+            changed = self.mergeLocked(delta.changed ?? [], deleted: delta.deleted ?? [])
+            self.cursor = cursor ?? delta.cursor
+            self._stats.deltas += 1
+        } else {
+            guard let list = try? self.decoder.decode([T].self, from: data) else { throw SyncError.decoding }
+            self.replaceLocked(list)
+            self.cursor = cursor
+            self._stats.snapshots += 1
+            changed = true
+        }
+        self.etag = etag
+        return changed
+    }
+    
+    private func replaceLocked(_ list: [T]) {
+        self.items = list
+        self.index.removeAll(keepingCapacity: true)
+        for (i, item) in list.enumerated() {
+            self.index[item.id] = i
+        }
+    }
+    
+    private func mergeLocked(_ changed: [T], deleted: [String]) -> Bool {
+        for item in changed {
+            if let i = self.index[item.id] {
+                self.items[i] = item
+            } else {
+                self.index[item.id] = self.items.count
+                self.items.append(item)
+            }
+        }
+        
+        let removed = Set(deleted).filter{ self.index[$0] != nil }
+        if !removed.isEmpty {
+            self.items.removeAll(where: { removed.contains($0.id) })
+            self.replaceLocked(self.items)
+        }
+        return !changed.isEmpty || !removed.isEmpty
+    }
+}
+
+// Single object endpoint revalidated with the ETag.
+public final class SyncDocument<T: Decodable> {
+    public let path: String
+    
+    private let lock = NSLock()
+    private var _value: T? = nil
+    private var etag: String? = nil
+    
+    public init(path: String) {
+        self.path = path
+    }
+    
+    public var value: T? {
+        self.lock.lock()
+        defer { self.lock.unlock() }
+        return self._value
+    }
+    
+    public func reset() {
+        self.lock.lock()
+        defer { self.lock.unlock() }
+        self._value = nil
+        self.etag = nil
+    }
+    
+    public func request(host: String, token: String) -> URLRequest? {
+        self.lock.lock()
+        defer { self.lock.unlock() }
+        return syncRequest(host: host, path: self.path, token: token, etag: self._value == nil ? nil : self.etag)
+    }
+    
+    @discardableResult
+    public func apply(status: Int, data: Data, etag: String? = nil) throws -> Bool {
+        self.lock.lock()
+        defer { self.lock.unlock() }
+        if status == 304 {
+            return false
+        }
+        guard status == 200 else { throw SyncError.status(status) }
+        guard let value = try? JSONDecoder().decode(T.self, from: data) else { throw SyncError.decoding }
+        self._value = value
+        self.etag = etag
+        return true
+    }
+}
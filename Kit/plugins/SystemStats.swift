@@ -67,13 +67,27 @@ public class SystemStats {
             }
         }
     }
+    // one binary frame per tick instead of a message per metric, needs a broker side decoder
+    public var binaryFrames: Bool {
+        get { Store.shared.bool(key: "remote_binary_frames", defaultValue: false) }
+        set {
+            Store.shared.set(key: "remote_binary_frames", value: newValue)
+            self.frameEncoder.reset()
+        }
+    }
     public let id: UUID
     public var isAuthorized: Bool = false
     public var auth: RemoteAuth = RemoteAuth()
     public var plan: AccountPlan?
+    // depth and lag of the metrics waiting for the replay
+    public var spoolStatus: MetricsSpoolStatus? {
+        self.mqtt.spoolStatus
+    }
     
     private let log: NextLog
     private var mqtt: MQTTManager = MQTTManager()
+    private let metrics: MetricsPublisher = MetricsPublisher()
+    private let frameEncoder: MetricsFrameEncoder = MetricsFrameEncoder()
     public let session: URLSession = {
         let config = URLSessionConfiguration.default
         config.timeoutIntervalForRequest = 30
@@ -143,8 +157,12 @@ public class SystemStats {
             self?.command(cmd: cmd, payload: payload)
         }
         self.mqtt.registerCallback = { [weak self] in
+            self?.frameEncoder.reset()
             self?.registerDevice()
         }
+        self.metrics.flushHandler = { [weak self] updates in
+            self?.publish(updates)
+        }
         self.mqtt.unregisterHandler = { [weak self] in
             guard let self else { return }
             info("Unregistered from MQTT broker, stopping Remote...", log: self.log)
@@ -177,6 +195,7 @@ public class SystemStats {
     
     public func logout() {
         self.mqtt.disconnect()
+        self.mqtt.clearSpool()
         self.auth.logout()
         self.isAuthorized = false
         debug("Logout successfully from Stats Remote", log: self.log)
@@ -205,8 +224,19 @@ public class SystemStats {
     
     public func send(key: String, value: Any) {
         guard self.monitoring && self.isAuthorized, let v = value as? RemoteType, let data = v.remote() else { return }
-        let topic = "stats/\(self.id.uuidString)/metrics/\(key)"
-        self.mqtt.publish(topic: topic, data: data)
+        self.metrics.add(key: key, payload: data)
+    }
+    
+    // all updates of a tick go out together: as one binary frame when enabled, otherwise one message per metric
+    private func publish(_ updates: [MetricUpdate]) {
+        guard self.monitoring && self.isAuthorized else { return }
+        if self.binaryFrames {
+            self.mqtt.publishMetric(topic: "stats/\(self.id.uuidString)/frames", data: self.frameEncoder.encode(updates), time: updates.map{ $0.time }.min() ?? Date())
+            return
+        }
+        for update in updates {
+            self.mqtt.publishMetric(topic: "stats/\(self.id.uuidString)/metrics/\(update.key)", data: update.payload, time: update.time)
+        }
     }
     
     @objc private func successLogin() {
@@ -230,6 +260,7 @@ public class SystemStats {
     }
     
     private func stop() {
+        self.metrics.discard()
         self.mqtt.disconnect()
         NotificationCenter.default.post(name: .remoteState, object: nil, userInfo: ["auth": self.isAuthorized])
     }
@@ -836,18 +867,6 @@ public class RemoteAuth {
 
 // MARK: - MQTT
 
-enum MQTTPacketType: UInt8 {
-    case connect = 1
-    case connack = 2
-    case publish = 3
-    case puback = 4
-    case subscribe = 8
-    case suback = 9
-    case pingreq = 12
-    case pingresp = 13
-    case disconnect = 14
-}
-
 class MQTTManager: NSObject {
     public var registerCallback: (() -> Void)? = nil
     public var commandCallback: ((String, Data?) -> Void)? = nil
@@ -864,7 +883,13 @@ class MQTTManager: NSObject {
     private var pingTimer: DispatchSourceTimer?
     private var reachability: Reachability = Reachability(start: true)
     private let log: NextLog
-    private var packetIdentifier: UInt16 = 1
+    private let encoder = MQTTEncoder()
+    private let decoder = MQTTDecoder()
+    private var inflight = MQTTInflight()
+    
+    private let spool: MetricsSpool? = MetricsSpool(directory: FileManager.default.urls(for: .applicationSupportDirectory, in: .userDomainMask).first!.appendingPathComponent("Stats/spool"))
+    private var replay: MetricsReplay = MetricsReplay()
+    private var replayTimer: DispatchSourceTimer?
     
     private let stateQueue = DispatchQueue(label: "eu.exelban.Stats.Remote.MQTT")
     private static let stateQueueKey = DispatchSpecificKey<Void>()
@@ -916,6 +941,7 @@ class MQTTManager: NSObject {
                     if status {
                         self.webSocket?.cancel(with: .normalClosure, reason: nil)
                         self.webSocket = self.session?.webSocketTask(with: SystemStats.brokerHost, protocols: ["mqtt"])
+                        self.decoder.reset()
                         self.webSocket?.resume()
                         self.receiveMessage()
                         self.isDisconnected = false
@@ -987,7 +1013,11 @@ class MQTTManager: NSObject {
     }
     
     private func sendConnect() {
-        let connectPacket = createConnectPacket(username: SystemStats.shared.id.uuidString, password: SystemStats.shared.auth.accessToken)
+        let username = SystemStats.shared.id.uuidString
+        guard let connectPacket = try? self.encoder.connect(clientID: "stats-\(username)", username: username, password: SystemStats.shared.auth.accessToken) else {
+            error("MQTT CONNECT fields are too long", log: self.log)
+            return
+        }
         self.webSocket?.send(.data(connectPacket)) { error in
             if let error = error {
                 print("Error sending MQTT CONNECT: \(error)")
@@ -996,12 +1026,12 @@ class MQTTManager: NSObject {
     }
     
     private func sendDisconnect() {
-        let disconnectPacket = Data([MQTTPacketType.disconnect.rawValue << 4, 0])
+        let disconnectPacket = self.encoder.disconnect()
         self.webSocket?.send(.data(disconnectPacket)) { _ in }
     }
     
     private func sendPingRequest() {
-        let pingPacket = Data([MQTTPacketType.pingreq.rawValue << 4, 0])
+        let pingPacket = self.encoder.pingreq()
         self.webSocket?.send(.data(pingPacket)) { error in
             if let error = error {
                 print("Error sending MQTT PINGREQ: \(error)")
@@ -1016,156 +1046,183 @@ class MQTTManager: NSObject {
         }
     }
     
-    public func publish(topic: String, data: Data, retain: Bool = false) {
+    public var spoolStatus: MetricsSpoolStatus? {
+        self.spool?.status()
+    }
+    
+    // metrics are spooled while offline or replaying and sent in order after the reconnect. Live
+    // samples go out with QoS 0, a lost one is replaced by the next tick and a missing PUBACK cannot
+    // stall the window, only the replay of the spool uses QoS 1
+    public func publishMetric(topic: String, data: Data, time: Date = Date()) {
         self.onStateQueue {
-            guard self.isConnected else { return }
-            
-            let publishPacket = self.createPublishPacket(topic: topic, payload: data, retain: retain)
-            self.webSocket?.send(.data(publishPacket)) { error in
-                if let error = error {
-                    print("Error publishing MQTT message: \(error)")
-                }
+            if !self.isConnected && self.replay.state != .offline {
+                self.stopReplay()
+            }
+            guard self.replay.spooling, let spool = self.spool else {
+                self.publish(topic: topic, data: data)
+                return
+            }
+            let evictions = spool.evictions
+            spool.append(MetricsSpool.Record(topic: topic, payload: data, time: time))
+            // the replayed records in flight were in the dropped segment, their acknowledgements must
+            // not remove the next records which were never sent
+            if spool.evictions != evictions && self.replay.inFlight > 0 {
+                self.replay.evicted()
+                self.inflight.detachReplayed()
             }
         }
     }
     
-    private func subscribe(to topic: String) {
-        guard self.isConnected else { return }
-        
-        let subscribePacket = createSubscribePacket(topic: topic)
-        self.webSocket?.send(.data(subscribePacket)) { error in
-            if let error = error {
-                print("Error subscribing to MQTT topic: \(error)")
-            }
+    public func clearSpool() {
+        self.onStateQueue {
+            self.spool?.removeAll()
+            self.inflight.removeAll()
         }
     }
     
-    private func createConnectPacket(username: String, password: String) -> Data {
-        var packet = Data()
+    private func startReplay() {
+        self.replayTimer?.cancel()
+        self.replay.connected(pending: !(self.spool?.isEmpty ?? true))
+        guard self.replay.state == .replaying, let status = self.spool?.status() else { return }
+        debug("Replaying \(status.records) spooled metrics, lag \(Int(status.lag ?? 0))s, dropped \(status.dropped)", log: self.log)
         
-        let fixedHeaderByte = MQTTPacketType.connect.rawValue << 4
-        
-        var variableHeader = Data()
-        variableHeader.append(contentsOf: encodeString("MQTT"))
-        variableHeader.append(4)
-        
-        var connectFlags: UInt8 = 0x00
-        connectFlags |= 0x80
-        connectFlags |= 0x40
-        variableHeader.append(connectFlags)
-        variableHeader.append(contentsOf: [0x03, 0x84])
-        
-        var payload = Data()
-        payload.append(contentsOf: encodeString("stats-\(username)"))
-        payload.append(contentsOf: encodeString(username))
-        payload.append(contentsOf: encodeString(password))
-        
-        let remainingLength = variableHeader.count + payload.count
-        packet.append(fixedHeaderByte)
-        packet.append(contentsOf: encodeRemainingLength(remainingLength))
-        packet.append(variableHeader)
-        packet.append(payload)
-        
-        return packet
+        let timer = DispatchSource.makeTimerSource(queue: self.stateQueue)
+        timer.schedule(deadline: .now(), repeating: 0.1)
+        timer.setEventHandler { [weak self] in
+            self?.replayTick()
+        }
+        timer.resume()
+        self.replayTimer = timer
     }
     
-    private func createPublishPacket(topic: String, payload: Data, retain: Bool = false) -> Data {
-        var packet = Data()
-        
-        let fixedHeaderByte = (MQTTPacketType.publish.rawValue << 4) | (retain ? 0x01 : 0x00)
-        
-        var variableHeader = Data()
-        variableHeader.append(contentsOf: encodeString(topic))
-        
-        let remainingLength = variableHeader.count + payload.count
-        
-        packet.append(fixedHeaderByte)
-        packet.append(contentsOf: encodeRemainingLength(remainingLength))
-        packet.append(variableHeader)
-        packet.append(payload)
-        
-        return packet
+    private func stopReplay() {
+        self.replayTimer?.cancel()
+        self.replayTimer = nil
+        self.replay.disconnected()
+        self.inflight.removeReplayed()
+        self.spool?.flush()
     }
     
-    private func createSubscribePacket(topic: String) -> Data {
-        var packet = Data()
-        
-        let fixedHeaderByte = (MQTTPacketType.subscribe.rawValue << 4) | 0x02
-        
-        var variableHeader = Data()
-        
-        let packetId = self.getNextPacketId()
-        variableHeader.append(contentsOf: [UInt8(packetId >> 8), UInt8(packetId & 0xFF)])
-        
-        var payload = Data()
-        payload.append(contentsOf: encodeString(topic))
-        payload.append(0x00)
-        
-        let remainingLength = variableHeader.count + payload.count
-        
-        packet.append(fixedHeaderByte)
-        packet.append(contentsOf: encodeRemainingLength(remainingLength))
-        packet.append(variableHeader)
-        packet.append(payload)
+    private func replayTick() {
+        guard self.isConnected, let spool = self.spool else {
+            self.stopReplay()
+            return
+        }
         
-        return packet
+        // the replay shares the QoS 1 window with the other acknowledged messages
+        // the records stay in the spool until their PUBACK, the ones in flight are skipped
+        let free = max(0, self.inflight.window - self.inflight.inFlight - self.inflight.queued)
+        let records = spool.peek(min(self.replay.budget(ProcessInfo.processInfo.systemUptime), free), from: self.replay.inFlight)
+        for record in records {
+            self.inflight.enqueue(MQTTInflight.Message(topic: record.topic, payload: record.payload, replayed: true))
+        }
+        self.replay.sent(records.count)
+        self.sendInflight()
+        
+        if spool.isEmpty {
+            self.replay.drained()
+            if self.replay.state == .live {
+                self.replayTimer?.cancel()
+                self.replayTimer = nil
+                spool.flush()
+                debug("Spooled metrics replayed, switching to live", log: self.log)
+            }
+        }
     }
     
-    private func encodeString(_ string: String) -> [UInt8] {
-        let data = string.data(using: .utf8) ?? Data()
-        let length = data.count
-        return [UInt8(length >> 8), UInt8(length & 0xFF)] + Array(data)
+    // QoS 1 messages wait in the in-flight window until PUBACK, the rest is sent only when connected
+    public func publish(topic: String, data: Data, retain: Bool = false, qos: UInt8 = 0) {
+        self.onStateQueue {
+            if qos > 0 {
+                self.inflight.enqueue(MQTTInflight.Message(topic: topic, payload: data))
+                self.sendInflight()
+                return
+            }
+            guard self.isConnected else { return }
+            
+            let log = self.log
+            guard let publishPacket = try? self.encoder.publish(topic: topic, payload: data, retain: retain) else {
+                error("MQTT message to \(topic) is too large", log: log)
+                return
+            }
+            self.webSocket?.send(.data(publishPacket)) { err in
+                if let err {
+                    error("Error publishing MQTT message: \(err)", log: log)
+                }
+            }
+        }
     }
     
-    private func encodeRemainingLength(_ length: Int) -> [UInt8] {
-        var bytes: [UInt8] = []
-        var remainingLength = length
-        
-        repeat {
-            var byte = UInt8(remainingLength % 128)
-            remainingLength /= 128
-            if remainingLength > 0 {
-                byte |= 128
+    private func sendInflight(_ messages: [MQTTInflight.Message]? = nil) {
+        guard self.isConnected else { return }
+        for message in messages ?? self.inflight.ready(ProcessInfo.processInfo.systemUptime) {
+            let log = self.log
+            guard let packet = try? self.encoder.publish(topic: message.topic, payload: message.payload, qos: 1, dup: message.dup, packetId: message.packetId) else {
+                // never sent, so no PUBACK comes, the identifier is freed at once
+                error("MQTT message to \(message.topic) is too large", log: log)
+                self.acknowledged(message.packetId)
+                continue
             }
-            bytes.append(byte)
-        } while remainingLength > 0
-        
-        return bytes
+            self.webSocket?.send(.data(packet)) { err in
+                if let err {
+                    error("Error publishing MQTT message: \(err)", log: log)
+                }
+            }
+        }
     }
     
-    private func getNextPacketId() -> UInt16 {
-        self.packetIdentifier &+= 1
-        if self.packetIdentifier == 0 {
-            self.packetIdentifier = 1
+    private func subscribe(to topic: String) {
+        guard self.isConnected else { return }
+        
+        let packetId = self.inflight.reserve()
+        guard let subscribePacket = try? self.encoder.subscribe(topic: topic, packetId: packetId) else {
+            self.inflight.release(packetId)
+            return
+        }
+        self.webSocket?.send(.data(subscribePacket)) { error in
+            if let error = error {
+                print("Error subscribing to MQTT topic: \(error)")
+            }
         }
-        return self.packetIdentifier
     }
     
-    private func handleMQTTPacket(_ data: Data) {
-        guard data.count >= 2 else { return }
-        
-        let packetType = MQTTPacketType(rawValue: (data[0] >> 4) & 0x0F)
-        
-        switch packetType {
+    private func handleMQTTPacket(_ packet: MQTTPacket) {
+        switch MQTTPacketType(rawValue: packet.type) {
         case .connack:
-            self.handleConnAck(data)
+            self.handleConnAck(packet)
+        case .puback:
+            if let id = packet.packetId {
+                self.acknowledged(id)
+            }
         case .pingresp:
             break
         case .suback:
-            break
+            if let id = packet.packetId {
+                self.inflight.release(id)
+            }
         case .publish:
-            self.handlePublish(data)
+            self.handlePublish(packet)
         default:
             break
         }
     }
     
-    private func handleConnAck(_ data: Data) {
-        guard data.count >= 4 else { return }
+    // only the acknowledgements of replayed messages move the replay and the spool
+    private func acknowledged(_ packetId: UInt16) {
+        guard let message = self.inflight.acknowledged(packetId) else { return }
+        if message.replayed {
+            self.spool?.remove(1)
+            self.replay.completed()
+        }
+        self.sendInflight()
+    }
+    
+    private func handleConnAck(_ packet: MQTTPacket) {
+        guard packet.body.count >= 2 else { return }
         
         self.isConnecting = false
         
-        let returnCode = data[3]
+        let returnCode = packet.body[packet.body.startIndex + 1]
         if returnCode == 0 {
             self.isConnected = true
             self.isReconnecting = false
@@ -1173,6 +1230,9 @@ class MQTTManager: NSObject {
             self.startPingTimer()
             self.subscribeToTopics()
             self.sendStatus(true)
+            self.sendInflight(self.inflight.resend(ProcessInfo.processInfo.systemUptime))
+            self.sendInflight()
+            self.startReplay()
             debug("MQTT connected successfully", log: self.log)
             DispatchQueue.main.async {
                 self.registerCallback?()
@@ -1183,6 +1243,7 @@ class MQTTManager: NSObject {
     }
     
     private func subscribeToTopics() {
+        self.inflight.releaseReserved()
         self.subscribe(to: "stats/\(SystemStats.shared.id.uuidString)/control/+")
         self.subscribe(to: "stats/\(SystemStats.shared.id.uuidString)/unregister")
     }
@@ -1197,7 +1258,7 @@ class MQTTManager: NSObject {
             case .success(let message):
                 switch message {
                 case .data(let data):
-                    self?.handleMQTTPacket(data)
+                    self?.receive(data)
                 case .string:
                     break
                 @unknown default:
@@ -1208,6 +1269,19 @@ class MQTTManager: NSObject {
         }
     }
     
+    // a WebSocket message can hold a part of a packet or several packets
+    private func receive(_ data: Data) {
+        self.decoder.append(data)
+        do {
+            while let packet = try self.decoder.next() {
+                self.handleMQTTPacket(packet)
+            }
+        } catch let err {
+            debug("Malformed MQTT data: \(err)", log: self.log)
+            self.webSocket?.cancel(with: .protocolError, reason: nil)
+        }
+    }
+    
     private func startPingTimer() {
         self.stopPingTimer()
         let timer = DispatchSource.makeTimerSource(queue: self.stateQueue)
@@ -1232,20 +1306,12 @@ class MQTTManager: NSObject {
         }
     }
     
-    private func handlePublish(_ data: Data) {
-        var offset = 1
-        while offset < data.count && data[offset] & 0x80 != 0 { offset += 1 }
-        guard offset < data.count else { return }
-        offset += 1
-        
-        guard data.count > offset + 1 else { return }
-        let topicLength = Int(data[offset]) << 8 | Int(data[offset + 1])
-        offset += 2
-        
-        guard data.count >= offset + topicLength else { return }
-        let topicData = data.subdata(in: offset..<(offset + topicLength))
-        guard let topic = String(data: topicData, encoding: .utf8) else { return }
-        offset += topicLength
+    private func handlePublish(_ packet: MQTTPacket) {
+        guard let message = try? packet.publish() else { return }
+        if let packetId = message.packetId, packet.qos == 1 {
+            self.webSocket?.send(.data(self.encoder.puback(packetId))) { _ in }
+        }
+        let topic = message.topic
         
         let base = "stats/\(SystemStats.shared.id.uuidString)/"
         if topic == base + "unregister" {
@@ -1260,7 +1326,7 @@ class MQTTManager: NSObject {
         guard topic.hasPrefix(controlPrefix) else { return }
         let commandName = String(topic.dropFirst(controlPrefix.count))
         guard !commandName.isEmpty, !commandName.contains("/") else { return }
-        let payload = data.subdata(in: offset..<data.count)
+        let payload = Data(message.payload)
         DispatchQueue.main.async {
             self.commandCallback?(commandName, payload)
         }
@@ -211,61 +211,119 @@ public class ProcessReader: Reader<[TopProcess]> {
         }
     }
     
+    private let estimator = EnergyEstimator()
+    private var pids: [pid_t] = []
+    private var denied: [pid_t] = []
+    private var timebase = mach_timebase_info_data_t()
+    
+    // top is setuid and sees the processes of other users, it runs in the background only while
+    // some processes cannot be read, its last values are used for them
+    private let topQueue = DispatchQueue(label: "eu.exelban.Battery.top", qos: .utility)
+    private let topLock = NSLock()
+    private var topPower: [Int32: (name: String, power: Double)] = [:]
+    private var topRunning: Bool = false
+    
     public override func setup() {
         self.popup = true
+        mach_timebase_info(&self.timebase)
     }
     
+    // the energy impact from the counters of all processes, the first snapshot only keeps the counters
     public override func read() {
         if self.numberOfProcesses == 0 {
             return
         }
         
-        let task = Process()
-        task.executableURL = URL(fileURLWithPath: "/usr/bin/top")
-        task.arguments = ["-o", "power", "-l", "2", "-n", "\(self.numberOfProcesses)", "-stats", "pid,command,power"]
-        
-        let outputPipe = Pipe()
-        defer {
-            outputPipe.fileHandleForReading.closeFile()
+        let count = Int(proc_listallpids(nil, 0))
+        guard count > 0 else { return }
+        if self.pids.count < count + 32 {
+            self.pids = [pid_t](repeating: 0, count: count + 64)
         }
-        task.standardOutput = outputPipe
-        
-        do {
-            try task.run()
-        } catch let err {
-            error("error read ps: \(err.localizedDescription)", log: self.log)
+        let number = Int(self.pids.withUnsafeMutableBytes { proc_listallpids($0.baseAddress, Int32($0.count)) })
+        guard number > 0 else {
+            error("proc_listallpids(): \(String(cString: strerror(errno)))", log: self.log)
             return
         }
         
-        let outputData = outputPipe.fileHandleForReading.readDataToEndOfFile()
-        if outputData.isEmpty {
-            return
+        let interval = self.estimator.begin(TimeInterval(DispatchTime.now().uptimeNanoseconds) / 1_000_000_000)
+        var list: [(pid: pid_t, usage: Double)] = []
+        self.denied.removeAll(keepingCapacity: true)
+        for pid in self.pids.prefix(min(number, self.pids.count)) {
+            guard let counters = self.counters(pid) else {
+                self.denied.append(pid)
+                continue
+            }
+            if let impact = self.estimator.add(pid, counters, interval: interval) {
+                list.append((pid, impact))
+            }
+        }
+        if !self.denied.isEmpty {
+            self.refreshTopPower()
         }
+        guard interval != nil else { return }
         
-        let output = String(data: outputData.advanced(by: outputData.count/2), encoding: .utf8)
-        guard let output, !output.isEmpty else { return }
+        self.topLock.lock()
+        let top = self.topPower
+        self.topLock.unlock()
         
-        var processes: [TopProcess] = []
-        output.enumerateLines { (line, _) in
-            if line.matches("^\\d+ *[^(\\d)]*\\d+\\.*\\d* *$") {
-                let str = line.trimmingCharacters(in: .whitespaces)
-                let pidFind = str.findAndCrop(pattern: "^\\d+")
-                let usageFind = pidFind.remain.findAndCrop(pattern: " +[0-9]+.*[0-9]*$")
-                let command = usageFind.remain.trimmingCharacters(in: .whitespaces)
-                let pid = Int(pidFind.cropped) ?? 0
-                guard let usage = Double(usageFind.cropped.filter("01234567890.".contains)) else {
-                    return
-                }
-                
-                var name: String = command
-                if let app = NSRunningApplication(processIdentifier: pid_t(pid)), let n = app.localizedName {
-                    name = n
-                }
-                
-                processes.append(TopProcess(pid: pid, name: name, usage: usage))
+        let processes: [TopProcess] = EnergyEstimator.rank(list, denied: self.denied, top: top, limit: self.numberOfProcesses).map { process in
+            var name: String = ""
+            if let app = NSRunningApplication(processIdentifier: process.pid), let n = app.localizedName {
+                name = n
+            } else {
+                var buffer = [CChar](repeating: 0, count: Int(MAXCOMLEN) * 2 + 1)
+                proc_name(process.pid, &buffer, UInt32(buffer.count))
+                name = String(cString: buffer)
+            }
+            if name.isEmpty {
+                name = top[process.pid]?.name ?? ""
+            }
+            return TopProcess(pid: Int(process.pid), name: name, usage: process.usage.rounded(toPlaces: 1))
+        }
+        
+        self.callback(processes)
+    }
+    
+    // nil for the processes of other users (kernel_task, WindowServer, daemons) when the app is not
+    // root, proc_pid_rusage and proc_pidinfo both refuse them
+    private func counters(_ pid: pid_t) -> EnergyCounters? {
+        var usage = rusage_info_current()
+        let result = withUnsafeMutablePointer(to: &usage) {
+            $0.withMemoryRebound(to: (rusage_info_t?.self), capacity: 1) {
+                proc_pid_rusage(pid, RUSAGE_INFO_CURRENT, $0)
             }
         }
+        guard result == 0 else { return nil }
+        return EnergyCounters(
+            start: usage.ri_proc_start_abstime,
+            cpuTime: self.nanoseconds(usage.ri_user_time &+ usage.ri_system_time),
+            wakeups: usage.ri_pkg_idle_wkups &+ usage.ri_interrupt_wkups,
+            diskRead: usage.ri_diskio_bytesread,
+            diskWritten: usage.ri_diskio_byteswritten
+        )
+    }
+    
+    // the two samples of top take about a second, the reader does not wait for them
+    private func refreshTopPower() {
+        self.topLock.lock()
+        defer { self.topLock.unlock() }
+        guard !self.topRunning else { return }
+        self.topRunning = true
         
-        self.callback(processes.suffix(self.numberOfProcesses).sorted(by: { $0.usage > $1.usage }))
+        let count = self.numberOfProcesses
+        self.topQueue.async { [weak self] in
+            let output = process(path: "/usr/bin/top", arguments: ["-o", "power", "-l", "2", "-n", "\(count)", "-stats", "pid,command,power"], timeout: 5)
+            guard let self else { return }
+            self.topLock.lock()
+            if let output {
+                self.topPower = EnergyEstimator.topPower(output)
+            }
+            self.topRunning = false
+            self.topLock.unlock()
+        }
+    }
+    
+    private func nanoseconds(_ ticks: UInt64) -> UInt64 {
+        ticks &* UInt64(self.timebase.numer) / UInt64(max(self.timebase.denom, 1))
     }
 }
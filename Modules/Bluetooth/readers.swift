@@ -272,50 +272,49 @@ internal class DevicesReader: Reader<[BLEDevice]>, CBCentralManagerDelegate, CBP
     
     // MARK: - system_profiler
     
+    private static let profilerBatteryKeys: [String] = ["device_batteryLevelCase", "device_batteryLevelLeft", "device_batteryLevelRight", "Left Battery Level", "Right Battery Level", "device_batteryLevelMain"]
+    // the connected devices, their address and battery levels and the addresses of the devices which are not connected
+    private static let profilerExtractor = StreamExtractor(
+        [["SPBluetoothDataType", "0", "device_connected", "0", "*"], ["SPBluetoothDataType", "0", "device_connected", "0", "*", "device_address"]]
+        + DevicesReader.profilerBatteryKeys.map{ ["SPBluetoothDataType", "0", "device_connected", "0", "*", $0] }
+        + [["SPBluetoothDataType", "0", "device_not_connected", "*", "*", "device_address"]]
+    )
+    
     private func profilerDevices() -> ([bleDevice], [String]) {
         guard let res = process(path: "/usr/sbin/system_profiler", arguments: ["SPBluetoothDataType", "-json"]) else {
             return ([], [])
         }
         
+        guard let matches = Data(res.utf8).withUnsafeBytes({ DevicesReader.profilerExtractor.json($0) }) else {
+            error("error to parse system_profiler SPBluetoothDataType")
+            return ([], [])
+        }
+        
         var list: [bleDevice] = []
         var notConnected: [String] = []
-        do {
-            if let json = try JSONSerialization.jsonObject(with: Data(res.utf8), options: []) as? [String: Any] {
-                guard let arr = json["SPBluetoothDataType"] as? [[String: Any]], let data = arr.first else {
-                    return (list, notConnected)
-                }
-                
-                if let rawList = data["device_connected"] as? [[String: [String: Any]]], let devices = rawList.first {
-                    for obj in devices {
-                        var batteryLevel: [KeyValue_t] = []
-                        
-                        for key in ["device_batteryLevelCase", "device_batteryLevelLeft", "device_batteryLevelRight", "Left Battery Level", "Right Battery Level", "device_batteryLevelMain"] {
-                            if let pair = obj.value.first(where: { $0.key == key }) {
-                                batteryLevel.append(KeyValue_t(key: key, value: (pair.value as? String)?.replacingOccurrences(of: "%", with: "") ?? "-1"))
-                            }
-                        }
-                        
-                        let address = obj.value["device_address"] as? String ?? ""
-                        list.append(bleDevice(
-                            name: obj.key,
-                            address: address.replacingOccurrences(of: ":", with: "-").lowercased(),
-                            batteryLevel: batteryLevel
-                        ))
-                    }
+        var fields: [String: [Int: StreamValue]] = [:]
+        for match in matches {
+            switch match.path {
+            case 0:
+                list.append(bleDevice(name: match.keys[0], address: "", batteryLevel: []))
+            case DevicesReader.profilerBatteryKeys.count + 2:
+                if let addr = match.value.string {
+                    notConnected.append(addr.replacingOccurrences(of: ":", with: "-").lowercased())
                 }
-                if let rawList = data["device_not_connected"] as? [[String: [String: String]]] {
-                    for device in rawList {
-                        for d in device.values {
-                            if let addr = d["device_address"] {
-                                notConnected.append(addr.replacingOccurrences(of: ":", with: "-").lowercased())
-                            }
-                        }
-                    }
+            default:
+                fields[match.keys[0], default: [:]][match.path] = match.value
+            }
+        }
+        
+        for i in list.indices {
+            guard let values = fields[list[i].name ?? ""] else { continue }
+            let address = values[1]?.string ?? ""
+            list[i].address = address.replacingOccurrences(of: ":", with: "-").lowercased()
+            for (n, key) in DevicesReader.profilerBatteryKeys.enumerated() {
+                if let value = values[n + 2] {
+                    list[i].batteryLevel.append(KeyValue_t(key: key, value: value.string?.replacingOccurrences(of: "%", with: "") ?? "-1"))
                 }
             }
-        } catch let err as NSError {
-            error("error to parse system_profiler SPBluetoothDataType: \(err.localizedDescription)")
-            return (list, notConnected)
         }
         
         return (list, notConnected)
@@ -380,19 +379,33 @@ internal class DevicesReader: Reader<[BLEDevice]>, CBCentralManagerDelegate, CBP
     }
     
     // MARK: - PMSET data
+    
+    // every document of the output is one accessory
+    private static let pmsetExtractor = StreamExtractor(
+        ["Name", "Current Capacity", "Accessory Identifier", "Is Charging", "Power Source State", "Part Identifier", "Group Identifier", "Accessory Category", "Vendor ID", "Product ID"].map{ ["*", $0] }
+        + ["Part Identifier", "Current Capacity", "Is Charging"].map{ ["*", "Combined Parts", "*", $0] }
+    )
+    
     private func pmsetAccessoryLevels() -> [bleDevice] {
         guard let res = process(path: "/usr/bin/pmset", arguments: ["-g", "accps", "-xml"]) else { return [] }
         
-        let plists = res.components(separatedBy: "<?xml")
-            .filter { !$0.trimmingCharacters(in: .whitespacesAndNewlines).isEmpty }
-            .compactMap { chunk -> [String: Any]? in
-                let xml = "<?xml" + chunk
-                guard let data = xml.data(using: .utf8),
-                      let plist = try? PropertyListSerialization.propertyList(from: data, format: nil) as? [String: Any] else {
-                    return nil
-                }
-                return plist
+        guard let matches = Data(res.utf8).withUnsafeBytes({ DevicesReader.pmsetExtractor.plist($0) }) else {
+            error("error to parse pmset accessories")
+            return []
+        }
+        
+        // the fields of every document and of its combined parts
+        var plists: [Int: [String: StreamValue]] = [:]
+        var combined: [Int: [Int: [String: StreamValue]]] = [:]
+        for match in matches {
+            guard let document = Int(match.keys[0]) else { continue }
+            let key = DevicesReader.pmsetExtractor.paths[match.path].last ?? ""
+            if match.keys.count > 1, let part = Int(match.keys[1]) {
+                combined[document, default: [:]][part, default: [:]][key] = match.value
+            } else {
+                plists[document, default: [:]][key] = match.value
             }
+        }
         
         struct PmsetEntry {
             let name: String
@@ -404,19 +417,19 @@ internal class DevicesReader: Reader<[BLEDevice]>, CBCentralManagerDelegate, CBP
             let isCharging: Bool
             let vendorId: Int?
             let productId: Int?
-            let combinedParts: [[String: Any]]?
+            let combinedParts: [[String: StreamValue]]?
         }
         
         var entries: [PmsetEntry] = []
-        for dict in plists {
-            guard let name = dict["Name"] as? String,
-                  let capacity = dict["Current Capacity"] as? Int,
-                  let accessoryId = dict["Accessory Identifier"] as? String else { continue }
+        for (document, dict) in plists.sorted(by: { $0.key < $1.key }) {
+            guard let name = dict["Name"]?.string,
+                  let capacity = dict["Current Capacity"]?.int,
+                  let accessoryId = dict["Accessory Identifier"]?.string else { continue }
             
             let isCharging: Bool
-            if let charging = dict["Is Charging"] as? Bool {
+            if let charging = dict["Is Charging"]?.bool {
                 isCharging = charging
-            } else if let state = dict["Power Source State"] as? String {
+            } else if let state = dict["Power Source State"]?.string {
                 isCharging = state == "AC Power"
             } else {
                 isCharging = false
@@ -426,13 +439,13 @@ internal class DevicesReader: Reader<[BLEDevice]>, CBCentralManagerDelegate, CBP
                 name: name,
                 capacity: capacity,
                 accessoryIdentifier: accessoryId,
-                partIdentifier: dict["Part Identifier"] as? String,
-                groupIdentifier: dict["Group Identifier"] as? String,
-                category: dict["Accessory Category"] as? String,
+                partIdentifier: dict["Part Identifier"]?.string,
+                groupIdentifier: dict["Group Identifier"]?.string,
+                category: dict["Accessory Category"]?.string,
                 isCharging: isCharging,
-                vendorId: dict["Vendor ID"] as? Int,
-                productId: dict["Product ID"] as? Int,
-                combinedParts: dict["Combined Parts"] as? [[String: Any]]
+                vendorId: dict["Vendor ID"]?.int,
+                productId: dict["Product ID"]?.int,
+                combinedParts: combined[document].map{ $0.sorted(by: { $0.key < $1.key }).map{ $0.value } }
             ))
         }
         
@@ -475,9 +488,9 @@ internal class DevicesReader: Reader<[BLEDevice]>, CBCentralManagerDelegate, CBP
             
             if let parts = combinedEntry?.combinedParts {
                 for part in parts {
-                    guard let partId = part["Part Identifier"] as? String,
-                          let cap = part["Current Capacity"] as? Int else { continue }
-                    let charging = (part["Is Charging"] as? Bool) ?? false
+                    guard let partId = part["Part Identifier"]?.string,
+                          let cap = part["Current Capacity"]?.int else { continue }
+                    let charging = part["Is Charging"]?.bool ?? false
                     let state = charging ? "charging" : "discharging"
                     kv.append(KeyValue_t(key: partId.lowercased(), value: "\(cap)", additional: state))
                 }
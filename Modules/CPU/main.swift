@@ -10,7 +10,7 @@ import Cocoa
 import Kit
 import WidgetKit
 
-public struct CPU_Load: Codable, RemoteType {
+public struct CPU_Load: Codable, RemoteType, OpenMetricsType {
     public var totalUsage: Double = 0
     var usagePerCore: [Double] = []
     var usageECores: Double? = nil
@@ -29,6 +29,16 @@ public struct CPU_Load: Codable, RemoteType {
         string += "$"
         return string.data(using: .utf8)
     }
+    
+    public func openMetrics() -> [OpenMetric] {
+        var list: [OpenMetric] = [("total", self.totalUsage), ("system", self.systemLoad), ("user", self.userLoad), ("idle", self.idleLoad)].map {
+            OpenMetric("stats_cpu_usage_ratio", $0.1, unit: "ratio", help: "CPU usage", labels: [("mode", $0.0)])
+        }
+        for (i, v) in self.usagePerCore.enumerated() {
+            list.append(OpenMetric("stats_cpu_core_usage_ratio", v, unit: "ratio", help: "CPU usage per core", labels: [("core", "\(i)")]))
+        }
+        return list
+    }
 }
 
 public struct CPU_Frequency: Codable {
@@ -44,7 +54,7 @@ public struct CPU_Limit: Codable {
     var speed: Int = 0
 }
 
-public struct CPU_AverageLoad: Codable, RemoteType {
+public struct CPU_AverageLoad: Codable, RemoteType, OpenMetricsType {
     var load1: Double = 0
     var load5: Double = 0
     var load15: Double = 0
@@ -53,6 +63,12 @@ public struct CPU_AverageLoad: Codable, RemoteType {
         let string = "1,1,\(self.load1),\(self.load5),\(self.load15)$"
         return string.data(using: .utf8)
     }
+    
+    public func openMetrics() -> [OpenMetric] {
+        [("1m", self.load1), ("5m", self.load5), ("15m", self.load15)].map {
+            OpenMetric("stats_cpu_load_average", $0.1, help: "Load average", labels: [("period", $0.0)])
+        }
+    }
 }
 
 public class CPU: Module {
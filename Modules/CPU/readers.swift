@@ -13,168 +13,51 @@ import Cocoa
 import Kit
 
 internal class LoadReader: Reader<CPU_Load> {
-    private var cpuInfo: processor_info_array_t!
-    private var prevCpuInfo: processor_info_array_t?
-    private var numCpuInfo: mach_msg_type_number_t = 0
-    private var numPrevCpuInfo: mach_msg_type_number_t = 0
-    private var numCPUs: uint = 0
-    private let CPUUsageLock: NSLock = NSLock()
-    private var previousInfo = host_cpu_load_info()
     private var hasHyperthreadingCores = false
+    private var table: CoreLoadTable? = nil
+    private var cores: [core_s]? = nil
     
     private var response: CPU_Load = CPU_Load()
-    private var numCPUsU: natural_t = 0
-    private var usagePerCore: [Double] = []
-    private var cores: [core_s]? = nil
     
     public override func setup() {
         self.hasHyperthreadingCores = sysctlByName("hw.physicalcpu") != sysctlByName("hw.logicalcpu")
-        [CTL_HW, HW_NCPU].withUnsafeBufferPointer { mib in
-            var sizeOfNumCPUs: size_t = MemoryLayout<uint>.size
-            let status = sysctl(processor_info_array_t(mutating: mib.baseAddress), 2, &numCPUs, &sizeOfNumCPUs, nil, 0)
-            if status != 0 {
-                self.numCPUs = 1
-            }
-        }
         self.cores = SystemKit.shared.device.info.cpu?.cores
     }
     
     public override func read() {
-        let result: kern_return_t = host_processor_info(mach_host_self(), PROCESSOR_CPU_LOAD_INFO, &self.numCPUsU, &self.cpuInfo, &self.numCpuInfo)
-        if result == KERN_SUCCESS {
-            self.CPUUsageLock.lock()
-            self.usagePerCore = []
-            
-            if let prevCpuInfo = self.prevCpuInfo {
-                for i in 0 ..< Int32(self.numCPUs) {
-                    let user = UInt32(bitPattern: self.cpuInfo[Int(CPU_STATE_MAX * i + CPU_STATE_USER)])
-                        &- UInt32(bitPattern: prevCpuInfo[Int(CPU_STATE_MAX * i + CPU_STATE_USER)])
-                    let system = UInt32(bitPattern: self.cpuInfo[Int(CPU_STATE_MAX * i + CPU_STATE_SYSTEM)])
-                        &- UInt32(bitPattern: prevCpuInfo[Int(CPU_STATE_MAX * i + CPU_STATE_SYSTEM)])
-                    let nice = UInt32(bitPattern: self.cpuInfo[Int(CPU_STATE_MAX * i + CPU_STATE_NICE)])
-                        &- UInt32(bitPattern: prevCpuInfo[Int(CPU_STATE_MAX * i + CPU_STATE_NICE)])
-                    let idle = UInt32(bitPattern: self.cpuInfo[Int(CPU_STATE_MAX * i + CPU_STATE_IDLE)])
-                        &- UInt32(bitPattern: prevCpuInfo[Int(CPU_STATE_MAX * i + CPU_STATE_IDLE)])
-                    
-                    let inUse = UInt64(user) + UInt64(system) + UInt64(nice)
-                    let total = inUse + UInt64(idle)
-                    if total != 0 {
-                        self.usagePerCore.append(min(1, Double(inUse) / Double(total)))
-                    }
-                }
-            }
-            self.CPUUsageLock.unlock()
-            
-            let showHyperthratedCores = Store.shared.bool(key: "CPU_hyperhreading", defaultValue: false)
-            if showHyperthratedCores || !self.hasHyperthreadingCores {
-                self.response.usagePerCore = self.usagePerCore
-            } else {
-                var i = 0
-                var a = 0
-                
-                self.response.usagePerCore = []
-                while i < Int(self.usagePerCore.count/2) {
-                    a = i*2
-                    if self.usagePerCore.indices.contains(a) && self.usagePerCore.indices.contains(a+1) {
-                        self.response.usagePerCore.append((Double(self.usagePerCore[a]) + Double(self.usagePerCore[a+1])) / 2)
-                    }
-                    i += 1
-                }
-            }
-            
-            if let prevCpuInfo = self.prevCpuInfo {
-                let prevCpuInfoSize: size_t = MemoryLayout<integer_t>.stride * Int(self.numPrevCpuInfo)
-                vm_deallocate(mach_task_self_, vm_address_t(bitPattern: prevCpuInfo), vm_size_t(prevCpuInfoSize))
-            }
-            
-            self.prevCpuInfo = self.cpuInfo
-            self.numPrevCpuInfo = self.numCpuInfo
-            
-            self.cpuInfo = nil
-            self.numCpuInfo = 0
-        } else {
-            error("host_processor_info(): \(String(cString: mach_error_string(result), encoding: String.Encoding.ascii) ?? "unknown error")", log: self.log)
-        }
+        var numCPUs: natural_t = 0
+        var cpuInfo: processor_info_array_t? = nil
+        var numCpuInfo: mach_msg_type_number_t = 0
         
-        let cpuInfo = hostCPULoadInfo()
-        if cpuInfo == nil {
+        let result: kern_return_t = host_processor_info(mach_host_self(), PROCESSOR_CPU_LOAD_INFO, &numCPUs, &cpuInfo, &numCpuInfo)
+        guard result == KERN_SUCCESS, let cpuInfo else {
+            error("host_processor_info(): \(String(cString: mach_error_string(result), encoding: String.Encoding.ascii) ?? "unknown error")", log: self.log)
             self.callback(nil)
             return
         }
         
-        let userDiff = Double(cpuInfo!.cpu_ticks.0 &- self.previousInfo.cpu_ticks.0)
-        let sysDiff  = Double(cpuInfo!.cpu_ticks.1 &- self.previousInfo.cpu_ticks.1)
-        let idleDiff = Double(cpuInfo!.cpu_ticks.2 &- self.previousInfo.cpu_ticks.2)
-        let niceDiff = Double(cpuInfo!.cpu_ticks.3 &- self.previousInfo.cpu_ticks.3)
-        let totalTicks = sysDiff + userDiff + niceDiff + idleDiff
+        // the counters are taken into the table, the array from the kernel is released right away
+        if self.table?.count != Int(numCPUs) {
+            self.table = CoreLoadTable(count: Int(numCPUs), cores: self.cores)
+        }
+        guard let table = self.table else { return }
+        table.update(UnsafeBufferPointer(start: cpuInfo, count: Int(numCpuInfo)))
+        vm_deallocate(mach_task_self_, vm_address_t(bitPattern: cpuInfo), vm_size_t(MemoryLayout<integer_t>.stride * Int(numCpuInfo)))
         
-        let system = sysDiff / totalTicks
-        let user = userDiff / totalTicks
-        let idle = idleDiff / totalTicks
+        let showHyperthratedCores = Store.shared.bool(key: "CPU_hyperhreading", defaultValue: false)
+        self.response.usagePerCore = showHyperthratedCores || !self.hasHyperthreadingCores ? table.usage : table.siblings
         
-        if !system.isNaN {
-            self.response.systemLoad  = system
-        }
-        if !user.isNaN {
-            self.response.userLoad = user
-        }
-        if !idle.isNaN {
-            self.response.idleLoad = idle
-        }
-        self.previousInfo = cpuInfo!
+        self.response.systemLoad = table.system
+        self.response.userLoad = table.user
+        self.response.idleLoad = table.idle
         self.response.totalUsage = self.response.systemLoad + self.response.userLoad
         
-        if let cores = self.cores {
-            let eCoresList: [Double] = cores.filter({ $0.type == .efficiency }).enumerated().compactMap { (i, c) -> Double? in
-                if self.response.usagePerCore.indices.contains(Int(c.id)) {
-                    return self.response.usagePerCore[Int(c.id)]
-                }
-                return i < self.usagePerCore.count ? self.usagePerCore[i] : 0
-            }
-            let pCoresList: [Double] = cores.filter({ $0.type == .performance }).enumerated().compactMap { (i, c) -> Double? in
-                if self.response.usagePerCore.indices.contains(Int(c.id)) {
-                    return self.response.usagePerCore[Int(c.id)]
-                }
-                return i < self.usagePerCore.count ? self.usagePerCore[i] : 0
-            }
-            let sCoresList: [Double] = cores.filter({ $0.type == .super }).enumerated().compactMap { (i, c) -> Double? in
-                if self.response.usagePerCore.indices.contains(Int(c.id)) {
-                    return self.response.usagePerCore[Int(c.id)]
-                }
-                return i < self.usagePerCore.count ? self.usagePerCore[i] : 0
-            }
-            
-            if !eCoresList.isEmpty {
-                self.response.usageECores = eCoresList.reduce(0, +)/Double(eCoresList.count)
-            }
-            if !pCoresList.isEmpty {
-                self.response.usagePCores = pCoresList.reduce(0, +)/Double(pCoresList.count)
-            }
-            if !sCoresList.isEmpty {
-                self.response.usageSCores = sCoresList.reduce(0, +)/Double(sCoresList.count)
-            }
-        }
+        self.response.usageECores = table.average(.efficiency)
+        self.response.usagePCores = table.average(.performance)
+        self.response.usageSCores = table.average(.super)
         
         self.callback(self.response)
     }
-    
-    private func hostCPULoadInfo() -> host_cpu_load_info? {
-        let count = MemoryLayout<host_cpu_load_info>.stride/MemoryLayout<integer_t>.stride
-        var size = mach_msg_type_number_t(count)
-        var cpuLoadInfo = host_cpu_load_info()
-        
-        let result: kern_return_t = withUnsafeMutablePointer(to: &cpuLoadInfo) {
-            $0.withMemoryRebound(to: integer_t.self, capacity: count) {
-                host_statistics(mach_host_self(), HOST_CPU_LOAD_INFO, $0, &size)
-            }
-        }
-        if result != KERN_SUCCESS {
-            error("kern_result_t: \(result)", log: self.log)
-            return nil
-        }
-        
-        return cpuLoadInfo
-    }
 }
 
 public class ProcessReader: Reader<[TopProcess]> {
@@ -314,7 +197,7 @@ public class FrequencyReader: Reader<CPU_Frequency> {
     
     private var channels: CFMutableDictionary? = nil
     private var subscription: IOReportSubscriptionRef? = nil
-    private var prev: (samples: CFDictionary, time: TimeInterval)? = nil
+    private var samples: IOReportSamples? = nil
     
     private let measurementCount: Int = 4
     private let isReadingQueue = DispatchQueue(label: "com.example.isReadingQueue")
@@ -325,12 +208,10 @@ public class FrequencyReader: Reader<CPU_Frequency> {
         set { self.isReadingQueue.sync { self._isReading = newValue } }
     }
     
-    private struct IOSample {
-        let group: String
-        let subGroup: String
-        let channel: String
-        let unit: String
-        let delta: CFDictionary
+    private enum Cluster: Int {
+        case eCore = 0
+        case pCore = 1
+        case sCore = 2
     }
     
     public override func setup() {
@@ -346,10 +227,12 @@ public class FrequencyReader: Reader<CPU_Frequency> {
         var dict: Unmanaged<CFMutableDictionary>?
         self.subscription = IOReportCreateSubscription(nil, self.channels, &dict, 0, nil)
         dict?.release()
+        self.samples = self.compile()
+        self.sample()
     }
     
     public override func read() {
-        guard !self.isReading, !self.eCoreFreqs.isEmpty || !self.pCoreFreqs.isEmpty || !self.sCoreFreqs.isEmpty, self.channels != nil, self.subscription != nil else { return }
+        guard !self.isReading, !self.eCoreFreqs.isEmpty || !self.pCoreFreqs.isEmpty || !self.sCoreFreqs.isEmpty, let samples = self.samples else { return }
         self.isReading = true
         let minECoreFreq = Double(self.eCoreFreqs.min() ?? 0)
         let minPCoreFreq = Double(self.pCoreFreqs.min() ?? 0)
@@ -360,34 +243,27 @@ public class FrequencyReader: Reader<CPU_Frequency> {
             var sCores: [Double] = []
             var pCores: [Double] = []
             
-            for (samples, _) in await self.getSamples() {
-                var eCore: [Double] = []
-                var pCore: [Double] = []
-                var sCore: [Double] = []
-                
-                for sample in samples {
-                    guard sample.group == "CPU Stats" else { continue }
-                    if sample.channel.contains("ECPU") {
-                        eCore.append(self.calculateFrequencies(dict: sample.delta, freqs: self.eCoreFreqs))
-                    }
-                    if sample.channel.contains(self.sCoreCount == 0 ? "PCPU" : "MCPU") {
-                        pCore.append(self.calculateFrequencies(dict: sample.delta, freqs: self.pCoreFreqs))
-                    }
-                    if self.sCoreCount != 0 {
-                        if sample.channel.contains("PCPU") {
-                            sCore.append(self.calculateFrequencies(dict: sample.delta, freqs: self.sCoreFreqs))
-                        }
+            let step = UInt64(500 / self.measurementCount) * 1_000_000
+            for _ in 0..<self.measurementCount {
+                do {
+                    try await Task.sleep(nanoseconds: step)
+                } catch {
+                    if Task.isCancelled {
+                        self.isReading = false
+                        return
                     }
+                    continue
                 }
+                guard self.sample() else { continue }
                 
-                if !eCore.isEmpty {
-                    eCores.append(max(eCore.reduce(0.0, +) / Double(eCore.count), minECoreFreq))
+                if let freq = samples.frequency(group: Cluster.eCore.rawValue, frequencies: self.eCoreFreqs) {
+                    eCores.append(max(freq, minECoreFreq))
                 }
-                if !pCore.isEmpty {
-                    pCores.append(max(pCore.reduce(0.0, +) / Double(pCore.count), minPCoreFreq))
+                if let freq = samples.frequency(group: Cluster.pCore.rawValue, frequencies: self.pCoreFreqs) {
+                    pCores.append(max(freq, minPCoreFreq))
                 }
-                if !sCore.isEmpty {
-                    sCores.append(max(sCore.reduce(0.0, +) / Double(sCore.count), minSCoreFreq))
+                if let freq = samples.frequency(group: Cluster.sCore.rawValue, frequencies: self.sCoreFreqs) {
+                    sCores.append(max(freq, minSCoreFreq))
                 }
             }
             
@@ -417,36 +293,6 @@ public class FrequencyReader: Reader<CPU_Frequency> {
         }
     }
     
-    private func calculateFrequencies(dict: CFDictionary, freqs: [Int32]) -> Double {
-        let items = self.getResidencies(dict: dict)
-        guard let offset = items.firstIndex(where: { $0.0 != "IDLE" && $0.0 != "DOWN" && $0.0 != "OFF" }) else { return 0 }
-        let usage = items.dropFirst(offset).reduce(0.0) { $0 + Double($1.f) }
-        let count = freqs.count
-        var avgFreq: Double = 0
-        
-        for i in 0..<count {
-            let key = i + offset
-            if !items.indices.contains(key) { continue }
-            let percent = usage == 0 ? 0 : Double(items[key].f) / usage
-            avgFreq += percent * Double(freqs[i])
-        }
-        
-        return avgFreq
-    }
-    
-    func getResidencies(dict: CFDictionary) -> [(ns: String, f: Int64)] {
-        let count = IOReportStateGetCount(dict)
-        var res: [(String, Int64)] = []
-        
-        for i in 0..<count {
-            let name = IOReportStateGetNameForIndex(dict, i)?.takeUnretainedValue() ?? ("" as CFString)
-            let val = IOReportStateGetResidency(dict, i)
-            res.append((name as String, val))
-        }
-        
-        return res
-    }
-    
     private func getChannels() -> CFMutableDictionary? {
         let channelNames = [
             ("CPU Stats", "CPU Complex Performance States"),
@@ -474,66 +320,68 @@ public class FrequencyReader: Reader<CPU_Frequency> {
         return channel
     }
     
-    private func getSamples() async -> [([IOSample], TimeInterval)] {
-        let duration = 500
-        let step = UInt64(duration / self.measurementCount)
-        var samples = [([IOSample], TimeInterval)]()
-        guard let initialSample = self.getSample() else { return samples }
-        var prev = self.prev ?? initialSample
-        
-        for _ in 0..<self.measurementCount {
-            let milliseconds = UInt64(step) * 1_000_000
-            do {
-                try await Task.sleep(nanoseconds: milliseconds)
-            } catch {
-                if Task.isCancelled { return [] }
+    // resolves every channel to its cluster and the index of the first active state once, so the samples are only copied into flat arrays afterward
+    private func compile() -> IOReportSamples? {
+        guard let sample = IOReportCreateSamples(self.subscription, self.channels, nil)?.takeRetainedValue(),
+              let items = IOReportSamples.channels(sample) else {
+            return nil
+        }
+        
+        let count = CFArrayGetCount(items)
+        var groups: [Int] = Array(repeating: -1, count: count)
+        var counts: [Int] = Array(repeating: 0, count: count)
+        var active: [Int] = Array(repeating: 0, count: count)
+        
+        for i in 0..<count {
+            let item = IOReportSamples.channel(items, i)
+            guard let group = IOReportChannelGetGroup(item)?.takeUnretainedValue() as? String, group == "CPU Stats",
+                  let channel = IOReportChannelGetChannelName(item)?.takeUnretainedValue() as? String else { continue }
+            
+            if channel.contains("ECPU") {
+                groups[i] = Cluster.eCore.rawValue
+            } else if channel.contains(self.sCoreCount == 0 ? "PCPU" : "MCPU") {
+                groups[i] = Cluster.pCore.rawValue
+            } else if self.sCoreCount != 0 && channel.contains("PCPU") {
+                groups[i] = Cluster.sCore.rawValue
+            } else {
                 continue
             }
             
-            guard let next = self.getSample() else { continue }
-            
-            if let diffCF = IOReportCreateSamplesDelta(prev.samples, next.samples, nil) {
-                let diff = diffCF.takeRetainedValue()
-                let elapsed = next.time - prev.time
-                samples.append((self.collectIOSamples(data: diff), max(elapsed, TimeInterval(1))))
+            let states = Int(IOReportStateGetCount(item))
+            counts[i] = states
+            active[i] = states
+            for s in 0..<states {
+                let name = IOReportStateGetNameForIndex(item, Int32(s))?.takeUnretainedValue() as? String ?? ""
+                if name != "IDLE" && name != "DOWN" && name != "OFF" {
+                    active[i] = s
+                    break
+                }
             }
-            prev = next
         }
         
-        self.prev = prev
-        return samples
+        let slots = IOReportSamples.layout(groups: groups, counts: counts, active: active)
+        return slots.isEmpty ? nil : IOReportSamples(slots: slots)
     }
     
-    private func getSample() -> (samples: CFDictionary, time: TimeInterval)? {
-        guard let sample = IOReportCreateSamples(self.subscription, self.channels, nil)?.takeRetainedValue() else {
-            return nil
-        }
-        return (sample, Date().timeIntervalSince1970)
-    }
-    
-    private func collectIOSamples(data: CFDictionary) -> [IOSample] {
-        guard let dict = data as? [String: Any],
-              let channelsList = dict["IOReportChannels"] as? NSArray else {
-            return []
-        }
-        let items = channelsList as CFArray
-        let itemSize = CFArrayGetCount(items)
-        
-        var samples = [IOSample]()
-        
-        for index in 0..<itemSize {
-            let dict = CFArrayGetValueAtIndex(items, index)
-            let item = unsafeBitCast(dict, to: CFDictionary.self)
-            
-            let group = IOReportChannelGetGroup(item)?.takeUnretainedValue() ?? ("" as CFString)
-            let subGroup = IOReportChannelGetSubGroup(item)?.takeUnretainedValue() ?? ("" as CFString)
-            let channel = IOReportChannelGetChannelName(item)?.takeUnretainedValue() ?? ("" as CFString)
-            let unit = IOReportChannelGetUnitLabel(item)?.takeUnretainedValue() ?? ("" as CFString)
-            
-            samples.append(IOSample(group: group as String, subGroup: subGroup as String, channel: channel as String, unit: unit as String, delta: item))
+    @discardableResult
+    private func sample() -> Bool {
+        guard let samples = self.samples,
+              let sample = IOReportCreateSamples(self.subscription, self.channels, nil)?.takeRetainedValue(),
+              let items = IOReportSamples.channels(sample) else {
+            return false
+        }
+        let count = CFArrayGetCount(items)
+        
+        samples.write { values in
+            for slot in samples.slots where slot.channel < count {
+                let item = IOReportSamples.channel(items, slot.channel)
+                for s in 0..<slot.count {
+                    values[slot.offset + s] = Double(IOReportStateGetResidency(item, Int32(s)))
+                }
+            }
         }
         
-        return samples
+        return samples.commit(time: ProcessInfo.processInfo.systemUptime)
     }
 }
 
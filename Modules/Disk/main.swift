@@ -35,6 +35,22 @@ public struct smart_t: Codable {
     var mediaErrors: Int64? = nil
 }
 
+extension smart_t {
+    init(_ values: SMARTValues) {
+        self.temperature = values.temperature
+        self.life = values.life
+        self.totalRead = values.totalRead
+        self.totalWritten = values.totalWritten
+        self.powerCycles = values.powerCycles
+        self.powerOnHours = values.powerOnHours
+        self.criticalWarning = values.criticalWarning
+        self.availableSpare = values.availableSpare
+        self.spareThreshold = values.spareThreshold
+        self.unsafeShutdowns = values.unsafeShutdowns
+        self.mediaErrors = values.mediaErrors
+    }
+}
+
 internal func smartCriticalWarnings(_ value: Int) -> [String] {
     var list: [String] = []
     if value & 0x01 != 0 { list.append(localizedString("Spare below threshold")) }
@@ -90,7 +106,7 @@ public struct drive: Codable {
     }
 }
 
-public class Disks: Codable, RemoteType {
+public class Disks: Codable, RemoteType, OpenMetricsType {
     private var queue: DispatchQueue = DispatchQueue(label: "eu.exelban.Stats.Disk.SynchronizedArray")
     private var _array: [drive] = []
     public var array: [drive] {
@@ -160,19 +176,6 @@ public class Disks: Codable, RemoteType {
         self.array[idx].free = newValue
     }
     
-    func updateReadWrite(_ idx: Int, read: Int64, write: Int64) {
-        self.array[idx].activity.readBytes = read
-        self.array[idx].activity.writeBytes = write
-    }
-    
-    func updateRead(_ idx: Int, newValue: Int64) {
-        self.array[idx].activity.read = newValue
-    }
-    
-    func updateWrite(_ idx: Int, newValue: Int64) {
-        self.array[idx].activity.write = newValue
-    }
-    
     func updateSMARTData(_ idx: Int, smart: smart_t?) {
         self.array[idx].smart = smart
     }
@@ -189,6 +192,20 @@ public class Disks: Codable, RemoteType {
         string += "$"
         return string.data(using: .utf8)
     }
+    
+    public func openMetrics() -> [OpenMetric] {
+        var list: [OpenMetric] = []
+        for d in self.array {
+            let labels = [("disk", d.BSDName), ("name", d.mediaName)]
+            list.append(OpenMetric("stats_disk_size_bytes", Double(d.size), unit: "bytes", help: "Disk size", labels: labels))
+            list.append(OpenMetric("stats_disk_free_bytes", Double(d.free), unit: "bytes", help: "Free disk space", labels: labels))
+            list.append(OpenMetric("stats_disk_speed_bytes_per_second", Double(d.activity.read), unit: "bytes_per_second", help: "Bytes per second", labels: labels + [("direction", "read")]))
+            list.append(OpenMetric("stats_disk_speed_bytes_per_second", Double(d.activity.write), unit: "bytes_per_second", help: "Bytes per second", labels: labels + [("direction", "write")]))
+            list.append(OpenMetric("stats_disk_transferred_bytes", Double(d.activity.readBytes), type: .counter, unit: "bytes", help: "Bytes transferred", labels: labels + [("direction", "read")]))
+            list.append(OpenMetric("stats_disk_transferred_bytes", Double(d.activity.writeBytes), type: .counter, unit: "bytes", help: "Bytes transferred", labels: labels + [("direction", "write")]))
+        }
+        return list
+    }
 }
 
 public struct Disk_process: Process_p, Codable {
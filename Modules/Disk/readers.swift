@@ -55,134 +55,153 @@ internal class CapacityReader: Reader<Disks> {
         Store.shared.bool(key: "\(ModuleType.disk.stringValue)_ATASMART", defaultValue: false)
     }
     
+    private var session: DASession? = nil
+    private var mounts: [statfs] = []
+    // mounts rejected by driveDetails (removable, recovery), they are not resolved again until remounted
+    private var ignored: Set<String> = []
+    private var removableState: Bool = false
     private var purgableSpace: [URL: (Date, Int64)] = [:]
+    
+    // SMART is read on its own queue, the reader takes the cached value
+    private let smartQueue = DispatchQueue(label: "eu.exelban.Disk.SMART", qos: .utility)
+    private let smartCache = SMARTCache<smart_t>(ttl: 600)
     private var smartTotals: [String: (read: Int64, written: Int64)] = [:]
     private var smartEnableAttempted: Set<String> = []
     
     public override func read() {
-        let keys: [URLResourceKey] = [.volumeNameKey]
         let removableState = Store.shared.bool(key: "Disk_removable", defaultValue: false)
-        guard let paths = FileManager.default.mountedVolumeURLs(includingResourceValuesForKeys: keys, options: [.skipHiddenVolumes]) else {
-            return
+        if removableState != self.removableState {
+            self.removableState = removableState
+            self.ignored.removeAll()
         }
         
-        guard let session = DASessionCreate(kCFAllocatorDefault) else {
-            error("cannot create main DASessionCreate()", log: self.log)
-            return
+        // one getfsstat call lists every mounted file system. MNT_NOWAIT returns the statistics cached
+        // by the kernel, so only the list is taken from it and the space is read with statfs per volume
+        let count = getfsstat(nil, 0, MNT_NOWAIT)
+        guard count > 0 else { return }
+        if self.mounts.count < Int(count) {
+            self.mounts = [statfs](repeating: statfs(), count: Int(count) + 4)
         }
+        let total = self.mounts.withUnsafeMutableBufferPointer {
+            getfsstat($0.baseAddress, Int32(MemoryLayout<statfs>.stride * $0.count), MNT_NOWAIT)
+        }
+        guard total > 0 else { return }
         
         var active: [String] = []
-        for url in paths {
-            if url.pathComponents.count == 1 || (url.pathComponents.count > 1 && url.pathComponents[1] == "Volumes") {
-                if let disk = DADiskCreateFromVolumePath(kCFAllocatorDefault, session, url as CFURL) {
-                    if let diskName = DADiskGetBSDName(disk) {
-                        let BSDName: String = String(cString: diskName)
-                        active.append(BSDName)
-                        
-                        if let d = self.list.first(where: { $0.BSDName == BSDName}), let idx = self.list.index(where: { $0.BSDName == BSDName}) {
-                            if d.removable && !removableState {
-                                if d.parent != 0 { IOObjectRelease(d.parent) }
-                                if let path = d.path { self.purgableSpace.removeValue(forKey: path) }
-                                self.list.remove(at: idx)
-                                continue
-                            }
-                            
-                            if driveIdentityChanged(d, url, disk) {
-                                if d.parent != 0 { IOObjectRelease(d.parent) }
-                                if let path = d.path { self.purgableSpace.removeValue(forKey: path) }
-                                self.list.remove(at: idx)
-                            } else {
-                                if let path = d.path {
-                                    self.list.updateFreeSize(idx, newValue: self.diskSpaceInBytes(path, fileSystem: d.fileSystem).free)
-                                    self.list.updateSMARTData(idx, smart: self.getSMARTDetails(for: BSDName))
-                                }
-                                continue
-                            }
-                        }
-                        
-                        if var d = driveDetails(disk, removableState: removableState) {
-                            if let path = d.path {
-                                let space = self.diskSpaceInBytes(path, fileSystem: d.fileSystem)
-                                d.free = space.free
-                                d.size = space.total
-                            }
-                            d.smart = self.getSMARTDetails(for: BSDName)
-                            guard d.size != 0 else {
-                                if d.parent != 0 { IOObjectRelease(d.parent) }
-                                continue
-                            }
-                            self.list.append(d)
-                            self.list.sort()
-                        }
+        var seen: Set<String> = []
+        for i in 0..<min(Int(total), self.mounts.count) {
+            var stat = self.mounts[i]
+            // the volumes listed by mountedVolumeURLs with skipHiddenVolumes: the root and /Volumes
+            guard stat.f_flags & UInt32(MNT_DONTBROWSE) == 0 else { continue }
+            let path = fsString(stat.f_mntonname)
+            let components = path.split(separator: "/")
+            guard path == "/" || components.first == "Volumes" else { continue }
+            let device = fsString(stat.f_mntfromname)
+            guard device.hasPrefix("/dev/") else { continue }
+            guard statfs(path, &stat) == 0 else { continue }
+            let BSDName = String(device.dropFirst(5))
+            let fileSystem = fsString(stat.f_fstypename)
+            let url = URL(fileURLWithPath: path, isDirectory: true)
+            let key = "\(BSDName)@\(path)"
+            seen.insert(key)
+            
+            if let idx = self.list.index(where: { $0.BSDName == BSDName }) {
+                let d = self.list.array[idx]
+                if d.path?.path == url.path && d.fileSystem == fileSystem && (!d.removable || removableState) {
+                    active.append(BSDName)
+                    if let path = d.path {
+                        self.list.updateFreeSize(idx, newValue: self.diskSpaceInBytes(stat, path: path, fileSystem: fileSystem).free)
                     }
+                    self.list.updateSMARTData(idx, smart: self.smart(for: BSDName))
+                    continue
+                }
+                self.remove(idx)
+                if d.removable && !removableState {
+                    continue
                 }
             }
+            
+            guard !self.ignored.contains(key) else { continue }
+            if self.session == nil {
+                self.session = DASessionCreate(kCFAllocatorDefault)
+            }
+            guard let session = self.session else {
+                error("cannot create main DASessionCreate()", log: self.log)
+                return
+            }
+            guard let disk = DADiskCreateFromBSDName(kCFAllocatorDefault, session, BSDName),
+                  var d = driveDetails(disk, removableState: removableState) else {
+                self.ignored.insert(key)
+                continue
+            }
+            active.append(BSDName)
+            if let path = d.path {
+                let space = self.diskSpaceInBytes(stat, path: path, fileSystem: fileSystem)
+                d.free = space.free
+                d.size = space.total
+            }
+            d.smart = self.smart(for: BSDName)
+            guard d.size != 0 else {
+                if d.parent != 0 { IOObjectRelease(d.parent) }
+                continue
+            }
+            self.list.append(d)
+            self.list.sort()
         }
         
-        active.difference(from: self.list.map{ $0.BSDName }).forEach { (BSDName: String) in
+        self.ignored.formIntersection(seen)
+        for BSDName in self.list.map({ $0.BSDName }) where !active.contains(BSDName) {
             if let idx = self.list.index(where: { $0.BSDName == BSDName }) {
-                let d = self.list.array[idx]
-                if d.parent != 0 { IOObjectRelease(d.parent) }
-                if let path = d.path { self.purgableSpace.removeValue(forKey: path) }
-                self.list.remove(at: idx)
+                self.remove(idx)
             }
         }
         
         self.callback(self.list)
-        
     }
-    private func diskSpaceInBytes(_ path: URL, fileSystem: String) -> (total: Int64, free: Int64) {
-        var path = path
-        path.removeAllCachedResourceValues()
-        
-        var stat = statfs()
-        if statfs(path.path, &stat) == 0 {
-            let total = Int64(stat.f_blocks) * Int64(stat.f_bsize)
-            let available = Int64(stat.f_bavail) * Int64(stat.f_bsize)
-            let used = total - available
-            
-            var purgeable: Int64 = 0
-            if fileSystem == "apfs" {
-                if let pair = self.purgableSpace[path], Date().timeIntervalSince(pair.0) <= 60 {
-                    purgeable = pair.1
-                } else {
-                    let value = CSDiskSpaceGetRecoveryEstimate(path as NSURL)
-                    if used > 0 && value <= UInt64(used) {
-                        purgeable = Int64(value)
-                    }
-                    self.purgableSpace[path] = (Date(), purgeable)
+    
+    private func remove(_ idx: Int) {
+        let d = self.list.array[idx]
+        if d.parent != 0 { IOObjectRelease(d.parent) }
+        if let path = d.path { self.purgableSpace.removeValue(forKey: path) }
+        self.smartCache.remove(d.BSDName)
+        self.list.remove(at: idx)
+    }
+    
+    private func diskSpaceInBytes(_ stat: statfs, path: URL, fileSystem: String) -> (total: Int64, free: Int64) {
+        let total = Int64(stat.f_blocks) * Int64(stat.f_bsize)
+        let available = Int64(stat.f_bavail) * Int64(stat.f_bsize)
+        let used = total - available
+        
+        var purgeable: Int64 = 0
+        if fileSystem == "apfs" {
+            if let pair = self.purgableSpace[path], Date().timeIntervalSince(pair.0) <= 60 {
+                purgeable = pair.1
+            } else {
+                let value = CSDiskSpaceGetRecoveryEstimate(path as NSURL)
+                if used > 0 && value <= UInt64(used) {
+                    purgeable = Int64(value)
                 }
+                self.purgableSpace[path] = (Date(), purgeable)
             }
-            
-            return (total, available + purgeable)
-        }
-        
-        var total: Int64 = 0
-        var free: Int64 = 0
-        
-        do {
-            let systemAttributes = try FileManager.default.attributesOfFileSystem(forPath: path.path)
-            total = (systemAttributes[FileAttributeKey.systemSize] as? NSNumber)?.int64Value ?? 0
-            free = (systemAttributes[FileAttributeKey.systemFreeSize] as? NSNumber)?.int64Value ?? 0
-        } catch let err {
-            error("error retrieving disk space: \(err.localizedDescription)", log: self.log)
         }
         
-        do {
-            let values = try path.resourceValues(forKeys: [.volumeAvailableCapacityForImportantUsageKey])
-            if let capacity = values.volumeAvailableCapacityForImportantUsage, capacity != 0 {
-                free = capacity
+        return (total, available + purgeable)
+    }
+    
+    // the cached SMART values, an expired or missing entry is refreshed in the background
+    private func smart(for BSDName: String) -> smart_t? {
+        guard self.SMART else { return nil }
+        let (value, refresh) = self.smartCache.get(BSDName)
+        if refresh {
+            let ATASMART = self.ATASMART
+            self.smartQueue.async {
+                self.smartCache.set(BSDName, self.getSMARTDetails(for: BSDName, ATASMART: ATASMART))
             }
-        } catch let err {
-            error("error retrieving free space: \(err.localizedDescription)", log: self.log)
         }
-        
-        return (total, free)
+        return value
     }
     
-    private func getSMARTDetails(for BSDName: String) -> smart_t? {
-        guard self.SMART else { return nil }
-        
+    private func getSMARTDetails(for BSDName: String, ATASMART: Bool) -> smart_t? {
         var disk = IOServiceGetMatchingService(kIOMainPortDefault, IOBSDNameMatching(kIOMainPortDefault, 0, BSDName.cString(using: .utf8)))
         guard disk != kIOReturnSuccess else { return nil }
         defer { IOObjectRelease(disk) }
@@ -198,7 +217,7 @@ internal class CapacityReader: Reader<Disks> {
         guard IOObjectConformsTo(disk, kIOBlockStorageDeviceClass) > 0 else { return nil }
         
         if let smart = self.getNVMeSMART(for: disk) { return smart }
-        if self.ATASMART, let smart = self.getATASMART(for: disk, BSDName: BSDName) { return smart }
+        if ATASMART, let smart = self.getATASMART(for: disk, BSDName: BSDName) { return smart }
         return nil
     }
     
@@ -237,33 +256,7 @@ internal class CapacityReader: Reader<Disks> {
         var smartData: nvme_smart_log = nvme_smart_log()
         guard smart.pointee.SMARTReadData(smartInterface, &smartData) == kIOReturnSuccess else { return nil }
         
-        let temperatures: [UInt8] = [UInt8(smartData.temperature.1), UInt8(smartData.temperature.0)]
-        var temperature: UInt16 = 0
-        let data = NSData(bytes: temperatures, length: 2)
-        data.getBytes(&temperature, length: 2)
-        
-        let dataUnitsRead = self.extractUInt128(smartData.data_units_read)
-        let dataUnitsWritten = self.extractUInt128(smartData.data_units_written)
-        let bytesPerDataUnit: Int64 = 512 * 1000
-        
-        let powerCycles = withUnsafeBytes(of: smartData.power_cycles) { $0.load(as: UInt32.self) }
-        let powerOnHours = withUnsafeBytes(of: smartData.power_on_hours) { $0.load(as: UInt32.self) }
-        let unsafeShutdowns = withUnsafeBytes(of: smartData.unsafe_shutdowns) { $0.load(as: UInt32.self) }
-        let mediaErrors = withUnsafeBytes(of: smartData.media_errors) { $0.load(as: UInt32.self) }
-        
-        return smart_t(
-            temperature: Int(UInt16(bigEndian: temperature) - 273),
-            life: 100 - Int(smartData.percent_used),
-            totalRead: dataUnitsRead * bytesPerDataUnit,
-            totalWritten: dataUnitsWritten * bytesPerDataUnit,
-            powerCycles: Int(powerCycles),
-            powerOnHours: Int(powerOnHours),
-            criticalWarning: Int(smartData.critical_warning),
-            availableSpare: Int(smartData.avail_spare),
-            spareThreshold: Int(smartData.spare_thresh),
-            unsafeShutdowns: Int(unsafeShutdowns),
-            mediaErrors: Int64(mediaErrors)
-        )
+        return withUnsafeBytes(of: &smartData) { SMARTLog.nvme($0) }.map{ smart_t($0) }
     }
     
     private func getATASMART(for disk: io_object_t, BSDName: String) -> smart_t? {
@@ -308,223 +301,173 @@ internal class CapacityReader: Reader<Disks> {
         }
         guard readResult == kIOReturnSuccess else { return nil }
         
-        var attributes: [Int: (current: Int, raw: [UInt8])] = [:]
-        withUnsafeBytes(of: &smartData) { buffer in
-            for i in 0..<30 {
-                let offset = 2 + i * 12
-                let id = Int(buffer[offset])
-                if id == 0 { continue }
-                let current = Int(buffer[offset + 3])
-                var rawBytes: [UInt8] = []
-                for j in 0..<6 {
-                    rawBytes.append(buffer[offset + 5 + j])
-                }
-                attributes[id] = (current, rawBytes)
-            }
-        }
-        
-        func rawValue(_ id: Int, bytes count: Int = 6) -> UInt64? {
-            guard let attribute = attributes[id] else { return nil }
-            var value: UInt64 = 0
-            for i in 0..<min(count, attribute.raw.count) {
-                value |= UInt64(attribute.raw[i]) << (8 * i)
-            }
-            return value
-        }
-        
-        var temperature = 0
-        if let temp = rawValue(194, bytes: 1) ?? rawValue(190, bytes: 1) {
-            temperature = Int(temp)
-        }
-        
-        var life = 100
-        for id in [231, 202, 177, 173, 169, 233] {
-            if let attribute = attributes[id] {
-                life = min(max(attribute.current, 0), 100)
-                break
-            }
-        }
-        
-        let bytesPerLBA: Int64 = 512
-        
-        var deviceRead: Int64?
-        var deviceWritten: Int64?
-        
-        let pageCount = 8
-        let logSize = 512 * pageCount
+        // device statistics log, pages 0-7
+        let logSize = 512 * 8
         var logBuffer = [UInt8](repeating: 0, count: logSize)
         let logResult = logBuffer.withUnsafeMutableBytes {
             smart.pointee.SMARTReadLogAtAddress(smartInterface, 0x04, $0.baseAddress, UInt32(logSize))
         }
-        if logResult == kIOReturnSuccess {
-            func deviceStatistic(page: Int, offset: Int) -> UInt64? {
-                let base = page * 512 + offset
-                guard base + 8 <= logBuffer.count else { return nil }
-                var value: UInt64 = 0
-                for i in 0..<8 {
-                    value |= UInt64(logBuffer[base + i]) << (8 * i)
-                }
-                guard (value & (UInt64(1) << 63)) != 0, (value & (UInt64(1) << 62)) != 0 else { return nil }
-                return value & 0x0000_FFFF_FFFF_FFFF
-            }
-            
-            if let written = deviceStatistic(page: 1, offset: 0x18) {
-                let (bytes, overflow) = Int64(written).multipliedReportingOverflow(by: bytesPerLBA)
-                if !overflow {
-                    deviceWritten = bytes
-                }
-            }
-            if let read = deviceStatistic(page: 1, offset: 0x28) {
-                let (bytes, overflow) = Int64(read).multipliedReportingOverflow(by: bytesPerLBA)
-                if !overflow {
-                    deviceRead = bytes
-                }
-            }
-            if let used = deviceStatistic(page: 7, offset: 0x08) {
-                life = max(0, 100 - Int(used & 0xFF))
+        
+        let decoded = withUnsafeBytes(of: &smartData) { data in
+            logBuffer.withUnsafeBytes { log in
+                SMARTLog.ata(data, statistics: logResult == kIOReturnSuccess ? log : nil)
             }
         }
+        guard let decoded else { return nil }
         
-        if deviceRead != nil || deviceWritten != nil {
+        // the statistics are not always returned, the last totals are kept instead of the attributes
+        var values = decoded.values
+        if decoded.read != nil || decoded.written != nil {
             let cached = self.smartTotals[BSDName]
             self.smartTotals[BSDName] = (
-                read: deviceRead ?? cached?.read ?? 0,
-                written: deviceWritten ?? cached?.written ?? 0
+                read: decoded.read ?? cached?.read ?? 0,
+                written: decoded.written ?? cached?.written ?? 0
             )
         }
-        
-        let totalRead = deviceRead ?? self.smartTotals[BSDName]?.read ?? Int64(rawValue(242) ?? 0) * bytesPerLBA
-        let totalWritten = deviceWritten ?? self.smartTotals[BSDName]?.written ?? Int64(rawValue(241) ?? 0) * bytesPerLBA
-        
-        let errorCounts = [rawValue(5), rawValue(197), rawValue(198)].compactMap({ $0 })
-        
-        return smart_t(
-            temperature: temperature,
-            life: life,
-            totalRead: totalRead,
-            totalWritten: totalWritten,
-            powerCycles: Int(rawValue(12, bytes: 4) ?? 0),
-            powerOnHours: Int(rawValue(9, bytes: 4) ?? 0),
-            unsafeShutdowns: rawValue(174, bytes: 4).map({ Int($0) }),
-            mediaErrors: errorCounts.isEmpty ? nil : Int64(errorCounts.reduce(0, +))
-        )
-    }
-    
-    private func extractUInt128(_ tuple: (UInt8, UInt8, UInt8, UInt8, UInt8, UInt8, UInt8, UInt8, UInt8, UInt8, UInt8, UInt8, UInt8, UInt8, UInt8, UInt8)) -> Int64 {
-        let byteArray: [UInt8] = [
-            tuple.0, tuple.1, tuple.2, tuple.3, tuple.4, tuple.5, tuple.6, tuple.7,
-            tuple.8, tuple.9, tuple.10, tuple.11, tuple.12, tuple.13, tuple.14, tuple.15
-        ]
-        
-        let uint64Value = byteArray.prefix(8).withUnsafeBytes { $0.load(as: UInt64.self) }
-        let hasHigherBytes = byteArray.suffix(8).contains(where: { $0 != 0 })
-        
-        if hasHigherBytes || uint64Value > UInt64(Int64.max) {
-            return Int64.max
+        if let cached = self.smartTotals[BSDName] {
+            values.totalRead = decoded.read ?? cached.read
+            values.totalWritten = decoded.written ?? cached.written
         }
         
-        return Int64(uint64Value)
+        return smart_t(values)
     }
 }
 
 internal class ActivityReader: Reader<Disks> {
     internal var list: Disks = Disks()
     
+    // drives follow the DiskArbitration events, the registry entry with the statistics is kept per drive
+    private let queue = DispatchQueue(label: "eu.exelban.Disk.topology")
+    private let topology = DiskTopology<drive>()
+    private var session: DASession? = nil
+    private var removableState: Bool = false
+    private var generation: Int = -1
+    private var order: [Int] = []
+    
     override func setup() {
         self.setInterval(1)
+        self.queue.async {
+            self.removableState = Store.shared.bool(key: "Disk_removable", defaultValue: false)
+            self.startSession()
+        }
+    }
+    
+    public override func terminate() {
+        self.queue.sync {
+            self.stopSession()
+            self.topology.removeAll().forEach{ if $0.parent != 0 { IOObjectRelease($0.parent) } }
+        }
     }
     
     public override func read() {
-        let keys: [URLResourceKey] = [.volumeNameKey]
         let removableState = Store.shared.bool(key: "Disk_removable", defaultValue: false)
-        guard let paths = FileManager.default.mountedVolumeURLs(includingResourceValuesForKeys: keys) else {
-            return
-        }
-        
-        guard let session = DASessionCreate(kCFAllocatorDefault) else {
-            error("cannot create a DASessionCreate()", log: self.log)
-            return
-        }
         
-        var active: [String] = []
-        for url in paths {
-            if url.pathComponents.count == 1 || (url.pathComponents.count > 1 && url.pathComponents[1] == "Volumes") {
-                if let disk = DADiskCreateFromVolumePath(kCFAllocatorDefault, session, url as CFURL) {
-                    if let diskName = DADiskGetBSDName(disk) {
-                        let BSDName: String = String(cString: diskName)
-                        active.append(BSDName)
-                        
-                        if let d = self.list.first(where: { $0.BSDName == BSDName}), let idx = self.list.index(where: { $0.BSDName == BSDName}) {
-                            if d.removable && !removableState {
-                                if d.parent != 0 { IOObjectRelease(d.parent) }
-                                self.list.remove(at: idx)
-                                continue
-                            }
-                            
-                            if driveIdentityChanged(d, url, disk) {
-                                if d.parent != 0 { IOObjectRelease(d.parent) }
-                                self.list.remove(at: idx)
-                            } else {
-                                self.driveStats(idx, d)
-                                continue
-                            }
-                        }
-                        
-                        if let d = driveDetails(disk, removableState: removableState) {
-                            self.list.append(d)
-                            self.list.sort()
-                        }
-                    }
+        let drives: [drive] = self.queue.sync {
+            if self.session == nil || removableState != self.removableState {
+                self.removableState = removableState
+                self.startSession()
+            }
+            
+            self.topology.tick { d in
+                guard d.parent != 0, let statistics = IORegistryEntryCreateCFProperty(d.parent, "Statistics" as CFString, kCFAllocatorDefault, 0)?.takeRetainedValue() as? NSDictionary else {
+                    return nil
                 }
+                return DiskCounters(
+                    read: statistics.object(forKey: "Bytes (Read)") as? Int64 ?? 0,
+                    write: statistics.object(forKey: "Bytes (Write)") as? Int64 ?? 0
+                )
             }
-        }
-        
-        active.difference(from: self.list.map{ $0.BSDName }).forEach { (BSDName: String) in
-            if let idx = self.list.index(where: { $0.BSDName == BSDName }) {
-                let parent = self.list.array[idx].parent
-                if parent != 0 { IOObjectRelease(parent) }
-                self.list.remove(at: idx)
+            
+            // removable drives go last, the order changes only with the topology
+            if self.generation != self.topology.generation {
+                self.generation = self.topology.generation
+                let drives = self.topology.drives
+                self.order = drives.indices.filter{ !drives[$0].handle.removable } + drives.indices.filter{ drives[$0].handle.removable }
             }
+            
+            var list: [drive] = []
+            list.reserveCapacity(self.order.count)
+            for i in self.order {
+                let entry = self.topology.drives[i]
+                var d = entry.handle
+                if let counters = entry.counters {
+                    d.activity.read = entry.delta.read
+                    d.activity.write = entry.delta.write
+                    d.activity.readBytes = counters.read
+                    d.activity.writeBytes = counters.write
+                }
+                list.append(d)
+            }
+            return list
         }
         
+        // the session reports the disks asynchronously after it starts
+        guard !drives.isEmpty else { return }
+        self.list.array = drives
         self.callback(self.list)
     }
     
-    private func driveStats(_ idx: Int, _ d: drive) {
-        let service = IOServiceGetMatchingService(kIOMainPortDefault, IOBSDNameMatching(kIOMainPortDefault, 0, d.BSDName))
-        if service == 0 { return }
-        IOObjectRelease(service)
-        
-        guard let props = getIOProperties(d.parent) else { return }
+    // a new session reports every present disk as appeared, so it is also used to rescan
+    private func startSession() {
+        self.stopSession()
+        self.topology.removeAll().forEach{ if $0.parent != 0 { IOObjectRelease($0.parent) } }
         
-        if let statistics = props.object(forKey: "Statistics") as? NSDictionary {
-            let readBytes = statistics.object(forKey: "Bytes (Read)") as? Int64 ?? 0
-            let writeBytes = statistics.object(forKey: "Bytes (Write)") as? Int64 ?? 0
-            
-            if d.activity.readBytes != 0 {
-                self.list.updateRead(idx, newValue: readBytes - d.activity.readBytes)
-            }
-            if d.activity.writeBytes != 0 {
-                self.list.updateWrite(idx, newValue: writeBytes - d.activity.writeBytes)
-            }
-            
-            self.list.updateReadWrite(idx, read: readBytes, write: writeBytes)
+        guard let session = DASessionCreate(kCFAllocatorDefault) else {
+            error("cannot create a DASessionCreate()", log: self.log)
+            return
         }
-        
-        return
+        let context = Unmanaged.passUnretained(self).toOpaque()
+        let match = kDADiskDescriptionMatchVolumeMountable.takeUnretainedValue()
+        
+        DARegisterDiskAppearedCallback(session, match, { disk, context in
+            guard let context else { return }
+            Unmanaged<ActivityReader>.fromOpaque(context).takeUnretainedValue().diskAppeared(disk)
+        }, context)
+        DARegisterDiskDisappearedCallback(session, match, { disk, context in
+            guard let context else { return }
+            Unmanaged<ActivityReader>.fromOpaque(context).takeUnretainedValue().diskDisappeared(disk)
+        }, context)
+        DARegisterDiskDescriptionChangedCallback(session, match, [kDADiskDescriptionVolumePathKey] as CFArray, { disk, _, context in
+            guard let context else { return }
+            let reader = Unmanaged<ActivityReader>.fromOpaque(context).takeUnretainedValue()
+            reader.diskDisappeared(disk)
+            reader.diskAppeared(disk)
+        }, context)
+        DASessionSetDispatchQueue(session, self.queue)
+        self.session = session
     }
-}
-
-private func driveIdentityChanged(_ d: drive, _ url: URL, _ disk: DADisk) -> Bool {
-    if d.path?.path != url.path {
-        return true
+    
+    private func stopSession() {
+        if let session = self.session {
+            DASessionSetDispatchQueue(session, nil)
+        }
+        self.session = nil
+    }
+    
+    // called on the queue
+    private func diskAppeared(_ disk: DADisk) {
+        guard let name = DADiskGetBSDName(disk).map({ String(cString: $0) }) else { return }
+        guard let d = driveDetails(disk, removableState: self.removableState) else { return }
+        guard let path = d.path, path.pathComponents.count == 1 || (path.pathComponents.count > 1 && path.pathComponents[1] == "Volumes") else {
+            if d.parent != 0 { IOObjectRelease(d.parent) }
+            return
+        }
+        if let old = self.topology.appeared(name, handle: d), old.parent != 0 {
+            IOObjectRelease(old.parent)
+        }
     }
-    if let description = DADiskCopyDescription(disk) as? [String: AnyObject],
-       let kind = description[kDADiskDescriptionVolumeKindKey as String] as? String,
-       kind != d.fileSystem {
-        return true
+    
+    private func diskDisappeared(_ disk: DADisk) {
+        guard let name = DADiskGetBSDName(disk).map({ String(cString: $0) }) else { return }
+        if let old = self.topology.disappeared(name), old.parent != 0 {
+            IOObjectRelease(old.parent)
+        }
     }
-    return false
+}
+
+// C string of a fixed size statfs field
+private func fsString<T>(_ field: T) -> String {
+    withUnsafeBytes(of: field) { String(decoding: $0.prefix(while: { $0 != 0 }), as: UTF8.self) }
 }
 
 private func driveDetails(_ disk: DADisk, removableState: Bool) -> drive? {
@@ -64,7 +64,7 @@ public struct GPU_Info: Codable {
     }
 }
 
-public class GPUs: Codable, RemoteType {
+public class GPUs: Codable, RemoteType, OpenMetricsType {
     private var queue: DispatchQueue = DispatchQueue(label: "eu.exelban.Stats.GPU.SynchronizedArray")
     
     private var _list: [GPU_Info] = []
@@ -104,6 +104,25 @@ public class GPUs: Codable, RemoteType {
         string += "$"
         return string.data(using: .utf8)
     }
+    
+    public func openMetrics() -> [OpenMetric] {
+        var list: [OpenMetric] = []
+        for (i, g) in self.list.enumerated() {
+            let labels = [("gpu", g.id.isEmpty ? "\(i)" : g.id), ("model", g.model)]
+            let ratios: [(String, Double?)] = [("device", g.utilization), ("render", g.renderUtilization), ("tiler", g.tilerUtilization)]
+            for (engine, value) in ratios {
+                guard let value else { continue }
+                list.append(OpenMetric("stats_gpu_utilization_ratio", value, unit: "ratio", help: "GPU utilization", labels: labels + [("engine", engine)]))
+            }
+            if let value = g.temperature {
+                list.append(OpenMetric("stats_gpu_temperature_celsius", value, unit: "celsius", help: "GPU temperature", labels: labels))
+            }
+            if let value = g.fanSpeed {
+                list.append(OpenMetric("stats_gpu_fan_speed_rpm", Double(value), help: "GPU fan speed", labels: labels))
+            }
+        }
+        return list
+    }
 }
 
 public class GPU: Module {
@@ -15,7 +15,7 @@ import Kit
 public struct device {
     public let vendor: String?
     public let model: String
-    public let pci: String
+    public let pci: UInt32
     public var used: Bool
 }
 
@@ -40,10 +40,30 @@ private func maxANEPower(for platform: Platform?) -> Double {
     }
 }
 
+// registry entry of an accelerator with the identity resolved once
+private struct accelerator {
+    let entry: io_registry_entry_t
+    let id: String
+    // SMC key with the temperature when the statistics do not have it (Intel and AMD)
+    var smcKey: String? = nil
+    var smcTemperature: Int? = nil
+    var smcTime: CFAbsoluteTime = 0
+}
+
+private let agcInfoKey: CFString = "AGCInfo" as CFString
+private let poweredOffKey: CFString = "poweredOffByAGC" as CFString
+
 internal class InfoReader: Reader<GPUs> {
     private var gpus: GPUs = GPUs()
     private var displays: [gpu_s] = []
     private var devices: [device] = []
+    
+    // accelerators are resolved again only when one is added or removed
+    private let queue = DispatchQueue(label: "eu.exelban.GPU.accelerators")
+    private var accelerators: [accelerator] = []
+    private var notificationPort: IONotificationPortRef? = nil
+    private var notificationIterators: [io_iterator_t] = []
+    private var stale: Bool = true
 
     private var aneChannels: CFMutableDictionary? = nil
     private var aneSubscription: IOReportSubscriptionRef? = nil
@@ -61,23 +81,25 @@ internal class InfoReader: Reader<GPUs> {
             self.displays = list
         }
         
-        guard let PCIdevices = fetchIOService("IOPCIDevice") else {
-            return
-        }
-        let devices = PCIdevices.filter{ $0.object(forKey: "IOName") as? String == "display" }
-        
         #if arch(arm64)
         self.aneMaxPower = maxANEPower(for: SystemKit.shared.device.platform)
         self.setupANE()
         self.setupFrames()
         #endif
-
+        
+        self.observe()
+        
+        guard let PCIdevices = fetchIOService("IOPCIDevice") else {
+            return
+        }
+        let devices = PCIdevices.filter{ $0.object(forKey: "IOName") as? String == "display" }
+        
         devices.forEach { (dict: NSDictionary) in
-            guard let deviceID = dict["device-id"] as? Data, let vendorID = dict["vendor-id"] as? Data else {
+            guard let deviceID = dict["device-id"] as? Data, let vendorID = dict["vendor-id"] as? Data,
+                  let pci = GPUPCIMatch.id(device: deviceID, vendor: vendorID) else {
                 error("device-id or vendor-id not found", log: self.log)
                 return
             }
-            let pci = "0x" + Data([deviceID[1], deviceID[0], vendorID[1], vendorID[0]]).map { String(format: "%02hhX", $0) }.joined().lowercased()
             
             guard let modelData = dict["model"] as? Data, let modelName = String(data: modelData, encoding: .ascii) else {
                 error("GPU model not found", log: self.log)
@@ -99,50 +121,161 @@ internal class InfoReader: Reader<GPUs> {
         }
     }
     
+    public override func terminate() {
+        self.queue.sync {
+            self.notificationIterators.forEach{ IOObjectRelease($0) }
+            self.notificationIterators.removeAll()
+            if let port = self.notificationPort {
+                IONotificationPortDestroy(port)
+                self.notificationPort = nil
+            }
+        }
+        self.accelerators.forEach{ IOObjectRelease($0.entry) }
+        self.accelerators.removeAll()
+    }
+    
     public override func read() {
-        guard let accelerators = fetchIOService(kIOAcceleratorClassName) else {
-            return
+        let stale: Bool = self.queue.sync {
+            defer { self.stale = false }
+            return self.stale
+        }
+        if stale || self.accelerators.isEmpty {
+            self.resolve()
         }
-        var devices = self.devices
         
-        for (index, accelerator) in accelerators.enumerated() {
-            guard let IOClass = accelerator.object(forKey: "IOClass") as? String else {
-                error("IOClass not found", log: self.log)
-                return
-            }
+        for i in self.accelerators.indices {
+            let acc = self.accelerators[i]
+            guard let idx = self.gpus.list.firstIndex(where: { $0.id == acc.id }) else { continue }
             
-            guard let stats = accelerator["PerformanceStatistics"] as? [String: Any] else {
+            guard let raw = IORegistryEntryCreateCFProperty(acc.entry, GPUPerformance.property, kCFAllocatorDefault, 0)?.takeRetainedValue(),
+                  CFGetTypeID(raw) == CFDictionaryGetTypeID() else {
                 error("PerformanceStatistics not found", log: self.log)
-                return
+                self.queue.sync { self.stale = true }
+                continue
+            }
+            let stats = GPUPerformance(raw as! CFDictionary)
+            
+            if let info = IORegistryEntryCreateCFProperty(acc.entry, agcInfoKey, kCFAllocatorDefault, 0)?.takeRetainedValue(),
+               CFGetTypeID(info) == CFDictionaryGetTypeID(), let state = GPUPerformance.int(info as! CFDictionary, poweredOffKey) {
+                self.gpus.list[idx].state = state == 0
+            }
+            
+            var temperature = stats.temperature
+            if (temperature == nil || temperature == 0), let key = acc.smcKey {
+                temperature = self.smcTemperature(i, key: key)
+            }
+            
+            if let value = stats.utilization {
+                self.gpus.list[idx].utilization = Double(min(value, 100))/100
+            }
+            if let value = stats.renderer {
+                self.gpus.list[idx].renderUtilization = Double(min(value, 100))/100
+            }
+            if let value = stats.tiler {
+                self.gpus.list[idx].tilerUtilization = Double(min(value, 100))/100
+            }
+            if let value = temperature {
+                self.gpus.list[idx].temperature = Double(value)
+            }
+            if let value = stats.fanSpeed {
+                self.gpus.list[idx].fanSpeed = value
+            }
+            if let value = stats.coreClock {
+                self.gpus.list[idx].coreClock = value
+            }
+            if let value = stats.memoryClock {
+                self.gpus.list[idx].memoryClock = value
+            }
+        }
+        
+        #if arch(arm64)
+        let anePower = self.readANEPower()
+        let aneUtil = anePower.map { min(1.0, max(0.0, $0 / self.aneMaxPower)) }
+        let fpsValue = self.readFrames()
+        for i in self.gpus.list.indices where self.gpus.list[i].IOClass.lowercased().contains("agx") {
+            self.gpus.list[i].aneUtilization = aneUtil ?? 0
+            self.gpus.list[i].fps = fpsValue
+        }
+        #endif
+        
+        self.gpus.list.sort{ !$0.state && $1.state }
+        self.callback(self.gpus)
+    }
+    
+    // MARK: - accelerators
+    
+    private func observe() {
+        self.queue.sync {
+            guard let port = IONotificationPortCreate(kIOMainPortDefault) else { return }
+            IONotificationPortSetDispatchQueue(port, self.queue)
+            self.notificationPort = port
+            
+            let callback: IOServiceMatchingCallback = { context, iterator in
+                while case let entry = IOIteratorNext(iterator), entry != 0 {
+                    IOObjectRelease(entry)
+                }
+                guard let context else { return }
+                Unmanaged<InfoReader>.fromOpaque(context).takeUnretainedValue().stale = true
             }
+            for type in [kIOFirstMatchNotification, kIOTerminatedNotification] {
+                var iterator: io_iterator_t = 0
+                let result = IOServiceAddMatchingNotification(port, type, IOServiceMatching(kIOAcceleratorClassName), callback, Unmanaged.passUnretained(self).toOpaque(), &iterator)
+                guard result == kIOReturnSuccess else {
+                    error("IOServiceAddMatchingNotification(): \(result)", log: self.log)
+                    continue
+                }
+                // the notifications are armed once the existing entries are iterated
+                while case let entry = IOIteratorNext(iterator), entry != 0 {
+                    IOObjectRelease(entry)
+                }
+                self.notificationIterators.append(iterator)
+            }
+        }
+    }
+    
+    private func resolve() {
+        self.accelerators.forEach{ IOObjectRelease($0.entry) }
+        self.accelerators.removeAll()
+        
+        var iterator: io_iterator_t = io_iterator_t()
+        let result = IOServiceGetMatchingServices(kIOMainPortDefault, IOServiceMatching(kIOAcceleratorClassName), &iterator)
+        guard result == kIOReturnSuccess else {
+            error("IOServiceGetMatchingServices(): \(result)", log: self.log)
+            return
+        }
+        defer { IOObjectRelease(iterator) }
+        
+        var devices = self.devices
+        var index = 0
+        while case let entry = IOIteratorNext(iterator), entry != 0 {
+            defer { index += 1 }
+            
+            guard let IOClass = IORegistryEntryCreateCFProperty(entry, "IOClass" as CFString, kCFAllocatorDefault, 0)?.takeRetainedValue() as? String else {
+                error("IOClass not found", log: self.log)
+                IOObjectRelease(entry)
+                continue
+            }
+            let stats = IORegistryEntryCreateCFProperty(entry, GPUPerformance.property, kCFAllocatorDefault, 0)?.takeRetainedValue() as? [String: Any]
             
             var id: String = ""
             var vendor: String? = nil
             var model: String = ""
             var cores: Int? = nil
-            let accMatch = (accelerator["IOPCIMatch"] as? String ?? accelerator["IOPCIPrimaryMatch"] as? String ?? "").lowercased()
+            let matchProperty = IORegistryEntryCreateCFProperty(entry, "IOPCIMatch" as CFString, kCFAllocatorDefault, 0)?.takeRetainedValue() as? String ??
+                IORegistryEntryCreateCFProperty(entry, "IOPCIPrimaryMatch" as CFString, kCFAllocatorDefault, 0)?.takeRetainedValue() as? String ?? ""
+            let match = GPUPCIMatch(matchProperty)
             
-            for (i, device) in devices.enumerated() {
-                if accMatch.range(of: device.pci) != nil && !device.used {
-                    model = device.model
-                    vendor = device.vendor
-                    id = "\(model) #\(index)"
-                    devices[i].used = true
-                    break
-                }
+            if let i = devices.firstIndex(where: { !$0.used && match.matches($0.pci) }) {
+                model = devices[i].model
+                vendor = devices[i].vendor
+                id = "\(model) #\(index)"
+                devices[i].used = true
             }
             
             let ioClass = IOClass.lowercased()
             var predictModel = ""
             var type: GPU_types = .unknown
-            
-            let utilization: Int? = stats["Device Utilization %"] as? Int ?? stats["GPU Activity(%)"] as? Int ?? nil
-            let renderUtilization: Int? = stats["Renderer Utilization %"] as? Int ?? nil
-            let tilerUtilization: Int? = stats["Tiler Utilization %"] as? Int ?? nil
-            var temperature: Int? = stats["Temperature(C)"] as? Int ?? nil
-            let fanSpeed: Int? = stats["Fan Speed(%)"] as? Int ?? nil
-            let coreClock: Int? = stats["Core Clock(MHz)"] as? Int ?? nil
-            let memoryClock: Int? = stats["Memory Clock(MHz)"] as? Int ?? nil
+            var smcKey: String? = nil
             
             if ioClass == "nvaccelerator" || ioClass.contains("nvidia") { // nvidia
                 predictModel = "Nvidia Graphics"
@@ -150,23 +283,13 @@ internal class InfoReader: Reader<GPUs> {
             } else if ioClass.contains("amd") { // amd
                 predictModel = "AMD Graphics"
                 type = .discrete
-                
-                if temperature == nil || temperature == 0 {
-                    if let tmp = SMC.shared.getValue("TGDD"), tmp != 128 {
-                        temperature = Int(tmp)
-                    }
-                }
+                smcKey = "TGDD"
             } else if ioClass.contains("intel") { // intel
                 predictModel = "Intel Graphics"
                 type = .integrated
-                
-                if temperature == nil || temperature == 0 {
-                    if let tmp = SMC.shared.getValue("TCGC"), tmp != 128 {
-                        temperature = Int(tmp)
-                    }
-                }
+                smcKey = "TCGC"
             } else if ioClass.contains("agx") { // apple
-                predictModel = stats["model"] as? String ?? "Apple Graphics"
+                predictModel = stats?["model"] as? String ?? "Apple Graphics"
                 if let display = self.displays.first(where: { $0.vendor == "sppci_vendor_Apple" }) {
                     if let name = display.name {
                         predictModel = name
@@ -198,58 +321,23 @@ internal class InfoReader: Reader<GPUs> {
                     cores: cores
                 ))
             }
-            guard let idx = self.gpus.list.firstIndex(where: { $0.id == id }) else {
-                return
-            }
-            
-            if let agcInfo = accelerator["AGCInfo"] as? [String: Int], let state = agcInfo["poweredOffByAGC"] {
-                self.gpus.list[idx].state = state == 0
-            }
-            
-            if var value = utilization {
-                if value > 100 {
-                    value = 100
-                }
-                self.gpus.list[idx].utilization = Double(value)/100
-            }
-            if var value = renderUtilization {
-                if value > 100 {
-                    value = 100
-                }
-                self.gpus.list[idx].renderUtilization = Double(value)/100
-            }
-            if var value = tilerUtilization {
-                if value > 100 {
-                    value = 100
-                }
-                self.gpus.list[idx].tilerUtilization = Double(value)/100
-            }
-            if let value = temperature {
-                self.gpus.list[idx].temperature = Double(value)
-            }
-            if let value = fanSpeed {
-                self.gpus.list[idx].fanSpeed = value
-            }
-            if let value = coreClock {
-                self.gpus.list[idx].coreClock = value
-            }
-            if let value = memoryClock {
-                self.gpus.list[idx].memoryClock = value
-            }
+            self.accelerators.append(accelerator(entry: entry, id: id, smcKey: smcKey))
         }
-        
-        #if arch(arm64)
-        let anePower = self.readANEPower()
-        let aneUtil = anePower.map { min(1.0, max(0.0, $0 / self.aneMaxPower)) }
-        let fpsValue = self.readFrames()
-        for i in self.gpus.list.indices where self.gpus.list[i].IOClass.lowercased().contains("agx") {
-            self.gpus.list[i].aneUtilization = aneUtil ?? 0
-            self.gpus.list[i].fps = fpsValue
+    }
+    
+    // the SMC fallback is read at most every 5 seconds and dropped when the key does not exist
+    private func smcTemperature(_ i: Int, key: String) -> Int? {
+        let now = CFAbsoluteTimeGetCurrent()
+        if now - self.accelerators[i].smcTime < 5 {
+            return self.accelerators[i].smcTemperature
         }
-        #endif
-        
-        self.gpus.list.sort{ !$0.state && $1.state }
-        self.callback(self.gpus)
+        self.accelerators[i].smcTime = now
+        guard let value = SMC.shared.getValue(key) else {
+            self.accelerators[i].smcKey = nil
+            return nil
+        }
+        self.accelerators[i].smcTemperature = value != 128 ? Int(value) : nil
+        return self.accelerators[i].smcTemperature
     }
     
     // MARK: - FPS
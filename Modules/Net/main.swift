@@ -72,7 +72,13 @@ public struct Bandwidth: Codable {
     var download: Int64 = 0
 }
 
-public struct Network_Usage: Codable, RemoteType {
+public struct Network_counters: Codable {
+    var name: String = ""
+    var bandwidth: Bandwidth = Bandwidth() // bytes since the previous read
+    var total: Bandwidth = Bandwidth() // kernel counters of the interface
+}
+
+public struct Network_Usage: Codable, RemoteType, OpenMetricsType {
     var bandwidth: Bandwidth = Bandwidth()
     var total: Bandwidth = Bandwidth()
     
@@ -87,6 +93,13 @@ public struct Network_Usage: Codable, RemoteType {
     
     var wifiDetails: Network_wifi = Network_wifi()
     
+    // every interface which has moved any traffic, only used by the exporter and not encoded
+    var interfaces: [Network_counters]? = nil
+    
+    enum CodingKeys: String, CodingKey {
+        case bandwidth, total, laddr, raddr, dns, interface, connectionType, status, wifiDetails
+    }
+    
     mutating func reset() {
         self.bandwidth = Bandwidth()
         
@@ -106,12 +119,41 @@ public struct Network_Usage: Codable, RemoteType {
         let string = "1,\(self.interface?.BSDName ?? ""),1,\(self.bandwidth.download),\(self.bandwidth.upload),\(addr)$"
         return string.data(using: .utf8)
     }
+    
+    public func openMetrics() -> [OpenMetric] {
+        var list: [OpenMetric] = []
+        if let name = self.interface?.BSDName, !name.isEmpty {
+            list.append(OpenMetric("stats_network_up", self.status ? 1 : 0, help: "Interface status", labels: [("interface", name)]))
+        }
+        
+        guard let interfaces = self.interfaces, !interfaces.isEmpty else {
+            guard let name = self.interface?.BSDName, !name.isEmpty else { return list }
+            return list + Network_Usage.metrics(name, bandwidth: self.bandwidth, total: self.total)
+        }
+        for i in interfaces {
+            list += Network_Usage.metrics(i.name, bandwidth: i.bandwidth, total: i.total)
+        }
+        return list
+    }
+    
+    private static func metrics(_ name: String, bandwidth: Bandwidth, total: Bandwidth) -> [OpenMetric] {
+        return [
+            OpenMetric("stats_network_speed_bytes_per_second", Double(bandwidth.download), unit: "bytes_per_second", help: "Bytes per second", labels: [("interface", name), ("direction", "download")]),
+            OpenMetric("stats_network_speed_bytes_per_second", Double(bandwidth.upload), unit: "bytes_per_second", help: "Bytes per second", labels: [("interface", name), ("direction", "upload")]),
+            OpenMetric("stats_network_transferred_bytes", Double(total.download), type: .counter, unit: "bytes", help: "Bytes transferred", labels: [("interface", name), ("direction", "download")]),
+            OpenMetric("stats_network_transferred_bytes", Double(total.upload), type: .counter, unit: "bytes", help: "Bytes transferred", labels: [("interface", name), ("direction", "upload")])
+        ]
+    }
 }
 
 public struct Network_Connectivity: Codable {
     var status: Bool = false
     var latency: Double = 0
     var jitter: Double = 0
+    var p50: Double? = nil
+    var p95: Double? = nil
+    var p99: Double? = nil
+    var loss: Double? = nil
 }
 
 public struct Network_Process: Codable, Process_p {
@@ -624,6 +624,17 @@ internal class Popup: PopupWrapper {
         self.latencyField?.stringValue = latency
         self.jitterField?.stringValue = jitter
         
+        var tooltip: [String] = []
+        if let v = value {
+            if let p50 = v.p50, let p95 = v.p95, let p99 = v.p99 {
+                tooltip.append("p50: \(p50.rounded(toPlaces: 2)) ms\np95: \(p95.rounded(toPlaces: 2)) ms\np99: \(p99.rounded(toPlaces: 2)) ms")
+            }
+            if let loss = v.loss {
+                tooltip.append("\(localizedString("Loss")): \((loss * 100).rounded(toPlaces: 1))%")
+            }
+        }
+        self.latencyField?.toolTip = tooltip.isEmpty ? nil : tooltip.joined(separator: "\n")
+        
         self.connectivityField?.setStatus(value?.status)
         self.connectivityChart?.display()
     }
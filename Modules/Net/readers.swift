@@ -158,6 +158,10 @@ internal class UsageReader: Reader<Network_Usage>, CWEventDelegate {
     
     private let wifiClient = CWWiFiClient.shared()
     
+    // counters of all interfaces, the selected one is taken from the table
+    private let counters = InterfaceCounterTable()
+    private var processBandwidth: Bandwidth? = nil
+    
     private var lastDetailsReadTS: Date = .distantPast
     
     private let detailsQueue = DispatchQueue(label: "eu.exelban.NetworkDetailsReader")
@@ -219,21 +223,14 @@ internal class UsageReader: Reader<Network_Usage>, CWEventDelegate {
         self.checkUsageReset()
         self.requestDetails()
         
-        let current: Bandwidth
         if self.reader == "interface" {
-            current = self.readInterfaceBandwidth()
+            self.usage.bandwidth = self.readInterfaceBandwidth()
         } else {
             self.readInterfaceStatus()
-            current = self.readProcessBandwidth()
-        }
-        
-        // allows to reset the value to 0 when first read
-        if self.usage.bandwidth.upload != 0 {
-            self.usage.bandwidth.upload = current.upload - self.usage.bandwidth.upload
-        }
-        if self.usage.bandwidth.download != 0 {
-            self.usage.bandwidth.download = current.download - self.usage.bandwidth.download
+            self.counters.read()
+            self.usage.bandwidth = self.readProcessBandwidth()
         }
+        self.usage.interfaces = self.interfaceCounters()
         
         self.usage.bandwidth.upload = max(self.usage.bandwidth.upload, 0) // prevent negative upload value
         self.usage.bandwidth.download = max(self.usage.bandwidth.download, 0) // prevent negative download value
@@ -260,9 +257,6 @@ internal class UsageReader: Reader<Network_Usage>, CWEventDelegate {
         }
         
         self.callback(self.usage)
-        
-        self.usage.bandwidth.upload = current.upload
-        self.usage.bandwidth.download = current.download
     }
     
     private func readInterfaceBandwidth() -> Bandwidth {
@@ -283,7 +277,23 @@ internal class UsageReader: Reader<Network_Usage>, CWEventDelegate {
         }
         freeifaddrs(interfaceAddresses)
         
-        return self.getBytesInfo() ?? Bandwidth()
+        guard self.counters.read(), let entry = self.counters.entry(self.interfaceID) else {
+            return Bandwidth()
+        }
+        return Bandwidth(upload: entry.upload, download: entry.download)
+    }
+    
+    private func interfaceCounters() -> [Network_counters] {
+        var list: [Network_counters] = []
+        for entry in self.counters.entries.values where !entry.counter.name.isEmpty {
+            guard entry.counter.ibytes != 0 || entry.counter.obytes != 0 else { continue }
+            list.append(Network_counters(
+                name: entry.counter.name,
+                bandwidth: Bandwidth(upload: max(entry.upload, 0), download: max(entry.download, 0)),
+                total: Bandwidth(upload: Int64(clamping: entry.counter.obytes), download: Int64(clamping: entry.counter.ibytes))
+            ))
+        }
+        return list.sorted{ $0.name < $1.name }
     }
     
     private func readInterfaceStatus() {
@@ -353,7 +363,10 @@ internal class UsageReader: Reader<Network_Usage>, CWEventDelegate {
             }
         }
         
-        return Bandwidth(upload: totalUpload, download: totalDownload)
+        let current = Bandwidth(upload: totalUpload, download: totalDownload)
+        defer { self.processBandwidth = current }
+        guard let last = self.processBandwidth else { return Bandwidth() }
+        return Bandwidth(upload: current.upload - last.upload, download: current.download - last.download)
     }
     
     private func requestDetails() {
@@ -460,26 +473,29 @@ internal class UsageReader: Reader<Network_Usage>, CWEventDelegate {
             guard let res = self.systemProfilerAirport(timeout: 5) else {
                 return
             }
-            do {
-                if let json = try JSONSerialization.jsonObject(with: Data(res.utf8), options: []) as? [String: Any] {
-                    if let arr = json["SPAirPortDataType"] as? [[String: Any]],
-                       let airport = arr.first(where: { $0["spairport_airport_interfaces"] != nil }),
-                       let interfaces = airport["spairport_airport_interfaces"] as? [[String: Any]],
-                       let interface = interfaces.first(where: { $0["_name"] as? String == self.interfaceID }),
-                       let obj = interface["spairport_current_network_information"] as? [String: Any] {
-                        
-                        self.usage.wifiDetails.ssid = obj["_name"] as? String
-                        self.usage.wifiDetails.countryCode = obj["spairport_network_country_code"] as? String
-                        self.usage.wifiDetails.standard = obj["spairport_network_phymode"] as? String
-                    }
-                }
-            } catch let err as NSError {
-                error("error to parse system_profiler SPAirPortDataType: \(err.localizedDescription)")
+            guard let matches = Data(res.utf8).withUnsafeBytes({ UsageReader.airportExtractor.json($0) }) else {
+                error("error to parse system_profiler SPAirPortDataType")
                 return
             }
+            guard let interface = matches.first(where: { $0.path == 0 && $0.value.string == self.interfaceID }) else { return }
+            let values = matches.filter{ $0.keys == interface.keys }
+            guard values.contains(where: { $0.path == 1 }) else { return }
+            
+            self.usage.wifiDetails.ssid = values.first(where: { $0.path == 2 })?.value.string
+            self.usage.wifiDetails.countryCode = values.first(where: { $0.path == 3 })?.value.string
+            self.usage.wifiDetails.standard = values.first(where: { $0.path == 4 })?.value.string
         }
     }
     
+    // the name of every interface and the fields of its current network
+    private static let airportExtractor = StreamExtractor([
+        ["SPAirPortDataType", "*", "spairport_airport_interfaces", "*", "_name"],
+        ["SPAirPortDataType", "*", "spairport_airport_interfaces", "*", "spairport_current_network_information"],
+        ["SPAirPortDataType", "*", "spairport_airport_interfaces", "*", "spairport_current_network_information", "_name"],
+        ["SPAirPortDataType", "*", "spairport_airport_interfaces", "*", "spairport_current_network_information", "spairport_network_country_code"],
+        ["SPAirPortDataType", "*", "spairport_airport_interfaces", "*", "spairport_current_network_information", "spairport_network_phymode"]
+    ])
+    
     private func systemProfilerAirport(timeout: TimeInterval) -> String? {
         return process(path: "/usr/sbin/system_profiler", arguments: ["SPAirPortDataType", "-json"], timeout: timeout)
     }
@@ -535,43 +551,6 @@ internal class UsageReader: Reader<Network_Usage>, CWEventDelegate {
         }
     }
     
-    private func getBytesInfo() -> Bandwidth? {
-        let index = if_nametoindex(self.interfaceID)
-        guard index != 0 else { return nil }
-        
-        var mib: [Int32] = [CTL_NET, PF_ROUTE, 0, 0, NET_RT_IFLIST2, Int32(index)]
-        var size: size_t = 0
-        guard sysctl(&mib, u_int(mib.count), nil, &size, nil, 0) == 0, size > 0 else { return nil }
-        var buffer = [UInt8](repeating: 0, count: size)
-        guard sysctl(&mib, u_int(mib.count), &buffer, &size, nil, 0) == 0 else { return nil }
-        
-        var offset = 0
-        while offset + MemoryLayout<if_msghdr>.size <= size {
-            var header = if_msghdr()
-            buffer.withUnsafeBytes { src in
-                _ = memcpy(&header, src.baseAddress?.advanced(by: offset), MemoryLayout<if_msghdr>.size)
-            }
-            guard header.ifm_msglen > 0 else { return nil }
-            
-            if Int32(header.ifm_type) == RTM_IFINFO2, offset + MemoryLayout<if_msghdr2>.size <= size {
-                var header2 = if_msghdr2()
-                buffer.withUnsafeBytes { src in
-                    _ = memcpy(&header2, src.baseAddress?.advanced(by: offset), MemoryLayout<if_msghdr2>.size)
-                }
-                if UInt32(header2.ifm_index) == index {
-                    return Bandwidth(
-                        upload: Int64(clamping: header2.ifm_data.ifi_obytes),
-                        download: Int64(clamping: header2.ifm_data.ifi_ibytes)
-                    )
-                }
-            }
-            
-            offset += Int(header.ifm_msglen)
-        }
-        
-        return nil
-    }
-    
     private func isIPv4(_ ip: String) -> Bool {
         let arr = ip.split(separator: ".").compactMap{ Int($0) }
         return arr.count == 4 && arr.filter{ $0 >= 0 && $0 < 256}.count == 4
@@ -759,20 +738,12 @@ public class ProcessReader: Reader<[Network_Process]> {
     }
 }
 
-internal class ConnectivityReaderWrapper {
-    weak var reader: ConnectivityReader?
-    
-    init(_ reader: ConnectivityReader) {
-        self.reader = reader
-    }
-}
-
 // inspired by https://github.com/samiyr/SwiftyPing
 internal class ConnectivityReader: Reader<Network_Connectivity> {
-    private let variablesQueue = DispatchQueue(label: "eu.exelban.ConnectivityReaderQueue")
+    private let queue = DispatchQueue(label: "eu.exelban.ConnectivityReaderQueue")
     
     private let identifier = UInt16.random(in: 0..<UInt16.max)
-    private var fingerprint: UUID = UUID()
+    private let token = UInt64.random(in: 0..<UInt64.max)
     
     private var ICMPHost: String {
         Store.shared.string(key: "Network_ICMPHost", defaultValue: "1.1.1.1")
@@ -781,8 +752,6 @@ internal class ConnectivityReader: Reader<Network_Connectivity> {
         Store.shared.string(key: "Network_HTTPHost", defaultValue: "https://google.com")
     }
     
-    private var lastHost: String = ""
-    private var addr: Data? = nil
     private let timeout: TimeInterval = 5
     
     public enum ConnectivityMode: String {
@@ -794,324 +763,206 @@ internal class ConnectivityReader: Reader<Network_Connectivity> {
         ConnectivityMode(rawValue: Store.shared.string(key: "Network_connectivityMode", defaultValue: "icmp")) ?? .icmp
     }
     
-    private var socket: CFSocket?
-    private var socketSource: CFRunLoopSource?
-    private var socketInfo: Unmanaged<ConnectivityReaderWrapper>?
+    // all targets are probed through one socket and one session, the state below is used on the queue
+    private var mode: ConnectivityMode? = nil
+    private lazy var prober: ConnectivityProber = ConnectivityProber(targets: [], timeout: self.timeout)
+    private var addresses: [String: Data] = [:]
+    private var socket: Int32 = -1
+    private var source: DispatchSourceRead? = nil
+    private var buffer: [UInt8] = [UInt8](repeating: 0, count: 2048)
+    private lazy var session: URLSession = {
+        let configuration = URLSessionConfiguration.ephemeral
+        configuration.timeoutIntervalForRequest = self.timeout
+        configuration.requestCachePolicy = .reloadIgnoringLocalCacheData
+        return URLSession(configuration: configuration)
+    }()
     
     private var wrapper: Network_Connectivity = Network_Connectivity(status: false)
     
-    private var _status: Bool? = nil
-    private var status: Bool? {
-        get { self.variablesQueue.sync { self._status } }
-        set { self.variablesQueue.sync { self._status = newValue } }
-    }
-    
-    private var _timeoutTimer: Timer?
-    private var timeoutTimer: Timer? {
-        get { self.variablesQueue.sync { self._timeoutTimer } }
-        set { self.variablesQueue.sync { self._timeoutTimer = newValue } }
-    }
-    
-    private var _isPinging: Bool = false
-    private var isPinging: Bool {
-        get { self.variablesQueue.sync { self._isPinging } }
-        set { self.variablesQueue.sync { self._isPinging = newValue } }
-    }
-    
-    private var _latency: Double? = nil
-    private var latency: Double? {
-        get { self.variablesQueue.sync { self._latency } }
-        set { self.variablesQueue.sync { self._latency = newValue } }
-    }
-    
-    private var _previousLatency: Double? = nil
-    private var previousLatency: Double? {
-        get { self.variablesQueue.sync { self._previousLatency } }
-        set { self.variablesQueue.sync { self._previousLatency = newValue } }
-    }
-    
-    private var _jitter: Double? = nil
-    private var jitter: Double? {
-        get { self.variablesQueue.sync { self._jitter } }
-        set { self.variablesQueue.sync { self._jitter = newValue } }
-    }
-    
-    var start: DispatchTime? = nil
-    
-    private struct ICMPHeader {
-        public var type: UInt8
-        public var code: UInt8
-        public var checksum: UInt16
-        public var identifier: UInt16
-        public var sequenceNumber: UInt16
-        public var payload: uuid_t
-    }
-    
-    private struct IPHeader {
-        public var versionAndHeaderLength: UInt8
-        public var differentiatedServices: UInt8
-        public var totalLength: UInt16
-        public var identification: UInt16
-        public var flagsAndFragmentOffset: UInt16
-        public var timeToLive: UInt8
-        public var `protocol`: UInt8
-        public var headerChecksum: UInt16
-        public var sourceAddress: (UInt8, UInt8, UInt8, UInt8)
-        public var destinationAddress: (UInt8, UInt8, UInt8, UInt8)
+    // monotonic time in seconds
+    private var now: TimeInterval {
+        TimeInterval(DispatchTime.now().uptimeNanoseconds) / 1_000_000_000
     }
     
     override func setup() {
         self.setInterval(Store.shared.int(key: "Network_updateICMPInterval", defaultValue: 1))
-        self.prepare()
     }
     
-    deinit {
-        self.closeConn()
+    public override func terminate() {
+        self.queue.sync {
+            self.closeSocket()
+        }
+        self.session.invalidateAndCancel()
     }
     
-    private func prepare() {
-        DispatchQueue.global(qos: .background).async {
-            self.addr = self.resolve()
-            self.openConn()
-            self.read()
-        }
+    deinit {
+        self.source?.cancel()
     }
     
     override func read() {
-        if self.connectivityMode == .http {
-            self.httpCheck()
-        } else {
-            guard !self.ICMPHost.isEmpty else {
-                if self.socket != nil {
-                    self.closeConn()
-                }
-                return
+        let mode = self.connectivityMode
+        // several hosts are separated by a comma
+        let hosts = (mode == .http ? self.HTTPHost : self.ICMPHost).split(separator: ",").map{ $0.trimmingCharacters(in: .whitespaces) }.filter{ !$0.isEmpty }
+        
+        if mode == .icmp {
+            let missing = self.queue.sync { hosts.filter{ self.addresses[$0] == nil } }
+            let resolved = missing.compactMap{ host in self.resolve(host).map{ (host, $0) } }
+            self.queue.sync {
+                resolved.forEach{ self.addresses[$0.0] = $0.1 }
             }
-            
-            self.icmpCheck()
         }
         
-        if let v = self.status {
-            self.wrapper.status = v
-            if let l = self.latency {
-                self.wrapper.latency = l
+        let interval = self.interval ?? 1
+        let value: Network_Connectivity? = self.queue.sync {
+            if mode != self.mode || hosts != self.prober.targets {
+                self.mode = mode
+                self.prober.set(hosts)
+                self.addresses = self.addresses.filter{ hosts.contains($0.key) }
+            }
+            self.prober.expire(self.now)
+            
+            guard !hosts.isEmpty else {
+                self.closeSocket()
+                return nil
+            }
+            if mode == .http {
+                self.closeSocket()
             }
-            if let j = self.jitter {
-                self.wrapper.jitter = j
+            
+            for (i, host) in hosts.enumerated() {
+                self.queue.asyncAfter(deadline: .now() + ConnectivityProber.offset(interval)) { [weak self] in
+                    guard let self, self.mode == mode, self.prober.targets.indices.contains(i), self.prober.targets[i] == host else { return }
+                    if mode == .http {
+                        self.fetch(i, host: host)
+                    } else {
+                        self.ping(i, host: host)
+                    }
+                }
             }
-            self.callback(self.wrapper)
+            
+            return self.connectivity()
+        }
+        
+        if let value {
+            self.callback(value)
         }
     }
     
-    private func httpCheck() {
-        guard !self.isPinging else { return }
-        self.isPinging = true
+    // the state reported by the module: reachable when any target answers, the latency and jitter
+    // of the first reachable target (or the first one)
+    private func connectivity() -> Network_Connectivity? {
+        guard let status = self.prober.reachable, self.prober.count > 0 else { return nil }
+        let list = (0..<self.prober.count).map{ self.prober.summary($0) }
+        let primary = list.first(where: { $0.reachable == true }) ?? list[0]
         
-        let urlString = self.HTTPHost.hasPrefix("http://") || self.HTTPHost.hasPrefix("https://") ? self.HTTPHost : "https://\(self.HTTPHost)"
+        self.wrapper.status = status
+        if let l = primary.latency {
+            self.wrapper.latency = l
+        }
+        if let j = primary.jitter {
+            self.wrapper.jitter = j
+        }
+        self.wrapper.p50 = primary.p50
+        self.wrapper.p95 = primary.p95
+        self.wrapper.p99 = primary.p99
+        self.wrapper.loss = primary.loss
+        return self.wrapper
+    }
+    
+    private func fetch(_ target: Int, host: String) {
+        let sequence = self.prober.sent(target, time: self.now)
+        let urlString = host.hasPrefix("http://") || host.hasPrefix("https://") ? host : "https://\(host)"
         guard let url = URL(string: urlString) else {
-            self.status = false
-            self.isPinging = false
+            self.prober.failed(sequence)
             return
         }
         
         var request = URLRequest(url: url, cachePolicy: .reloadIgnoringLocalCacheData, timeoutInterval: self.timeout)
         request.httpMethod = "HEAD"
         
-        let startTime = DispatchTime.now()
-        let task = URLSession.shared.dataTask(with: request) { _, response, error in
-            let endTime = DispatchTime.now()
-            let elapsed = Double(endTime.uptimeNanoseconds - startTime.uptimeNanoseconds) / 1_000_000
-            
-            self.latency = elapsed
-            if let prev = self.previousLatency {
-                let d = abs(elapsed - prev)
-                if self.jitter == nil {
-                    self.jitter = d
+        self.session.dataTask(with: request) { [weak self] _, response, error in
+            guard let self else { return }
+            let time = self.now
+            let success = error == nil && (response as? HTTPURLResponse).map{ (200...399).contains($0.statusCode) } ?? false
+            self.queue.async {
+                if success {
+                    self.prober.received(sequence, time: time)
                 } else {
-                    self.jitter! += (d - self.jitter!) / 16.0
+                    self.prober.failed(sequence)
                 }
             }
-            self.previousLatency = elapsed
-            
-            if let http = response as? HTTPURLResponse {
-                self.status = (200...399).contains(http.statusCode) && error == nil
-            } else {
-                self.status = false
-            }
-            self.isPinging = false
-        }
-        task.resume()
+        }.resume()
     }
     
-    private func icmpCheck() {
-        if self.socket == nil {
-            self.prepare()
-        }
-        
-        if self.lastHost != self.ICMPHost {
-            self.addr = self.resolve()
+    private func ping(_ target: Int, host: String) {
+        let sequence = self.prober.sent(target, time: self.now)
+        guard self.openSocket(), let address = self.addresses[host] else {
+            self.prober.failed(sequence)
+            return
         }
         
-        guard !self.isPinging && self.active, let socket = self.socket, let addr = self.addr, let data = self.request() else { return }
-        self.isPinging = true
-        
-        let timer = Timer(timeInterval: self.timeout, target: self, selector: #selector(self.timeoutCallback), userInfo: nil, repeats: false)
-        RunLoop.main.add(timer, forMode: .common)
-        self.timeoutTimer = timer
-        self.start = DispatchTime.now()
-        
-        let error = CFSocketSendData(socket, addr as CFData, data as CFData, self.timeout)
-        if error != .success {
-            self.socketCallback(data: nil, error: error)
-        }
-    }
-    
-    @objc private func timeoutCallback() {
-        self.status = false
-        self.isPinging = false
-    }
-    
-    private func socketCallback(data: Data? = nil, error: CFSocketError? = nil) {
-        guard let data = data, validateResponse(data) else { return }
-        let end = DispatchTime.now()
-        
-        self.latency = Double(end.uptimeNanoseconds - (self.start?.uptimeNanoseconds ?? 0)) / 1_000_000
-        
-        if let prev = self.previousLatency {
-            let d = abs((self.latency ?? 0) - prev)
-            if self.jitter == nil {
-                self.jitter = d
-            } else {
-                self.jitter! += (d - self.jitter!) / 16.0
+        let packet = ICMPEcho.request(identifier: self.identifier, sequence: sequence, token: self.token)
+        let result = address.withUnsafeBytes { addr in
+            packet.withUnsafeBytes {
+                sendto(self.socket, $0.baseAddress, $0.count, 0, addr.baseAddress?.assumingMemoryBound(to: sockaddr.self), socklen_t(addr.count))
             }
         }
-        self.previousLatency = self.latency
-        
-        self.status = error == nil
-        self.isPinging = false
-        self.timeoutTimer?.invalidate()
-        self.timeoutTimer = nil
+        if result < 0 {
+            self.prober.failed(sequence)
+        }
     }
     
     // MARK: - helpers
     
-    private func validateResponse(_ data: Data) -> Bool {
-        guard data.count >= MemoryLayout<ICMPHeader>.size + MemoryLayout<IPHeader>.size,
-              let headerOffset = icmpHeaderOffset(of: data) else { return false }
+    private func openSocket() -> Bool {
+        guard self.socket < 0 else { return true }
         
-        let payloadSize = data.count - headerOffset - MemoryLayout<ICMPHeader>.size
-        let icmpHeader = data.withUnsafeBytes({ $0.load(fromByteOffset: headerOffset, as: ICMPHeader.self) })
-        let payload = data.subdata(in: (data.count - payloadSize)..<data.count)
-        let uuid = UUID(uuid: icmpHeader.payload)
-        
-        guard uuid == self.fingerprint else { return false }
-        guard icmpHeader.checksum == computeChecksum(header: icmpHeader, additionalPayload: [UInt8](payload)) else { return false }
-        guard icmpHeader.type == 0 else { return false }
-        guard icmpHeader.code == 0 else { return false }
-        
-        return true
-    }
-    
-    private func request() -> Data? {
-        var header = ICMPHeader(
-            type: 8,
-            code: 0,
-            checksum: 0,
-            identifier: CFSwapInt16HostToBig(self.identifier),
-            sequenceNumber: CFSwapInt16HostToBig(0),
-            payload: self.fingerprint.uuid
-        )
-        
-        let delta = MemoryLayout<uuid_t>.size - MemoryLayout<uuid_t>.size
-        var additional = [UInt8]()
-        if delta > 0 {
-            additional = (0..<delta).map { _ in UInt8.random(in: UInt8.min...UInt8.max) }
+        let fd = Darwin.socket(AF_INET, SOCK_DGRAM, IPPROTO_ICMP)
+        guard fd >= 0 else {
+            error("cannot open ICMP socket: \(String(cString: strerror(errno)))", log: self.log)
+            return false
         }
+        var value: Int32 = 1
+        setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &value, socklen_t(MemoryLayout.size(ofValue: value)))
+        _ = fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK)
         
-        guard let checksum = computeChecksum(header: header, additionalPayload: additional) else { return nil }
-        header.checksum = checksum
-        
-        return Data(bytes: &header, count: MemoryLayout<ICMPHeader>.size) + Data(additional)
-    }
-    
-    private func computeChecksum(header: ICMPHeader, additionalPayload: [UInt8]) -> UInt16? {
-        let typecode = Data([header.type, header.code]).withUnsafeBytes { $0.load(as: UInt16.self) }
-        var sum = UInt64(typecode) + UInt64(header.identifier) + UInt64(header.sequenceNumber)
-        let payload = convert(payload: header.payload) + additionalPayload
-        guard payload.count % 2 == 0 else { return nil }
-        
-        var i = 0
-        while i < payload.count {
-            guard payload.indices.contains(i + 1) else { return nil }
-            sum += Data([payload[i], payload[i + 1]]).withUnsafeBytes { UInt64($0.load(as: UInt16.self)) }
-            i += 2
+        let source = DispatchSource.makeReadSource(fileDescriptor: fd, queue: self.queue)
+        source.setEventHandler { [weak self] in
+            self?.receive()
         }
-        while sum >> 16 != 0 {
-            sum = (sum & 0xffff) + (sum >> 16)
+        source.setCancelHandler {
+            close(fd)
         }
-        guard sum < UInt16.max else { return nil }
+        source.resume()
         
-        return ~UInt16(sum)
+        self.socket = fd
+        self.source = source
+        return true
     }
     
-    private func convert(payload: uuid_t) -> [UInt8] {
-        let p = payload
-        return [p.0, p.1, p.2, p.3, p.4, p.5, p.6, p.7, p.8, p.9, p.10, p.11, p.12, p.13, p.14, p.15].map { UInt8($0) }
+    private func closeSocket() {
+        self.source?.cancel()
+        self.source = nil
+        self.socket = -1
     }
     
-    private func icmpHeaderOffset(of packet: Data) -> Int? {
-        if packet.count >= MemoryLayout<IPHeader>.size + MemoryLayout<ICMPHeader>.size {
-            let ipHeader = packet.withUnsafeBytes({ $0.load(as: IPHeader.self) })
-            if ipHeader.versionAndHeaderLength & 0xF0 == 0x40 && ipHeader.protocol == IPPROTO_ICMP {
-                let headerLength = Int(ipHeader.versionAndHeaderLength) & 0x0F * MemoryLayout<UInt32>.size
-                if packet.count >= headerLength + MemoryLayout<ICMPHeader>.size {
-                    return headerLength
-                }
+    private func receive() {
+        while self.socket >= 0 {
+            let length = self.buffer.withUnsafeMutableBytes { recv(self.socket, $0.baseAddress, $0.count, 0) }
+            guard length > 0 else { break }
+            let time = self.now
+            let sequence = self.buffer.withUnsafeBytes {
+                ICMPEcho.reply(UnsafeRawBufferPointer(rebasing: $0.prefix(length)), token: self.token)
             }
-        }
-        return nil
-    }
-    
-    private func openConn() {
-        let info = ConnectivityReaderWrapper(self)
-        let unmanagedSocketInfo = Unmanaged.passRetained(info)
-        self.socketInfo = unmanagedSocketInfo
-        var context = CFSocketContext(version: 0, info: unmanagedSocketInfo.toOpaque(), retain: nil, release: nil, copyDescription: nil)
-        self.socket = CFSocketCreate(kCFAllocatorDefault, AF_INET, SOCK_DGRAM, IPPROTO_ICMP, CFSocketCallBackType.dataCallBack.rawValue, { _, callBackType, _, data, info in
-            guard let info = info, let data = data else { return }
-            if (callBackType as CFSocketCallBackType) == CFSocketCallBackType.dataCallBack {
-                let cfdata = Unmanaged<CFData>.fromOpaque(data).takeUnretainedValue()
-                let wrapper = Unmanaged<ConnectivityReaderWrapper>.fromOpaque(info).takeUnretainedValue()
-                wrapper.reader?.socketCallback(data: cfdata as Data)
+            if let sequence {
+                self.prober.received(sequence, time: time)
             }
-        }, &context)
-        let handle = CFSocketGetNative(self.socket)
-        var value: Int32 = 1
-        let err = setsockopt(handle, SOL_SOCKET, SO_NOSIGPIPE, &value, socklen_t(MemoryLayout.size(ofValue: value)))
-        guard err == 0 else { return }
-        self.socketSource = CFSocketCreateRunLoopSource(nil, self.socket, 0)
-        CFRunLoopAddSource(CFRunLoopGetMain(), self.socketSource, .commonModes)
-    }
-    
-    private func closeConn() {
-        if let source = self.socketSource {
-            CFRunLoopSourceInvalidate(source)
-            self.socketSource = nil
-        }
-        if let socket = self.socket {
-            CFSocketInvalidate(socket)
-            self.socket = nil
         }
-        self.socketInfo?.release()
-        self.socketInfo = nil
-        self.timeoutTimer?.invalidate()
-        self.timeoutTimer = nil
     }
     
-    private func resolve() -> Data? {
-        self.lastHost = self.ICMPHost
+    private func resolve(_ host: String) -> Data? {
         var streamError = CFStreamError()
-        let cfhost = CFHostCreateWithName(nil, self.ICMPHost as CFString).takeRetainedValue()
+        let cfhost = CFHostCreateWithName(nil, host as CFString).takeRetainedValue()
         let status = CFHostStartInfoResolution(cfhost, .addresses, &streamError)
         guard status else { return nil }
         var success: DarwinBoolean = false
@@ -13,7 +13,7 @@ import Cocoa
 import Kit
 import WidgetKit
 
-public struct RAM_Usage: Codable, RemoteType {
+public struct RAM_Usage: Codable, RemoteType, OpenMetricsType {
     var total: Double
     var used: Double
     var free: Double
@@ -31,6 +31,8 @@ public struct RAM_Usage: Codable, RemoteType {
     
     var swapins: Int64
     var swapouts: Int64
+    // nil on the first sample
+    var rates: VMRates? = nil
     
     public var usage: Double {
         get { Double((self.total - self.free) / self.total) }
@@ -40,6 +42,27 @@ public struct RAM_Usage: Codable, RemoteType {
         let string = "\(self.total),\(self.used),\(self.pressure.level),\(self.swap.used)$"
         return string.data(using: .utf8)
     }
+    
+    public func openMetrics() -> [OpenMetric] {
+        let memory: [(String, Double)] = [
+            ("total", self.total), ("used", self.used), ("free", self.free),
+            ("active", self.active), ("inactive", self.inactive), ("wired", self.wired), ("compressed", self.compressed),
+            ("app", self.app), ("cache", self.cache)
+        ]
+        var list = memory.map{ OpenMetric("stats_memory_bytes", $0.1, unit: "bytes", help: "Memory usage", labels: [("type", $0.0)]) }
+        list += [("total", self.swap.total), ("used", self.swap.used), ("free", self.swap.free)].map {
+            OpenMetric("stats_memory_swap_bytes", $0.1, unit: "bytes", help: "Swap usage", labels: [("type", $0.0)])
+        }
+        list.append(OpenMetric("stats_memory_pressure_level", Double(self.pressure.level), help: "Memory pressure level"))
+        list.append(OpenMetric("stats_memory_swapins", Double(self.swapins), type: .counter, help: "Pages swapped in"))
+        list.append(OpenMetric("stats_memory_swapouts", Double(self.swapouts), type: .counter, help: "Pages swapped out"))
+        if let rates = self.rates {
+            list += [("compressions", rates.compressions), ("decompressions", rates.decompressions), ("swapins", rates.swapins), ("swapouts", rates.swapouts)].map {
+                OpenMetric("stats_memory_pages_rate", $0.1, help: "Pages per second", labels: [("type", $0.0)])
+            }
+        }
+        return list
+    }
 }
 
 public struct Swap: Codable {
@@ -51,6 +74,8 @@ public struct Swap: Codable {
 public struct Pressure: Codable {
     let level: Int
     let value: RAMPressure
+    // time of the last change of the level
+    var since: Date? = nil
 }
 
 public class RAM: Module {
@@ -15,6 +15,12 @@ import Kit
 internal class UsageReader: Reader<RAM_Usage> {
     public var totalSize: Double = 0
     
+    // the samples are taken on the queue, from the timer of the reader, the pressure events and the fast timer
+    private let queue = DispatchQueue(label: "eu.exelban.RAM.pressure")
+    private let monitor = MemoryPressureMonitor()
+    private var source: DispatchSourceMemoryPressure? = nil
+    private var timer: DispatchSourceTimer? = nil
+    
     public override func setup() {
         var stats = host_basic_info()
         var count = UInt32(MemoryLayout<host_basic_info_data_t>.size / MemoryLayout<integer_t>.size)
@@ -25,6 +31,16 @@ internal class UsageReader: Reader<RAM_Usage> {
             }
         }
         
+        let source = DispatchSource.makeMemoryPressureSource(eventMask: [.normal, .warning, .critical], queue: self.queue)
+        source.setEventHandler { [weak self] in
+            guard let self, let event = self.source?.data else { return }
+            let level: RAMPressure = event.contains(.critical) ? .critical : event.contains(.warning) ? .warning : .normal
+            guard self.active, self.monitor.set(level) else { return }
+            self.sample()
+        }
+        source.resume()
+        self.source = source
+        
         if kerr == KERN_SUCCESS {
             self.totalSize = Double(stats.max_mem)
             return
@@ -34,7 +50,39 @@ internal class UsageReader: Reader<RAM_Usage> {
         error("host_info(): \(String(cString: mach_error_string(kerr), encoding: String.Encoding.ascii) ?? "unknown error")", log: self.log)
     }
     
+    public override func terminate() {
+        self.queue.sync {
+            self.source?.cancel()
+            self.source = nil
+            self.timer?.cancel()
+            self.timer = nil
+        }
+    }
+    
     public override func read() {
+        self.queue.sync {
+            self.sample()
+        }
+    }
+    
+    // samples at the fast interval while the pressure is elevated
+    private func schedule() {
+        if self.monitor.elevated && self.active {
+            guard self.timer == nil else { return }
+            let timer = DispatchSource.makeTimerSource(queue: self.queue)
+            timer.schedule(deadline: .now() + self.monitor.fastInterval, repeating: self.monitor.fastInterval)
+            timer.setEventHandler { [weak self] in
+                self?.sample()
+            }
+            timer.resume()
+            self.timer = timer
+        } else if let timer = self.timer {
+            timer.cancel()
+            self.timer = nil
+        }
+    }
+    
+    private func sample() {
         var stats = vm_statistics64()
         var count = UInt32(MemoryLayout<vm_statistics64_data_t>.size / MemoryLayout<integer_t>.size)
         
@@ -45,6 +93,7 @@ internal class UsageReader: Reader<RAM_Usage> {
         }
         
         if result == KERN_SUCCESS {
+            let time = TimeInterval(DispatchTime.now().uptimeNanoseconds) / 1_000_000_000
             let active = Double(stats.active_count) * Double(vm_page_size)
             let speculative = Double(stats.speculative_count) * Double(vm_page_size)
             let inactive = Double(stats.inactive_count) * Double(vm_page_size)
@@ -62,12 +111,15 @@ internal class UsageReader: Reader<RAM_Usage> {
             var pressureLevel: Int = 0
             sysctlbyname("kern.memorystatus_vm_pressure_level", &pressureLevel, &intSize, nil, 0)
             
-            var pressureValue: RAMPressure
-            switch pressureLevel {
-            case 2: pressureValue = .warning
-            case 4: pressureValue = .critical
-            default: pressureValue = .normal
-            }
+            // an event could be missed while the reader was paused, the polled level is recorded too
+            self.monitor.set(MemoryPressureMonitor.level(pressureLevel))
+            self.schedule()
+            let rates = self.monitor.rates(VMCounters(
+                compressions: stats.compressions,
+                decompressions: stats.decompressions,
+                swapins: stats.swapins,
+                swapouts: stats.swapouts
+            ), time: time)
             
             var stringSize: size_t = MemoryLayout<xsw_usage>.size
             var swap: xsw_usage = xsw_usage()
@@ -91,10 +143,11 @@ internal class UsageReader: Reader<RAM_Usage> {
                     used: Double(swap.xsu_used),
                     free: Double(swap.xsu_avail)
                 ),
-                pressure: Pressure(level: pressureLevel, value: pressureValue),
+                pressure: Pressure(level: pressureLevel, value: self.monitor.level, since: self.monitor.since),
                 
                 swapins: swapins,
-                swapouts: swapouts
+                swapouts: swapouts,
+                rates: rates
             ))
             return
         }
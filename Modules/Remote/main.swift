@@ -108,7 +108,7 @@ public struct RemoteSnapshot: Codable {
     public let order: RemoteAccountOrder
 }
 
-private struct RemoteAccountResponse: Decodable {
+internal struct RemoteAccountResponse: Decodable {
     let settings: Settings?
     struct Settings: Decodable {
         let order: [String]?
@@ -165,6 +165,10 @@ public struct RemoteHost: Codable {
     }
 }
 
+extension RemoteMachine: SyncItem {}
+extension RemoteHost: SyncItem {}
+extension RemoteGroup: SyncItem {}
+
 public struct RemoteHostBucket: Codable {
     public let ts: String
     public let status: String
@@ -194,6 +198,9 @@ public class Remote: Module {
         self.settingsView.toggleCallback = { [weak self] in
             self?.dataReader?.read()
         }
+        self.popupView.appearCallback = { [weak self] in
+            self?.dataReader?.refresh()
+        }
         
         NotificationCenter.default.addObserver(self, selector: #selector(self.handleRemoteState), name: .remoteState, object: nil)
         
@@ -253,43 +260,30 @@ public class Remote: Module {
 }
 
 extension SystemStats {
-    internal func fetchMachines() async -> [RemoteMachine] {
-        await self.fetchListAsync(path: "/v1/machine")
-    }
-    internal func fetchHosts(historyWindow: String = "") async -> [RemoteHost] {
-        let path = historyWindow.isEmpty ? "/v1/host" : "/v1/host?history=\(historyWindow)"
-        return await self.fetchListAsync(path: path)
-    }
-    internal func fetchGroups() async -> [RemoteGroup] {
-        await self.fetchListAsync(path: "/v1/group")
-    }
-    internal func fetchAccountOrder() async -> RemoteAccountOrder {
-        guard let request = self.authorizedGET("/v1/account") else {
-            return RemoteAccountOrder(machines: [], hosts: [])
-        }
-        guard let (data, response) = try? await self.session.data(for: request),
-              let http = response as? HTTPURLResponse, http.statusCode == 200,
-              let account = try? JSONDecoder().decode(RemoteAccountResponse.self, from: data) else {
-            return RemoteAccountOrder(machines: [], hosts: [])
+    // revalidates the cached list and returns it, the cache stays as it was when the request fails
+    internal func sync<T: SyncItem>(_ collection: SyncCollection<T>) async -> [T] {
+        guard self.isAuthorized, let request = collection.request(host: SystemStats.host, token: self.auth.accessToken),
+              let (data, response) = try? await self.session.data(for: request),
+              let http = response as? HTTPURLResponse else { return collection.list }
+        do {
+            try collection.apply(status: http.statusCode, data: data, etag: http.value(forHTTPHeaderField: "ETag"), cursor: http.value(forHTTPHeaderField: "X-Sync-Cursor"))
+        } catch let err {
+            debug("sync \(collection.path) failed: \(err)")
         }
-        return RemoteAccountOrder(machines: account.settings?.order ?? [], hosts: account.settings?.hostsOrder ?? [])
+        return collection.list
     }
     
-    private func fetchListAsync<T: Decodable>(path: String) async -> [T] {
-        guard let request = self.authorizedGET(path) else { return [] }
-        guard let (data, response) = try? await self.session.data(for: request),
-              let http = response as? HTTPURLResponse, http.statusCode == 200 else { return [] }
-        if let list = try? JSONDecoder().decode([T].self, from: data) { return list }
-        debug("fetch \(path) decode failed: \(String(data: data, encoding: .utf8) ?? "")")
-        return []
-    }
-    
-    private func authorizedGET(_ path: String) -> URLRequest? {
-        guard self.isAuthorized, let url = URL(string: "\(SystemStats.host)\(path)") else { return nil }
-        var request = URLRequest(url: url)
-        request.httpMethod = "GET"
-        request.setValue("Bearer \(self.auth.accessToken)", forHTTPHeaderField: "Authorization")
-        return request
+    internal func sync(_ account: SyncDocument<RemoteAccountResponse>) async -> RemoteAccountOrder {
+        if self.isAuthorized, let request = account.request(host: SystemStats.host, token: self.auth.accessToken),
+           let (data, response) = try? await self.session.data(for: request), let http = response as? HTTPURLResponse {
+            do {
+                try account.apply(status: http.statusCode, data: data, etag: http.value(forHTTPHeaderField: "ETag"))
+            } catch let err {
+                debug("sync \(account.path) failed: \(err)")
+            }
+        }
+        let settings = account.value?.settings
+        return RemoteAccountOrder(machines: settings?.order ?? [], hosts: settings?.hostsOrder ?? [])
     }
     
     internal func fetchMachines(completion: @escaping ([RemoteMachine]) -> Void) {
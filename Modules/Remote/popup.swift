@@ -55,6 +55,8 @@ internal class Popup: PopupWrapper {
         return view
     }()
     
+    internal var appearCallback: (() -> Void)? = nil
+    
     private var visible: Bool = false
     private var streams: [String: RemoteMachineStream] = [:]
     private var currentMachineIDs: [String] = []
@@ -94,6 +96,7 @@ internal class Popup: PopupWrapper {
         super.appear()
         self.visible = true
         self.syncStreams()
+        self.appearCallback?()
     }
     
     public override func disappear() {
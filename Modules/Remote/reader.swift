@@ -14,30 +14,63 @@ import Kit
 public final class DataReader: Reader<RemoteSnapshot> {
     private var task: Task<Void, Never>?
     private let taskLock = NSLock()
+    private var lastRead: Date? = nil
+    
+    // lists are kept between the reads and revalidated, unchanged ones are not downloaded again
+    private let machines = SyncCollection<RemoteMachine>(path: "/v1/machine")
+    private let hosts = SyncCollection<RemoteHost>(path: "/v1/host")
+    private let groups = SyncCollection<RemoteGroup>(path: "/v1/group")
+    private let account = SyncDocument<RemoteAccountResponse>(path: "/v1/account")
     
     public override func setup() {
         self.interval = 60
+        
+        // the last snapshot from the database is shown until the first sync
+        if let value = self.value {
+            self.machines.seed(value.machines)
+            self.hosts.seed(value.hosts)
+            self.groups.seed(value.groups)
+        }
     }
     
     public override func read() {
         guard SystemStats.shared.isAuthorized else {
+            self.machines.reset()
+            self.hosts.reset()
+            self.groups.reset()
+            self.account.reset()
             self.callback(nil)
             return
         }
         
         self.taskLock.lock()
+        self.lastRead = Date()
         self.task?.cancel()
         self.task = Task { [weak self] in
-            async let machines = SystemStats.shared.fetchMachines()
-            async let hosts = SystemStats.shared.fetchHosts()
-            async let groups = SystemStats.shared.fetchGroups()
-            async let order = SystemStats.shared.fetchAccountOrder()
+            guard let self else { return }
+            async let machines = SystemStats.shared.sync(self.machines)
+            async let hosts = SystemStats.shared.sync(self.hosts)
+            async let groups = SystemStats.shared.sync(self.groups)
+            async let order = SystemStats.shared.sync(self.account)
             
             let (m, h, g, o) = await (machines, hosts, groups, order)
             guard !Task.isCancelled else { return }
             
-            self?.callback(RemoteSnapshot(machines: m, hosts: h, groups: g, order: o))
+            self.callback(RemoteSnapshot(machines: m, hosts: h, groups: g, order: o))
         }
         self.taskLock.unlock()
     }
+    
+    // read when the popup opens, unless the last read was a moment ago
+    public func refresh() {
+        self.taskLock.lock()
+        let last = self.lastRead
+        self.taskLock.unlock()
+        if let last, Date().timeIntervalSince(last) < 10 {
+            return
+        }
+        DispatchQueue.global(qos: .userInitiated).async {
+            self.read()
+        }
+    }
 }
@@ -13,6 +13,7 @@
 
 #include <IOKit/hidsystem/IOHIDEventSystemClient.h>
 #include <CoreFoundation/CoreFoundation.h>
+#import <Foundation/Foundation.h>
 
 typedef struct __IOHIDEvent *IOHIDEventRef;
 typedef struct __IOHIDServiceClient *IOHIDServiceClientRef;
@@ -33,7 +34,22 @@ IOHIDEventRef IOHIDServiceClientCopyEvent(IOHIDServiceClientRef, int64_t , int32
 CFTypeRef IOHIDServiceClientCopyProperty(IOHIDServiceClientRef service, CFStringRef property);
 IOHIDFloat IOHIDEventGetFloatValue(IOHIDEventRef event, int32_t field);
 
-NSDictionary*AppleSiliconSensors(int page, int usage, int32_t type);
+typedef void (*IOHIDServiceClientCallback)(void *target, void *refcon, IOHIDServiceClientRef service);
+void IOHIDEventSystemClientRegisterDeviceMatchingCallback(IOHIDEventSystemClientRef client, IOHIDServiceClientCallback callback, void *target, void *refcon);
+void IOHIDServiceClientRegisterRemovalCallback(IOHIDServiceClientRef service, IOHIDServiceClientCallback callback, void *target, void *refcon);
+void IOHIDEventSystemClientScheduleWithDispatchQueue(IOHIDEventSystemClientRef client, dispatch_queue_t queue);
+void IOHIDEventSystemClientUnscheduleFromDispatchQueue(IOHIDEventSystemClientRef client, dispatch_queue_t queue);
+
+// Long-lived HID sampler: the event system client, the matched services and their product
+// names are created once and refreshed only when a service appears or disappears.
+@interface HIDSensorsSampler : NSObject
+- (instancetype)initWithPage:(int32_t)page usage:(int32_t)usage type:(int32_t)type;
+// Product names of the cached services, index matches the values buffer. Changes only when generation changes.
+@property (nonatomic, readonly) NSArray<NSString*> *names;
+@property (nonatomic, readonly) NSUInteger generation;
+// Copies the current event values into the preallocated buffer (NaN when the service has no event) and returns it.
+- (const double*)read;
+@end
 
 CFDictionaryRef IOReportCopyChannelsInGroup(CFStringRef a, CFStringRef b, uint64_t c, uint64_t d, uint64_t e);
 void IOReportMergeChannels(CFDictionaryRef a, CFDictionaryRef b, CFTypeRef null);
@@ -102,9 +102,9 @@ public class Sensors: Module {
     private func usageCallback(_ raw: Sensors_List?) {
         guard let value = raw, self.enabled else { return }
         
-        self.popupView.usageCallback(value.sensors)
+        self.popupView.usageCallback(value.sensors, history: value.history)
         self.portalView.usageCallback(value.sensors)
-        self.notificationsView.usageCallback(value.sensors)
+        self.notificationsView.usageCallback(value.sensors, history: value.history)
         
         let activeWidgets = self.menuBar.widgets.filter{ $0.isActive }
         self.sensorsReader?.sleepMode(state: activeWidgets.contains(where: {$0.item is Label}) && activeWidgets.count == 1)
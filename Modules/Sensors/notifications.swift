@@ -76,14 +76,21 @@ class Notifications: NotificationsWrapper {
         }
     }
     
-    internal func usageCallback(_ values: [Sensor_p]) {
+    internal func usageCallback(_ values: [Sensor_p], history: ValueHistory? = nil) {
         let sensors = values.filter({ !$0.notificationThreshold.isEmpty })
         let title = localizedString("Sensor threshold")
         
         for s in sensors {
             if let threshold = Double(s.notificationThreshold) {
                 let subtitle = localizedString("\(localizedString(s.name)): \(s.formattedPopupValue)")
-                self.checkDouble(id: s.key, value: s.value, threshold: threshold, title: title, subtitle: subtitle)
+                // both of the last two readings must cross the threshold, the history replaces the streak counter
+                if let history, let slot = history.index(of: s.key) {
+                    if let range = history.range(slot, last: 2, minimum: 2) {
+                        self.checkDouble(id: s.key, value: range.min, threshold: threshold, title: title, subtitle: subtitle, consecutive: 1)
+                    }
+                } else {
+                    self.checkDouble(id: s.key, value: s.value, threshold: threshold, title: title, subtitle: subtitle)
+                }
             }
         }
     }
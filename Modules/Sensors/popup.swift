@@ -185,11 +185,11 @@ internal class Popup: PopupWrapper {
         self.recalculateHeight()
     }
     
-    internal func usageCallback(_ values: [Sensor_p]) {
+    internal func usageCallback(_ values: [Sensor_p], history: ValueHistory? = nil) {
         DispatchQueue.main.async(execute: {
             values.filter({ $0 is Sensor }).forEach { (s: Sensor_p) in
                 if let sensor = self.list[s.key] as? SensorView {
-                    sensor.addHistoryPoint(s)
+                    sensor.addHistoryPoint(s, stats: history?.stats(s.key))
                 }
             }
             
@@ -298,8 +298,16 @@ internal class SensorView: NSStackView {
         self.valueView.update(value)
     }
     
-    public func addHistoryPoint(_ sensor: Sensor_p) {
+    public func addHistoryPoint(_ sensor: Sensor_p, stats: ValueHistory.Stats? = nil) {
         self.chartView.update(sensor.localValue, sensor.unit)
+        
+        if let stats {
+            var lower = sensor, upper = sensor, mean = sensor
+            lower.value = stats.min
+            upper.value = stats.max
+            mean.value = stats.mean
+            self.chartView.toolTip = "\(localizedString("Min")): \(lower.formattedPopupValue)\n\(localizedString("Average")): \(mean.formattedPopupValue)\n\(localizedString("Max")): \(upper.formattedPopupValue)"
+        }
     }
     
     private func open() {
@@ -10,38 +10,128 @@
 //
 
 #import <Foundation/Foundation.h>
+#import <stdatomic.h>
 #import "bridge.h"
 
-NSDictionary*AppleSiliconSensors(int32_t page, int32_t usage, int32_t type) {
+@interface HIDSensorsSampler ()
+- (void)markDirty;
+@end
+
+@implementation HIDSensorsSampler {
+    IOHIDEventSystemClientRef _client;
+    dispatch_queue_t _queue;
+    int32_t _type;
+    CFArrayRef _services;
+    CFMutableSetRef _registered;
+    double *_values;
+    NSUInteger _capacity;
+    atomic_bool _dirty;
+}
+
+static void HIDSensorsSamplerChanged(void *target, void *refcon, IOHIDServiceClientRef service) {
+    [(__bridge HIDSensorsSampler *)target markDirty];
+}
+
+- (instancetype)initWithPage:(int32_t)page usage:(int32_t)usage type:(int32_t)type {
+    self = [super init];
+    if (self == nil) {
+        return nil;
+    }
+    
+    _type = type;
+    _names = @[];
+    _generation = 0;
+    atomic_init(&_dirty, true);
+    
     NSDictionary* dictionary = @{@"PrimaryUsagePage":@(page),@"PrimaryUsage":@(usage)};
+    _client = IOHIDEventSystemClientCreate(kCFAllocatorDefault);
+    if (_client == nil) {
+        return self;
+    }
+    IOHIDEventSystemClientSetMatching(_client, (__bridge CFDictionaryRef)dictionary);
     
-    IOHIDEventSystemClientRef system = IOHIDEventSystemClientCreate(kCFAllocatorDefault);
-    IOHIDEventSystemClientSetMatching(system, (__bridge CFDictionaryRef)dictionary);
-    CFArrayRef services = IOHIDEventSystemClientCopyServices(system);
-    if (services == nil) {
-        return nil;
+    _queue = dispatch_queue_create("eu.exelban.Stats.Sensors.HID", DISPATCH_QUEUE_SERIAL);
+    IOHIDEventSystemClientRegisterDeviceMatchingCallback(_client, HIDSensorsSamplerChanged, (__bridge void *)self, NULL);
+    IOHIDEventSystemClientScheduleWithDispatchQueue(_client, _queue);
+    
+    return self;
+}
+
+- (void)dealloc {
+    if (_client != nil) {
+        IOHIDEventSystemClientUnscheduleFromDispatchQueue(_client, _queue);
+        CFRelease(_client);
+    }
+    if (_services != nil) {
+        CFRelease(_services);
+    }
+    if (_registered != nil) {
+        CFRelease(_registered);
+    }
+    free(_values);
+}
+
+- (void)markDirty {
+    atomic_store(&_dirty, true);
+}
+
+- (void)refresh {
+    if (_services != nil) {
+        CFRelease(_services);
+        _services = nil;
     }
     
-    NSMutableDictionary*dict = [NSMutableDictionary dictionary];
-    for (int i = 0; i < CFArrayGetCount(services); i++) {
-        IOHIDServiceClientRef service = (IOHIDServiceClientRef)CFArrayGetValueAtIndex(services, i);
+    _services = IOHIDEventSystemClientCopyServices(_client);
+    NSUInteger count = _services != nil ? (NSUInteger)CFArrayGetCount(_services) : 0;
+    
+    NSMutableArray<NSString*> *names = [NSMutableArray arrayWithCapacity:count];
+    // the removal callback is registered once per service, the set keeps only the current services
+    CFMutableSetRef registered = CFSetCreateMutable(kCFAllocatorDefault, (CFIndex)count, &kCFTypeSetCallBacks);
+    for (NSUInteger i = 0; i < count; i++) {
+        IOHIDServiceClientRef service = (IOHIDServiceClientRef)CFArrayGetValueAtIndex(_services, i);
         NSString* name = CFBridgingRelease(IOHIDServiceClientCopyProperty(service, CFSTR("Product")));
-        
-        IOHIDEventRef event = IOHIDServiceClientCopyEvent(service, type, 0, 0);
+        [names addObject:name ?: @""];
+        if (_registered == nil || !CFSetContainsValue(_registered, service)) {
+            IOHIDServiceClientRegisterRemovalCallback(service, HIDSensorsSamplerChanged, (__bridge void *)self, NULL);
+        }
+        CFSetAddValue(registered, service);
+    }
+    if (_registered != nil) {
+        CFRelease(_registered);
+    }
+    _registered = registered;
+    
+    if (count > _capacity) {
+        free(_values);
+        _values = malloc(sizeof(double) * count);
+        _capacity = count;
+    }
+    
+    _names = names;
+    _generation += 1;
+}
+
+- (const double*)read {
+    if (_client == nil) {
+        return NULL;
+    }
+    if (atomic_exchange(&_dirty, false)) {
+        [self refresh];
+    }
+    
+    NSUInteger count = _names.count;
+    for (NSUInteger i = 0; i < count; i++) {
+        IOHIDServiceClientRef service = (IOHIDServiceClientRef)CFArrayGetValueAtIndex(_services, i);
+        IOHIDEventRef event = IOHIDServiceClientCopyEvent(service, _type, 0, 0);
         if (event == nil) {
+            _values[i] = NAN;
             continue;
         }
-        
-        if (name && event) {
-            double value = IOHIDEventGetFloatValue(event, IOHIDEventFieldBase(type));
-            dict[name]=@(value);
-        }
-        
+        _values[i] = IOHIDEventGetFloatValue(event, IOHIDEventFieldBase(_type));
         CFRelease(event);
     }
     
-    CFRelease(services);
-    CFRelease(system);
-    
-    return dict;
+    return _values;
 }
+
+@end
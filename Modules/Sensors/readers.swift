@@ -16,10 +16,11 @@ internal class SensorsReader: Reader<Sensors_List> {
     static let HIDtypes: [SensorType] = [.temperature, .voltage]
     
     internal var list: Sensors_List = Sensors_List()
+    // one hour of values at the default 1 second interval
+    internal let history: ValueHistory = ValueHistory(capacity: 3600)
     
     private var lastRead: TimeInterval = ProcessInfo.processInfo.systemUptime
     private let firstRead: TimeInterval = ProcessInfo.processInfo.systemUptime
-    private var lastIOSensorsRead: Date? = nil
     
     private var HIDState: Bool {
         Store.shared.bool(key: "Sensors_hid", defaultValue: false)
@@ -28,7 +29,12 @@ internal class SensorsReader: Reader<Sensors_List> {
     
     private var channels: CFMutableDictionary? = nil
     private var subscription: IOReportSubscriptionRef? = nil
-    private var powers: (CPU: Double, GPU: Double, ANE: Double, RAM: Double, PCI: Double) = (0.0, 0.0, 0.0, 0.0, 0.0)
+    private var HIDSamplers: [SensorType: HIDSensorsSampler] = [:]
+    private var HIDSlots: [SensorType: (generation: Int, count: Int, indexes: [Int?])] = [:]
+    private var IOSamples: IOReportSamples? = nil
+    private var derived: DerivedGraph? = nil
+    private var derivedSlots: [Int?] = []
+    private var historySlots: [Int] = []
     
     init(callback: @escaping (T?) -> Void = {_ in }) {
         self.unknownSensorsState = Store.shared.bool(key: "Sensors_unknown", defaultValue: false)
@@ -40,6 +46,7 @@ internal class SensorsReader: Reader<Sensors_List> {
         dict?.release()
         
         self.list.sensors = self.sensors()
+        self.list.history = self.history
     }
     
     private func sensors() -> [Sensor_p] {
@@ -141,37 +148,19 @@ internal class SensorsReader: Reader<Sensors_List> {
             sensors[i].value = newValue
         }
         
-        var cpuSensors = sensors.filter({ $0.group == .CPU && $0.type == .temperature && $0.average }).map{ $0.value }
-        var gpuSensors = sensors.filter({ $0.group == .GPU && $0.type == .temperature && $0.average }).map{ $0.value }
         let fanSensors = sensors.filter({ $0.type == .fan && !$0.isComputed })
         
         #if arch(arm64)
         if self.HIDState {
             for typ in SensorsReader.HIDtypes {
-                let (page, usage, type) = self.m1Preset(type: typ)
-                AppleSiliconSensors(page, usage, type).forEach { (key, value) in
-                    guard let key = key as? String, let value = value as? Double, value < 300 && value >= 0 else {
-                        return
-                    }
-                    
-                    if let idx = sensors.firstIndex(where: { $0.group == .hid && $0.key == key }) {
-                        sensors[idx].value = value
-                    }
-                }
-            }
-            
-            cpuSensors += sensors.filter({ $0.key.hasPrefix("pACC MTR Temp") || $0.key.hasPrefix("eACC MTR Temp") }).map{ $0.value }
-            gpuSensors += sensors.filter({ $0.key.hasPrefix("GPU MTR Temp") }).map{ $0.value }
-            
-            let socSensors = sensors.filter({ $0.key.hasPrefix("SOC MTR Temp") }).map{ $0.value }
-            if !socSensors.isEmpty {
-                if let idx = sensors.firstIndex(where: { $0.key == "Average SOC" }) {
-                    sensors[idx].value = socSensors.reduce(0, +) / Double(socSensors.count)
-                }
-                if let max = socSensors.max() {
-                    if let idx = sensors.firstIndex(where: { $0.key == "Hottest SOC" }) {
-                        sensors[idx].value = max
-                    }
+                let sampler = self.HIDSampler(typ)
+                guard let values = sampler.read() else { continue }
+                let indexes = self.HIDIndexes(typ, sampler: sampler, sensors: sensors)
+                for (i, idx) in indexes.enumerated() {
+                    guard let idx else { continue }
+                    let value = values[i]
+                    guard !value.isNaN, value < 300 && value >= 0 else { continue }
+                    sensors[idx].value = value
                 }
             }
         }
@@ -195,26 +184,8 @@ internal class SensorsReader: Reader<Sensors_List> {
         }
         #endif
         
-        if !cpuSensors.isEmpty {
-            if let idx = sensors.firstIndex(where: { $0.key == "Average CPU" }) {
-                sensors[idx].value = cpuSensors.reduce(0, +) / Double(cpuSensors.count)
-            }
-            if let max = cpuSensors.max() {
-                if let idx = sensors.firstIndex(where: { $0.key == "Hottest CPU" }) {
-                    sensors[idx].value = max
-                }
-            }
-        }
-        if !gpuSensors.isEmpty {
-            if let idx = sensors.firstIndex(where: { $0.key == "Average GPU" }) {
-                sensors[idx].value = gpuSensors.reduce(0, +) / Double(gpuSensors.count)
-            }
-            if let max = gpuSensors.max() {
-                if let idx = sensors.firstIndex(where: { $0.key == "Hottest GPU" }) {
-                    sensors[idx].value = max
-                }
-            }
-        }
+        self.updateDerivedSensors(&sensors)
+        
         if !fanSensors.isEmpty && fanSensors.count > 1 {
             if let f = fanSensors.max(by: { $0.value < $1.value }) as? Fan {
                 if let idx = sensors.firstIndex(where: { $0.key == "Fastest fan" }) {
@@ -252,6 +223,8 @@ internal class SensorsReader: Reader<Sensors_List> {
             sensors[idx].value = 0
         }
         
+        self.updateHistory(sensors)
+        
         let updated = Dictionary(sensors.map{ ($0.key, $0) }, uniquingKeysWith: { (first, _) in first })
         self.list.update { current in
             var list = current
@@ -269,32 +242,24 @@ internal class SensorsReader: Reader<Sensors_List> {
     private func initCalculatedSensors(_ sensors: [Sensor_p]) -> [Sensor_p] {
         var list: [Sensor_p] = []
         
-        var cpuSensors = sensors.filter({ $0.group == .CPU && $0.type == .temperature && $0.average }).map{ $0.value }
-        var gpuSensors = sensors.filter({ $0.group == .GPU && $0.type == .temperature && $0.average }).map{ $0.value }
+        let definitions = self.derivedDefinitions(sensors)
+        let graph = DerivedGraph(sources: sensors.map{ $0.key }.filter{ key in !definitions.contains(where: { $0.key == key }) }, definitions: definitions)
+        for s in sensors {
+            if let slot = graph.slot(s.key) {
+                graph.set(slot, s.value)
+            }
+        }
+        graph.evaluate()
         
-        #if arch(arm64)
-        if self.HIDState {
-            cpuSensors += sensors.filter({ $0.key.hasPrefix("pACC MTR Temp") || $0.key.hasPrefix("eACC MTR Temp") }).map{ $0.value }
-            gpuSensors += sensors.filter({ $0.key.hasPrefix("GPU MTR Temp") }).map{ $0.value }
+        let builtin = self.builtinDefinitions(sensors).map{ $0.key }
+        for d in graph.definitions where !sensors.contains(where: { $0.key == d.key }) {
+            guard let value = graph.value(d.key), let input = sensors.first(where: { d.matches($0.key) }) else { continue }
+            let group: SensorGroup = builtin.contains(d.key) ? input.group : .sensor
+            list.append(Sensor(key: d.key, name: d.name, value: value, group: group, type: input.type, platforms: Platform.all, isComputed: true))
         }
-        #endif
         
         let fanSensors = sensors.filter({ $0.type == .fan && !$0.isComputed })
         
-        if !cpuSensors.isEmpty {
-            let value = cpuSensors.reduce(0, +) / Double(cpuSensors.count)
-            list.append(Sensor(key: "Average CPU", name: "Average CPU", value: value, group: .CPU, type: .temperature, platforms: Platform.all, isComputed: true))
-            if let max = cpuSensors.max() {
-                list.append(Sensor(key: "Hottest CPU", name: "Hottest CPU", value: max, group: .CPU, type: .temperature, platforms: Platform.all, isComputed: true))
-            }
-        }
-        if !gpuSensors.isEmpty {
-            let value = gpuSensors.reduce(0, +) / Double(gpuSensors.count)
-            list.append(Sensor(key: "Average GPU", name: "Average GPU", value: value, group: .GPU, type: .temperature, platforms: Platform.all, isComputed: true))
-            if let max = gpuSensors.max() {
-                list.append(Sensor(key: "Hottest GPU", name: "Hottest GPU", value: max, group: .GPU, type: .temperature, platforms: Platform.all, isComputed: true))
-            }
-        }
         if !fanSensors.isEmpty && fanSensors.count > 1 {
             if let f = fanSensors.max(by: { $0.value < $1.value }) as? Fan {
                 list.append(Fan(id: -1, key: "Fastest fan", name: "Fastest fan", minSpeed: f.minSpeed, maxSpeed: f.maxSpeed, value: f.value, mode: .automatic, isComputed: true))
@@ -325,6 +290,61 @@ internal class SensorsReader: Reader<Sensors_List> {
     }
 }
 
+// MARK: - Derived sensors
+
+extension SensorsReader {
+    private func builtinDefinitions(_ sensors: [Sensor_p]) -> [Derived_t] {
+        let cpu = sensors.filter({ $0.group == .CPU && $0.type == .temperature && $0.average }).map{ $0.key } + ["pACC MTR Temp*", "eACC MTR Temp*"]
+        let gpu = sensors.filter({ $0.group == .GPU && $0.type == .temperature && $0.average }).map{ $0.key } + ["GPU MTR Temp*"]
+        
+        return [
+            Derived_t(key: "Average CPU", name: "Average CPU", operation: .avg, inputs: cpu),
+            Derived_t(key: "Hottest CPU", name: "Hottest CPU", operation: .max, inputs: cpu),
+            Derived_t(key: "Average GPU", name: "Average GPU", operation: .avg, inputs: gpu),
+            Derived_t(key: "Hottest GPU", name: "Hottest GPU", operation: .max, inputs: gpu),
+            Derived_t(key: "Average SOC", name: "Average SOC", operation: .avg, inputs: ["SOC MTR Temp*"]),
+            Derived_t(key: "Hottest SOC", name: "Hottest SOC", operation: .max, inputs: ["SOC MTR Temp*"])
+        ]
+    }
+    
+    // built-in computed sensors followed by the user defined ones (e.g. max of "*NVMe*" or sum of "CPU Power" and "GPU Power")
+    private func derivedDefinitions(_ sensors: [Sensor_p]) -> [Derived_t] {
+        self.builtinDefinitions(sensors) + Derived_t.load("\(ModuleType.sensors.stringValue)_derived")
+    }
+    
+    private func updateDerivedSensors(_ sensors: inout [Sensor_p]) {
+        if self.derived == nil || self.derivedSlots.count != sensors.count {
+            let definitions = self.derivedDefinitions(sensors)
+            let keys = Set(definitions.map{ $0.key })
+            let graph = DerivedGraph(sources: sensors.map{ $0.key }.filter{ !keys.contains($0) }, definitions: definitions)
+            self.derivedSlots = sensors.map{ graph.slot($0.key) }
+            self.derived = graph
+        }
+        guard let graph = self.derived else { return }
+        
+        for (i, slot) in self.derivedSlots.enumerated() {
+            if let slot, slot < graph.sources.count {
+                graph.set(slot, sensors[i].value)
+            }
+        }
+        graph.evaluate()
+        for (i, slot) in self.derivedSlots.enumerated() {
+            if let slot, slot >= graph.sources.count, let value = graph.value(at: slot) {
+                sensors[i].value = value
+            }
+        }
+    }
+    
+    private func updateHistory(_ sensors: [Sensor_p]) {
+        if self.historySlots.count != sensors.count {
+            self.historySlots = sensors.map{ self.history.slot($0.key) }
+        }
+        for (i, slot) in self.historySlots.enumerated() {
+            self.history.append(slot, sensors[i].value)
+        }
+    }
+}
+
 // MARK: - Fans
 
 extension SensorsReader {
@@ -433,16 +453,44 @@ extension SensorsReader {
         return (page, usage, eventType)
     }
     
+    // the sampler keeps the HID client and the services list alive between reads
+    private func HIDSampler(_ type: SensorType) -> HIDSensorsSampler {
+        if let sampler = self.HIDSamplers[type] {
+            return sampler
+        }
+        let (page, usage, eventType) = self.m1Preset(type: type)
+        let sampler = HIDSensorsSampler(page: page, usage: usage, type: eventType)
+        self.HIDSamplers[type] = sampler
+        return sampler
+    }
+    
+    // maps sampler service index to the sensor index, rebuilt only when services or sensors list changed
+    private func HIDIndexes(_ type: SensorType, sampler: HIDSensorsSampler, sensors: [Sensor_p]) -> [Int?] {
+        if let slots = self.HIDSlots[type], slots.generation == sampler.generation, slots.count == sensors.count {
+            return slots.indexes
+        }
+        
+        var lookup: [String: Int] = [:]
+        for (i, s) in sensors.enumerated() where s.group == .hid && lookup[s.key] == nil {
+            lookup[s.key] = i
+        }
+        let indexes = sampler.names.map{ lookup[$0] }
+        self.HIDSlots[type] = (sampler.generation, sensors.count, indexes)
+        
+        return indexes
+    }
+    
     private func initHIDSensors() -> [Sensor] {
         var list: [Sensor] = []
         
         for typ in SensorsReader.HIDtypes {
-            let (page, usage, type) = self.m1Preset(type: typ)
-            if let sensors = AppleSiliconSensors(page, usage, type) {
+            let sampler = self.HIDSampler(typ)
+            if let values = sampler.read() {
+                var sensors: [String: Double] = [:]
+                for (i, name) in sampler.names.enumerated() where !name.isEmpty && !values[i].isNaN {
+                    sensors[name] = values[i]
+                }
                 sensors.forEach { (key, value) in
-                    guard let key = key as? String, let value = value as? Double else {
-                        return
-                    }
                     var name: String = key
                     
                     HIDSensorsList.forEach { (s: Sensor) in
@@ -545,67 +593,78 @@ extension SensorsReader {
         ]
     }
     
-    private static func appleSiliconPower(currentEnergy: Double, previousEnergy: Double, elapsed: TimeInterval) -> Double {
-        guard elapsed > 0 else { return 0 }
-        return (currentEnergy - previousEnergy) / elapsed
-    }
-
-    private func IOSensors() -> (Double, Double, Double, Double, Double)? {
-        guard let reportSample = IOReportCreateSamples(self.subscription, self.channels, nil)?.takeRetainedValue(),
-              let dict = reportSample as? [String: Any],
-              let channelsList = dict["IOReportChannels"] as? NSArray else {
+    // resolves the energy model channels to flat slots once, the last matching channel is used for each component
+    private func compileIOSensors() -> IOReportSamples? {
+        guard let sample = IOReportCreateSamples(self.subscription, self.channels, nil)?.takeRetainedValue(),
+              let items = IOReportSamples.channels(sample) else {
             return nil
         }
-        let items = channelsList as CFArray
-        let now = Date()
         
-        let prevCPU = self.powers.CPU
-        let prevGPU = self.powers.GPU
-        let prevANE = self.powers.ANE
-        let prevRAM = self.powers.RAM
-        let prevPCI = self.powers.PCI
+        let count = CFArrayGetCount(items)
+        var groups: [Int] = Array(repeating: -1, count: count)
+        var scales: [Double] = Array(repeating: 0, count: count)
+        var last: [Int: Int] = [:]
         
-        for i in 0..<CFArrayGetCount(items) {
-            let dict = CFArrayGetValueAtIndex(items, i)
-            let item = unsafeBitCast(dict, to: CFDictionary.self)
-            
+        for i in 0..<count {
+            let item = IOReportSamples.channel(items, i)
             guard let group = IOReportChannelGetGroup(item)?.takeUnretainedValue() as? String,
                   group == "Energy Model",
                   let channel = IOReportChannelGetChannelName(item)?.takeUnretainedValue() as? String,
                   let unit = IOReportChannelGetUnitLabel(item)?.takeUnretainedValue() as? String else { continue }
             
-            let value = Double(IOReportSimpleGetIntegerValue(item, 0))
-            
+            var component: Int? = nil
             if channel.hasSuffix("CPU Energy") {
-                self.powers.CPU = value.power(unit)
+                component = 0
             } else if channel.hasSuffix("GPU Energy") {
-                self.powers.GPU = value.power(unit)
+                component = 1
             } else if channel.starts(with: "ANE") {
-                self.powers.ANE = value.power(unit)
+                component = 2
             } else if channel.starts(with: "DRAM") {
-                self.powers.RAM = value.power(unit)
+                component = 3
             } else if channel.starts(with: "PCI") && channel.hasSuffix("Energy") {
-                self.powers.PCI = value.power(unit)
+                component = 4
             }
+            guard let component else { continue }
+            
+            if let prev = last[component] {
+                groups[prev] = -1
+            }
+            last[component] = i
+            groups[i] = component
+            scales[i] = 1.0.power(unit)
         }
         
-        guard let lastIOSensorsRead = self.lastIOSensorsRead else {
-            self.lastIOSensorsRead = now
-            return (0, 0, 0, 0, 0)
+        let slots = IOReportSamples.layout(groups: groups, counts: Array(repeating: 1, count: count), scales: scales)
+        return slots.isEmpty ? nil : IOReportSamples(slots: slots)
+    }
+    
+    private func IOSensors() -> (Double, Double, Double, Double, Double)? {
+        if self.IOSamples == nil {
+            self.IOSamples = self.compileIOSensors()
+        }
+        guard let samples = self.IOSamples,
+              let reportSample = IOReportCreateSamples(self.subscription, self.channels, nil)?.takeRetainedValue(),
+              let items = IOReportSamples.channels(reportSample) else {
+            return nil
         }
-        guard prevCPU != 0 else {
-            self.lastIOSensorsRead = now
+        let count = CFArrayGetCount(items)
+        
+        samples.write { values in
+            for slot in samples.slots where slot.channel < count {
+                values[slot.offset] = Double(IOReportSimpleGetIntegerValue(IOReportSamples.channel(items, slot.channel), 0))
+            }
+        }
+        
+        guard samples.commit(time: ProcessInfo.processInfo.systemUptime) else {
             return (0, 0, 0, 0, 0)
         } // omit first read
         
-        let elapsed = now.timeIntervalSince(lastIOSensorsRead)
-        defer { self.lastIOSensorsRead = now }
         return (
-            Self.appleSiliconPower(currentEnergy: self.powers.CPU, previousEnergy: prevCPU, elapsed: elapsed),
-            Self.appleSiliconPower(currentEnergy: self.powers.GPU, previousEnergy: prevGPU, elapsed: elapsed),
-            Self.appleSiliconPower(currentEnergy: self.powers.ANE, previousEnergy: prevANE, elapsed: elapsed),
-            Self.appleSiliconPower(currentEnergy: self.powers.RAM, previousEnergy: prevRAM, elapsed: elapsed),
-            Self.appleSiliconPower(currentEnergy: self.powers.PCI, previousEnergy: prevPCI, elapsed: elapsed)
+            samples.rate(group: 0),
+            samples.rate(group: 1),
+            samples.rate(group: 2),
+            samples.rate(group: 3),
+            samples.rate(group: 4)
         )
     }
 }
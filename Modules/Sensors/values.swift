@@ -51,7 +51,7 @@ public protocol Sensor_p {
     var formattedPopupValue: String { get }
 }
 
-public class Sensors_List: Codable {
+public class Sensors_List: Codable, OpenMetricsType {
     private var queue: DispatchQueue = DispatchQueue(label: "eu.exelban.Stats.Sensors.SynchronizedArray", attributes: .concurrent)
     
     private var list: [Sensor_p] = []
@@ -66,6 +66,9 @@ public class Sensors_List: Codable {
         }
     }
     
+    // rolling window of the sensor values kept by the reader
+    public var history: ValueHistory? = nil
+    
     public func update(_ transform: ([Sensor_p]) -> [Sensor_p]) {
         self.queue.sync(flags: .barrier) {
             self.list = transform(self.list)
@@ -74,6 +77,7 @@ public class Sensors_List: Codable {
     
     private enum CodingKeys: String, CodingKey {
         case sensors
+        case stats
     }
     
     public init() {}
@@ -82,6 +86,10 @@ public class Sensors_List: Codable {
         let wrappers = sensors.map { Sensor_w($0) }
         var container = encoder.container(keyedBy: CodingKeys.self)
         try container.encode(wrappers, forKey: .sensors)
+        if let history = self.history {
+            let stats = Dictionary(sensors.compactMap{ s in history.stats(s.key).map{ (s.key, $0) } }, uniquingKeysWith: { (first, _) in first })
+            try container.encode(stats, forKey: .stats)
+        }
     }
     
     required public init(from decoder: Decoder) throws {
@@ -89,6 +97,21 @@ public class Sensors_List: Codable {
         let wrappers = try container.decode([Sensor_w].self, forKey: .sensors)
         self.sensors = wrappers.map { $0.sensor }
     }
+    
+    // values are in base units: celsius, volts, amperes, watts, joules and RPM
+    public func openMetrics() -> [OpenMetric] {
+        self.sensors.map { s in
+            let labels = [("key", s.key), ("name", s.name), ("group", s.group.rawValue)]
+            switch s.type {
+            case .temperature: return OpenMetric("stats_sensor_temperature_celsius", s.value, unit: "celsius", help: "Temperature", labels: labels)
+            case .voltage: return OpenMetric("stats_sensor_voltage_volts", s.value, unit: "volts", help: "Voltage", labels: labels)
+            case .current: return OpenMetric("stats_sensor_current_amperes", s.value, unit: "amperes", help: "Current", labels: labels)
+            case .power: return OpenMetric("stats_sensor_power_watts", s.value, unit: "watts", help: "Power", labels: labels)
+            case .energy: return OpenMetric("stats_sensor_energy_joules", s.value * 3_600, unit: "joules", help: "Energy", labels: labels)
+            case .fan: return OpenMetric("stats_fan_speed_rpm", s.value, help: "Fan speed", labels: labels)
+            }
+        }
+    }
 }
 
 public struct Sensor_w: Codable {
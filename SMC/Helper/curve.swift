@@ -0,0 +1,221 @@
+//
+//  curve.swift
+//  Helper
+//
+//  Created by Serhiy Mytrovtsiy on 18/10/2026
+//  Using Swift 6.0
+//  Running on macOS 26.5
+//
+//  Copyright © 2026 Serhiy Mytrovtsiy. All rights reserved.
+//
+
+import Foundation
+
+public struct FanCurve: Codable, Equatable {
+    public struct Point: Codable, Equatable {
+        public var temperature: Double
+        public var speed: Double
+        
+        public init(temperature: Double, speed: Double) {
+            self.temperature = temperature
+            self.speed = speed
+        }
+    }
+    
+    public struct PID: Codable, Equatable {
+        public var target: Double
+        public var kp: Double
+        public var ki: Double
+        public var kd: Double
+        
+        public init(target: Double, kp: Double, ki: Double, kd: Double) {
+            self.target = target
+            self.kp = kp
+            self.ki = ki
+            self.kd = kd
+        }
+    }
+    
+    // SMC keys of the temperature sensors, the hottest one drives the fan
+    public var sensors: [String]
+    public var points: [Point]
+    public var hysteresis: Double
+    public var pid: PID?
+    public var interval: Double
+    
+    public init(sensors: [String], points: [Point], hysteresis: Double = 2, pid: PID? = nil, interval: Double = 2) {
+        self.sensors = sensors
+        self.points = points.sorted{ $0.temperature < $1.temperature }
+        self.hysteresis = hysteresis
+        self.pid = pid
+        self.interval = interval
+    }
+    
+    // linear interpolation between the curve points, clamped to the first and last point
+    public func speed(_ temperature: Double) -> Double? {
+        guard let first = self.points.first, let last = self.points.last else { return nil }
+        if temperature <= first.temperature { return first.speed }
+        if temperature >= last.temperature { return last.speed }
+        
+        for i in 1..<self.points.count where temperature <= self.points[i].temperature {
+            let a = self.points[i-1], b = self.points[i]
+            guard b.temperature > a.temperature else { return b.speed }
+            return a.speed + (b.speed - a.speed) * (temperature - a.temperature) / (b.temperature - a.temperature)
+        }
+        
+        return last.speed
+    }
+}
+
+// Converts the temperature to the fan target. In curve mode the fan ramps up immediately and
+// slows down only when the temperature drops by the hysteresis below the point of the last change.
+// In PID mode the curve value at the PID target is used as a feed-forward.
+public struct FanCurveController {
+    public let curve: FanCurve
+    public let minSpeed: Double
+    public let maxSpeed: Double
+    
+    public private(set) var target: Double? = nil
+    
+    private var anchor: Double? = nil
+    private var integral: Double = 0
+    private var previousError: Double? = nil
+    private var previousTime: TimeInterval? = nil
+    
+    public init(curve: FanCurve, minSpeed: Double, maxSpeed: Double) {
+        self.curve = curve
+        self.minSpeed = minSpeed
+        self.maxSpeed = max(minSpeed, maxSpeed)
+    }
+    
+    public mutating func update(temperature: Double?, time: TimeInterval) -> Double {
+        guard let temperature else {
+            self.target = self.maxSpeed
+            return self.maxSpeed
+        }
+        
+        let value: Double
+        if let pid = self.curve.pid {
+            value = self.pid(pid, temperature: temperature, time: time)
+        } else {
+            value = self.hysteresis(temperature)
+        }
+        
+        self.target = value
+        return value
+    }
+    
+    private mutating func hysteresis(_ temperature: Double) -> Double {
+        let desired = self.clamp(self.curve.speed(temperature) ?? self.maxSpeed)
+        
+        if let target = self.target, let anchor = self.anchor {
+            if desired > target || temperature <= anchor - self.curve.hysteresis {
+                self.anchor = temperature
+                return desired
+            }
+            return target
+        }
+        
+        self.anchor = temperature
+        return desired
+    }
+    
+    private mutating func pid(_ pid: FanCurve.PID, temperature: Double, time: TimeInterval) -> Double {
+        let base = self.curve.speed(pid.target) ?? self.minSpeed
+        let error = temperature - pid.target
+        let dt = self.previousTime.map{ time - $0 } ?? 0
+        
+        var derivative: Double = 0
+        if dt > 0, let previousError = self.previousError {
+            derivative = (error - previousError) / dt
+        }
+        
+        let integral = self.integral + error * dt
+        let raw = base + pid.kp * error + pid.ki * integral + pid.kd * derivative
+        let output = self.clamp(raw)
+        
+        // anti-windup: do not accumulate the error when the output is already saturated in its direction
+        if raw == output || (raw > output && error < 0) || (raw < output && error > 0) {
+            self.integral = integral
+        }
+        self.previousError = error
+        self.previousTime = time
+        
+        return output
+    }
+    
+    private func clamp(_ value: Double) -> Double {
+        min(max(value, self.minSpeed), self.maxSpeed)
+    }
+}
+
+// Retry state for the fan writes. Instead of blocking with sleeps, a failed write is
+// rescheduled with exponential backoff and picked up on one of the next controller ticks.
+public struct FanWriteState: Codable, Equatable {
+    public private(set) var pending: Int? = nil
+    public private(set) var applied: Int? = nil
+    public private(set) var attempts: Int = 0
+    public private(set) var failed: Bool = false
+    public private(set) var inFlight: Bool = false
+    public private(set) var nextAttempt: TimeInterval = 0
+    
+    public var deadband: Int = 50
+    public var maxAttempts: Int = 10
+    public var delay: TimeInterval = 0.05
+    public var maxDelay: TimeInterval = 5
+    
+    public init() {}
+    
+    public mutating func request(_ value: Int) {
+        if let applied = self.applied, self.pending == nil, abs(applied - value) < self.deadband {
+            return
+        }
+        // a new value, or the same one again after the writes gave up, starts the attempts again
+        if self.pending != value || self.failed {
+            self.pending = value
+            self.attempts = 0
+            self.failed = false
+            self.nextAttempt = 0
+        }
+    }
+    
+    // returns the value which must be written now, nil when nothing to do or waiting for the backoff
+    public mutating func due(time: TimeInterval) -> Int? {
+        guard !self.inFlight, !self.failed, let pending = self.pending, time >= self.nextAttempt else { return nil }
+        self.inFlight = true
+        return pending
+    }
+    
+    public mutating func completed(_ value: Int, success: Bool, time: TimeInterval) {
+        self.inFlight = false
+        guard self.pending == value else { return } // a newer value was requested meanwhile
+        
+        if success {
+            self.applied = value
+            self.pending = nil
+            self.attempts = 0
+            return
+        }
+        
+        self.attempts += 1
+        if self.attempts >= self.maxAttempts {
+            self.failed = true
+            return
+        }
+        self.nextAttempt = time + min(self.delay * pow(2, Double(self.attempts - 1)), self.maxDelay)
+    }
+}
+
+public struct FanCurveState: Codable, Equatable {
+    public let id: Int
+    public let temperature: Double?
+    public let target: Int?
+    public let write: FanWriteState
+    
+    public init(id: Int, temperature: Double?, target: Int?, write: FanWriteState) {
+        self.id = id
+        self.temperature = temperature
+        self.target = target
+        self.write = write
+    }
+}
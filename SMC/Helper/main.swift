@@ -17,18 +17,26 @@ helper.run()
 
 class Helper: NSObject, NSXPCListenerDelegate, HelperProtocol {
     private let listener: NSXPCListener
-    private let smcQueue = DispatchQueue(label: "eu.exelban.Stats.SMC.Helper.smcQueue")
+    private let smcQueue: DispatchQueue
     
     private var connections = [NSXPCConnection]()
     private var shouldQuit = false
     private var shouldQuitCheckInterval = 1.0
     
     private var smc: String? = nil
+    private let fanCurves: FanCurves
     
     override init() {
         self.listener = NSXPCListener(machServiceName: "eu.exelban.Stats.SMC.Helper")
+        let smcQueue = DispatchQueue(label: "eu.exelban.Stats.SMC.Helper.smcQueue")
+        self.smcQueue = smcQueue
+        self.fanCurves = FanCurves(smcQueue: smcQueue)
         super.init()
         self.listener.delegate = self
+        // set before the listener accepts a connection, so it is never read from two threads at once
+        self.fanCurves.call = { [weak self] arguments in
+            self?.callSMC(arguments) ?? (nil, "helper is not available", -1)
+        }
     }
     
     public func run() {
@@ -73,6 +81,7 @@ class Helper: NSObject, NSXPCListenerDelegate, HelperProtocol {
                 self.connections.remove(at: connectionIndex)
             }
             if self.connections.isEmpty {
+                self.fanCurves.stop()
                 self.shouldQuit = true
             }
         }
@@ -139,8 +148,9 @@ extension Helper {
         self.smc = path
     }
     
-    func setFanMode(id: Int, mode: Int, completion: (String?) -> Void) {
-        self.smcQueue.sync {
+    func setFanMode(id: Int, mode: Int, completion: @escaping (String?) -> Void) {
+        self.fanCurves.remove(id)
+        self.smcQueue.async {
             let result = self.callSMC(["fan", "\(id)", "-m", "\(mode)"])
             
             if let error = result.error, !error.isEmpty {
@@ -153,8 +163,9 @@ extension Helper {
         }
     }
     
-    func setFanSpeed(id: Int, value: Int, completion: (String?) -> Void) {
-        self.smcQueue.sync {
+    func setFanSpeed(id: Int, value: Int, completion: @escaping (String?) -> Void) {
+        self.fanCurves.remove(id)
+        self.smcQueue.async {
             let result = self.callSMC(["fan", "\(id)", "-v", "\(value)"])
             
             if let error = result.error, !error.isEmpty {
@@ -167,8 +178,9 @@ extension Helper {
         }
     }
     
-    func resetFanControl(completion: (String?) -> Void) {
-        self.smcQueue.sync {
+    func resetFanControl(completion: @escaping (String?) -> Void) {
+        self.fanCurves.removeAll()
+        self.smcQueue.async {
             let result = self.callSMC(["reset"])
             if let error = result.error, !error.isEmpty {
                 NSLog("error reset fan control: \(error)")
@@ -179,12 +191,31 @@ extension Helper {
         }
     }
     
-    public func callSMC(_ arguments: [String]) -> (output: String?, error: String?) {
+    func setFanCurve(id: Int, curve: Data, completion: @escaping (Bool) -> Void) {
+        guard let curve = try? JSONDecoder().decode(FanCurve.self, from: curve), !curve.sensors.isEmpty,
+              !curve.points.isEmpty || curve.pid != nil else {
+            NSLog("rejected fan curve for fan \(id)")
+            completion(false)
+            return
+        }
+        self.fanCurves.set(id, curve: curve)
+        completion(true)
+    }
+    
+    func removeFanCurve(id: Int, completion: @escaping (Bool) -> Void) {
+        completion(self.fanCurves.remove(id))
+    }
+    
+    func fanCurveState(completion: @escaping (Data?) -> Void) {
+        completion(try? JSONEncoder().encode(self.fanCurves.state()))
+    }
+    
+    public func callSMC(_ arguments: [String]) -> (output: String?, error: String?, status: Int32) {
         guard let smc = self.smc else {
-            return (nil, "missing smc tool")
+            return (nil, "missing smc tool", -1)
         }
         guard CodesignCheck.matchesSelf(path: smc) else {
-            return (nil, "smc tool failed signature validation")
+            return (nil, "smc tool failed signature validation", -1)
         }
 
         let task = Process()
@@ -205,15 +236,16 @@ extension Helper {
         do {
             try task.run()
         } catch let err {
-            return (nil, "runSMC: \(err.localizedDescription)")
+            return (nil, "runSMC: \(err.localizedDescription)", -1)
         }
         
         let outputData = outputPipe.fileHandleForReading.readDataToEndOfFile()
         let errorData = errorPipe.fileHandleForReading.readDataToEndOfFile()
         let output = String(data: outputData, encoding: .utf8)
         let error = String(data: errorData, encoding: .utf8)
+        task.waitUntilExit()
         
-        return (output, error)
+        return (output, error, task.terminationStatus)
     }
     
     func uninstall() {
@@ -230,6 +262,138 @@ extension Helper {
     }
 }
 
+// Closed-loop fan control: every fan with a curve is driven from its own timer. Temperatures are read
+// directly from the SMC, the writes go through the smc tool on the smc queue and never block the timer.
+class FanCurves {
+    private struct Fan {
+        var controller: FanCurveController
+        var write: FanWriteState = FanWriteState()
+        var temperature: Double? = nil
+        var lastUpdate: TimeInterval = 0
+        var unlocked: Bool = false
+    }
+    
+    private let queue = DispatchQueue(label: "eu.exelban.Stats.SMC.Helper.fanCurves")
+    private let smcQueue: DispatchQueue
+    var call: ([String]) -> (output: String?, error: String?, status: Int32) = { _ in (nil, "smc tool is not set", -1) }
+    
+    private var fans: [Int: Fan] = [:]
+    private var timer: DispatchSourceTimer? = nil
+    private var interval: Double = 0
+    
+    init(smcQueue: DispatchQueue) {
+        self.smcQueue = smcQueue
+    }
+    
+    func set(_ id: Int, curve: FanCurve) {
+        self.queue.async {
+            let minSpeed = SMC.shared.getValue("F\(id)Mn") ?? 0
+            let maxSpeed = SMC.shared.getValue("F\(id)Mx") ?? minSpeed
+            var fan = Fan(controller: FanCurveController(curve: curve, minSpeed: minSpeed, maxSpeed: maxSpeed))
+            fan.unlocked = self.fans[id]?.unlocked ?? false
+            self.fans[id] = fan
+            self.schedule()
+        }
+    }
+    
+    @discardableResult
+    func remove(_ id: Int) -> Bool {
+        self.queue.sync {
+            guard self.fans.removeValue(forKey: id) != nil else { return false }
+            self.schedule()
+            return true
+        }
+    }
+    
+    func removeAll() {
+        self.queue.sync {
+            self.fans.removeAll()
+            self.schedule()
+        }
+    }
+    
+    // gives the fans back to the system when the app is gone, it returns after the fans were reset
+    func stop() {
+        let ids: [Int] = self.queue.sync {
+            let ids = Array(self.fans.keys)
+            self.fans.removeAll()
+            self.schedule()
+            return ids
+        }
+        self.smcQueue.sync {
+            ids.forEach { _ = self.call(["fan", "\($0)", "-m", "\(FanMode.automatic.rawValue)"]) }
+        }
+    }
+    
+    func state() -> [FanCurveState] {
+        self.queue.sync {
+            self.fans.map { (id, fan) in
+                FanCurveState(id: id, temperature: fan.temperature, target: fan.controller.target.map{ Int($0) }, write: fan.write)
+            }.sorted{ $0.id < $1.id }
+        }
+    }
+    
+    private func schedule() {
+        let interval = self.fans.values.map{ $0.controller.curve.interval }.min() ?? 0
+        guard interval != self.interval || (interval > 0) != (self.timer != nil) else { return }
+        
+        self.timer?.cancel()
+        self.timer = nil
+        self.interval = interval
+        guard interval > 0 else { return }
+        
+        // the timer ticks faster than the curve interval so the retry backoff is not stretched to the interval
+        let timer = DispatchSource.makeTimerSource(queue: self.queue)
+        timer.schedule(deadline: .now(), repeating: min(interval, 0.25), leeway: .milliseconds(50))
+        timer.setEventHandler { [weak self] in
+            self?.tick()
+        }
+        timer.resume()
+        self.timer = timer
+    }
+    
+    private func tick() {
+        let now = ProcessInfo.processInfo.systemUptime
+        
+        for id in self.fans.keys {
+            guard var fan = self.fans[id] else { continue }
+            
+            if now - fan.lastUpdate >= fan.controller.curve.interval {
+                let values = fan.controller.curve.sensors.compactMap{ SMC.shared.getValue($0) }.filter{ $0 > 0 && $0 < 130 }
+                fan.temperature = values.max()
+                fan.write.request(Int(fan.controller.update(temperature: fan.temperature, time: now)))
+                fan.lastUpdate = now
+            }
+            
+            if let value = fan.write.due(time: now) {
+                let unlock = !fan.unlocked
+                self.smcQueue.async { [weak self] in
+                    guard let self else { return }
+                    var arguments = ["fan", "\(id)"]
+                    if unlock {
+                        arguments += ["-m", "\(FanMode.forced.rawValue)"]
+                    }
+                    arguments += ["-v", "\(value)"]
+                    // the tool reports a failed write on stdout and with a non-zero exit status
+                    let result = self.call(arguments)
+                    let success = result.status == 0 && !(result.output?.contains("[ERROR]") ?? false)
+                    if !success {
+                        NSLog("error set fan curve speed: \(result.output ?? "") \(result.error ?? "")")
+                    }
+                    self.queue.async {
+                        guard var fan = self.fans[id] else { return }
+                        fan.write.completed(value, success: success, time: ProcessInfo.processInfo.systemUptime)
+                        fan.unlocked = fan.unlocked || success
+                        self.fans[id] = fan
+                    }
+                }
+            }
+            
+            self.fans[id] = fan
+        }
+    }
+}
+
 // https://github.com/duanefields/VirtualKVM/blob/master/VirtualKVM/CodesignCheck.swift
 enum CodesignCheckError: Error {
     case message(String)
@@ -19,5 +19,10 @@ import Foundation
     func setFanSpeed(id: Int, value: Int, completion: @escaping (String?) -> Void)
     func resetFanControl(completion: @escaping (String?) -> Void)
     
+    // closed-loop fan curves run by the helper, the app has no client for them yet
+    func setFanCurve(id: Int, curve: Data, completion: @escaping (Bool) -> Void)
+    func removeFanCurve(id: Int, completion: @escaping (Bool) -> Void)
+    func fanCurveState(completion: @escaping (Data?) -> Void)
+    
     func uninstall()
 }
@@ -104,18 +104,25 @@ func main() {
             return
         }
         var help: Bool = true
+        var success: Bool = true
         
-        if let index = args.firstIndex(where: { $0 == "-v" }), args.indices.contains(index+1), let value = Int(args[index+1]) {
-            SMC.shared.setFanSpeed(id, speed: value)
+        // the mode is set first when given, "-v <speed>" alone switches the fan to the manual mode itself
+        if let index = args.firstIndex(where: { $0 == "-m" }), args.indices.contains(index+1),
+           let raw = Int(args[index+1]), let mode = FanMode.init(rawValue: raw) {
+            success = SMC.shared.setFanMode(id, mode: mode)
             help = false
         }
         
-        if let index = args.firstIndex(where: { $0 == "-m" }), args.indices.contains(index+1),
-           let raw = Int(args[index+1]), let mode = FanMode.init(rawValue: raw) {
-            SMC.shared.setFanMode(id, mode: mode)
+        if success, let index = args.firstIndex(where: { $0 == "-v" }), args.indices.contains(index+1), let value = Int(args[index+1]) {
+            success = SMC.shared.setFanSpeed(id, speed: value)
             help = false
         }
         
+        if !success {
+            print("[ERROR]: fan \(id) was not changed")
+            exit(1)
+        }
+        
         guard help else { return }
         
         print("Available Flags:")
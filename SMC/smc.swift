@@ -369,10 +369,11 @@ public class SMC {
         #endif
     }
     
-    public func setFanMode(_ id: Int, mode: FanMode) {
+    @discardableResult
+    public func setFanMode(_ id: Int, mode: FanMode) -> Bool {
         #if arch(arm64)
         if mode == .forced {
-            if !unlockFanControl(fanId: id) { return }
+            if !unlockFanControl(fanId: id) { return false }
         } else {
             let modeKey = fanModeKey(id)
             let targetKey = "F\(id)Tg"
@@ -382,11 +383,11 @@ public class SMC {
                 let readResult = read(&modeVal)
                 guard readResult == kIOReturnSuccess else {
                     print(smcError("read", key: modeKey, result: readResult))
-                    return
+                    return false
                 }
                 if modeVal.bytes[0] != 0 {
                     modeVal.bytes[0] = 0
-                    if !writeWithRetry(modeVal) { return }
+                    if !writeWithRetry(modeVal) { return false }
                 }
             }
             
@@ -394,7 +395,7 @@ public class SMC {
             let result = read(&targetValue)
             guard result == kIOReturnSuccess else {
                 print(smcError("read", key: targetKey, result: result))
-                return
+                return false
             }
             
             let bytes = Float(0).bytes
@@ -403,8 +404,9 @@ public class SMC {
             targetValue.bytes[2] = bytes[2]
             targetValue.bytes[3] = bytes[3]
             
-            if !writeWithRetry(targetValue) { return }
+            if !writeWithRetry(targetValue) { return false }
         }
+        return true
         #else
         // Intel
         if self.getValue("F\(id)Md") != nil {
@@ -414,7 +416,7 @@ public class SMC {
             result = read(&value)
             if result != kIOReturnSuccess {
                 print("Error read fan mode: " + (String(cString: mach_error_string(result), encoding: String.Encoding.ascii) ?? "unknown error"))
-                return
+                return false
             }
             
             value.bytes = [UInt8(mode.rawValue), UInt8(0), UInt8(0), UInt8(0), UInt8(0), UInt8(0),
@@ -427,7 +429,7 @@ public class SMC {
             result = write(value)
             if result != kIOReturnSuccess {
                 print("Error write: " + (String(cString: mach_error_string(result), encoding: String.Encoding.ascii) ?? "unknown error"))
-                return
+                return false
             }
         }
         
@@ -453,7 +455,7 @@ public class SMC {
         }
         
         if fansMode == newMode {
-            return
+            return true
         }
         
         var result: kern_return_t = 0
@@ -462,7 +464,7 @@ public class SMC {
         result = read(&value)
         if result != kIOReturnSuccess {
             print("Error read fan mode: " + (String(cString: mach_error_string(result), encoding: String.Encoding.ascii) ?? "unknown error"))
-            return
+            return false
         }
         
         value.bytes = [0, newMode, UInt8(0), UInt8(0), UInt8(0), UInt8(0),
@@ -475,12 +477,22 @@ public class SMC {
         result = write(value)
         if result != kIOReturnSuccess {
             print("Error write: " + (String(cString: mach_error_string(result), encoding: String.Encoding.ascii) ?? "unknown error"))
-            return
+            return false
         }
+        return true
         #endif
     }
     
-    public func setFanSpeed(_ id: Int, speed: Int) {
+    // a fan which is not in the manual mode is switched to it before the speed is written, so a speed
+    // can be sent without the mode (the firmware also puts the fan back to automatic on its own)
+    public static func speedNeedsManualMode(_ mode: UInt8) -> Bool {
+        mode != 1
+    }
+    
+    // a single write of the target speed, a fan in the automatic mode is switched to the manual one
+    // first. The speed write does not retry, the helper retries a failed write on its next ticks.
+    @discardableResult
+    public func setFanSpeed(_ id: Int, speed: Int) -> Bool {
         if let maxSpeed = self.getValue("F\(id)Mx"),
            speed > Int(maxSpeed) {
             return setFanSpeed(id, speed: Int(maxSpeed))
@@ -490,11 +502,12 @@ public class SMC {
         var modeVal = SMCVal_t(fanModeKey(id))
         let modeResult = read(&modeVal)
         guard modeResult == kIOReturnSuccess else {
-            print("Error read fan mode: " + (String(cString: mach_error_string(modeResult), encoding: String.Encoding.ascii) ?? "unknown error"))
-            return
+            print("[ERROR]: " + smcError("read", key: modeVal.key, result: modeResult))
+            return false
         }
-        if modeVal.bytes[0] != 1 {
-            if !unlockFanControl(fanId: id) { return }
+        if SMC.speedNeedsManualMode(modeVal.bytes[0]) && !self.setFanMode(id, mode: .forced) {
+            print("[ERROR]: fan \(id) cannot be switched to the manual mode")
+            return false
         }
         #endif
         
@@ -503,8 +516,8 @@ public class SMC {
         
         result = read(&value)
         if result != kIOReturnSuccess {
-            print("Error read fan value: " + (String(cString: mach_error_string(result), encoding: String.Encoding.ascii) ?? "unknown error"))
-            return
+            print("[ERROR]: read fan value: " + (String(cString: mach_error_string(result), encoding: String.Encoding.ascii) ?? "unknown error"))
+            return false
         }
         
         if value.dataType == "flt " {
@@ -520,17 +533,12 @@ public class SMC {
             value.bytes[3] = UInt8(0)
         }
         
-        #if arch(arm64)
-        if !writeWithRetry(value) {
-            return
-        }
-        #else
         result = write(value)
         if result != kIOReturnSuccess {
-            print("Error write: " + (String(cString: mach_error_string(result), encoding: String.Encoding.ascii) ?? "unknown error"))
-            return
+            print("[ERROR]: write: " + (String(cString: mach_error_string(result), encoding: String.Encoding.ascii) ?? "unknown error"))
+            return false
         }
-        #endif
+        return true
     }
     
     // MARK: - Apple Silicon Fan Control
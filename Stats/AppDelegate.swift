@@ -105,6 +105,7 @@ class AppDelegate: NSObject, NSApplicationDelegate, UNUserNotificationCenterDele
     func applicationWillTerminate(_ aNotification: Notification) {
         modules.forEach{ $0.terminate() }
         SystemStats.shared.terminate()
+        NextLog.flush()
     }
     
     deinit {
@@ -76,6 +76,7 @@ class ApplicationSettings: NSStackView {
     private var GPUTest: GPUStressTest? = GPUStressTest()
     
     private var planField: NSTextField?
+    private var spoolField: NSTextField?
     
     init() {
         super.init(frame: NSRect(x: 0, y: 0, width: Constants.Settings.width, height: Constants.Settings.height))
@@ -159,6 +160,7 @@ class ApplicationSettings: NSStackView {
             state: SystemStats.shared.update
         )
         self.planField = textView(SystemStats.shared.plan?.rawValue.capitalized ?? "Free")
+        self.spoolField = textView(self.spoolText())
         self.remoteView = PreferencesSection(title: localizedString("System Stats"), [
             PreferencesRow(localizedString("Authorization"), component: buttonView(#selector(self.loginToRemote), text: localizedString("Login"))),
             PreferencesRow(localizedString("Identificator"), component: textView(SystemStats.shared.id.uuidString)),
@@ -169,6 +171,7 @@ class ApplicationSettings: NSStackView {
             )),
             PreferencesRow(localizedString("Control"), component: self.remoteControlBtn!),
             PreferencesRow(localizedString("Update"), component: self.remoteUpdatesBtn!),
+            PreferencesRow(localizedString("Offline queue"), component: self.spoolField!),
             PreferencesRow(component: buttonView(#selector(self.logoutFromRemote), text: localizedString("Logout"))),
             PreferencesRow(component: buttonView(#selector(self.deregisterFromRemote), text: localizedString("Deregister")))
         ])
@@ -180,6 +183,15 @@ class ApplicationSettings: NSStackView {
         self.remoteView?.setRowVisibility(5, newState: false)
         self.remoteView?.setRowVisibility(6, newState: false)
         self.remoteView?.setRowVisibility(7, newState: false)
+        self.remoteView?.setRowVisibility(8, newState: false)
+        
+        scrollView.stackView.addArrangedSubview(PreferencesSection(title: localizedString("OpenMetrics"), [
+            PreferencesRow(localizedString("Local endpoint"), component: switchView(
+                action: #selector(self.toggleOpenMetricsState),
+                state: OpenMetricsExporter.shared.enabled
+            )),
+            PreferencesRow(localizedString("Address"), component: textView(OpenMetricsExporter.shared.url))
+        ]))
         
         scrollView.stackView.addArrangedSubview(PreferencesSection(title: localizedString("Settings"), [
             PreferencesRow(
@@ -243,6 +255,7 @@ class ApplicationSettings: NSStackView {
         self.remoteControlBtn?.state = SystemStats.shared.control ? .on : .off
         
         self.planField?.stringValue = SystemStats.shared.plan?.rawValue.capitalized ?? "Free"
+        self.spoolField?.stringValue = self.spoolText()
         self.setRemoteSettings(SystemStats.shared.isAuthorized)
         
         var idx = self.updateSelector?.indexOfSelectedItem ?? 0
@@ -476,6 +489,9 @@ class ApplicationSettings: NSStackView {
     @objc private func toggleRemoteMonitoringState(_ sender: NSButton) {
         SystemStats.shared.monitoring = sender.state == NSControl.StateValue.on
     }
+    @objc private func toggleOpenMetricsState(_ sender: NSButton) {
+        OpenMetricsExporter.shared.enabled = sender.state == NSControl.StateValue.on
+    }
     @objc private func toggleRemoteControlState(_ sender: NSButton) {
         if sender.state == .on {
             let alert = NSAlert()
@@ -534,6 +550,7 @@ class ApplicationSettings: NSStackView {
                 self.remoteView?.setRowVisibility(5, newState: true)
                 self.remoteView?.setRowVisibility(6, newState: true)
                 self.remoteView?.setRowVisibility(7, newState: true)
+                self.remoteView?.setRowVisibility(8, newState: true)
                 self.remoteView?.setRowVisibility(0, newState: false)
             } else {
                 self.remoteView?.setRowVisibility(0, newState: true)
@@ -544,10 +561,24 @@ class ApplicationSettings: NSStackView {
                 self.remoteView?.setRowVisibility(5, newState: false)
                 self.remoteView?.setRowVisibility(6, newState: false)
                 self.remoteView?.setRowVisibility(7, newState: false)
+                self.remoteView?.setRowVisibility(8, newState: false)
             }
         }
     }
     
+    // depth and lag of the metrics spooled while offline
+    private func spoolText() -> String {
+        guard let status = SystemStats.shared.spoolStatus, status.records > 0 else { return "0" }
+        var text = "\(status.records) (\(Units(bytes: Int64(status.bytes)).getReadableMemory()))"
+        if let lag = status.lag {
+            text += ", \(Int(lag))s"
+        }
+        if status.dropped > 0 {
+            text += ", \(status.dropped) \(localizedString("dropped"))"
+        }
+        return text
+    }
+    
     @objc private func toggleSystemWidgetsUpdatesState(_ sender: NSButton) {
         self.systemWidgetsUpdatesState = sender.state == NSControl.StateValue.on
     }
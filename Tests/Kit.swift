@@ -65,4 +65,1453 @@ class KitTests: XCTestCase {
         XCTAssertEqual(Units(bytes: 500_000).getReadableSpeed(base: .byte, unit: "MB"), "0.5 MB/s")
         XCTAssertEqual(Units(bytes: 500_000).getReadableSpeed(base: .bit, unit: "MB"), "4 Mb/s")
     }
+    
+    func testIOReportSamples_frequency() throws {
+        // two E-core channels (IDLE, DOWN + 3 states) and one P-core channel (IDLE + 2 states)
+        let slots = IOReportSamples.layout(groups: [0, -1, 0, 1], counts: [5, 3, 5, 3], active: [2, 0, 2, 1])
+        XCTAssertEqual(slots.count, 3)
+        XCTAssertEqual(slots.map{ $0.offset }, [0, 5, 10])
+        
+        let samples = IOReportSamples(slots: slots)
+        samples.write { $0 = [100, 10, 0, 0, 0, 50, 50, 0, 0, 0, 10, 0, 0] }
+        XCTAssertFalse(samples.commit(time: 1))
+        XCTAssertNil(samples.frequency(group: 0, frequencies: [600, 1000, 2000]))
+        
+        samples.write { $0 = [200, 10, 10, 30, 0, 50, 50, 0, 0, 40, 20, 20, 60] }
+        XCTAssertTrue(samples.commit(time: 1.5))
+        XCTAssertEqual(samples.elapsed, 0.5)
+        XCTAssertEqual(samples.deltas, [100, 0, 10, 30, 0, 0, 0, 0, 0, 40, 10, 20, 60])
+        
+        // (10*600 + 30*1000) / 40 = 900 and 2000, averaged over both channels
+        XCTAssertEqual(samples.frequency(group: 0, frequencies: [600, 1000, 2000]) ?? 0, 1450, accuracy: 0.001)
+        XCTAssertEqual(samples.frequency(group: 1, frequencies: [1000, 3000]) ?? 0, 2500, accuracy: 0.001)
+        XCTAssertNil(samples.frequency(group: 2, frequencies: [1000]))
+    }
+    
+    func testIOReportSamples_rate() throws {
+        let slots = IOReportSamples.layout(groups: [0, 1], counts: [1, 1], scales: [1e-3, 1e-9])
+        let samples = IOReportSamples(slots: slots)
+        
+        samples.write { $0 = [1_000, 5_000_000_000] }
+        samples.commit(time: 10)
+        XCTAssertEqual(samples.rate(group: 0), 0)
+        
+        samples.write { $0 = [3_000, 7_000_000_000] }
+        samples.commit(time: 12)
+        XCTAssertEqual(samples.rate(group: 0), 1, accuracy: 0.0001)
+        XCTAssertEqual(samples.rate(group: 1), 1, accuracy: 0.0001)
+    }
+    
+    func testDerivedGraph() throws {
+        let graph = DerivedGraph(sources: ["TC0P", "TC1P", "NVMe 1", "NVMe 2", "CPU Power", "GPU Power"], definitions: [
+            Derived_t(key: "Hottest NVMe", name: "Hottest NVMe", operation: .max, inputs: ["NVMe*"]),
+            Derived_t(key: "Total", name: "Total", operation: .clamp, inputs: ["SoC Power"], lower: 0, upper: 50),
+            Derived_t(key: "SoC Power", name: "SoC Power", operation: .sum, inputs: ["*Power"]),
+            Derived_t(key: "Loop A", name: "Loop A", operation: .avg, inputs: ["Loop B"]),
+            Derived_t(key: "Loop B", name: "Loop B", operation: .avg, inputs: ["Loop A"])
+        ])
+        XCTAssertEqual(graph.definitions.map{ $0.key }, ["Hottest NVMe", "SoC Power", "Total"])
+        
+        for (i, value) in [50.0, 60, 35, 41, 20, 45].enumerated() {
+            graph.set(i, value)
+        }
+        XCTAssertEqual(graph.evaluate(time: 1), 3)
+        XCTAssertEqual(graph.value("Hottest NVMe"), 41)
+        XCTAssertEqual(graph.value("SoC Power"), 65)
+        XCTAssertEqual(graph.value("Total"), 50)
+        
+        graph.set(0, 52)
+        XCTAssertEqual(graph.evaluate(time: 2), 0)
+        
+        graph.set(4, 2)
+        XCTAssertEqual(graph.evaluate(time: 3), 2)
+        XCTAssertEqual(graph.value("SoC Power"), 47)
+        XCTAssertEqual(graph.value("Total"), 47)
+    }
+    
+    func testFanCurveController_hysteresis() throws {
+        let curve = FanCurve(sensors: ["TC0P"], points: [FanCurve.Point(temperature: 80, speed: 5000), FanCurve.Point(temperature: 40, speed: 1000)], hysteresis: 2)
+        var controller = FanCurveController(curve: curve, minSpeed: 1200, maxSpeed: 4500)
+        
+        XCTAssertEqual(controller.update(temperature: 30, time: 0), 1200)
+        XCTAssertEqual(controller.update(temperature: 60, time: 1), 3000)
+        XCTAssertEqual(controller.update(temperature: 61, time: 2), 3100, accuracy: 0.001)
+        XCTAssertEqual(controller.update(temperature: 59.5, time: 3), 3100, accuracy: 0.001)
+        XCTAssertEqual(controller.update(temperature: 58.5, time: 4), 2850, accuracy: 0.001)
+        XCTAssertEqual(controller.update(temperature: 95, time: 5), 4500)
+        XCTAssertEqual(controller.update(temperature: nil, time: 6), 4500)
+    }
+    
+    func testFanCurveController_pid() throws {
+        let curve = FanCurve(sensors: ["TC0P"], points: [FanCurve.Point(temperature: 40, speed: 1000), FanCurve.Point(temperature: 90, speed: 6000)],
+                             pid: FanCurve.PID(target: 70, kp: 200, ki: 10, kd: 0))
+        var controller = FanCurveController(curve: curve, minSpeed: 1000, maxSpeed: 6000)
+        
+        // 30 W heat source with 10 J/K capacity, cooling improves with the fan speed
+        var temperature: Double = 40
+        for i in 0..<900 {
+            let rpm = controller.update(temperature: temperature, time: Double(i))
+            temperature += (30 - (temperature - 25) * (0.2 + 0.0002 * rpm)) / 10
+        }
+        
+        XCTAssertEqual(temperature, 70, accuracy: 0.1)
+        XCTAssertEqual(controller.target ?? 0, 2333, accuracy: 10)
+    }
+    
+    func testFanSpeedWithoutMode() throws {
+        // a speed sent to a fan in the automatic mode switches it to the manual one first
+        XCTAssertTrue(SMC.speedNeedsManualMode(0))
+        XCTAssertTrue(SMC.speedNeedsManualMode(3))
+        XCTAssertFalse(SMC.speedNeedsManualMode(1))
+    }
+    
+    func testFanWriteState_retry() throws {
+        var state = FanWriteState()
+        state.request(2000)
+        XCTAssertEqual(state.due(time: 0), 2000)
+        XCTAssertNil(state.due(time: 0))
+        
+        state.completed(2000, success: false, time: 0)
+        XCTAssertNil(state.due(time: 0.01))
+        XCTAssertEqual(state.due(time: 0.05), 2000)
+        state.completed(2000, success: false, time: 0.05)
+        XCTAssertNil(state.due(time: 0.1))
+        XCTAssertEqual(state.due(time: 0.15), 2000)
+        state.completed(2000, success: true, time: 0.15)
+        XCTAssertEqual(state.applied, 2000)
+        XCTAssertNil(state.pending)
+        
+        state.request(2030)
+        XCTAssertNil(state.due(time: 1))
+        state.request(2600)
+        XCTAssertEqual(state.due(time: 1), 2600)
+        state.request(3000)
+        state.completed(2600, success: true, time: 1.1)
+        XCTAssertEqual(state.due(time: 1.1), 3000)
+        
+        for i in 0..<10 {
+            state.completed(3000, success: false, time: 2 + Double(i) * 10)
+            _ = state.due(time: 3 + Double(i) * 10)
+        }
+        XCTAssertTrue(state.failed)
+        XCTAssertNil(state.due(time: 1000))
+        
+        // the same target requested again is retried
+        state.request(3000)
+        XCTAssertFalse(state.failed)
+        XCTAssertEqual(state.due(time: 1000), 3000)
+        state.completed(3000, success: true, time: 1000)
+        XCTAssertEqual(state.applied, 3000)
+    }
+    
+    func testValueHistory() throws {
+        let history = ValueHistory(capacity: 50)
+        let slot = history.slot("TC0P")
+        XCTAssertEqual(history.slot("TC0P"), slot)
+        XCTAssertNil(history.stats(slot))
+        
+        var values: [Double] = []
+        var seed: UInt32 = 7
+        for _ in 0..<537 {
+            seed = seed &* 1103515245 &+ 12345
+            let value = Double((seed >> 16) % 1000) / 10
+            values.append(value)
+            history.append(slot, value)
+            
+            let window = values.suffix(50)
+            let mean = window.reduce(0, +) / Double(window.count)
+            let variance = window.map{ ($0 - mean) * ($0 - mean) }.reduce(0, +) / Double(window.count)
+            guard let stats = history.stats(slot) else { return XCTFail("no stats") }
+            
+            XCTAssertEqual(stats.count, window.count)
+            XCTAssertEqual(stats.last, value, accuracy: 0.01)
+            XCTAssertEqual(stats.min, window.min() ?? 0, accuracy: 0.01)
+            XCTAssertEqual(stats.max, window.max() ?? 0, accuracy: 0.01)
+            XCTAssertEqual(stats.mean, mean, accuracy: 0.01)
+            XCTAssertEqual(stats.variance, variance, accuracy: 0.1)
+        }
+        
+        let ordered = history.withValues(slot) { older, newer in
+            Array(older) + Array(newer)
+        }
+        XCTAssertEqual(ordered.map{ Double($0) }, values.suffix(50).map{ Double(Float($0)) })
+        
+        let range = history.range(slot, last: 3)
+        XCTAssertEqual(range?.min ?? 0, values.suffix(3).min() ?? 0, accuracy: 0.01)
+        XCTAssertEqual(range?.max ?? 0, values.suffix(3).max() ?? 0, accuracy: 0.01)
+        
+        XCTAssertEqual(history.index(of: "TC0P"), slot)
+        XCTAssertNil(history.index(of: "TG0P"))
+        XCTAssertEqual(history.keys, ["TC0P"])
+        let single = history.slot("TA0P")
+        history.append(single, 80)
+        XCTAssertNil(history.range(single, last: 2, minimum: 2))
+        history.append(single, 70)
+        XCTAssertEqual(history.range(single, last: 2, minimum: 2)?.min, 70)
+    }
+    
+    func testChartDecimator_m4() throws {
+        let capacity = 10_000, columns = 270
+        var values: [Double] = []
+        var seed: UInt32 = 3
+        
+        let decimator = ChartDecimator(capacity: capacity, columns: columns)
+        for i in 0..<capacity*2 {
+            seed = seed &* 1103515245 &+ 12345
+            let value = Double((seed >> 16) % 1000)
+            values.append(value)
+            decimator.append(i, value)
+            decimator.trim(oldest: i + 1 - capacity) { values[$0] }
+        }
+        
+        let first = values.count - capacity
+        let lines = decimator.samples()
+        XCTAssertEqual(lines.count, 1)
+        let reduced = lines[0]
+        XCTAssertLessThanOrEqual(reduced.count, (columns + 1) * 4)
+        XCTAssertEqual(reduced.first?.index, first)
+        XCTAssertEqual(reduced.last?.index, values.count - 1)
+        XCTAssertEqual(decimator.maxValue, values[first...].max())
+        
+        // every bucket keeps its extremes
+        for id in first/decimator.width...(values.count-1)/decimator.width {
+            let range = max(id * decimator.width, first)..<min((id + 1) * decimator.width, values.count)
+            let kept = reduced.filter{ range.contains($0.index) }.map{ $0.value }
+            XCTAssertEqual(kept.max(), values[range].max())
+            XCTAssertEqual(kept.min(), values[range].min())
+        }
+        
+        let rebuilt = ChartDecimator(capacity: capacity, columns: columns)
+        for i in first..<values.count {
+            rebuilt.append(i, values[i])
+        }
+        XCTAssertEqual(rebuilt.samples(), lines)
+        
+        let frame = ChartFrame(width: 270, height: 50, scale: .linear)
+        let points = decimator.lines(first: first, count: capacity, frame: frame)[0]
+        XCTAssertEqual(points.first?.point.x ?? -1, 0, accuracy: 0.001)
+        XCTAssertEqual(points.last?.point.x ?? -1, 270, accuracy: 0.001)
+        XCTAssertLessThanOrEqual(points.map{ $0.point.y }.max() ?? 0, 50)
+    }
+    
+    func testChartDecimator_gaps() throws {
+        let decimator = ChartDecimator(capacity: 100, columns: 10, method: .lttb)
+        for i in 0..<100 {
+            decimator.append(i, i >= 40 && i < 50 ? nil : Double(i % 7))
+        }
+        let lines = decimator.samples()
+        XCTAssertEqual(lines.count, 2)
+        XCTAssertEqual(lines[0].first?.index, 0)
+        XCTAssertEqual(lines[0].last?.index, 39)
+        XCTAssertEqual(lines[1].first?.index, 50)
+        XCTAssertEqual(lines[1].last?.index, 99)
+        
+        let data = (0..<1000).map{ ChartSample(index: $0, value: $0 == 500 ? 100 : 0) }
+        let reduced = ChartDecimator.lttb(data, threshold: 20)
+        XCTAssertEqual(reduced.count, 20)
+        XCTAssertTrue(reduced.contains(where: { $0.value == 100 }))
+    }
+    
+    func testIntervalEstimator_median() throws {
+        var estimator = IntervalEstimator(window: 15)
+        var ts = Date(timeIntervalSince1970: 0)
+        var deltas: [TimeInterval] = []
+        var seed: UInt32 = 11
+        
+        XCTAssertNil(estimator.typical)
+        estimator.add(ts)
+        for _ in 0..<500 {
+            seed = seed &* 1103515245 &+ 12345
+            let delta = 0.5 + Double((seed >> 16) % 100) / 100 // irregular 0.5...1.5 s
+            ts = ts.addingTimeInterval(delta)
+            deltas.append(delta)
+            XCTAssertEqual(estimator.add(ts), 0)
+            
+            let window = deltas.suffix(15).sorted()
+            if window.count >= 2 {
+                XCTAssertEqual(estimator.typical ?? 0, window[window.count / 2], accuracy: 1e-9)
+            }
+        }
+        XCTAssertEqual(estimator.last, ts)
+        XCTAssertNil(estimator.gap)
+    }
+    
+    func testIntervalEstimator_gap() throws {
+        var estimator = IntervalEstimator()
+        var ts = Date(timeIntervalSince1970: 0)
+        for _ in 0..<10 {
+            ts = ts.addingTimeInterval(1)
+            estimator.add(ts)
+        }
+        XCTAssertEqual(estimator.typical, 1)
+        
+        let start = ts
+        ts = ts.addingTimeInterval(5)
+        XCTAssertEqual(estimator.add(ts), 4)
+        XCTAssertEqual(estimator.gap?.start, start)
+        XCTAssertEqual(estimator.gap?.end, ts)
+        XCTAssertEqual(estimator.typical, 1) // the gap is not counted as an interval
+        
+        estimator.interrupt()
+        ts = ts.addingTimeInterval(1.2)
+        XCTAssertEqual(estimator.add(ts), 0)
+        XCTAssertEqual(estimator.typical, 1)
+    }
+    
+    func testLRUCache() throws {
+        let cache = LRUCache<Int, String>(capacity: 3)
+        cache.set(1, "a")
+        cache.set(2, "b")
+        cache.set(3, "c")
+        XCTAssertEqual(cache.get(1), "a")
+        cache.set(4, "d")
+        
+        XCTAssertNil(cache.get(2))
+        XCTAssertEqual(cache.get(1), "a")
+        XCTAssertEqual(cache.get(3), "c")
+        XCTAssertEqual(cache.get(4), "d")
+        XCTAssertEqual(cache.count, 3)
+        
+        var calls = 0
+        _ = cache.value(5) { calls += 1; return "e" }
+        _ = cache.value(5) { calls += 1; return "e" }
+        XCTAssertEqual(calls, 1)
+        XCTAssertNil(cache.get(1))
+    }
+    
+    func testWidgetRenderCache() throws {
+        let cache = WidgetRenderCache()
+        let top = CGRect(x: 0, y: 9, width: 50, height: 9)
+        let bottom = CGRect(x: 0, y: 0, width: 50, height: 9)
+        
+        XCTAssertEqual(cache.update([(0, AnyHashable("1 KB/s"), top), (1, AnyHashable("0 KB/s"), bottom)]), top.union(bottom))
+        XCTAssertNil(cache.update([(0, AnyHashable("1 KB/s"), top), (1, AnyHashable("0 KB/s"), bottom)]))
+        XCTAssertEqual(cache.update([(0, AnyHashable("1 KB/s"), top), (1, AnyHashable("2 KB/s"), bottom)]), bottom)
+        
+        let step = 1.0 / 36
+        XCTAssertEqual(WidgetRenderCache.quantize(0.5, step: step), WidgetRenderCache.quantize(0.51, step: step))
+        XCTAssertNotEqual(WidgetRenderCache.quantize(0.5, step: step), WidgetRenderCache.quantize(0.53, step: step))
+        
+        var counter = RedrawCounter()
+        for i in 0..<120 {
+            counter.record(100 + Double(i) * 0.5)
+        }
+        XCTAssertEqual(counter.perMinute(159.9), 120)
+        XCTAssertEqual(counter.perMinute(189.5), 60)
+        XCTAssertEqual(counter.perMinute(300), 0)
+    }
+    
+    func testValueFormatter_decimal() throws {
+        for value in [0, 0.4, 1.25, 9.99, 12.345, 999.5, 123456.789] {
+            XCTAssertEqual(ValueFormatter.decimal(value, digits: 1), String(format: "%.1f", value))
+            XCTAssertEqual(ValueFormatter.decimal(value, digits: 0), String(format: "%.0f", value))
+        }
+        XCTAssertEqual(ValueFormatter.decimal(-2.5, digits: 2), "-2.50")
+        XCTAssertEqual(ValueFormatter.decimal(1.5, digits: 2, trim: true), "1.5")
+        XCTAssertEqual(ValueFormatter.decimal(2.0, digits: 2, trim: true), "2")
+        // decimal ties are not exact in binary, printf rounds the stored value
+        for value in [0.05, 0.15, 0.25, 0.35, 0.45, 1.005, 2.675, 0.125, 0.375, 2.5, 99.95, 9.995] {
+            for digits in 0...3 {
+                XCTAssertEqual(ValueFormatter.decimal(value, digits: digits), String(format: "%.\(digits)f", value), "\(value) \(digits)")
+            }
+        }
+        XCTAssertEqual(ValueFormatter.decimal(0.15, digits: 1), "0.1")
+        XCTAssertEqual(ValueFormatter.decimal(0.125, digits: 2), "0.12")
+        XCTAssertEqual(Units(bytes: 2_600).getReadableSpeed(), "3 KB/s")
+        XCTAssertEqual(Units(bytes: 12_340_000).getReadableSpeed(), "12.3 MB/s")
+    }
+    
+    func testValueFormatter_memory() throws {
+        let formatter = ByteCountFormatter()
+        formatter.countStyle = .memory
+        formatter.includesUnit = true
+        formatter.isAdaptive = true
+        
+        for value: Int64 in [0, 512, 4_096, 1_572_864, 8_589_934_592] {
+            XCTAssertEqual(Units(bytes: value).getReadableMemory(style: .memory), formatter.string(fromByteCount: value).replacingOccurrences(of: ",", with: "."))
+        }
+        XCTAssertEqual(ValueFormatter.shared.memory(1_572_864, style: .memory), ValueFormatter.shared.memory(1_572_900, style: .memory))
+        XCTAssertEqual(ValueFormatter.shared.memory(1_048_575, style: .memory), ValueFormatter.shared.memory(1_048_576, style: .memory))
+        XCTAssertEqual(ValueFormatter.shared.memory(999_999, style: .file), ValueFormatter.shared.memory(1_000_000, style: .file))
+        XCTAssertEqual(ValueFormatter.shared.temperature(21.4, to: .celsius), ValueFormatter.shared.temperature(20.6, to: .celsius))
+    }
+    
+    func testMetricsFrame_roundTrip() throws {
+        let encoder = MetricsFrameEncoder(keyframeInterval: 3)
+        let decoder = MetricsFrameDecoder()
+        let time = Date(timeIntervalSince1970: 1_760_000_000)
+        
+        let ticks: [[MetricUpdate]] = [
+            [MetricUpdate(key: "CPU", time: time, payload: Data("1,1,0.25,2,0.2,0.3,$".utf8)), MetricUpdate(key: "RAM", time: time.addingTimeInterval(0.25), payload: Data("17179869184,8589934592,1,0$".utf8))],
+            [MetricUpdate(key: "CPU", time: time.addingTimeInterval(1), payload: Data("1,1,0.31,2,0.2,0.4,$".utf8)), MetricUpdate(key: "RAM", time: time.addingTimeInterval(1), payload: Data("17179869184,8589934592,1,0$".utf8))],
+            [MetricUpdate(key: "Net", time: time.addingTimeInterval(2), payload: Data("1,en0,1,1024,512,,,,$".utf8))],
+            [MetricUpdate(key: "CPU", time: time.addingTimeInterval(3), payload: Data("1,1,0.12,2,0.1,0.1,$".utf8))]
+        ]
+        
+        var frames: [Data] = []
+        for updates in ticks {
+            let frame = encoder.encode(updates)
+            frames.append(frame)
+            XCTAssertEqual(try decoder.decode(frame), updates)
+        }
+        XCTAssertEqual(frames[0][1], 0x01)
+        XCTAssertEqual(frames[1][1], 0x00)
+        XCTAssertEqual(frames[3][1], 0x01)
+        XCTAssertLessThan(frames[1].count, frames[0].count)
+    }
+    
+    func testMetricsFrame_errors() throws {
+        let encoder = MetricsFrameEncoder()
+        let time = Date(timeIntervalSince1970: 1_760_000_000)
+        let key = encoder.encode([MetricUpdate(key: "CPU", time: time, payload: Data("1,1,0.25$".utf8))])
+        let next = encoder.encode([MetricUpdate(key: "CPU", time: time.addingTimeInterval(1), payload: Data("1,1,0.26$".utf8))])
+        let last = encoder.encode([MetricUpdate(key: "CPU", time: time.addingTimeInterval(2), payload: Data("1,1,0.27$".utf8))])
+        
+        let decoder = MetricsFrameDecoder()
+        XCTAssertThrowsError(try decoder.decode(next)) { XCTAssertEqual($0 as? MetricsFrameError, .outOfSync) }
+        XCTAssertThrowsError(try decoder.decode(key.prefix(key.count - 2))) { XCTAssertEqual($0 as? MetricsFrameError, .truncated) }
+        XCTAssertNoThrow(try decoder.decode(key))
+        XCTAssertThrowsError(try decoder.decode(last)) { XCTAssertEqual($0 as? MetricsFrameError, .outOfSync) }
+        XCTAssertThrowsError(try decoder.decode(Data([2, 1, 0, 0, 0]))) { XCTAssertEqual($0 as? MetricsFrameError, .version(2)) }
+    }
+    
+    func testMetricsSpool() throws {
+        let directory = URL(fileURLWithPath: NSTemporaryDirectory()).appendingPathComponent("spool-\(UUID().uuidString)")
+        defer { try? FileManager.default.removeItem(at: directory) }
+        let time = Date(timeIntervalSince1970: 1_760_000_000)
+        let record = { (i: Int) in MetricsSpool.Record(topic: "stats/id/metrics/CPU", payload: Data(repeating: UInt8(i % 256), count: 200), time: time.addingTimeInterval(Double(i))) }
+        
+        var spool = try XCTUnwrap(MetricsSpool(directory: directory, segmentSize: 1024, maxBytes: 4096))
+        for i in 0..<10 {
+            XCTAssertTrue(spool.append(record(i)))
+        }
+        XCTAssertEqual(spool.peek(3), [record(0), record(1), record(2)])
+        spool.remove(6)
+        XCTAssertEqual(spool.status(time.addingTimeInterval(10)).records, 4)
+        XCTAssertEqual(spool.status(time.addingTimeInterval(10)).lag, 4)
+        
+        // the read position survives a restart
+        spool = try XCTUnwrap(MetricsSpool(directory: directory, segmentSize: 1024, maxBytes: 4096))
+        XCTAssertEqual(spool.peek(10), (6..<10).map(record))
+        XCTAssertEqual(spool.peek(2, from: 1), [record(7), record(8)])
+        
+        // the cached segment is extended by appends
+        XCTAssertTrue(spool.append(record(10)))
+        XCTAssertEqual(spool.peek(10).last, record(10))
+        XCTAssertTrue(spool.append(record(11)))
+        XCTAssertEqual(spool.peek(10).last, record(11))
+        
+        // the cursor is written once per interval and on flush
+        let batched = try XCTUnwrap(MetricsSpool(directory: directory, segmentSize: 1024, maxBytes: 4096, cursorInterval: 60))
+        batched.remove(1, now: 100)
+        batched.remove(1, now: 101)
+        XCTAssertEqual(try XCTUnwrap(MetricsSpool(directory: directory, segmentSize: 1024, maxBytes: 4096)).peek(1), [record(7)])
+        batched.flush()
+        spool = try XCTUnwrap(MetricsSpool(directory: directory, segmentSize: 1024, maxBytes: 4096))
+        XCTAssertEqual(spool.peek(1), [record(8)])
+        
+        // the oldest segments are dropped when the spool is full
+        for i in 12..<40 {
+            spool.append(record(i))
+        }
+        let status = spool.status()
+        XCTAssertLessThanOrEqual(status.bytes, 4096)
+        XCTAssertEqual(status.records + status.dropped, 32)
+        XCTAssertEqual(spool.peek(100).last, record(39))
+        
+        spool.remove(100)
+        XCTAssertTrue(spool.isEmpty)
+    }
+    
+    func testMetricsSpool_evictionWhileReplaying() throws {
+        let directory = URL(fileURLWithPath: NSTemporaryDirectory()).appendingPathComponent("spool-\(UUID().uuidString)")
+        defer { try? FileManager.default.removeItem(at: directory) }
+        let time = Date(timeIntervalSince1970: 1_760_000_000)
+        let record = { (i: Int) in MetricsSpool.Record(topic: "stats/id/metrics/CPU", payload: Data(repeating: UInt8(i % 256), count: 200), time: time.addingTimeInterval(Double(i))) }
+        
+        let spool = try XCTUnwrap(MetricsSpool(directory: directory, segmentSize: 1024, maxBytes: 2048))
+        for i in 0..<6 {
+            spool.append(record(i))
+        }
+        
+        // the first segment is replayed and waits for the acknowledgements
+        var replay = MetricsReplay(rate: 100, burst: 10, window: 4)
+        var inflight = MQTTInflight(window: 4)
+        replay.connected(pending: true)
+        let records = spool.peek(replay.budget(0), from: replay.inFlight)
+        XCTAssertEqual(records, (0..<4).map(record))
+        for r in records {
+            inflight.enqueue(MQTTInflight.Message(topic: r.topic, payload: r.payload, replayed: true))
+        }
+        replay.sent(records.count)
+        let sent = inflight.ready(0)
+        XCTAssertEqual(sent.count, 4)
+        
+        // the spool overflows and drops the segment in flight
+        for i in 6..<12 {
+            let evictions = spool.evictions
+            spool.append(record(i))
+            if spool.evictions != evictions && replay.inFlight > 0 {
+                replay.evicted()
+                inflight.detachReplayed()
+            }
+        }
+        XCTAssertEqual(spool.evictions, 1)
+        XCTAssertEqual(spool.status().dropped, 4)
+        XCTAssertEqual(replay.inFlight, 0)
+        
+        // the late acknowledgement does not remove the next record, which was never sent
+        for message in sent {
+            let acked = try XCTUnwrap(inflight.acknowledged(message.packetId))
+            if acked.replayed {
+                spool.remove(1)
+                replay.completed()
+            }
+        }
+        XCTAssertEqual(spool.peek(1, from: replay.inFlight), [record(4)])
+        XCTAssertEqual(spool.status().records, 8)
+    }
+    
+    func testMetricsReplay() throws {
+        var replay = MetricsReplay(rate: 10, burst: 5, window: 3)
+        XCTAssertTrue(replay.spooling)
+        
+        replay.connected(pending: true)
+        XCTAssertEqual(replay.state, .replaying)
+        XCTAssertEqual(replay.budget(0), 3)
+        replay.sent(3)
+        XCTAssertEqual(replay.budget(0.1), 0)
+        replay.completed()
+        replay.completed()
+        XCTAssertEqual(replay.budget(0.2), 2)
+        replay.sent(2)
+        XCTAssertEqual(replay.budget(0.3), 0)
+        
+        replay.drained()
+        XCTAssertEqual(replay.state, .replaying)
+        for _ in 0..<3 {
+            replay.completed()
+        }
+        replay.drained()
+        XCTAssertEqual(replay.state, .live)
+        XCTAssertFalse(replay.spooling)
+        
+        replay.disconnected()
+        XCTAssertEqual(replay.state, .offline)
+        replay.connected(pending: false)
+        XCTAssertEqual(replay.state, .live)
+    }
+    
+    func testMQTTDecoder_framing() throws {
+        let encoder = MQTTEncoder()
+        var stream = Data()
+        var expected: [(String, Data)] = []
+        for i in 0..<50 {
+            let payload = Data(repeating: UInt8(i), count: i * 37)
+            expected.append(("stats/id/metrics/\(i)", payload))
+            stream.append(try encoder.publish(topic: "stats/id/metrics/\(i)", payload: payload, qos: UInt8(i % 2), packetId: UInt16(i + 1)))
+        }
+        
+        // the same stream cut into random frames, some of them hold several packets
+        var seed: UInt64 = 42
+        let decoder = MQTTDecoder()
+        var received: [(String, Data)] = []
+        var offset = 0
+        while offset < stream.count {
+            seed = seed &* 6364136223846793005 &+ 1442695040888963407
+            let size = min(Int((seed >> 33) % 300) + 1, stream.count - offset)
+            decoder.append(stream.subdata(in: offset..<offset+size))
+            offset += size
+            while let packet = try decoder.next() {
+                let message = try packet.publish()
+                XCTAssertEqual(message.packetId, packet.qos == 1 ? UInt16(received.count + 1) : nil)
+                received.append((message.topic, Data(message.payload)))
+            }
+        }
+        
+        XCTAssertEqual(received.map{ $0.0 }, expected.map{ $0.0 })
+        XCTAssertEqual(received.map{ $0.1 }, expected.map{ $0.1 })
+        XCTAssertEqual(decoder.buffered, 0)
+        
+        decoder.append(Data([0x30, 0xFF, 0xFF, 0xFF, 0xFF, 0x01]))
+        XCTAssertThrowsError(try decoder.next()) { XCTAssertEqual($0 as? MQTTError, .malformedLength) }
+        
+        let long = String(repeating: "a", count: 70_000)
+        XCTAssertThrowsError(try encoder.publish(topic: long, payload: Data())) { XCTAssertEqual($0 as? MQTTError, .tooLarge(70_000)) }
+        XCTAssertThrowsError(try encoder.subscribe(topic: long, packetId: 1))
+        
+        decoder.append(encoder.puback(7))
+        let ack = try XCTUnwrap(try decoder.next())
+        XCTAssertEqual(ack.type, 4)
+        XCTAssertEqual(ack.packetId, 7)
+    }
+    
+    func testMQTTInflight() throws {
+        var inflight = MQTTInflight(window: 2, queueLimit: 3)
+        for i in 0..<4 {
+            inflight.enqueue(MQTTInflight.Message(topic: "t", payload: Data([UInt8(i)])))
+        }
+        XCTAssertEqual(inflight.dropped, 1)
+        
+        let first = inflight.ready(0)
+        XCTAssertEqual(first.map{ $0.payload }, [Data([1]), Data([2])])
+        XCTAssertEqual(inflight.ready(0).count, 0)
+        
+        XCTAssertEqual(inflight.acknowledged(first[0].packetId)?.payload, Data([1]))
+        XCTAssertNil(inflight.acknowledged(first[0].packetId))
+        let second = inflight.ready(1)
+        XCTAssertEqual(second.map{ $0.payload }, [Data([3])])
+        XCTAssertNotEqual(second[0].packetId, first[1].packetId)
+        
+        let resent = inflight.resend(2)
+        XCTAssertEqual(resent.map{ $0.packetId }, [first[1].packetId, second[0].packetId])
+        XCTAssertTrue(resent.allSatisfy{ $0.dup })
+        XCTAssertEqual(inflight.inFlight, 2)
+        
+        
+        // a reserved identifier is not given to a publish until released
+        let reserved = inflight.reserve()
+        XCTAssertNotEqual(inflight.nextId(), reserved)
+        XCTAssertTrue(inflight.release(reserved))
+        XCTAssertFalse(inflight.release(reserved))
+        
+        inflight.acknowledged(second[0].packetId)
+        inflight.enqueue(MQTTInflight.Message(topic: "t", payload: Data([4]), replayed: true))
+        inflight.enqueue(MQTTInflight.Message(topic: "t", payload: Data([5]), replayed: true))
+        XCTAssertEqual(inflight.ready(3).map{ $0.replayed }, [true])
+        inflight.removeReplayed()
+        XCTAssertEqual(inflight.inFlight, 1)
+        XCTAssertEqual(inflight.queued, 0)
+        XCTAssertEqual(inflight.resend(4).map{ $0.packetId }, [first[1].packetId])
+    }
+    
+    func testOpenMetricsRegistry() throws {
+        let registry = OpenMetricsRegistry()
+        registry.update(source: "CPU@LoadReader", [
+            OpenMetric("stats_cpu_usage_ratio", 0.25, unit: "ratio", help: "CPU usage", labels: [("mode", "total")]),
+            OpenMetric("stats_cpu_core_usage_ratio", 0.5, unit: "ratio", labels: [("core", "0")])
+        ])
+        registry.update(source: "Net@UsageReader", [
+            OpenMetric("stats_network_transferred_bytes", 1024, type: .counter, unit: "bytes", labels: [("interface", "en\"0\"")])
+        ])
+        
+        let first = String(decoding: registry.exposition(), as: UTF8.self)
+        XCTAssertEqual(first, """
+        # TYPE stats_cpu_core_usage_ratio gauge
+        # UNIT stats_cpu_core_usage_ratio ratio
+        stats_cpu_core_usage_ratio{core="0"} 0.5
+        # TYPE stats_cpu_usage_ratio gauge
+        # UNIT stats_cpu_usage_ratio ratio
+        # HELP stats_cpu_usage_ratio CPU usage
+        stats_cpu_usage_ratio{mode="total"} 0.25
+        # TYPE stats_network_transferred_bytes counter
+        # UNIT stats_network_transferred_bytes bytes
+        stats_network_transferred_bytes_total{interface="en\\"0\\""} 1024
+        # EOF
+        
+        """)
+        
+        // a source which stops reporting a series removes it, an empty family disappears
+        registry.update(source: "CPU@LoadReader", [
+            OpenMetric("stats_cpu_usage_ratio", .nan, unit: "ratio", help: "CPU usage", labels: [("mode", "total")])
+        ])
+        let second = String(decoding: registry.exposition(), as: UTF8.self)
+        XCTAssertFalse(second.contains("stats_cpu_core_usage_ratio"))
+        XCTAssertTrue(second.contains("stats_cpu_usage_ratio{mode=\"total\"} NaN\n"))
+        XCTAssertEqual(registry.count, 2)
+        
+        XCTAssertEqual(OpenMetricsRegistry.value(.infinity), "+Inf")
+        XCTAssertEqual(OpenMetricsRegistry.value(-.infinity), "-Inf")
+        XCTAssertEqual(OpenMetricsRegistry.value(1e20), "1e+20")
+        
+        let server = OpenMetricsServer(registry: registry)
+        let response = String(decoding: server.response(Data("GET /metrics HTTP/1.1\r\nHost: localhost\r\n\r\n".utf8)), as: UTF8.self)
+        XCTAssertTrue(response.hasPrefix("HTTP/1.1 200 OK\r\nContent-Type: \(OpenMetricsServer.contentType)\r\n"))
+        XCTAssertTrue(response.hasSuffix(second))
+        XCTAssertTrue(String(decoding: server.response(Data("GET / HTTP/1.1\r\n\r\n".utf8)), as: UTF8.self).hasPrefix("HTTP/1.1 404"))
+        XCTAssertTrue(String(decoding: server.response(Data("POST /metrics HTTP/1.1\r\n\r\n".utf8)), as: UTF8.self).hasPrefix("HTTP/1.1 405"))
+    }
+    
+    func testSyncCollection() throws {
+        struct Item: SyncItem, Equatable {
+            let id: String
+            let value: Int
+        }
+        let collection = SyncCollection<Item>(path: "/v1/machine")
+        collection.seed([Item(id: "old", value: 0)])
+        XCTAssertNil(collection.request(host: "https://api", token: "t")?.value(forHTTPHeaderField: "If-None-Match"))
+        
+        XCTAssertTrue(try collection.apply(status: 200, data: Data(#"[{"id":"a","value":1},{"id":"b","value":2}]"#.utf8), etag: "\"v1\"", cursor: "c1"))
+        XCTAssertEqual(collection.list, [Item(id: "a", value: 1), Item(id: "b", value: 2)])
+        
+        let request = collection.request(host: "https://api", token: "t")
+        XCTAssertEqual(request?.url?.absoluteString, "https://api/v1/machine?since=c1")
+        XCTAssertEqual(request?.value(forHTTPHeaderField: "If-None-Match"), "\"v1\"")
+        
+        XCTAssertFalse(try collection.apply(status: 304, data: Data()))
+        XCTAssertTrue(try collection.apply(status: 200, data: Data(#"{"changed":[{"id":"b","value":3},{"id":"c","value":4}],"deleted":["a"],"cursor":"c2"}"#.utf8), etag: "\"v2\""))
+        XCTAssertEqual(collection.list, [Item(id: "b", value: 3), Item(id: "c", value: 4)])
+        XCTAssertEqual(collection.request(host: "https://api", token: "t")?.url?.query, "since=c2")
+        
+        XCTAssertThrowsError(try collection.apply(status: 200, data: Data("{".utf8))) { XCTAssertEqual($0 as? SyncError, .decoding) }
+        XCTAssertEqual(collection.list.count, 2)
+        XCTAssertThrowsError(try collection.apply(status: 410, data: Data())) { XCTAssertEqual($0 as? SyncError, .status(410)) }
+        XCTAssertEqual(collection.request(host: "https://api", token: "t")?.url?.query, nil)
+        
+        let stats = collection.stats
+        XCTAssertEqual(stats.requests, 5)
+        XCTAssertEqual(stats.notModified, 1)
+        XCTAssertEqual(stats.snapshots, 1)
+        XCTAssertEqual(stats.deltas, 1)
+    }
+    
+    func testLogRing() throws {
+        var ring = LogRing<Int>(capacity: 3)
+        XCTAssertTrue(ring.push(1))
+        XCTAssertTrue(ring.push(2))
+        XCTAssertTrue(ring.push(3))
+        XCTAssertFalse(ring.push(4))
+        
+        var list: [Int] = []
+        XCTAssertEqual(ring.drain(into: &list), 1)
+        XCTAssertEqual(list, [1, 2, 3])
+        
+        // wraps around the end of the storage
+        ring.push(5)
+        ring.push(6)
+        list.removeAll()
+        XCTAssertEqual(ring.drain(into: &list), 0)
+        XCTAssertEqual(list, [5, 6])
+        XCTAssertEqual(ring.count, 0)
+    }
+    
+    func testLogRateLimiter() throws {
+        var limiter = LogRateLimiter(burst: 2, window: 10)
+        XCTAssertEqual(limiter.check(1, message: 7, time: 0), 0)
+        XCTAssertEqual(limiter.check(1, message: 7, time: 1), 0)
+        XCTAssertNil(limiter.check(1, message: 7, time: 2))
+        XCTAssertNil(limiter.check(1, message: 7, time: 3))
+        
+        // other call sites are not affected
+        XCTAssertEqual(limiter.check(2, message: 7, time: 3), 0)
+        
+        // a new message or the next window reports how many lines were suppressed
+        XCTAssertEqual(limiter.check(1, message: 8, time: 4), 2)
+        XCTAssertEqual(limiter.check(1, message: 8, time: 5), 0)
+        XCTAssertNil(limiter.check(1, message: 8, time: 6))
+        XCTAssertEqual(limiter.check(1, message: 8, time: 20), 1)
+        
+        // the suppressed lines are collected once
+        XCTAssertEqual(limiter.check(1, message: 8, time: 21), 0)
+        XCTAssertNil(limiter.check(1, message: 8, time: 22))
+        XCTAssertNil(limiter.check(1, message: 8, time: 23))
+        XCTAssertEqual(limiter.collect(), [1: 2])
+        XCTAssertEqual(limiter.collect(), [:])
+        XCTAssertNil(limiter.check(1, message: 8, time: 24))
+        XCTAssertEqual(limiter.check(1, message: 9, time: 25), 1)
+    }
+    
+    func testDiskTopology() throws {
+        let topology = DiskTopology<Int>()
+        var counters: [Int: DiskCounters] = [1: DiskCounters(read: 100, write: 10), 2: DiskCounters(read: 5, write: 5)]
+        
+        XCTAssertNil(topology.appeared("disk1s1", handle: 1))
+        XCTAssertNil(topology.appeared("disk2s1", handle: 2))
+        topology.tick{ counters[$0] }
+        XCTAssertEqual(topology.drives.map{ $0.delta }, [DiskCounters(), DiskCounters()])
+        
+        counters[1] = DiskCounters(read: 150, write: 30)
+        counters[2] = DiskCounters(read: 5, write: 9)
+        topology.tick{ counters[$0] }
+        XCTAssertEqual(topology.drives.map{ $0.delta }, [DiskCounters(read: 50, write: 20), DiskCounters(read: 0, write: 4)])
+        
+        // a remount replaces the handle and starts the counters again
+        XCTAssertEqual(topology.appeared("disk2s1", handle: 3), 2)
+        counters[3] = DiskCounters(read: 1, write: 1)
+        counters[1] = DiskCounters(read: 10, write: 30)
+        topology.tick{ counters[$0] }
+        XCTAssertEqual(topology.drives.map{ $0.delta }, [DiskCounters(), DiskCounters()])
+        
+        let generation = topology.generation
+        XCTAssertEqual(topology.disappeared("disk1s1"), 1)
+        XCTAssertNil(topology.disappeared("disk1s1"))
+        XCTAssertEqual(topology.generation, generation + 1)
+        XCTAssertEqual(topology.handle("disk2s1"), 3)
+        XCTAssertEqual(topology.removeAll(), [3])
+        XCTAssertEqual(topology.count, 0)
+    }
+    
+    func testSMARTLog() throws {
+        var nvme = [UInt8](repeating: 0, count: 512)
+        nvme[0] = 0x01
+        nvme[1] = 0x31; nvme[2] = 0x01 // 305 K
+        nvme[3] = 100; nvme[4] = 10; nvme[5] = 3
+        nvme[32] = 0x40; nvme[33] = 0x42; nvme[34] = 0x0F // 1 000 000 units
+        nvme[48] = 0x10; nvme[49] = 0x27 // 10 000 units
+        nvme[112] = 0xD2; nvme[113] = 0x04
+        nvme[128] = 0x2E; nvme[129] = 0x16
+        nvme[144] = 42
+        var values = nvme.withUnsafeBytes{ SMARTLog.nvme($0) }
+        XCTAssertEqual(values?.temperature, 32)
+        XCTAssertEqual(values?.life, 97)
+        XCTAssertEqual(values?.totalRead, 1_000_000 * 512_000)
+        XCTAssertEqual(values?.totalWritten, 10_000 * 512_000)
+        XCTAssertEqual(values?.powerCycles, 1234)
+        XCTAssertEqual(values?.powerOnHours, 5678)
+        XCTAssertEqual(values?.criticalWarning, 1)
+        XCTAssertEqual(values?.spareThreshold, 10)
+        XCTAssertEqual(values?.unsafeShutdowns, 42)
+        XCTAssertEqual(values?.mediaErrors, 0)
+        nvme[40] = 1
+        XCTAssertEqual(nvme.withUnsafeBytes{ SMARTLog.nvme($0) }?.totalRead, Int64.max)
+        XCTAssertNil([UInt8](repeating: 0, count: 64).withUnsafeBytes{ SMARTLog.nvme($0) })
+        
+        var ata = [UInt8](repeating: 0, count: 512)
+        for (i, attribute) in [(194, 100, 38), (9, 100, 12000), (12, 100, 300), (241, 100, 1000), (242, 100, 2000), (5, 100, 1), (197, 100, 2), (231, 95, 0)].enumerated() {
+            let offset = 2 + i * 12
+            ata[offset] = UInt8(attribute.0)
+            ata[offset + 3] = UInt8(attribute.1)
+            ata[offset + 5] = UInt8(attribute.2 & 0xFF)
+            ata[offset + 6] = UInt8(attribute.2 >> 8)
+        }
+        var decoded = ata.withUnsafeBytes{ SMARTLog.ata($0) }
+        values = decoded?.values
+        XCTAssertEqual(values?.temperature, 38)
+        XCTAssertEqual(values?.life, 95)
+        XCTAssertEqual(values?.powerOnHours, 12000)
+        XCTAssertEqual(values?.powerCycles, 300)
+        XCTAssertEqual(values?.totalWritten, 1000 * 512)
+        XCTAssertEqual(values?.totalRead, 2000 * 512)
+        XCTAssertEqual(values?.mediaErrors, 3)
+        XCTAssertNil(values?.unsafeShutdowns)
+        XCTAssertNil(decoded?.read)
+        
+        var statistics = [UInt8](repeating: 0, count: 512 * 8)
+        func statistic(_ offset: Int, _ value: UInt64, valid: Bool = true) {
+            let value = value | (valid ? (1 << 63 | 1 << 62) : 1 << 63)
+            for i in 0..<8 {
+                statistics[offset + i] = UInt8((value >> (8 * i)) & 0xFF)
+            }
+        }
+        statistic(512 + 0x18, 5000)
+        statistic(512 + 0x28, 7000, valid: false)
+        statistic(512 * 7 + 0x08, 7)
+        decoded = ata.withUnsafeBytes{ data in statistics.withUnsafeBytes{ SMARTLog.ata(data, statistics: $0) } }
+        XCTAssertEqual(decoded?.written, 5000 * 512)
+        XCTAssertNil(decoded?.read)
+        XCTAssertEqual(decoded?.values.totalWritten, 5000 * 512)
+        XCTAssertEqual(decoded?.values.totalRead, 2000 * 512)
+        XCTAssertEqual(decoded?.values.life, 93)
+    }
+    
+    func testSMARTCache() throws {
+        let cache = SMARTCache<Int>(ttl: 60)
+        
+        var result = cache.get("disk0", now: 0)
+        XCTAssertNil(result.value)
+        XCTAssertTrue(result.refresh)
+        XCTAssertFalse(cache.get("disk0", now: 1).refresh)
+        
+        cache.set("disk0", 1, now: 2)
+        result = cache.get("disk0", now: 30)
+        XCTAssertEqual(result.value, 1)
+        XCTAssertFalse(result.refresh)
+        
+        result = cache.get("disk0", now: 70)
+        XCTAssertEqual(result.value, 1)
+        XCTAssertTrue(result.refresh)
+        XCTAssertFalse(cache.get("disk0", now: 71).refresh)
+        
+        cache.set("disk0", nil, now: 72)
+        result = cache.get("disk0", now: 80)
+        XCTAssertEqual(result.value, 1)
+        XCTAssertFalse(result.refresh)
+        
+        cache.remove("disk0")
+        XCTAssertTrue(cache.get("disk0", now: 81).refresh)
+    }
+    
+    func testGPUPerformance() throws {
+        let agx: NSDictionary = [
+            "Device Utilization %": 37, "Renderer Utilization %": 35, "Tiler Utilization %": 12,
+            "In use system memory": 771_489_792, "Alloc system memory": 4_194_304_000, "recoveryCount": 0,
+            "SplitSceneCount": 0, "TiledSceneBytes": 1_572_864
+        ]
+        var stats = GPUPerformance(agx as CFDictionary)
+        XCTAssertEqual(stats.utilization, 37)
+        XCTAssertEqual(stats.renderer, 35)
+        XCTAssertEqual(stats.tiler, 12)
+        XCTAssertNil(stats.temperature)
+        XCTAssertNil(stats.coreClock)
+        
+        let amd: NSDictionary = [
+            "GPU Activity(%)": 7, "Temperature(C)": 54, "Fan Speed(%)": 30, "Fan Speed(RPM)": 1200,
+            "Core Clock(MHz)": 1300, "Memory Clock(MHz)": 1750, "Total Power(W)": 18, "vramUsedBytes": 1_073_741_824
+        ]
+        stats = GPUPerformance(amd as CFDictionary)
+        XCTAssertEqual(stats.utilization, 7)
+        XCTAssertEqual(stats.temperature, 54)
+        XCTAssertEqual(stats.fanSpeed, 30)
+        XCTAssertEqual(stats.coreClock, 1300)
+        XCTAssertEqual(stats.memoryClock, 1750)
+        XCTAssertNil(stats.renderer)
+        
+        let broken: NSDictionary = ["Device Utilization %": "37", "Temperature(C)": 54.5]
+        XCTAssertEqual(GPUPerformance(broken as CFDictionary), GPUPerformance())
+    }
+    
+    func testGPUPCIMatch() throws {
+        let rx580 = GPUPCIMatch.id(device: Data([0xDF, 0x67, 0x00, 0x00]), vendor: Data([0x02, 0x10, 0x00, 0x00]))
+        XCTAssertEqual(rx580, 0x67DF1002)
+        
+        let amd = GPUPCIMatch("0x67C01002 0x67DF1002 0x67EF1002 0x699F1002")
+        XCTAssertEqual(amd.list.count, 4)
+        XCTAssertTrue(amd.matches(0x67DF1002))
+        XCTAssertFalse(amd.matches(0x67DF8086))
+        XCTAssertFalse(amd.matches(0x67D01002))
+        
+        let intel = GPUPCIMatch("0x3e9b8086&0xffffffff 0x00008086&0x0000ffff")
+        XCTAssertTrue(intel.matches(0x3E9B8086))
+        XCTAssertTrue(intel.matches(0x591B8086))
+        XCTAssertFalse(intel.matches(0x591B1002))
+        XCTAssertTrue(GPUPCIMatch("").list.isEmpty)
+        XCTAssertNil(GPUPCIMatch.id(device: Data([0xDF]), vendor: Data([0x02, 0x10])))
+    }
+    
+    func testInterfaceCounters() throws {
+        func message(_ index: UInt16, _ name: String, ibytes: UInt64, obytes: UInt64) -> [UInt8] {
+            var header = if_msghdr2()
+            header.ifm_type = UInt8(RTM_IFINFO2)
+            header.ifm_version = UInt8(RTM_VERSION)
+            header.ifm_addrs = RTA_IFP
+            header.ifm_index = index
+            header.ifm_data.ifi_ibytes = ibytes
+            header.ifm_data.ifi_obytes = obytes
+            header.ifm_data.ifi_baudrate = 1_000_000_000
+            var link = sockaddr_dl()
+            link.sdl_len = UInt8(MemoryLayout<sockaddr_dl>.size)
+            link.sdl_family = UInt8(AF_LINK)
+            link.sdl_index = index
+            link.sdl_nlen = UInt8(name.utf8.count)
+            withUnsafeMutableBytes(of: &link.sdl_data) { raw in
+                for (i, byte) in name.utf8.enumerated() { raw[i] = byte }
+            }
+            header.ifm_msglen = UInt16(MemoryLayout<if_msghdr2>.size + MemoryLayout<sockaddr_dl>.size)
+            return withUnsafeBytes(of: header) { Array($0) } + withUnsafeBytes(of: link) { Array($0) }
+        }
+        var address = ifa_msghdr()
+        address.ifam_msglen = UInt16(MemoryLayout<ifa_msghdr>.size)
+        address.ifam_type = UInt8(RTM_NEWADDR)
+        
+        var buffer = message(1, "lo0", ibytes: 100, obytes: 100)
+        buffer += withUnsafeBytes(of: address) { Array($0) }
+        buffer += message(6, "en0", ibytes: 1_000, obytes: 500)
+        buffer += message(14, "utun3", ibytes: UInt64(UInt32.max) - 10, obytes: 5_000)
+        
+        var list: [InterfaceCounter] = []
+        buffer.withUnsafeBytes{ InterfaceCounterTable.parse($0, into: &list) }
+        XCTAssertEqual(list.map{ $0.name }, ["lo0", "en0", "utun3"])
+        XCTAssertEqual(list[1], InterfaceCounter(index: 6, name: "en0", baudrate: 1_000_000_000, ibytes: 1_000, obytes: 500))
+        
+        let table = InterfaceCounterTable()
+        table.update(list)
+        XCTAssertEqual(table.entry("en0")?.download, 0)
+        
+        list[1].ibytes = 3_000
+        list[1].obytes = 900
+        list[2].ibytes = 20 // re-created after 4 GB, not a 32-bit wrap
+        list[2].obytes = 100 // reset
+        table.update(list)
+        XCTAssertEqual(table.entry("en0")?.download, 2_000)
+        XCTAssertEqual(table.entry("en0")?.upload, 400)
+        XCTAssertEqual(table.entry("utun3")?.download, 0)
+        XCTAssertEqual(table.entry("utun3")?.upload, 0)
+        XCTAssertEqual(table.entry("utun3")?.resets, 1)
+        
+        // the reset is the new baseline
+        list[2].ibytes = 70
+        list[2].obytes = 160
+        table.update(list)
+        XCTAssertEqual(table.entry("utun3")?.download, 50)
+        XCTAssertEqual(table.entry("utun3")?.upload, 60)
+        
+        table.update([list[1]])
+        XCTAssertNil(table.entry("utun3"))
+        XCTAssertEqual(table.entries.count, 1)
+        
+        XCTAssertEqual(InterfaceCounterTable.delta(10, 15), 5)
+        XCTAssertNil(InterfaceCounterTable.delta(1 << 40, 100))
+        XCTAssertNil(InterfaceCounterTable.delta(3_000_000_000, 100))
+        
+        var truncated: [InterfaceCounter] = []
+        Array(buffer.prefix(buffer.count - 7)).withUnsafeBytes{ InterfaceCounterTable.parse($0, into: &truncated) }
+        XCTAssertEqual(truncated.count, 2)
+    }
+    
+    func testICMPEcho() throws {
+        let packet = ICMPEcho.request(identifier: 0x1234, sequence: 513, token: 0xDEAD_BEEF_0102_0304)
+        XCTAssertEqual(packet.count, ICMPEcho.size)
+        XCTAssertEqual(packet.withUnsafeBytes{ ICMPEcho.checksum($0) }, 0)
+        
+        var reply = packet
+        reply[0] = 0
+        let checksum = UInt16(reply[2]) << 8 | UInt16(reply[3])
+        let sum = UInt32(checksum) + 0x0800
+        let fixed = UInt16(truncatingIfNeeded: sum + (sum >> 16))
+        reply[2] = UInt8(fixed >> 8)
+        reply[3] = UInt8(fixed & 0xFF)
+        XCTAssertEqual(reply.withUnsafeBytes{ ICMPEcho.reply($0, token: 0xDEAD_BEEF_0102_0304) }, 513)
+        XCTAssertNil(reply.withUnsafeBytes{ ICMPEcho.reply($0, token: 1) })
+        XCTAssertNil(packet.withUnsafeBytes{ ICMPEcho.reply($0, token: 0xDEAD_BEEF_0102_0304) })
+        
+        var ip = [UInt8](repeating: 0, count: 20)
+        ip[0] = 0x45
+        ip[9] = UInt8(IPPROTO_ICMP)
+        XCTAssertEqual((ip + reply).withUnsafeBytes{ ICMPEcho.reply($0, token: 0xDEAD_BEEF_0102_0304) }, 513)
+        
+        reply[12] ^= 0xFF
+        XCTAssertNil(reply.withUnsafeBytes{ ICMPEcho.reply($0, token: 0xDEAD_BEEF_0102_0304) })
+    }
+    
+    func testLatencyHistogram() throws {
+        let histogram = LatencyHistogram(window: 100)
+        XCTAssertNil(histogram.percentile(0.5))
+        
+        for i in 1...100 {
+            histogram.add(Double(i))
+        }
+        XCTAssertEqual(histogram.percentile(0.5)!, 50, accuracy: 2.5)
+        XCTAssertEqual(histogram.percentile(0.95)!, 95, accuracy: 4.75)
+        XCTAssertEqual(histogram.percentile(0.99)!, 99, accuracy: 4.95)
+        XCTAssertEqual(histogram.loss, 0)
+        
+        for _ in 0..<50 {
+            histogram.add(nil)
+        }
+        XCTAssertEqual(histogram.total, 100)
+        XCTAssertEqual(histogram.loss, 0.5)
+        XCTAssertEqual(histogram.percentile(0.5)!, 75, accuracy: 3.75)
+        
+        histogram.removeAll()
+        XCTAssertEqual(histogram.total, 0)
+        XCTAssertNil(histogram.percentile(0.99))
+    }
+    
+    func testConnectivityProber() throws {
+        let prober = ConnectivityProber(targets: ["1.1.1.1", "8.8.8.8"], timeout: 2, capacity: 4)
+        XCTAssertNil(prober.reachable)
+        
+        let a = prober.sent(0, time: 10)
+        let b = prober.sent(1, time: 10)
+        XCTAssertEqual(prober.received(b, time: 10.02), 1)
+        XCTAssertNil(prober.received(b, time: 10.03))
+        XCTAssertEqual(prober.summary(1).latency!, 20, accuracy: 0.001)
+        
+        prober.expire(12)
+        XCTAssertEqual(prober.summary(0).reachable, false)
+        XCTAssertEqual(prober.summary(0).loss, 1)
+        XCTAssertNil(prober.received(a, time: 12.1))
+        XCTAssertEqual(prober.reachable, true)
+        
+        let c = prober.sent(1, time: 13)
+        XCTAssertEqual(prober.received(c, time: 13.05), 1)
+        XCTAssertEqual(prober.summary(1).jitter!, 30, accuracy: 0.001)
+        
+        // the ring of pending probes is full, the oldest one is lost
+        let d = prober.sent(1, time: 14)
+        for _ in 0..<4 {
+            _ = prober.sent(0, time: 14)
+        }
+        XCTAssertNil(prober.received(d, time: 14.01))
+        XCTAssertEqual(prober.summary(1).reachable, false)
+        XCTAssertEqual(prober.reachable, false)
+        
+        prober.set(["1.1.1.1"])
+        XCTAssertNil(prober.reachable)
+        XCTAssertEqual(ConnectivityProber.offset(1, random: 0.5), 0.1, accuracy: 0.0001)
+    }
+    
+    func testCoreLoadTable() throws {
+        let cores = [
+            core_s(id: 0, type: .efficiency),
+            core_s(id: 1, type: .efficiency),
+            core_s(id: 2, type: .performance),
+            core_s(id: 3, type: .performance)
+        ]
+        let table = CoreLoadTable(count: 4, cores: cores)
+        XCTAssertFalse([Int32](repeating: 0, count: 8).withUnsafeBufferPointer{ table.update($0) })
+        
+        // user, system, idle, nice of every core
+        var counters: [Int32] = [
+            10, 10, 80, 0,
+            50, 0, 50, 0,
+            100, 0, 0, 0,
+            -1, 0, 100, 0
+        ]
+        XCTAssertTrue(counters.withUnsafeBufferPointer{ table.update($0) })
+        XCTAssertEqual(table.usage[0], 0.2, accuracy: 0.0001)
+        
+        counters = [
+            40, 10, 90, 10,
+            50, 0, 150, 0,
+            150, 50, 0, 0,
+            99, 0, 200, 0 // wrapped
+        ]
+        XCTAssertTrue(counters.withUnsafeBufferPointer{ table.update($0) })
+        XCTAssertEqual(table.usage, [0.8, 0, 1, 0.5])
+        XCTAssertEqual(table.siblings, [0.4, 0.75])
+        XCTAssertEqual(table.average(.efficiency)!, 0.4, accuracy: 0.0001)
+        XCTAssertEqual(table.average(.performance)!, 0.75, accuracy: 0.0001)
+        XCTAssertNil(table.average(.super))
+        XCTAssertEqual(table.user, 180.0 / 450, accuracy: 0.0001)
+        XCTAssertEqual(table.system, 50.0 / 450, accuracy: 0.0001)
+        XCTAssertEqual(table.idle, 210.0 / 450, accuracy: 0.0001)
+        
+        // a core without ticks keeps its load
+        XCTAssertTrue(counters.withUnsafeBufferPointer{ table.update($0) })
+        XCTAssertEqual(table.usage, [0.8, 0, 1, 0.5])
+    }
+    
+    func testMemoryPressureMonitor() throws {
+        let monitor = MemoryPressureMonitor(limit: 2)
+        XCTAssertFalse(monitor.elevated)
+        XCTAssertEqual(MemoryPressureMonitor.level(4), .critical)
+        XCTAssertEqual(MemoryPressureMonitor.level(1), .normal)
+        
+        let start = Date(timeIntervalSince1970: 1_000)
+        XCTAssertFalse(monitor.set(.normal, time: start))
+        XCTAssertTrue(monitor.set(.warning, time: start))
+        XCTAssertFalse(monitor.set(.warning, time: start.addingTimeInterval(1)))
+        XCTAssertTrue(monitor.elevated)
+        XCTAssertEqual(monitor.since, start)
+        monitor.set(.critical, time: start.addingTimeInterval(2))
+        monitor.set(.normal, time: start.addingTimeInterval(3))
+        XCTAssertEqual(monitor.transitions.map{ $0.to }, [.critical, .normal])
+        XCTAssertEqual(monitor.transitions.last?.from, .critical)
+        XCTAssertEqual(monitor.since, start.addingTimeInterval(3))
+        
+        XCTAssertNil(monitor.rates(VMCounters(compressions: 100, swapins: 10), time: 5))
+        let rates = monitor.rates(VMCounters(compressions: 150, decompressions: 20, swapins: 5), time: 5.5)
+        XCTAssertEqual(rates?.compressions, 100)
+        XCTAssertEqual(rates?.decompressions, 40)
+        XCTAssertEqual(rates?.swapins, 0)
+        XCTAssertNil(monitor.rates(VMCounters(), time: 5.5))
+    }
+    
+    func testEnergyEstimator() throws {
+        let model = EnergyModel()
+        XCTAssertEqual(model.impact(cpuTime: 500_000_000, wakeups: 0, diskRead: 0, diskWritten: 0, interval: 1), 50, accuracy: 0.0001)
+        XCTAssertEqual(model.impact(cpuTime: 0, wakeups: 1_000, diskRead: 0, diskWritten: 0, interval: 2), 10, accuracy: 0.0001)
+        XCTAssertEqual(model.impact(cpuTime: 1, wakeups: 1, diskRead: 1, diskWritten: 1, interval: 0), 0)
+        
+        let estimator = EnergyEstimator()
+        XCTAssertNil(estimator.begin(10))
+        XCTAssertNil(estimator.add(100, EnergyCounters(start: 1, cpuTime: 1_000_000_000), interval: nil))
+        estimator.add(200, EnergyCounters(start: 2, cpuTime: 5_000_000_000), interval: nil)
+        
+        let interval = estimator.begin(12)
+        XCTAssertEqual(interval, 2)
+        XCTAssertEqual(estimator.add(100, EnergyCounters(start: 1, cpuTime: 3_000_000_000, wakeups: 100), interval: interval)!, 101, accuracy: 0.0001)
+        // the pid was reused by another process
+        XCTAssertNil(estimator.add(200, EnergyCounters(start: 3, cpuTime: 10), interval: interval))
+        XCTAssertNil(estimator.add(300, EnergyCounters(start: 4), interval: interval))
+        XCTAssertEqual(estimator.count, 3)
+        
+        let next = estimator.begin(13)
+        XCTAssertEqual(estimator.add(300, EnergyCounters(start: 4, diskWritten: 1_000_000_000), interval: next)!, 53, accuracy: 0.0001)
+        XCTAssertEqual(estimator.count, 1)
+    }
+    
+    func testEnergyEstimator_top() throws {
+        let output = """
+        Processes: 512 total, 3 running, 509 sleeping, 2311 threads
+        PID    COMMAND          POWER
+        0      kernel_task      0.0
+        412    WindowServer     0.0
+        
+        Processes: 512 total, 2 running, 510 sleeping, 2309 threads
+        PID    COMMAND          POWER
+        0      kernel_task      12.3
+        412    WindowServer     8.5
+        1033   Google Chrome He 3.1
+        """
+        let top = EnergyEstimator.topPower(output)
+        XCTAssertEqual(top.count, 3)
+        XCTAssertEqual(top[0]?.name, "kernel_task")
+        XCTAssertEqual(try XCTUnwrap(top[0]?.power), 12.3, accuracy: 0.0001)
+        XCTAssertEqual(top[1033]?.name, "Google Chrome He")
+        
+        // kernel_task and WindowServer have no counters without root
+        let list = EnergyEstimator.rank([(pid: 500, usage: 10), (pid: 501, usage: 1)], denied: [0, 412, 77], top: top, limit: 3)
+        XCTAssertEqual(list.map{ $0.pid }, [0, 500, 412])
+        XCTAssertEqual(list[0].usage, 12.3, accuracy: 0.0001)
+    }
+    
+    func testStreamExtractor() throws {
+        let json = """
+        {"SPBluetoothDataType": [{"controller": {"list": [1, 2.5, {"x": [true, null]}]},
+          "device_connected": [{"AirPods \\"Pro\\"": {"device_address": "AA:BB", "device_batteryLevelLeft": "80%", "count": 3}},
+                               {"Mouse": {"device_address": "CC:DD", "flag": false, "name": "\\u00e9\\ud83d\\ude00"}}]}]}
+        """
+        let extractor = StreamExtractor([
+            ["SPBluetoothDataType", "0", "device_connected", "*", "*"],
+            ["SPBluetoothDataType", "0", "device_connected", "*", "*", "device_address"],
+            ["SPBluetoothDataType", "0", "device_connected", "*", "*", "device_batteryLevelLeft"],
+            ["SPBluetoothDataType", "0", "device_connected", "1", "Mouse", "*"]
+        ])
+        let matches = try XCTUnwrap(Array(json.utf8).withUnsafeBytes{ extractor.json($0) })
+        XCTAssertEqual(matches.map{ $0.path }, [0, 1, 2, 0, 1, 3, 3])
+        XCTAssertEqual(matches[0], StreamMatch(path: 0, keys: ["0", "AirPods \"Pro\""], value: .container))
+        XCTAssertEqual(matches[2].value.string, "80%")
+        XCTAssertEqual(matches[4].keys, ["1", "Mouse"])
+        XCTAssertEqual(matches[5].value, .bool(false))
+        XCTAssertEqual(matches[6].value.string, "é😀")
+        
+        XCTAssertNil(Array("{\"a\": [1, 2}".utf8).withUnsafeBytes{ extractor.json($0) })
+        XCTAssertNil(Array("{\"SPBluetoothDataType\": [{\"device_connected\": [".utf8).withUnsafeBytes{ extractor.json($0) })
+        
+        let plist = """
+        <?xml version="1.0" encoding="UTF-8"?>
+        <!DOCTYPE plist PUBLIC "-//Apple//DTD PLIST 1.0//EN" "http://www.apple.com/DTDs/PropertyList-1.0.dtd">
+        <plist version="1.0">
+        <dict>
+            <key>Name</key><string>Keyboard &amp; Trackpad</string>
+            <key>Skipped</key><dict><key>Name</key><string>no</string><key>List</key><array><integer>1</integer><true/></array></dict>
+            <key>Current Capacity</key><integer>42</integer>
+            <key>Combined Parts</key>
+            <array>
+                <dict><key>Part Identifier</key><string>Left</string><key>Is Charging</key><true/></dict>
+                <dict><key>Part Identifier</key><string>Right</string><key>Is Charging</key><false/></dict>
+            </array>
+        </dict>
+        </plist>
+        <?xml version="1.0" encoding="UTF-8"?>
+        <plist version="1.0"><dict><key>Name</key><string>Mouse</string><key>Current Capacity</key><integer>7</integer></dict></plist>
+        """
+        let accessories = StreamExtractor([["*", "Name"], ["*", "Current Capacity"], ["*", "Combined Parts", "*", "Is Charging"]])
+        let list = try XCTUnwrap(Array(plist.utf8).withUnsafeBytes{ accessories.plist($0) })
+        XCTAssertEqual(list.map{ $0.value }, [.string("Keyboard & Trackpad"), .integer(42), .bool(true), .bool(false), .string("Mouse"), .integer(7)])
+        XCTAssertEqual(list[3].keys, ["0", "1"])
+        XCTAssertEqual(list[4].keys, ["1"])
+        
+        XCTAssertNil(Array("<plist><dict><key>Name</key><string>x</dict></plist>".utf8).withUnsafeBytes{ accessories.plist($0) })
+    }
+    
+    func testNotificationRules() {
+        let engine = RuleEngine()
+        let cpu = engine.slot("cpu")
+        let temperature = engine.slot("temperature")
+        XCTAssertEqual(engine.slot("cpu"), cpu)
+        
+        engine.set(NotificationRule(id: "load", conditions: [RuleCondition(slot: cpu, .above(0.8))], consecutive: 2))
+        engine.update(cpu, 0.9)
+        XCTAssertEqual(engine.evaluate(0), [])
+        engine.update(cpu, 0.95)
+        XCTAssertEqual(engine.evaluate(1), [.fired("load")])
+        engine.update(cpu, 0.85)
+        XCTAssertEqual(engine.evaluate(2), [])
+        engine.update(cpu, 0.7)
+        XCTAssertEqual(engine.evaluate(3), [.cleared("load")])
+        
+        engine.set(NotificationRule(id: "temperature", conditions: [RuleCondition(slot: temperature, .above(90, band: 5))]))
+        engine.update(temperature, 91)
+        XCTAssertEqual(engine.evaluate(4), [.fired("temperature")])
+        engine.update(temperature, 87)
+        XCTAssertEqual(engine.evaluate(5), [])
+        engine.update(temperature, 84)
+        XCTAssertEqual(engine.evaluate(6), [.cleared("temperature")])
+        
+        engine.set(NotificationRule(id: "hot", conditions: [RuleCondition(slot: cpu, .above(0.9)), RuleCondition(slot: temperature, .above(95))], duration: 2))
+        engine.update(cpu, 0.95)
+        engine.update(temperature, 96)
+        XCTAssertEqual(engine.evaluate(10), [.fired("temperature")])
+        engine.update(cpu, 0.95)
+        engine.update(temperature, 96)
+        XCTAssertEqual(engine.evaluate(11), [.fired("load")])
+        engine.update(cpu, 0.95)
+        engine.update(temperature, 96)
+        XCTAssertEqual(engine.evaluate(12), [.fired("hot")])
+        engine.update(temperature, nil)
+        XCTAssertEqual(engine.evaluate(13), [.cleared("temperature"), .cleared("hot")])
+        XCTAssertTrue(engine.isFiring("load"))
+        
+        engine.set(NotificationRule(id: "load", conditions: [RuleCondition(slot: cpu, .above(0.5))], consecutive: 2))
+        engine.update(cpu, 0.6)
+        XCTAssertEqual(engine.evaluate(14), [])
+        XCTAssertTrue(engine.isFiring("load"))
+        engine.remove("load")
+        XCTAssertFalse(engine.isFiring("load"))
+        engine.update(cpu, 0.3)
+        XCTAssertEqual(engine.evaluate(15), [])
+        
+        let rate = RuleEngine()
+        let swap = rate.slot("swap")
+        rate.set(NotificationRule(id: "swap", conditions: [RuleCondition(slot: swap, .rate(10))]))
+        XCTAssertEqual([0, 5, 20, 20].enumerated().map{ rate.update(swap, $0.element); return rate.evaluate(TimeInterval($0.offset)) }, [[], [], [.fired("swap")], [.cleared("swap")]])
+        
+        let anomaly = RuleEngine()
+        let fan = anomaly.slot("fan")
+        anomaly.set(NotificationRule(id: "fan", conditions: [RuleCondition(slot: fan, .anomaly(alpha: 0.25, deviations: 3))]))
+        let events = [10, 11, 10, 11, 10, 11, 20, 10.5].enumerated().map{ anomaly.update(fan, $0.element); return anomaly.evaluate(TimeInterval($0.offset)) }
+        XCTAssertEqual(events, [[], [], [], [], [], [], [.fired("fan")], [.cleared("fan")]])
+        
+        // a condition on a slot which was not updated keeps its state, the rate does not see a zero change
+        let cross = RuleEngine()
+        let pressure = cross.slot("pressure")
+        let swapped = cross.slot("swapped")
+        cross.set(NotificationRule(id: "swapping", conditions: [RuleCondition(slot: swapped, .rate(10)), RuleCondition(slot: pressure, .above(50))]))
+        cross.update(pressure, 60)
+        cross.update(swapped, 0)
+        XCTAssertEqual(cross.evaluate(0), [])
+        cross.update(swapped, 20)
+        XCTAssertEqual(cross.evaluate(1), [.fired("swapping")])
+        cross.update(pressure, 70)
+        XCTAssertEqual(cross.evaluate(2), [])
+        cross.update(swapped, 25)
+        XCTAssertEqual(cross.evaluate(3), [.cleared("swapping")])
+        
+        XCTAssertFalse(cross.set(NotificationRule(id: "zero", conditions: [RuleCondition(slot: pressure, .anomaly(alpha: 0, deviations: 3))])))
+        XCTAssertFalse(cross.set(NotificationRule(id: "large", conditions: [RuleCondition(slot: pressure, .anomaly(alpha: 1.5, deviations: 3))])))
+        XCTAssertTrue(cross.set(NotificationRule(id: "one", conditions: [RuleCondition(slot: pressure, .anomaly(alpha: 1, deviations: 3))])))
+        XCTAssertFalse(cross.set(NotificationRule(id: "unknown", conditions: [RuleCondition(slot: pressure, .above(1)), RuleCondition(slot: 2, .above(1))])))
+        XCTAssertFalse(cross.set(NotificationRule(id: "negative", conditions: [RuleCondition(slot: -1, .below(1))])))
+        XCTAssertFalse(cross.isFiring("unknown"))
+        cross.update(pressure, 80)
+        XCTAssertEqual(cross.evaluate(4), [])
+    }
+    
+    // MARK: - benchmarks of the Swift cores, the numbers in the Xcode test report are the reference
+    
+    func testPerformance_coreLoadTable() throws {
+        let table = CoreLoadTable(count: 64, cores: (0..<64).map{ core_s(id: Int32($0), type: $0 < 16 ? .efficiency : .performance) })
+        var counters = [Int32](repeating: 0, count: 64 * 4)
+        measure {
+            for tick in 0..<10_000 {
+                for i in 0..<counters.count {
+                    counters[i] &+= Int32((tick &+ i) % 7)
+                }
+                _ = counters.withUnsafeBufferPointer{ table.update($0) }
+            }
+        }
+    }
+    
+    func testPerformance_chartDecimator() throws {
+        measure {
+            let decimator = ChartDecimator(capacity: 10_000, columns: 270)
+            for i in 0..<100_000 {
+                decimator.append(i, Double(i % 997))
+                decimator.trim(oldest: i + 1 - 10_000) { Double($0 % 997) }
+            }
+            _ = decimator.samples()
+        }
+    }
+    
+    func testPerformance_valueFormatter() throws {
+        measure {
+            for i in 0..<100_000 {
+                _ = ValueFormatter.decimal(Double(i) / 7, digits: 1)
+            }
+        }
+    }
+    
+    func testPerformance_metricsFrame() throws {
+        let time = Date(timeIntervalSince1970: 1_760_000_000)
+        measure {
+            let encoder = MetricsFrameEncoder()
+            let decoder = MetricsFrameDecoder()
+            for i in 0..<10_000 {
+                let updates = [
+                    MetricUpdate(key: "CPU", time: time.addingTimeInterval(Double(i)), payload: Data("1,1,0.\(i % 100),2,0.2,0.3,$".utf8)),
+                    MetricUpdate(key: "RAM", time: time.addingTimeInterval(Double(i)), payload: Data("17179869184,8589934592,1,0$".utf8))
+                ]
+                _ = try? decoder.decode(encoder.encode(updates))
+            }
+        }
+    }
+    
+    func testPerformance_MQTTDecoder() throws {
+        let encoder = MQTTEncoder()
+        var stream = Data()
+        for i in 0..<10_000 {
+            stream.append(try encoder.publish(topic: "stats/id/metrics/CPU", payload: Data(repeating: UInt8(i % 256), count: 120), qos: 1, packetId: UInt16(i % 60_000 + 1)))
+        }
+        measure {
+            let decoder = MQTTDecoder()
+            var offset = 0
+            while offset < stream.count {
+                let size = min(1_500, stream.count - offset)
+                decoder.append(stream.subdata(in: offset..<offset+size))
+                offset += size
+                while let packet = try? decoder.next() {
+                    _ = try? packet.publish()
+                }
+            }
+        }
+    }
+    
+    func testPerformance_openMetrics() throws {
+        let registry = OpenMetricsRegistry()
+        measure {
+            for tick in 0..<1_000 {
+                registry.update(source: "CPU@LoadReader", (0..<64).map{ OpenMetric("stats_cpu_core_usage_ratio", Double((tick + $0) % 100) / 100, unit: "ratio", labels: [("core", "\($0)")]) })
+                _ = registry.exposition()
+            }
+        }
+    }
+    
+    func testPerformance_interfaceCounters() throws {
+        var list = (0..<40).map{ InterfaceCounter(index: $0 + 1, name: "utun\($0)", ibytes: 0, obytes: 0) }
+        let table = InterfaceCounterTable()
+        measure {
+            for _ in 0..<10_000 {
+                for i in 0..<list.count {
+                    list[i].ibytes += UInt64(i * 100)
+                    list[i].obytes += UInt64(i * 50)
+                }
+                table.update(list)
+            }
+        }
+    }
+    
+    func testPerformance_energyEstimator() throws {
+        let estimator = EnergyEstimator()
+        measure {
+            for tick in 0..<100 {
+                let interval = estimator.begin(TimeInterval(tick))
+                for pid in 0..<1_000 {
+                    estimator.add(Int32(pid), EnergyCounters(start: UInt64(pid), cpuTime: UInt64(tick * pid * 1_000), wakeups: UInt64(tick * 10)), interval: interval)
+                }
+            }
+        }
+    }
+    
+    func testPerformance_streamExtractor() throws {
+        let devices = (0..<1_000).map{ "{\"Device \($0)\": {\"device_address\": \"AA:BB:\($0)\", \"device_batteryLevelLeft\": \"\($0 % 100)%\", \"list\": [1, 2, 3]}}" }
+        let json = Array("{\"SPBluetoothDataType\": [{\"device_connected\": [\(devices.joined(separator: ","))]}]}".utf8)
+        let extractor = StreamExtractor([
+            ["SPBluetoothDataType", "0", "device_connected", "*", "*", "device_address"],
+            ["SPBluetoothDataType", "0", "device_connected", "*", "*", "device_batteryLevelLeft"]
+        ])
+        measure {
+            for _ in 0..<20 {
+                _ = json.withUnsafeBytes{ extractor.json($0) }
+            }
+        }
+    }
+    
+    func testPerformance_notificationRules() throws {
+        let engine = RuleEngine()
+        let slots = (0..<50).map{ engine.slot("sensor \($0)") }
+        for (i, slot) in slots.enumerated() {
+            engine.set(NotificationRule(id: "rule \(i)", conditions: [RuleCondition(slot: slot, .above(90, band: 5)), RuleCondition(slot: slots[(i + 1) % slots.count], .anomaly(alpha: 0.1, deviations: 3))]))
+        }
+        measure {
+            for tick in 0..<10_000 {
+                for (i, slot) in slots.enumerated() {
+                    engine.update(slot, Double((tick + i) % 100))
+                }
+                _ = engine.evaluate(TimeInterval(tick))
+            }
+        }
+    }
 }